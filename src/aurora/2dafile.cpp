@@ -27,6 +27,10 @@
  *  Handling BioWare's 2DAs (two-dimensional array).
  */
 
+#include <cstring>
+
+#include <boost/unordered/unordered_map.hpp>
+
 #include "common/util.h"
 #include "common/strutil.h"
 #include "common/stream.h"
@@ -42,70 +46,47 @@ static const uint32 kVersion2b = MKTAG('V', '2', '.', 'b');
 
 namespace Aurora {
 
-TwoDARow::TwoDARow(TwoDAFile &parent) : _parent(&parent) {
-}
-
-TwoDARow::~TwoDARow() {
+TwoDARow::TwoDARow(const TwoDAFile &parent, uint32 row) : _parent(&parent), _row(row) {
 }
 
 const Common::UString &TwoDARow::getString(uint32 column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
+	const uint32 cell = _parent->getCell(_row, column);
+	if ((cell == kFieldIDInvalid) || _parent->isEmpty(cell))
 		return _parent->_defaultString;
 
-	return cell;
+	return _parent->_strings[_parent->_cellStrings[cell]];
 }
 
 const Common::UString &TwoDARow::getString(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultString;
-
-	return cell;
+	return getString(_parent->headerToColumn(column));
 }
 
 const int32 TwoDARow::getInt(uint32 column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
+	const uint32 cell = _parent->getCell(_row, column);
+	if (cell == kFieldIDInvalid)
 		return _parent->_defaultInt;
 
-	return _parent->parseInt(cell);
+	return _parent->_cellInts[cell];
 }
 
 const int32 TwoDARow::getInt(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultInt;
-
-	return _parent->parseInt(cell);
+	return getInt(_parent->headerToColumn(column));
 }
 
 const float TwoDARow::getFloat(uint32 column) const {
-	const Common::UString &cell = getCell(column);
-	if (cell.empty() || (cell == "****"))
+	const uint32 cell = _parent->getCell(_row, column);
+	if (cell == kFieldIDInvalid)
 		return _parent->_defaultFloat;
 
-	return _parent->parseFloat(cell);
+	return _parent->_cellFloats[cell];
 }
 
 const float TwoDARow::getFloat(const Common::UString &column) const {
-	const Common::UString &cell = getCell(_parent->headerToColumn(column));
-	if (cell.empty() || (cell == "****"))
-		return _parent->_defaultFloat;
-
-	return _parent->parseFloat(cell);
-}
-
-static const Common::UString kEmpty;
-const Common::UString &TwoDARow::getCell(uint32 n) const {
-	if (n >= _data.size())
-		return kEmpty;
-
-	return _data[n];
+	return getFloat(_parent->headerToColumn(column));
 }
 
 
-TwoDAFile::TwoDAFile() : _defaultInt(0), _defaultFloat(0.0), _emptyRow(*this) {
+TwoDAFile::TwoDAFile() : _defaultInt(0), _defaultFloat(0.0), _emptyRow(*this, kFieldIDInvalid) {
 }
 
 TwoDAFile::~TwoDAFile() {
@@ -117,10 +98,14 @@ void TwoDAFile::clear() {
 
 	_headers.clear();
 
-	for (std::vector<TwoDARow *>::iterator row = _rows.begin(); row != _rows.end(); ++row)
-		delete *row;
 	_rows.clear();
 
+	_strings.clear();
+	_cellStrings.clear();
+	_cellInts.clear();
+	_cellFloats.clear();
+	_cellEmpty.clear();
+
 	_headerMap.clear();
 
 	_defaultString.clear();
@@ -144,10 +129,16 @@ void TwoDAFile::load(Common::SeekableReadStream &twoda) {
 
 	try {
 
+		// The string indices of the cells, as read, in row-major order
+		std::vector<uint32> cells;
+
 		if      (_version == kVersion2a)
-			read2a(twoda);
+			read2a(twoda, cells);
 		else if (_version == kVersion2b)
-			read2b(twoda);
+			read2b(twoda, cells);
+
+		// Parse the cells into typed columns
+		createColumns(cells);
 
 		// Create the map to quickly translate headers to column indices
 		createHeaderMap();
@@ -162,7 +153,7 @@ void TwoDAFile::load(Common::SeekableReadStream &twoda) {
 
 }
 
-void TwoDAFile::read2a(Common::SeekableReadStream &twoda) {
+void TwoDAFile::read2a(Common::SeekableReadStream &twoda, std::vector<uint32> &cells) {
 	Common::StreamTokenizer tokenize(Common::StreamTokenizer::kRuleIgnoreAll);
 
 	tokenize.addSeparator(' ');
@@ -173,13 +164,15 @@ void TwoDAFile::read2a(Common::SeekableReadStream &twoda) {
 
 	readDefault2a(twoda, tokenize);
 	readHeaders2a(twoda, tokenize);
-	readRows2a(twoda, tokenize);
+	readRows2a(twoda, tokenize, cells);
 }
 
-void TwoDAFile::read2b(Common::SeekableReadStream &twoda) {
+void TwoDAFile::read2b(Common::SeekableReadStream &twoda, std::vector<uint32> &cells) {
 	readHeaders2b(twoda);
-	skipRowNames2b(twoda);
-	readRows2b(twoda);
+
+	const uint32 rowCount = skipRowNames2b(twoda);
+
+	readRows2b(twoda, rowCount, cells);
 }
 
 void TwoDAFile::readDefault2a(Common::SeekableReadStream &twoda,
@@ -206,26 +199,37 @@ void TwoDAFile::readHeaders2a(Common::SeekableReadStream &twoda,
 }
 
 void TwoDAFile::readRows2a(Common::SeekableReadStream &twoda,
-                           Common::StreamTokenizer &tokenize) {
+                           Common::StreamTokenizer &tokenize,
+                           std::vector<uint32> &cells) {
+
+	typedef boost::unordered_map<Common::UString, uint32, Common::hashUStringCaseSensitive> StringIndex;
 
 	uint32 columnCount = _headers.size();
 
-	while (!twoda.eos()) {
-		TwoDARow *row = new TwoDARow(*this);
+	// Most cells share a few values, so each distinct string is only stored once
+	StringIndex stringIndex;
 
+	std::vector<Common::UString> row;
+	while (!twoda.eos()) {
 		tokenize.skipToken(twoda);
 
-		int count = tokenize.getTokens(twoda, row->_data, columnCount, columnCount);
+		int count = tokenize.getTokens(twoda, row, columnCount, columnCount);
 
 		tokenize.nextChunk(twoda);
 
-		if (count == 0) {
+		if (count == 0)
 			// Ignore empty lines
-			delete row;
 			continue;
-		}
 
-		_rows.push_back(row);
+		for (std::vector<Common::UString>::const_iterator c = row.begin(); c != row.end(); ++c) {
+			std::pair<StringIndex::iterator, bool> string =
+				stringIndex.insert(std::make_pair(*c, (uint32) _strings.size()));
+
+			if (string.second)
+				_strings.push_back(*c);
+
+			cells.push_back(string.first->second);
+		}
 	}
 }
 
@@ -243,59 +247,100 @@ void TwoDAFile::readHeaders2b(Common::SeekableReadStream &twoda) {
 	}
 }
 
-void TwoDAFile::skipRowNames2b(Common::SeekableReadStream &twoda) {
+uint32 TwoDAFile::skipRowNames2b(Common::SeekableReadStream &twoda) {
 	uint32 rowCount = twoda.readUint32LE();
 
-	_rows.reserve(rowCount);
-	for (uint32 i = 0; i < rowCount; i++)
-		_rows.push_back(0);
-
 	Common::StreamTokenizer tokenize(Common::StreamTokenizer::kRuleHeed);
 
 	tokenize.addSeparator('\t');
 	tokenize.addSeparator('\0');
 
 	tokenize.skipToken(twoda, rowCount);
+
+	return rowCount;
 }
 
-void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda) {
+void TwoDAFile::readRows2b(Common::SeekableReadStream &twoda, uint32 rowCount,
+                           std::vector<uint32> &cells) {
+
 	uint32 columnCount = _headers.size();
-	uint32 rowCount    = _rows.size();
 	uint32 cellCount   = columnCount * rowCount;
 
-	uint32 *offsets = new uint32[cellCount];
-
-	Common::StreamTokenizer tokenize(Common::StreamTokenizer::kRuleHeed);
-
-	tokenize.addSeparator('\0');
+	cells.resize(cellCount);
 
 	for (uint32 i = 0; i < cellCount; i++)
-		offsets[i] = twoda.readUint16LE();
+		cells[i] = twoda.readUint16LE();
 
 	twoda.skip(2); // Reserved
 
-	uint32 dataOffset = twoda.pos();
+	/* The data block already holds every distinct string only once, and the cells
+	 * reference them by offset. So we read the whole block in one go, and then
+	 * turn each referenced offset into a string exactly once. */
 
-	for (uint32 i = 0; i < rowCount; i++) {
-		_rows[i] = new TwoDARow(*this);
+	const uint32 dataSize = twoda.size() - twoda.pos();
+
+	std::vector<char> data(dataSize + 1, '\0');
+	if (dataSize > 0)
+		if (twoda.read(&data[0], dataSize) != dataSize)
+			throw Common::Exception(Common::kReadError);
 
-		_rows[i]->_data.resize(columnCount);
+	std::vector<uint32> offsetToString(dataSize + 1, kFieldIDInvalid);
 
-		for (uint32 j = 0; j < columnCount; j++) {
-			uint32 offset = dataOffset + offsets[i * columnCount + j];
+	for (uint32 i = 0; i < cellCount; i++) {
+		const uint32 offset = cells[i];
+		if (offset > dataSize)
+			throw Common::Exception(Common::kSeekError);
 
-			if (!twoda.seek(offset)) {
-				delete[] offsets;
-				throw Common::Exception(Common::kSeekError);
-			}
+		if (offsetToString[offset] == kFieldIDInvalid) {
+			offsetToString[offset] = _strings.size();
 
-			_rows[i]->_data[j] = tokenize.getToken(twoda);
-			if (_rows[i]->_data[j].empty())
-				_rows[i]->_data[j] = "****";
+			const char *string = &data[offset];
+			_strings.push_back((*string == '\0') ? "****" : string);
 		}
+
+		cells[i] = offsetToString[offset];
+	}
+}
+
+void TwoDAFile::createColumns(const std::vector<uint32> &cells) {
+	const uint32 columnCount = _headers.size();
+	const uint32 rowCount    = (columnCount > 0) ? (cells.size() / columnCount) : 0;
+	const uint32 cellCount   = columnCount * rowCount;
+
+	// Parse every distinct string only once
+	std::vector<int32> stringInts  (_strings.size());
+	std::vector<float> stringFloats(_strings.size());
+	std::vector<bool>  stringEmpty (_strings.size());
+
+	for (uint32 i = 0; i < _strings.size(); i++) {
+		stringEmpty[i] = _strings[i].empty() || (_strings[i] == "****");
+
+		stringInts  [i] = stringEmpty[i] ? _defaultInt   : parseInt  (_strings[i]);
+		stringFloats[i] = stringEmpty[i] ? _defaultFloat : parseFloat(_strings[i]);
+	}
+
+	_cellStrings.resize(cellCount);
+	_cellInts.resize(cellCount);
+	_cellFloats.resize(cellCount);
+	_cellEmpty.resize((cellCount + 31) / 32, 0);
+
+	for (uint32 i = 0; i < cellCount; i++) {
+		const uint32 index = cells[i];
+
+		// Transpose from row-major into column-major
+		const uint32 cell = (i % columnCount) * rowCount + (i / columnCount);
+
+		_cellStrings[cell] = index;
+		_cellInts   [cell] = stringInts[index];
+		_cellFloats [cell] = stringFloats[index];
+
+		if (stringEmpty[index])
+			_cellEmpty[cell >> 5] |= 1U << (cell & 31);
 	}
 
-	delete[] offsets;
+	_rows.reserve(rowCount);
+	for (uint32 i = 0; i < rowCount; i++)
+		_rows.push_back(TwoDARow(*this, i));
 }
 
 void TwoDAFile::createHeaderMap() {
@@ -325,11 +370,41 @@ uint32 TwoDAFile::headerToColumn(const Common::UString &header) const {
 }
 
 const TwoDARow &TwoDAFile::getRow(uint32 row) const {
-	if ((row >= _rows.size()) || !_rows[row])
+	if (row >= _rows.size())
 		// No such row
 		return _emptyRow;
 
-	return *_rows[row];
+	return _rows[row];
+}
+
+uint32 TwoDAFile::getCell(uint32 row, uint32 column) const {
+	if ((row >= _rows.size()) || (column >= _headers.size()))
+		return kFieldIDInvalid;
+
+	return column * _rows.size() + row;
+}
+
+bool TwoDAFile::isEmpty(uint32 cell) const {
+	return (_cellEmpty[cell >> 5] & (1U << (cell & 31))) != 0;
+}
+
+uint32 TwoDAFile::getStringCount() const {
+	return _strings.size();
+}
+
+uint32 TwoDAFile::getMemoryUsage() const {
+	uint32 size = 0;
+
+	for (std::vector<Common::UString>::const_iterator s = _strings.begin(); s != _strings.end(); ++s)
+		size += sizeof(Common::UString) + std::strlen(s->c_str()) + 1;
+
+	size += _cellStrings.capacity() * sizeof(uint32);
+	size += _cellInts.capacity()    * sizeof(int32);
+	size += _cellFloats.capacity()  * sizeof(float);
+	size += _cellEmpty.capacity()   * sizeof(uint32);
+	size += _rows.capacity()        * sizeof(TwoDARow);
+
+	return size;
 }
 
 bool TwoDAFile::dumpASCII(const Common::UString &fileName) const {
@@ -354,8 +429,8 @@ bool TwoDAFile::dumpASCII(const Common::UString &fileName) const {
 		colLength[i + 1] = _headers[i].size();
 
 	for (uint32 i = 0; i < _rows.size(); i++)
-		for (uint32 j = 0; j < _rows[i]->_data.size(); j++)
-			colLength[j + 1] = MAX<uint32>(colLength[j + 1], _rows[i]->_data[j].size());
+		for (uint32 j = 0; j < _headers.size(); j++)
+			colLength[j + 1] = MAX<uint32>(colLength[j + 1], _strings[_cellStrings[getCell(i, j)]].size());
 
 	// Write column headers
 
@@ -371,8 +446,9 @@ bool TwoDAFile::dumpASCII(const Common::UString &fileName) const {
 	for (uint32 i = 0; i < _rows.size(); i++) {
 		file.writeString(Common::UString::sprintf("%*d", colLength[0], i));
 
-		for (uint32 j = 0; j < _rows[i]->_data.size(); j++)
-			file.writeString(Common::UString::sprintf(" %-*s", colLength[j + 1], _rows[i]->_data[j].c_str()));
+		for (uint32 j = 0; j < _headers.size(); j++)
+			file.writeString(Common::UString::sprintf(" %-*s", colLength[j + 1],
+			                 _strings[_cellStrings[getCell(i, j)]].c_str()));
 
 		file.writeByte('\n');
 	}
@@ -48,6 +48,11 @@ namespace Aurora {
 
 class TwoDAFile;
 
+/** A row within a 2DA file.
+ *
+ *  A row holds no data of its own; it merely references a row index
+ *  within its parent's column-major cell arrays.
+ */
 class TwoDARow {
 public:
 	/** Return the contents of a cell as a string. */
@@ -66,14 +71,11 @@ public:
 	const float getFloat(const Common::UString &column) const;
 
 private:
-	TwoDAFile *_parent; ///< The parent 2DA.
+	const TwoDAFile *_parent; ///< The parent 2DA.
 
-	std::vector<Common::UString> _data;
+	uint32 _row; ///< The index of this row, or kFieldIDInvalid for the empty row.
 
-	TwoDARow(TwoDAFile &parent);
-	~TwoDARow();
-
-	const Common::UString &getCell(uint32 n) const;
+	TwoDARow(const TwoDAFile &parent, uint32 row);
 
 	friend class TwoDAFile;
 };
@@ -111,6 +113,11 @@ public:
 	/** Dump the 2DA data into an V2.0 ASCII 2DA. */
 	bool dumpASCII(const Common::UString &fileName) const;
 
+	/** Return the number of distinct cell strings in the array. */
+	uint32 getStringCount() const;
+	/** Return the approximate number of bytes used by the array's data. */
+	uint32 getMemoryUsage() const;
+
 private:
 	typedef std::map<Common::UString, uint32, Common::UString::iless> HeaderMap;
 
@@ -121,25 +128,45 @@ private:
 	std::vector<Common::UString> _headers;
 	HeaderMap _headerMap;
 
+	/** All distinct cell strings. */
+	std::vector<Common::UString> _strings;
+
+	/* The cells are stored column-major, indexed by column * rowCount + row.
+	 * Ints and floats are parsed once on load, with empty cells ("****")
+	 * already replaced by the default values. */
+
+	std::vector<uint32> _cellStrings; ///< Index into _strings of each cell.
+	std::vector<int32>  _cellInts;    ///< Each cell parsed as an int.
+	std::vector<float>  _cellFloats;  ///< Each cell parsed as a float.
+	std::vector<uint32> _cellEmpty;   ///< Bitmap of empty cells.
+
 	TwoDARow _emptyRow;
-	std::vector<TwoDARow *> _rows;
+	std::vector<TwoDARow> _rows;
 
 	// Loading helpers
-	void read2a(Common::SeekableReadStream &twoda);
-	void read2b(Common::SeekableReadStream &twoda);
+	void read2a(Common::SeekableReadStream &twoda, std::vector<uint32> &cells);
+	void read2b(Common::SeekableReadStream &twoda, std::vector<uint32> &cells);
 
 	// ASCII loading helpers
 	void readDefault2a(Common::SeekableReadStream &twoda, Common::StreamTokenizer &tokenize);
 	void readHeaders2a(Common::SeekableReadStream &twoda, Common::StreamTokenizer &tokenize);
-	void readRows2a   (Common::SeekableReadStream &twoda, Common::StreamTokenizer &tokenize);
+	void readRows2a   (Common::SeekableReadStream &twoda, Common::StreamTokenizer &tokenize,
+	                   std::vector<uint32> &cells);
 
 	// Binary loading helpers
 	void readHeaders2b (Common::SeekableReadStream &twoda);
-	void skipRowNames2b(Common::SeekableReadStream &twoda);
-	void readRows2b    (Common::SeekableReadStream &twoda);
+	uint32 skipRowNames2b(Common::SeekableReadStream &twoda);
+	void readRows2b    (Common::SeekableReadStream &twoda, uint32 rowCount,
+	                    std::vector<uint32> &cells);
 
+	/** Build the typed columns out of the row-major string indices of all cells. */
+	void createColumns(const std::vector<uint32> &cells);
 	void createHeaderMap();
 
+	/** Return the index of a cell, or kFieldIDInvalid if it doesn't exist. */
+	uint32 getCell(uint32 row, uint32 column) const;
+	bool isEmpty(uint32 cell) const;
+
 	static int32 parseInt(const Common::UString &str);
 	static float parseFloat(const Common::UString &str);
 
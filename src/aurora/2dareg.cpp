@@ -27,8 +27,12 @@
  *  The global 2DA registry.
  */
 
+#include <vector>
+
 #include "common/error.h"
 #include "common/stream.h"
+#include "common/debug.h"
+#include "common/timestamp.h"
 
 #include "aurora/2dareg.h"
 #include "aurora/2dafile.h"
@@ -38,7 +42,30 @@ DECLARE_SINGLETON(Aurora::TwoDARegistry)
 
 namespace Aurora {
 
-TwoDARegistry::TwoDARegistry() {
+/** FNV-1a hash over a block of data. */
+static uint64 hashData(const byte *data, uint32 size) {
+	uint64 hash = 0xCBF29CE484222325ULL;
+
+	while (size-- > 0)
+		hash = (hash ^ *data++) * 0x100000001B3ULL;
+
+	return hash;
+}
+
+
+TwoDARegistry::Stats::Stats() : hits(0), reused(0), loads(0), evictions(0),
+	count(0), size(0), maxSize(0), checkTime(0), loadTime(0) {
+
+}
+
+
+TwoDARegistry::Entry::Entry() : twoda(0), fingerprint(0), dataSize(0), size(0),
+	checked(false), lastUsed(0) {
+
+}
+
+
+TwoDARegistry::TwoDARegistry() : _size(0), _maxSize(kDefaultMaxSize), _useCounter(0) {
 }
 
 TwoDARegistry::~TwoDARegistry() {
@@ -47,37 +74,43 @@ TwoDARegistry::~TwoDARegistry() {
 
 void TwoDARegistry::clear() {
 	for (TwoDAMap::iterator it = _twodas.begin(); it != _twodas.end(); ++it)
-		delete it->second;
+		delete it->second.twoda;
 
 	_twodas.clear();
-}
 
-const TwoDAFile &TwoDARegistry::get(const Common::UString &name) {
-	TwoDAMap::const_iterator twoda = _twodas.find(name);
-	if (twoda != _twodas.end())
-		// Entry exists => return
-		return *twoda->second;
+	_size = 0;
+}
 
-	// Entry doesn't exist => load and add
+void TwoDARegistry::invalidate() {
+	for (TwoDAMap::iterator it = _twodas.begin(); it != _twodas.end(); ++it)
+		it->second.checked = false;
 
-	TwoDAFile *newTwoDA = load(name);
+	trim();
+}
 
-	std::pair<TwoDAMap::iterator, bool> result;
-	result = _twodas.insert(std::make_pair(name, newTwoDA));
+void TwoDARegistry::setMaxSize(uint32 maxSize) {
+	_maxSize = maxSize;
 
-	return *result.first->second;
+	trim();
 }
 
-void TwoDARegistry::add(const Common::UString &name) {
+const TwoDAFile &TwoDARegistry::get(const Common::UString &name) {
 	TwoDAMap::iterator twoda = _twodas.find(name);
-	if (twoda != _twodas.end()) {
-		// Entry exists => remove first
-		delete twoda->second;
-		_twodas.erase(twoda);
+	if ((twoda != _twodas.end()) && twoda->second.checked) {
+		// Entry exists and is up-to-date => return
+		_stats.hits++;
+
+		twoda->second.lastUsed = _useCounter++;
+		return *twoda->second.twoda;
 	}
 
-	// Load and add
-	_twodas[name] = load(name);
+	// Entry doesn't exist or might be outdated => check and load if necessary
+
+	return *load(name, false).twoda;
+}
+
+void TwoDARegistry::add(const Common::UString &name) {
+	load(name, true);
 }
 
 void TwoDARegistry::remove(const Common::UString &name) {
@@ -86,34 +119,135 @@ void TwoDARegistry::remove(const Common::UString &name) {
 		// Does exist, nothing to do
 		return;
 
-	delete twoda->second;
-	_twodas.erase(twoda);
+	removeEntry(twoda);
 }
 
-TwoDAFile *TwoDARegistry::load(const Common::UString &name) {
+TwoDARegistry::Stats TwoDARegistry::getStats() const {
+	Stats stats = _stats;
+
+	stats.count   = _twodas.size();
+	stats.size    = _size;
+	stats.maxSize = _maxSize;
+
+	return stats;
+}
+
+void TwoDARegistry::resetStats() {
+	_stats = Stats();
+}
+
+TwoDARegistry::Entry &TwoDARegistry::load(const Common::UString &name, bool force) {
+	const uint64 startTime = Common::getMicroseconds();
+
+	// Read the whole resource, to see whether it changed
+
 	Common::SeekableReadStream *twodaFile = 0;
-	TwoDAFile *twoda = new TwoDAFile;
+	std::vector<byte> data;
 	try {
 		if (!(twodaFile = ResMan.getResource(name, kFileType2DA)))
 			throw Common::Exception("No such 2DA");
 
-		twoda->load(*twodaFile);
+		data.resize(twodaFile->size());
+		if (!data.empty())
+			if (twodaFile->read(&data[0], data.size()) != data.size())
+				throw Common::Exception(Common::kReadError);
 
 		delete twodaFile;
 	} catch (Common::Exception &e) {
 		delete twodaFile;
-		delete twoda;
 
 		e.add("Failed loading 2DA \"%s\"", name.c_str());
 		throw e;
 
 	} catch (...) {
 		delete twodaFile;
-		delete twoda;
 		throw;
 	}
 
-	return twoda;
+	const uint64 fingerprint = hashData(data.empty() ? 0 : &data[0], data.size());
+
+	const uint64 checkedTime = Common::getMicroseconds();
+	_stats.checkTime += checkedTime - startTime;
+
+	TwoDAMap::iterator twoda = _twodas.find(name);
+	if (!force && (twoda != _twodas.end()) &&
+	    (twoda->second.dataSize == data.size()) && (twoda->second.fingerprint == fingerprint)) {
+
+		// Unchanged => reuse
+		_stats.reused++;
+
+		twoda->second.checked  = true;
+		twoda->second.lastUsed = _useCounter++;
+
+		return twoda->second;
+	}
+
+	// New or changed => (re)load
+
+	Common::MemoryReadStream twodaStream(data.empty() ? 0 : &data[0], data.size());
+
+	TwoDAFile *newTwoDA = new TwoDAFile;
+	try {
+		newTwoDA->load(twodaStream);
+	} catch (Common::Exception &e) {
+		delete newTwoDA;
+
+		e.add("Failed loading 2DA \"%s\"", name.c_str());
+		throw e;
+
+	} catch (...) {
+		delete newTwoDA;
+		throw;
+	}
+
+	if (twoda != _twodas.end())
+		removeEntry(twoda);
+
+	Entry &entry = _twodas[name];
+
+	entry.twoda       = newTwoDA;
+	entry.fingerprint = fingerprint;
+	entry.dataSize    = data.size();
+	entry.size        = newTwoDA->getMemoryUsage();
+	entry.checked     = true;
+	entry.lastUsed    = _useCounter++;
+
+	_size += entry.size;
+
+	_stats.loads++;
+	_stats.loadTime += Common::getMicroseconds() - checkedTime;
+
+	trim();
+
+	return entry;
+}
+
+void TwoDARegistry::removeEntry(TwoDAMap::iterator entry) {
+	_size -= entry->second.size;
+
+	delete entry->second.twoda;
+	_twodas.erase(entry);
+}
+
+void TwoDARegistry::trim() {
+	while (_size > _maxSize) {
+		// Find the least recently used 2DA that's not in use
+		TwoDAMap::iterator oldest = _twodas.end();
+		for (TwoDAMap::iterator it = _twodas.begin(); it != _twodas.end(); ++it)
+			if (!it->second.checked && ((oldest == _twodas.end()) ||
+			    (it->second.lastUsed < oldest->second.lastUsed)))
+				oldest = it;
+
+		if (oldest == _twodas.end())
+			// Everything left might still be referenced
+			break;
+
+		debugC(2, Common::kDebugResources, "Evicting 2DA \"%s\" (%u bytes)",
+		       oldest->first.c_str(), oldest->second.size);
+
+		removeEntry(oldest);
+		_stats.evictions++;
+	}
 }
 
 } // End of namespace Aurora
@@ -41,14 +41,51 @@ namespace Aurora {
 
 class TwoDAFile;
 
-/** The global 2DA registry, holding all current 2DAs. */
+/** The global 2DA registry, holding all current 2DAs.
+ *
+ *  Loaded 2DAs are kept in a pool that survives invalidate(), which is called
+ *  on module changes. A 2DA requested after an invalidation is checked against
+ *  the resource it was loaded from, and is only reloaded if that resource has
+ *  changed (for example due to a different HAK overriding it).
+ *
+ *  2DAs not requested since the last invalidation are evicted, least recently
+ *  used first, once the pool grows beyond its byte budget. 2DAs requested since
+ *  then are never evicted, since references to them might still be held.
+ */
 class TwoDARegistry : public Common::Singleton<TwoDARegistry> {
 public:
+	/** The default byte budget of the pool. */
+	static const uint32 kDefaultMaxSize = 16 * 1024 * 1024;
+
+	/** Statistics about the registry's usage. */
+	struct Stats {
+		uint32 hits;      ///< Number of requests for 2DAs already checked.
+		uint32 reused;    ///< Number of 2DAs reused after an invalidation.
+		uint32 loads;     ///< Number of 2DAs (re)loaded.
+		uint32 evictions; ///< Number of 2DAs evicted to stay within budget.
+
+		uint32 count;   ///< Number of 2DAs currently in the pool.
+		uint32 size;    ///< Number of bytes currently used by the 2DAs in the pool.
+		uint32 maxSize; ///< The pool's budget in bytes.
+
+		uint64 checkTime; ///< Time spent checking 2DAs for changes, in microseconds.
+		uint64 loadTime;  ///< Time spent loading 2DAs, in microseconds.
+
+		Stats();
+	};
+
 	TwoDARegistry();
 	~TwoDARegistry();
 
+	/** Remove all 2DAs. */
 	void clear();
 
+	/** Mark all 2DAs as possibly outdated, to be checked again on their next request. */
+	void invalidate();
+
+	/** Set the number of bytes the pool may hold, evicting 2DAs if necessary. */
+	void setMaxSize(uint32 maxSize);
+
 	/** Get a certain 2DA, loading it if necessary. */
 	const TwoDAFile &get(const Common::UString &name);
 
@@ -57,12 +94,42 @@ public:
 	/** Remove a certain 2DA from the registry. */
 	void remove(const Common::UString &name);
 
+	/** Return the usage statistics. */
+	Stats getStats() const;
+	/** Reset the usage statistics. */
+	void resetStats();
+
 private:
-	typedef std::map<Common::UString, TwoDAFile *> TwoDAMap;
+	/** A pooled 2DA. */
+	struct Entry {
+		TwoDAFile *twoda;
+
+		uint64 fingerprint; ///< Hash over the data the 2DA was loaded from.
+		uint32 dataSize;    ///< Size of the data the 2DA was loaded from.
+		uint32 size;        ///< Number of bytes used by the 2DA.
+
+		bool   checked;  ///< Was the 2DA requested since the last invalidation?
+		uint32 lastUsed; ///< When was the 2DA last requested?
+
+		Entry();
+	};
+
+	typedef std::map<Common::UString, Entry> TwoDAMap;
 
 	TwoDAMap _twodas;
 
-	TwoDAFile *load(const Common::UString &name);
+	uint32 _size;    ///< Number of bytes used by all pooled 2DAs.
+	uint32 _maxSize; ///< The pool's budget in bytes.
+
+	uint32 _useCounter; ///< Ever increasing request counter, for LRU eviction.
+
+	Stats _stats;
+
+	Entry &load(const Common::UString &name, bool force);
+
+	void removeEntry(TwoDAMap::iterator entry);
+
+	void trim();
 };
 
 } // End of namespace Aurora
@@ -44,6 +44,10 @@ uint32 Archive::getResourceSize(uint32 index) const {
 	return 0xFFFFFFFF;
 }
 
+bool Archive::isResourceCompressed(uint32 index) const {
+	return false;
+}
+
 Common::HashAlgo Archive::getNameHashAlgo() const {
 	return Common::kHashNone;
 }
@@ -74,6 +74,9 @@ public:
 	/** Return a stream of the resource's contents. */
 	virtual Common::SeekableReadStream *getResource(uint32 index) const = 0;
 
+	/** Does the resource need to be decompressed when read? */
+	virtual bool isResourceCompressed(uint32 index) const;
+
 	/** Return with which algorithm the name is hashed. */
 	virtual Common::HashAlgo getNameHashAlgo() const;
 };
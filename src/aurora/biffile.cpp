@@ -31,6 +31,7 @@
 #include "common/error.h"
 #include "common/stream.h"
 #include "common/file.h"
+#include "common/filepool.h"
 
 #include "aurora/biffile.h"
 #include "aurora/keyfile.h"
@@ -44,9 +45,21 @@ namespace Aurora {
 
 BIFFile::BIFFile(const Common::UString &fileName) : _fileName(fileName) {
 	load();
+
+	// Map the whole BIF into memory, so resources can be read without copying
+	_mappedFile = Common::mapFile(_fileName);
+}
+
+BIFFile::BIFFile(const Common::UString &fileName, Common::SeekableReadStream &index) :
+	_fileName(fileName) {
+
+	readIndex(index);
+
+	_mappedFile = Common::mapFile(_fileName);
 }
 
 BIFFile::~BIFFile() {
+	FilePool.close(_fileName);
 }
 
 void BIFFile::clear() {
@@ -132,6 +145,59 @@ void BIFFile::mergeKEY(const KEYFile &key, uint32 bifIndex) {
 
 }
 
+void BIFFile::writeIndex(Common::WriteStream &index) const {
+	index.writeUint32LE(_iResources.size());
+	for (IResourceList::const_iterator res = _iResources.begin(); res != _iResources.end(); ++res) {
+		index.writeUint32LE((uint32) res->type);
+		index.writeUint32LE(res->offset);
+		index.writeUint32LE(res->size);
+	}
+
+	index.writeUint32LE(_resources.size());
+	for (ResourceList::const_iterator res = _resources.begin(); res != _resources.end(); ++res) {
+		index.writeUint32LE((uint32) res->type);
+		index.writeUint32LE(res->index);
+
+		index.writeString(res->name);
+		index.writeByte(0);
+	}
+}
+
+void BIFFile::readIndex(Common::SeekableReadStream &index) {
+	// Each internal resource takes up 12 bytes, each external one at least 9
+	const uint32 iResCount = index.readUint32LE();
+	if (iResCount > (((uint32) (index.size() - index.pos())) / 12))
+		throw Common::Exception("Invalid BIF index");
+
+	_iResources.resize(iResCount);
+	for (IResourceList::iterator res = _iResources.begin(); res != _iResources.end(); ++res) {
+		res->type   = (FileType) index.readUint32LE();
+		res->offset = index.readUint32LE();
+		res->size   = index.readUint32LE();
+	}
+
+	const uint32 resCount = index.readUint32LE();
+	if (resCount > (((uint32) (index.size() - index.pos())) / 9))
+		throw Common::Exception("Invalid BIF index");
+
+	for (uint32 i = 0; i < resCount; i++) {
+		_resources.push_back(Resource());
+
+		Resource &res = _resources.back();
+
+		res.type  = (FileType) index.readUint32LE();
+		res.index = index.readUint32LE();
+
+		res.name.readUTF8(index);
+
+		if (res.index >= _iResources.size())
+			throw Common::Exception("Invalid BIF index");
+	}
+
+	if (index.err() || index.eos())
+		throw Common::Exception(Common::kReadError);
+}
+
 const Archive::ResourceList &BIFFile::getResources() const {
 	return _resources;
 }
@@ -152,20 +218,10 @@ Common::SeekableReadStream *BIFFile::getResource(uint32 index) const {
 	if (res.size == 0)
 		return new Common::MemoryReadStream(0, 0);
 
-	Common::File bif;
-	open(bif);
-
-	if (!bif.seek(res.offset))
-		throw Common::Exception(Common::kSeekError);
-
-	Common::SeekableReadStream *resStream = bif.readStream(res.size);
-
-	if (!resStream || (((uint32) resStream->size()) != res.size)) {
-		delete resStream;
-		throw Common::Exception(Common::kReadError);
-	}
+	if (_mappedFile)
+		return new Common::MappedReadStream(_mappedFile, res.offset, res.size);
 
-	return resStream;
+	return FilePool.readStream(_fileName, res.offset, res.size);
 }
 
 void BIFFile::open(Common::File &file) const {
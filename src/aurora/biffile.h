@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "common/types.h"
+#include "common/mappedfile.h"
 
 #include "aurora/types.h"
 #include "aurora/archive.h"
@@ -40,6 +41,7 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class WriteStream;
 	class File;
 }
 
@@ -51,6 +53,8 @@ class KEYFile;
 class BIFFile : public Archive, public AuroraBase {
 public:
 	BIFFile(const Common::UString &fileName);
+	/** Take the BIF's resource information out of an index written by writeIndex(). */
+	BIFFile(const Common::UString &fileName, Common::SeekableReadStream &index);
 	~BIFFile();
 
 	/** Clear the resource list. */
@@ -68,6 +72,9 @@ public:
 	/** Merge information from the KEY into the BIF. */
 	void mergeKEY(const KEYFile &key, uint32 bifIndex);
 
+	/** Write the BIF's resource information, as merged with the KEY, into an index. */
+	void writeIndex(Common::WriteStream &index) const;
+
 private:
 	/** Internal resource information. */
 	struct IResource {
@@ -88,11 +95,16 @@ private:
 	/** The name of the BIF file. */
 	Common::UString _fileName;
 
+	/** The BIF file mapped into memory, if possible. */
+	Common::MappedFilePtr _mappedFile;
+
 	void open(Common::File &file) const;
 
 	void load();
 	void readVarResTable(Common::SeekableReadStream &bif, uint32 offset);
 
+	void readIndex(Common::SeekableReadStream &index);
+
 	const IResource &getIResource(uint32 index) const;
 };
 
@@ -29,6 +29,7 @@
 
 #include "common/stream.h"
 #include "common/file.h"
+#include "common/filepool.h"
 #include "common/util.h"
 
 #include "aurora/erffile.h"
@@ -52,9 +53,14 @@ ERFFile::ERFFile(const Common::UString &fileName, bool noResources) :
 	_noResources(noResources), _fileName(fileName) {
 
 	load();
+
+	// Map the whole ERF into memory, so resources can be read without copying
+	if (!_noResources && !(_flags & 0xF0))
+		_mappedFile = Common::mapFile(_fileName);
 }
 
 ERFFile::~ERFFile() {
+	FilePool.close(_fileName);
 }
 
 void ERFFile::clear() {
@@ -365,72 +371,78 @@ Common::SeekableReadStream *ERFFile::getResource(uint32 index) const {
 	if (_flags & 0xF0)
 		throw Common::Exception("Unhandled ERF encryption");
 
-	Common::File erf;
-	open(erf);
+	if (_mappedFile) {
+		if ((res.offset > _mappedFile->size()) || (res.packedSize > (_mappedFile->size() - res.offset)))
+			throw Common::Exception(Common::kReadError);
 
-	if (!erf.seek(res.offset))
-		throw Common::Exception(Common::kSeekError);
+		// Uncompressed data can be used directly out of the mapped file
+		if (getCompressionType() == 0)
+			return new Common::MappedReadStream(_mappedFile, res.offset, res.packedSize);
+
+		// Compressed data can at least be decompressed without copying it first
+		return decompress(_mappedFile->getData() + res.offset, res.packedSize, res.unpackedSize);
+	}
 
 	byte *compressedData = new byte[res.packedSize];
 
-	if (erf.read(compressedData, res.packedSize) != res.packedSize) {
+	try {
+		FilePool.read(_fileName, res.offset, compressedData, res.packedSize);
+	} catch (...) {
 		delete[] compressedData;
-		throw Common::Exception(Common::kReadError);
+		throw;
 	}
 
-	return decompress(compressedData, res.packedSize, res.unpackedSize);
+	if (getCompressionType() == 0)
+		return new Common::MemoryReadStream(compressedData, res.packedSize, true);
+
+	try {
+		Common::SeekableReadStream *stream = decompress(compressedData, res.packedSize, res.unpackedSize);
+		delete[] compressedData;
+		return stream;
+	} catch (...) {
+		delete[] compressedData;
+		throw;
+	}
+}
+
+bool ERFFile::isResourceCompressed(uint32 index) const {
+	return getCompressionType() != 0;
 }
 
 uint32 ERFFile::getCompressionType() const {
 	return (_flags >> 29) & 0x7;
 }
 
-Common::SeekableReadStream *ERFFile::decompress(byte *compressedData, uint32 packedSize, uint32 unpackedSize) const {
+Common::SeekableReadStream *ERFFile::decompress(const byte *compressedData, uint32 packedSize, uint32 unpackedSize) const {
 	switch (getCompressionType()) {
-	case 0:
-		// No compression
-		return new Common::MemoryReadStream(compressedData, packedSize, true);
 	case 1:
 		// Bioware Zlib
 		return decompressBiowareZlib(compressedData, packedSize, unpackedSize);
 	case 2:
 	case 3:
 		// Unknown
-		delete[] compressedData;
 		throw Common::Exception("Unknown ERF compression %d", getCompressionType());
 	case 7:
 		// Headerless Zlib
 		return decompressHeaderlessZlib(compressedData, packedSize, unpackedSize);
 	default:
 		// Invalid
-		delete[] compressedData;
 		throw Common::Exception("Invalid ERF compression %d", getCompressionType());
 	}
 }
 
-Common::SeekableReadStream *ERFFile::decompressBiowareZlib(byte *compressedData, uint32 packedSize, uint32 unpackedSize) const {
-	try {
-		Common::SeekableReadStream *stream = decompressZlib(compressedData + 1, packedSize - 1, unpackedSize, *compressedData >> 4);
-		delete[] compressedData;
-		return stream;
-	} catch (Common::Exception &e) {
-		delete[] compressedData;
-		throw e;
-	}
+Common::SeekableReadStream *ERFFile::decompressBiowareZlib(const byte *compressedData, uint32 packedSize, uint32 unpackedSize) const {
+	if (packedSize < 1)
+		throw Common::Exception(Common::kReadError);
+
+	return decompressZlib(compressedData + 1, packedSize - 1, unpackedSize, *compressedData >> 4);
 }
 
-Common::SeekableReadStream *ERFFile::decompressHeaderlessZlib(byte *compressedData, uint32 packedSize, uint32 unpackedSize) const {
-	try {
-		Common::SeekableReadStream *stream = decompressZlib(compressedData, packedSize, unpackedSize, MAX_WBITS);
-		delete[] compressedData;
-		return stream;
-	} catch (Common::Exception &e) {
-		delete[] compressedData;
-		throw e;
-	}
+Common::SeekableReadStream *ERFFile::decompressHeaderlessZlib(const byte *compressedData, uint32 packedSize, uint32 unpackedSize) const {
+	return decompressZlib(compressedData, packedSize, unpackedSize, MAX_WBITS);
 }
 
-Common::SeekableReadStream *ERFFile::decompressZlib(byte *compressedData, uint32 packedSize, uint32 unpackedSize, int windowBits) const {
+Common::SeekableReadStream *ERFFile::decompressZlib(const byte *compressedData, uint32 packedSize, uint32 unpackedSize, int windowBits) const {
 	// Allocate the decompressed data
 	byte *decompressedData = new byte[unpackedSize];
 
@@ -439,7 +451,7 @@ Common::SeekableReadStream *ERFFile::decompressZlib(byte *compressedData, uint32
 	strm.zfree    = Z_NULL;
 	strm.opaque   = Z_NULL;
 	strm.avail_in = packedSize;
-	strm.next_in  = compressedData;
+	strm.next_in  = const_cast<byte *>(compressedData);
 
 	// Negative windows bits means there is no zlib header present in the data.
 	int zResult = inflateInit2(&strm, -windowBits);
@@ -452,6 +464,8 @@ Common::SeekableReadStream *ERFFile::decompressZlib(byte *compressedData, uint32
 	strm.next_out  = decompressedData;
 
 	zResult = inflate(&strm, Z_SYNC_FLUSH);
+	inflateEnd(&strm);
+
 	if (zResult != Z_OK && zResult != Z_STREAM_END) {
 		delete[] decompressedData;
 		throw Common::Exception("Failed to inflate: %d", zResult);
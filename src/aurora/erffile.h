@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "common/types.h"
+#include "common/mappedfile.h"
 #include "common/ustring.h"
 
 #include "aurora/types.h"
@@ -65,6 +66,9 @@ public:
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index) const;
 
+	/** Does the resource need to be decompressed when read? */
+	bool isResourceCompressed(uint32 index) const;
+
 	/** Return the description. */
 	const LocString &getDescription() const;
 
@@ -108,6 +112,9 @@ private:
 	/** The name of the ERF file. */
 	Common::UString _fileName;
 
+	/** The ERF file mapped into memory, if possible. */
+	Common::MappedFilePtr _mappedFile;
+
 	uint32 _flags;
 	uint32 _moduleID;
 	Common::UString _passwordDigest;
@@ -135,10 +142,10 @@ private:
 
 	// Compression
 	uint32 getCompressionType() const;
-	Common::SeekableReadStream *decompress(byte *compressedData, uint32 packedSize, uint32 unpackedSize) const;
-	Common::SeekableReadStream *decompressBiowareZlib(byte *compressedData, uint32 packedSize, uint32 unpackedSize) const;
-	Common::SeekableReadStream *decompressHeaderlessZlib(byte *compressedData, uint32 packedSize, uint32 unpackedSize) const;
-	Common::SeekableReadStream *decompressZlib(byte *compressedData, uint32 packedSize, uint32 unpackedSize, int windowBits) const;
+	Common::SeekableReadStream *decompress(const byte *compressedData, uint32 packedSize, uint32 unpackedSize) const;
+	Common::SeekableReadStream *decompressBiowareZlib(const byte *compressedData, uint32 packedSize, uint32 unpackedSize) const;
+	Common::SeekableReadStream *decompressHeaderlessZlib(const byte *compressedData, uint32 packedSize, uint32 unpackedSize) const;
+	Common::SeekableReadStream *decompressZlib(const byte *compressedData, uint32 packedSize, uint32 unpackedSize, int windowBits) const;
 
 	const IResource &getIResource(uint32 index) const;
 };
@@ -27,6 +27,10 @@
  *  Handling BioWare's GFFs (generic file format).
  */
 
+#include <cstring>
+#include <algorithm>
+
+#include "common/util.h"
 #include "common/endianness.h"
 #include "common/error.h"
 #include "common/stream.h"
@@ -43,6 +47,56 @@ static const uint32 kVersion33 = MKTAG('V', '3', '.', '3'); // Found in The Witc
 
 namespace Aurora {
 
+GFFLabel::GFFLabel() : _hash(0) {
+	std::memset(_label, 0, kMaxLength);
+}
+
+GFFLabel::GFFLabel(const char *label) {
+	set(label, std::strlen(label));
+}
+
+GFFLabel::GFFLabel(const Common::UString &label) {
+	set(label.c_str(), std::strlen(label.c_str()));
+}
+
+void GFFLabel::set(const char *label, uint32 length) {
+	length = MIN(length, kMaxLength);
+
+	std::memset(_label, 0, kMaxLength);
+	std::memcpy(_label, label, length);
+
+	// FNV-1a, over the whole padded label
+	_hash = 0x811C9DC5;
+	for (uint32 i = 0; i < kMaxLength; i++)
+		_hash = (_hash ^ ((byte) _label[i])) * 0x01000193;
+}
+
+bool GFFLabel::operator==(const GFFLabel &label) const {
+	return (_hash == label._hash) && (std::memcmp(_label, label._label, kMaxLength) == 0);
+}
+
+bool GFFLabel::operator!=(const GFFLabel &label) const {
+	return !(*this == label);
+}
+
+bool GFFLabel::operator<(const GFFLabel &label) const {
+	return std::memcmp(_label, label._label, kMaxLength) < 0;
+}
+
+uint32 GFFLabel::getHash() const {
+	return _hash;
+}
+
+Common::UString GFFLabel::getString() const {
+	char label[kMaxLength + 1];
+
+	std::memcpy(label, _label, kMaxLength);
+	label[kMaxLength] = '\0';
+
+	return label;
+}
+
+
 GFFFile::Header::Header() {
 	clear();
 }
@@ -110,6 +164,8 @@ void GFFFile::load(uint32 id) {
 	try {
 
 		readStructs();
+		readLabels();
+		readFields();
 		readLists();
 
 		if (_stream->err())
@@ -150,6 +206,85 @@ void GFFFile::readStructs() {
 		_structs.push_back(new GFFStruct(*this, *_stream));
 }
 
+void GFFFile::readLabels() {
+	if (!_stream->seek(_header.labelOffset))
+		throw Common::Exception(Common::kSeekError);
+
+	_labels.resize(_header.labelCount);
+	for (LabelArray::iterator l = _labels.begin(); l != _labels.end(); ++l) {
+		char label[GFFLabel::kMaxLength];
+		if (_stream->read(label, GFFLabel::kMaxLength) != GFFLabel::kMaxLength)
+			throw Common::Exception(Common::kReadError);
+
+		// Everything after the terminating 0 is garbage
+		l->set(label, std::find(label, label + GFFLabel::kMaxLength, '\0') - label);
+	}
+
+	// Hash table size: power of two, at most half full
+	uint32 size = 16;
+	while (size < (_labels.size() * 2))
+		size <<= 1;
+
+	_labelHash.resize(size, kFieldIDInvalid);
+
+	for (uint32 i = 0; i < _labels.size(); i++) {
+		uint32 slot = _labels[i].getHash() & (size - 1);
+
+		while (_labelHash[slot] != kFieldIDInvalid) {
+			// Duplicate labels; the first one wins
+			if (_labels[_labelHash[slot]] == _labels[i])
+				break;
+
+			slot = (slot + 1) & (size - 1);
+		}
+
+		if (_labelHash[slot] == kFieldIDInvalid)
+			_labelHash[slot] = i;
+	}
+}
+
+void GFFFile::readFields() {
+	if (!_stream->seek(_header.fieldOffset))
+		throw Common::Exception(Common::kSeekError);
+
+	_fields.reserve(_header.fieldCount);
+	for (uint32 i = 0; i < _header.fieldCount; i++) {
+		uint32 type  = _stream->readUint32LE();
+		uint32 label = _stream->readUint32LE();
+		uint32 data  = _stream->readUint32LE();
+
+		if (label >= _labels.size())
+			throw Common::Exception("Field label index out of range (%d/%d)",
+			                        label, (int) _labels.size());
+
+		// Fields are matched by label index, so point duplicate labels to the first one
+		label = findLabel(_labels[label]);
+
+		_fields.push_back(Field((GFFFieldType) type, label, data));
+	}
+
+	if (!_stream->seek(_header.fieldIndicesOffset))
+		throw Common::Exception(Common::kSeekError);
+
+	_fieldIndices.resize(_header.fieldIndicesCount / 4);
+	for (std::vector<uint32>::iterator i = _fieldIndices.begin(); i != _fieldIndices.end(); ++i)
+		*i = _stream->readUint32LE();
+
+	// Make sure all structs only reference valid fields
+	for (StructArray::const_iterator strct = _structs.begin(); strct != _structs.end(); ++strct)
+		(*strct)->check();
+}
+
+uint32 GFFFile::findLabel(const GFFLabel &label) const {
+	const uint32 mask = _labelHash.size() - 1;
+
+	for (uint32 slot = label.getHash() & mask; _labelHash[slot] != kFieldIDInvalid; slot = (slot + 1) & mask)
+		if (_labels[_labelHash[slot]] == label)
+			return _labelHash[slot];
+
+	return kFieldIDInvalid;
+}
+
 void GFFFile::readLists() {
 	if (!_stream->seek(_header.listIndicesOffset))
 		throw Common::Exception(Common::kSeekError);
@@ -205,10 +340,10 @@ Common::SeekableReadStream &GFFFile::getFieldData() const {
 }
 
 
-GFFStruct::Field::Field() : type(kFieldTypeNone), data(0), extended(false) {
+GFFFile::Field::Field() : type(kFieldTypeNone), label(kFieldIDInvalid), data(0), extended(false) {
 }
 
-GFFStruct::Field::Field(FieldType t, uint32 d) : type(t), data(d) {
+GFFFile::Field::Field(GFFFieldType t, uint32 l, uint32 d) : type(t), label(l), data(d) {
 	// These field types need extended field data
 	extended = (type == kFieldTypeUint64     ) ||
 	           (type == kFieldTypeSint64     ) ||
@@ -233,72 +368,35 @@ GFFStruct::GFFStruct(const GFFFile &parent, Common::SeekableReadStream &gff) :
 GFFStruct::~GFFStruct() {
 }
 
-void GFFStruct::load() const {
-	if (!_fields.empty())
-		return;
-
-	Common::SeekableReadStream &gff = _parent->getStream();
-
-	// Read the field(s)
-	if      (_fieldCount == 1)
-		readField (gff, _fieldIndex);
-	else if (_fieldCount > 1)
-		readFields(gff, _fieldIndex, _fieldCount);
-}
-
-void GFFStruct::readField(Common::SeekableReadStream &gff, uint32 index) const {
-	// Sanity check
-	if (index > _parent->_header.fieldCount)
-		throw Common::Exception("Field index out of range (%d/%d)",
-				index, _parent->_header.fieldCount);
+void GFFStruct::check() const {
+	if (_fieldCount == 1) {
+		if (_fieldIndex >= _parent->_fields.size())
+			throw Common::Exception("Field index out of range (%d/%d)",
+			                        _fieldIndex, (int) _parent->_fields.size());
 
-	// Seek
-	if (!gff.seek(_parent->_header.fieldOffset + index * 12))
-		throw Common::Exception(Common::kSeekError);
-
-	// Read the field data
-	uint32 type  = gff.readUint32LE();
-	uint32 label = gff.readUint32LE();
-	uint32 data  = gff.readUint32LE();
-
-	// And add it to the map
-	_fields[readLabel(gff, label)] = Field((FieldType) type, data);
-}
-
-void GFFStruct::readFields(Common::SeekableReadStream &gff,
-                           uint32 index, uint32 count) const {
-	// Sanity check
-	if (index > _parent->_header.fieldIndicesCount)
-		throw Common::Exception("Field indices index out of range (%d/%d)",
-		                        index , _parent->_header.fieldIndicesCount);
-
-	// Seek
-	if (!gff.seek(_parent->_header.fieldIndicesOffset + index))
-		throw Common::Exception(Common::kSeekError);
+		return;
+	}
 
-	// Read the field indices
-	std::vector<uint32> indices;
-	readIndices(gff, indices, count);
+	if (_fieldCount == 0)
+		return;
 
-	// Read the fields
-	for (std::vector<uint32>::const_iterator i = indices.begin(); i != indices.end(); ++i)
-		readField(gff, *i);
-}
+	// A byte offset into the field indices
+	if (((_fieldIndex % 4) != 0) || ((_fieldIndex / 4) > _parent->_fieldIndices.size()) ||
+	    (_fieldCount > (_parent->_fieldIndices.size() - (_fieldIndex / 4))))
+		throw Common::Exception("Field indices index out of range (%d+%d/%d)",
+		                        _fieldIndex, _fieldCount, _parent->_header.fieldIndicesCount);
 
-void GFFStruct::readIndices(Common::SeekableReadStream &gff,
-                            std::vector<uint32> &indices, uint32 count) const {
-	indices.reserve(count);
-	while (count-- > 0)
-		indices.push_back(gff.readUint32LE());
+	for (uint32 i = 0; i < _fieldCount; i++)
+		if (_parent->_fieldIndices[_fieldIndex / 4 + i] >= _parent->_fields.size())
+			throw Common::Exception("Field index out of range (%d/%d)",
+			                        _parent->_fieldIndices[_fieldIndex / 4 + i], (int) _parent->_fields.size());
 }
 
-Common::UString GFFStruct::readLabel(Common::SeekableReadStream &gff, uint32 index) const {
-	gff.seek(_parent->_header.labelOffset + index * 16);
-
-	Common::UString label;
-	label.readFixedASCII(gff, 16);
+uint32 GFFStruct::getFieldIndex(uint32 n) const {
+	if (_fieldCount == 1)
+		return _fieldIndex;
 
-	return label;
+	return _parent->_fieldIndices[_fieldIndex / 4 + n];
 }
 
 Common::SeekableReadStream &GFFStruct::getData(const Field &field) const {
@@ -311,27 +409,48 @@ Common::SeekableReadStream &GFFStruct::getData(const Field &field) const {
 	return data;
 }
 
-const GFFStruct::Field *GFFStruct::getField(const Common::UString &name) const {
-	FieldMap::const_iterator field = _fields.find(name);
-	if (field == _fields.end())
+const GFFStruct::Field *GFFStruct::getField(const GFFLabel &name) const {
+	const uint32 label = _parent->findLabel(name);
+	if (label == kFieldIDInvalid)
 		return 0;
 
-	return &field->second;
+	for (uint32 i = 0; i < _fieldCount; i++) {
+		const Field &field = _parent->_fields[getFieldIndex(i)];
+		if (field.label == label)
+			return &field;
+	}
+
+	return 0;
+}
+
+uint32 GFFStruct::getID() const {
+	return _id;
 }
 
 uint GFFStruct::getFieldCount() const {
-	return _fields.size();
+	return _fieldCount;
 }
 
-bool GFFStruct::hasField(const Common::UString &field) const {
-	load();
+void GFFStruct::getFieldLabels(std::vector<GFFLabel> &labels) const {
+	labels.reserve(labels.size() + _fieldCount);
+
+	for (uint32 i = 0; i < _fieldCount; i++)
+		labels.push_back(_parent->_labels[_parent->_fields[getFieldIndex(i)].label]);
+}
 
+bool GFFStruct::hasField(const GFFLabel &field) const {
 	return getField(field) != 0;
 }
 
-char GFFStruct::getChar(const Common::UString &field, char def) const {
-	load();
+GFFFieldType GFFStruct::getType(const GFFLabel &field) const {
+	const Field *f = getField(field);
+	if (!f)
+		return kFieldTypeNone;
+
+	return f->type;
+}
 
+char GFFStruct::getChar(const GFFLabel &field, char def) const {
 	const Field *f = getField(field);
 	if (!f)
 		return def;
@@ -341,9 +460,7 @@ char GFFStruct::getChar(const Common::UString &field, char def) const {
 	return (char) f->data;
 }
 
-uint64 GFFStruct::getUint(const Common::UString &field, uint64 def) const {
-	load();
-
+uint64 GFFStruct::getUint(const GFFLabel &field, uint64 def) const {
 	const Field *f = getField(field);
 	if (!f)
 		return def;
@@ -369,9 +486,7 @@ uint64 GFFStruct::getUint(const Common::UString &field, uint64 def) const {
 	throw Common::Exception("Field is not an int type");
 }
 
-int64 GFFStruct::getSint(const Common::UString &field, int64 def) const {
-	load();
-
+int64 GFFStruct::getSint(const GFFLabel &field, int64 def) const {
 	const Field *f = getField(field);
 	if (!f)
 		return def;
@@ -397,15 +512,11 @@ int64 GFFStruct::getSint(const Common::UString &field, int64 def) const {
 	throw Common::Exception("Field is not an int type");
 }
 
-bool GFFStruct::getBool(const Common::UString &field, bool def) const {
-	load();
-
+bool GFFStruct::getBool(const GFFLabel &field, bool def) const {
 	return getUint(field, def) != 0;
 }
 
-double GFFStruct::getDouble(const Common::UString &field, double def) const {
-	load();
-
+double GFFStruct::getDouble(const GFFLabel &field, double def) const {
 	const Field *f = getField(field);
 	if (!f)
 		return def;
@@ -418,10 +529,8 @@ double GFFStruct::getDouble(const Common::UString &field, double def) const {
 	throw Common::Exception("Field is not a double type");
 }
 
-Common::UString GFFStruct::getString(const Common::UString &field,
+Common::UString GFFStruct::getString(const GFFLabel &field,
                                         const Common::UString &def) const {
-	load();
-
 	const Field *f = getField(field);
 	if (!f)
 		return def;
@@ -432,7 +541,7 @@ Common::UString GFFStruct::getString(const Common::UString &field,
 		uint32 length = data.readUint32LE();
 
 		Common::UString str;
-		str.readFixedASCII(data, length);
+		str.readFixedLatin9(data, length);
 		return str;
 	}
 
@@ -485,9 +594,7 @@ Common::UString GFFStruct::getString(const Common::UString &field,
 	throw Common::Exception("Field is not a string(able) type");
 }
 
-void GFFStruct::getLocString(const Common::UString &field, LocString &str) const {
-	load();
-
+void GFFStruct::getLocString(const GFFLabel &field, LocString &str) const {
 	const Field *f = getField(field);
 	if (!f)
 		return;
@@ -503,9 +610,7 @@ void GFFStruct::getLocString(const Common::UString &field, LocString &str) const
 	str.readLocString(gff);
 }
 
-Common::SeekableReadStream *GFFStruct::getData(const Common::UString &field) const {
-	load();
-
+Common::SeekableReadStream *GFFStruct::getData(const GFFLabel &field) const {
 	const Field *f = getField(field);
 	if (!f)
 		return 0;
@@ -519,10 +624,8 @@ Common::SeekableReadStream *GFFStruct::getData(const Common::UString &field) con
 	return data.readStream(size);
 }
 
-void GFFStruct::getVector(const Common::UString &field,
+void GFFStruct::getVector(const GFFLabel &field,
                           float &x, float &y, float &z) const {
-	load();
-
 	const Field *f = getField(field);
 	if (!f)
 		return;
@@ -536,10 +639,8 @@ void GFFStruct::getVector(const Common::UString &field,
 	z = data.readIEEEFloatLE();
 }
 
-void GFFStruct::getOrientation(const Common::UString &field,
+void GFFStruct::getOrientation(const GFFLabel &field,
                                float &a, float &b, float &c, float &d) const {
-	load();
-
 	const Field *f = getField(field);
 	if (!f)
 		return;
@@ -554,10 +655,8 @@ void GFFStruct::getOrientation(const Common::UString &field,
 	d = data.readIEEEFloatLE();
 }
 
-void GFFStruct::getVector(const Common::UString &field,
+void GFFStruct::getVector(const GFFLabel &field,
                           double &x, double &y, double &z) const {
-	load();
-
 	const Field *f = getField(field);
 	if (!f)
 		return;
@@ -571,10 +670,8 @@ void GFFStruct::getVector(const Common::UString &field,
 	z = data.readIEEEFloatLE();
 }
 
-void GFFStruct::getOrientation(const Common::UString &field,
+void GFFStruct::getOrientation(const GFFLabel &field,
                                double &a, double &b, double &c, double &d) const {
-	load();
-
 	const Field *f = getField(field);
 	if (!f)
 		return;
@@ -589,9 +686,7 @@ void GFFStruct::getOrientation(const Common::UString &field,
 	d = data.readIEEEFloatLE();
 }
 
-const GFFStruct &GFFStruct::getStruct(const Common::UString &field) const {
-	load();
-
+const GFFStruct &GFFStruct::getStruct(const GFFLabel &field) const {
 	const Field *f = getField(field);
 	if (!f)
 		throw Common::Exception("No such field");
@@ -602,9 +697,7 @@ const GFFStruct &GFFStruct::getStruct(const Common::UString &field) const {
 	return _parent->getStruct(f->data);
 }
 
-const GFFList &GFFStruct::getList(const Common::UString &field, uint32 &size) const {
-	load();
-
+const GFFList &GFFStruct::getList(const GFFLabel &field, uint32 &size) const {
 	const Field *f = getField(field);
 	if (!f)
 		throw Common::Exception("No such field");
@@ -615,7 +708,7 @@ const GFFList &GFFStruct::getList(const Common::UString &field, uint32 &size) co
 	return _parent->getList(f->data / 4, size);
 }
 
-const GFFList &GFFStruct::getList(const Common::UString &field) const {
+const GFFList &GFFStruct::getList(const GFFLabel &field) const {
 	uint32 size;
 
 	return getList(field, size);
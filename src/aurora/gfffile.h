@@ -32,7 +32,6 @@
 
 #include <vector>
 #include <list>
-#include <map>
 
 #include "common/types.h"
 #include "common/ustring.h"
@@ -51,6 +50,64 @@ class GFFStruct;
 
 typedef std::list<GFFStruct *> GFFList;
 
+/** The type of a GFF field. */
+enum GFFFieldType {
+	kFieldTypeNone        = - 1, ///< Invalid type.
+	kFieldTypeByte        =   0, ///< A single byte.
+	kFieldTypeChar        =   1, ///< A single character.
+	kFieldTypeUint16      =   2, ///< Unsigned 16bit integer.
+	kFieldTypeSint16      =   3, ///< Signed 16bit integer.
+	kFieldTypeUint32      =   4, ///< Unsigned 32bit integer.
+	kFieldTypeSint32      =   5, ///< Signed 32bit integer.
+	kFieldTypeUint64      =   6, ///< Unsigned 64bit integer.
+	kFieldTypeSint64      =   7, ///< Signed 64bit integer.
+	kFieldTypeFloat       =   8, ///< IEEE float.
+	kFieldTypeDouble      =   9, ///< IEEE double.
+	kFieldTypeExoString   =  10, ///< String.
+	kFieldTypeResRef      =  11, ///< String, max. 16 characters.
+	kFieldTypeLocString   =  12, ///< Localized string.
+	kFieldTypeVoid        =  13, ///< Random data of variable length.
+	kFieldTypeStruct      =  14, ///< Struct containing a number of fields.
+	kFieldTypeList        =  15, ///< List containing a number of structs.
+	kFieldTypeOrientation =  16, ///< An object orientation.
+	kFieldTypeVector      =  17, ///< A vector of 3 floats.
+	kFieldTypeStrRef      =  18  // TODO: New in Jade Empire
+};
+
+/** The label of a GFF field.
+ *
+ *  A label is at most 16 characters long, and stored inline together with
+ *  its hash. Creating a label never allocates memory, so callers can either
+ *  pass string literals directly or keep a label around for repeated lookups.
+ */
+class GFFLabel {
+public:
+	static const uint32 kMaxLength = 16;
+
+	GFFLabel();
+	GFFLabel(const char *label);
+	GFFLabel(const Common::UString &label);
+
+	bool operator==(const GFFLabel &label) const;
+	bool operator!=(const GFFLabel &label) const;
+	bool operator< (const GFFLabel &label) const;
+
+	/** Return the label's hash. */
+	uint32 getHash() const;
+
+	/** Return the label as a string. */
+	Common::UString getString() const;
+
+private:
+	char   _label[kMaxLength]; ///< The label, padded with zeros.
+	uint32 _hash;              ///< The label's hash.
+
+	void set(const char *label, uint32 length);
+
+	friend class GFFFile;
+	friend class GFFWriter;
+};
+
 class GFFFile : public AuroraBase {
 public:
 	GFFFile(Common::SeekableReadStream *gff, uint32 id);
@@ -85,8 +142,21 @@ private:
 		void read(Common::SeekableReadStream &gff);
 	};
 
+	/** A GFF field. */
+	struct Field {
+		GFFFieldType type;     ///< Type of the field.
+		uint32       label;    ///< Index of the field's label.
+		uint32       data;     ///< Data of the field.
+		bool         extended; ///< Does this field need extended data?
+
+		Field();
+		Field(GFFFieldType t, uint32 l, uint32 d);
+	};
+
 	typedef std::vector<GFFStruct *> StructArray;
 	typedef std::vector<GFFList> ListArray;
+	typedef std::vector<GFFLabel> LabelArray;
+	typedef std::vector<Field> FieldArray;
 
 
 	Common::SeekableReadStream *_stream;
@@ -96,6 +166,15 @@ private:
 	StructArray _structs; ///< Our structs.
 	ListArray   _lists;   ///< Our lists.
 
+	LabelArray _labels; ///< All field labels.
+	FieldArray _fields; ///< All fields of all structs.
+
+	/** Indices into the field array, for structs with more than one field. */
+	std::vector<uint32> _fieldIndices;
+
+	/** Open-addressing hash table mapping label hashes to label indices. */
+	std::vector<uint32> _labelHash;
+
 	/** The size of each GFF list. */
 	std::vector<uint32> _listSizes;
 
@@ -113,85 +192,66 @@ private:
 	/** Return a list within the GFF. */
 	const GFFList   &getList  (uint32 i, uint32 &size) const;
 
+	/** Return the index of a label, or kFieldIDInvalid if there's no such label. */
+	uint32 findLabel(const GFFLabel &label) const;
+
 	// Loading helpers
 	void load(uint32 id);
 	void readStructs();
+	void readLabels();
+	void readFields();
 	void readLists();
 
 	friend class GFFStruct;
+	friend class GFFPatcher;
 };
 
 /** A struct within a GFF. */
 class GFFStruct {
 public:
+	/** Return the struct's ID. */
+	uint32 getID() const;
+
 	uint getFieldCount() const;
 
-	bool hasField(const Common::UString &field) const;
+	/** Return the labels of all fields in this struct. */
+	void getFieldLabels(std::vector<GFFLabel> &labels) const;
+
+	bool hasField(const GFFLabel &field) const;
 
-	char   getChar(const Common::UString &field, char   def = '\0' ) const;
-	uint64 getUint(const Common::UString &field, uint64 def = 0    ) const;
-	 int64 getSint(const Common::UString &field,  int64 def = 0    ) const;
-	bool   getBool(const Common::UString &field, bool   def = false) const;
+	/** Return the type of a field, or kFieldTypeNone if there's no such field. */
+	GFFFieldType getType(const GFFLabel &field) const;
 
-	double getDouble(const Common::UString &field, double def = 0.0) const;
+	char   getChar(const GFFLabel &field, char   def = '\0' ) const;
+	uint64 getUint(const GFFLabel &field, uint64 def = 0    ) const;
+	 int64 getSint(const GFFLabel &field,  int64 def = 0    ) const;
+	bool   getBool(const GFFLabel &field, bool   def = false) const;
 
-	Common::UString getString(const Common::UString &field,
+	double getDouble(const GFFLabel &field, double def = 0.0) const;
+
+	Common::UString getString(const GFFLabel &field,
 	                          const Common::UString &def = "") const;
 
-	void getLocString(const Common::UString &field, LocString &str) const;
+	void getLocString(const GFFLabel &field, LocString &str) const;
 
-	Common::SeekableReadStream *getData(const Common::UString &field) const;
+	Common::SeekableReadStream *getData(const GFFLabel &field) const;
 
-	void getVector     (const Common::UString &field,
+	void getVector     (const GFFLabel &field,
 			float &x, float &y, float &z          ) const;
-	void getOrientation(const Common::UString &field,
+	void getOrientation(const GFFLabel &field,
 			float &a, float &b, float &c, float &d) const;
 
-	void getVector     (const Common::UString &field,
+	void getVector     (const GFFLabel &field,
 			double &x, double &y, double &z           ) const;
-	void getOrientation(const Common::UString &field,
+	void getOrientation(const GFFLabel &field,
 			double &a, double &b, double &c, double &d) const;
 
-	const GFFStruct &getStruct(const Common::UString &field) const;
-	const GFFList   &getList  (const Common::UString &field) const;
-	const GFFList   &getList  (const Common::UString &field, uint32 &size) const;
+	const GFFStruct &getStruct(const GFFLabel &field) const;
+	const GFFList   &getList  (const GFFLabel &field) const;
+	const GFFList   &getList  (const GFFLabel &field, uint32 &size) const;
 
 private:
-	/** The type of a GFF field. */
-	enum FieldType {
-		kFieldTypeNone        = - 1, ///< Invalid type.
-		kFieldTypeByte        =   0, ///< A single byte.
-		kFieldTypeChar        =   1, ///< A single character.
-		kFieldTypeUint16      =   2, ///< Unsigned 16bit integer.
-		kFieldTypeSint16      =   3, ///< Signed 16bit integer.
-		kFieldTypeUint32      =   4, ///< Unsigned 32bit integer.
-		kFieldTypeSint32      =   5, ///< Signed 32bit integer.
-		kFieldTypeUint64      =   6, ///< Unsigned 64bit integer.
-		kFieldTypeSint64      =   7, ///< Signed 64bit integer.
-		kFieldTypeFloat       =   8, ///< IEEE float.
-		kFieldTypeDouble      =   9, ///< IEEE double.
-		kFieldTypeExoString   =  10, ///< String.
-		kFieldTypeResRef      =  11, ///< String, max. 16 characters.
-		kFieldTypeLocString   =  12, ///< Localized string.
-		kFieldTypeVoid        =  13, ///< Random data of variable length.
-		kFieldTypeStruct      =  14, ///< Struct containing a number of fields.
-		kFieldTypeList        =  15, ///< List containing a number of structs.
-		kFieldTypeOrientation =  16, ///< An object orientation.
-		kFieldTypeVector      =  17, ///< A vector of 3 floats.
-		kFieldTypeStrRef      =  18  // TODO: New in Jade Empire
-	};
-
-	/** A GFF field. */
-	struct Field {
-		FieldType type;     ///< Type of the field.
-		uint32    data;     ///< Data of the field.
-		bool      extended; ///< Does this field need extended data?
-
-		Field();
-		Field(FieldType t, uint32 d);
-	};
-
-	typedef std::map<Common::UString, Field> FieldMap;
+	typedef GFFFile::Field Field;
 
 	const GFFFile *_parent; ///< The parent GFF.
 
@@ -199,26 +259,22 @@ private:
 	uint32 _fieldIndex; ///< Field / Field indices index.
 	uint32 _fieldCount; ///< Field count.
 
-	mutable FieldMap _fields; ///< The fields, indexed by their label.
-
 	GFFStruct(const GFFFile &parent, Common::SeekableReadStream &gff);
 	~GFFStruct();
 
-	void load() const;
+	/** Return the index of the struct's nth field within the parent's field array. */
+	uint32 getFieldIndex(uint32 n) const;
 
-	/** Returns the field with this tag. */
-	const Field *getField(const Common::UString &name) const;
+	/** Returns the field with this label. */
+	const Field *getField(const GFFLabel &name) const;
 	/** Returns the extended field data for this field. */
 	Common::SeekableReadStream &getData(const Field &field) const;
 
-	// Loading helpers
-	void readField  (Common::SeekableReadStream &gff, uint32 index) const;
-	void readFields (Common::SeekableReadStream &gff, uint32 index, uint32 count) const;
-	void readIndices(Common::SeekableReadStream &gff,
-	                 std::vector<uint32> &indices, uint32 count) const;
-	Common::UString readLabel(Common::SeekableReadStream &gff, uint32 index) const;
+	/** Make sure the struct's fields are within the parent's field arrays. */
+	void check() const;
 
 	friend class GFFFile;
+	friend class GFFPatcher;
 };
 
 } // End of namespace Aurora
@@ -0,0 +1,658 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/gffwriter.cpp
+ *  Writing and patching BioWare's GFFs (generic file format).
+ */
+
+#include <cstring>
+
+#include "common/util.h"
+#include "common/error.h"
+#include "common/endianness.h"
+#include "common/stream.h"
+
+#include "aurora/gffwriter.h"
+#include "aurora/locstring.h"
+
+static const uint32 kVersion32 = MKTAG('V', '3', '.', '2');
+
+static const uint32 kHeaderSize = 14 * 4;
+
+/** Hash a block of field data, with FNV-1a. */
+static uint32 hashData(const byte *data, uint32 size) {
+	uint32 hash = 0x811C9DC5;
+	while (size-- > 0)
+		hash = (hash ^ *data++) * 0x01000193;
+
+	return hash;
+}
+
+namespace Aurora {
+
+GFFWriter::StructEntry::StructEntry(uint32 i) : id(i) {
+}
+
+
+GFFWriter::Struct::Struct(GFFWriter &writer, uint32 index) : _writer(&writer), _index(index) {
+}
+
+void GFFWriter::Struct::addField(const GFFLabel &field, GFFFieldType type, uint32 data) {
+	const uint32 label = _writer->addLabel(field);
+
+	std::vector<uint32> &fields = _writer->_structs[_index].fields;
+	for (std::vector<uint32>::const_iterator f = fields.begin(); f != fields.end(); ++f)
+		if (_writer->_fields[*f].label == label)
+			throw Common::Exception("Duplicate GFF field \"%s\"", field.getString().c_str());
+
+	fields.push_back(_writer->_fields.size());
+
+	_writer->_fields.push_back(FieldEntry());
+
+	FieldEntry &entry = _writer->_fields.back();
+
+	entry.type  = type;
+	entry.label = label;
+	entry.data  = data;
+}
+
+void GFFWriter::Struct::addField(const GFFLabel &field, GFFFieldType type,
+                                 const byte *data, uint32 size) {
+
+	addField(field, type, _writer->addFieldData(data, size));
+}
+
+void GFFWriter::Struct::addByte(const GFFLabel &field, uint8 value) {
+	addField(field, kFieldTypeByte, value);
+}
+
+void GFFWriter::Struct::addChar(const GFFLabel &field, int8 value) {
+	addField(field, kFieldTypeChar, (uint8) value);
+}
+
+void GFFWriter::Struct::addUint16(const GFFLabel &field, uint16 value) {
+	addField(field, kFieldTypeUint16, value);
+}
+
+void GFFWriter::Struct::addSint16(const GFFLabel &field, int16 value) {
+	addField(field, kFieldTypeSint16, (uint16) value);
+}
+
+void GFFWriter::Struct::addUint32(const GFFLabel &field, uint32 value) {
+	addField(field, kFieldTypeUint32, value);
+}
+
+void GFFWriter::Struct::addSint32(const GFFLabel &field, int32 value) {
+	addField(field, kFieldTypeSint32, (uint32) value);
+}
+
+void GFFWriter::Struct::addUint64(const GFFLabel &field, uint64 value) {
+	byte data[8];
+	WRITE_LE_UINT64(data, value);
+
+	addField(field, kFieldTypeUint64, data, sizeof(data));
+}
+
+void GFFWriter::Struct::addSint64(const GFFLabel &field, int64 value) {
+	byte data[8];
+	WRITE_LE_UINT64(data, (uint64) value);
+
+	addField(field, kFieldTypeSint64, data, sizeof(data));
+}
+
+void GFFWriter::Struct::addFloat(const GFFLabel &field, float value) {
+	addField(field, kFieldTypeFloat, convertIEEEFloat(value));
+}
+
+void GFFWriter::Struct::addDouble(const GFFLabel &field, double value) {
+	byte data[8];
+	WRITE_LE_UINT64(data, convertIEEEDouble(value));
+
+	addField(field, kFieldTypeDouble, data, sizeof(data));
+}
+
+void GFFWriter::Struct::addString(const GFFLabel &field, const Common::UString &value) {
+	Common::MemoryWriteStreamDynamic data(true);
+	value.writeLatin9(data, true);
+
+	addField(field, kFieldTypeExoString, data.getData(), data.size());
+}
+
+void GFFWriter::Struct::addResRef(const GFFLabel &field, const Common::UString &value) {
+	const uint32 length = std::strlen(value.c_str());
+	if (length > 16)
+		throw Common::Exception("ResRef \"%s\" too long", value.c_str());
+
+	byte data[17];
+
+	data[0] = length;
+	std::memcpy(data + 1, value.c_str(), length);
+
+	addField(field, kFieldTypeResRef, data, length + 1);
+}
+
+void GFFWriter::Struct::addLocString(const GFFLabel &field, const LocString &value) {
+	Common::MemoryWriteStreamDynamic locString(true);
+	value.writeLocString(locString);
+
+	Common::MemoryWriteStreamDynamic data(true);
+	data.writeUint32LE(locString.size());
+	data.write(locString.getData(), locString.size());
+
+	addField(field, kFieldTypeLocString, data.getData(), data.size());
+}
+
+void GFFWriter::Struct::addData(const GFFLabel &field, const byte *data, uint32 size) {
+	Common::MemoryWriteStreamDynamic fieldData(true);
+	fieldData.writeUint32LE(size);
+	fieldData.write(data, size);
+
+	addField(field, kFieldTypeVoid, fieldData.getData(), fieldData.size());
+}
+
+void GFFWriter::Struct::addVector(const GFFLabel &field, float x, float y, float z) {
+	byte data[12];
+
+	WRITE_LE_UINT32(data + 0, convertIEEEFloat(x));
+	WRITE_LE_UINT32(data + 4, convertIEEEFloat(y));
+	WRITE_LE_UINT32(data + 8, convertIEEEFloat(z));
+
+	addField(field, kFieldTypeVector, data, sizeof(data));
+}
+
+void GFFWriter::Struct::addOrientation(const GFFLabel &field, float a, float b, float c, float d) {
+	byte data[16];
+
+	WRITE_LE_UINT32(data +  0, convertIEEEFloat(a));
+	WRITE_LE_UINT32(data +  4, convertIEEEFloat(b));
+	WRITE_LE_UINT32(data +  8, convertIEEEFloat(c));
+	WRITE_LE_UINT32(data + 12, convertIEEEFloat(d));
+
+	addField(field, kFieldTypeOrientation, data, sizeof(data));
+}
+
+GFFWriter::Struct GFFWriter::Struct::addStruct(const GFFLabel &field, uint32 id) {
+	const uint32 index = _writer->addStruct(id);
+
+	addField(field, kFieldTypeStruct, index);
+
+	return Struct(*_writer, index);
+}
+
+GFFWriter::List GFFWriter::Struct::addList(const GFFLabel &field) {
+	const uint32 index = _writer->_lists.size();
+
+	addField(field, kFieldTypeList, index);
+
+	_writer->_lists.push_back(StructList());
+
+	return List(*_writer, index);
+}
+
+void GFFWriter::Struct::addFields(const GFFStruct &strct) {
+	std::vector<GFFLabel> labels;
+	strct.getFieldLabels(labels);
+
+	for (std::vector<GFFLabel>::const_iterator l = labels.begin(); l != labels.end(); ++l) {
+		switch (strct.getType(*l)) {
+			case kFieldTypeByte:
+				addByte(*l, strct.getUint(*l));
+				break;
+
+			case kFieldTypeChar:
+				addChar(*l, strct.getSint(*l));
+				break;
+
+			case kFieldTypeUint16:
+				addUint16(*l, strct.getUint(*l));
+				break;
+
+			case kFieldTypeSint16:
+				addSint16(*l, strct.getSint(*l));
+				break;
+
+			case kFieldTypeUint32:
+				addUint32(*l, strct.getUint(*l));
+				break;
+
+			case kFieldTypeSint32:
+				addSint32(*l, strct.getSint(*l));
+				break;
+
+			case kFieldTypeUint64:
+				addUint64(*l, strct.getUint(*l));
+				break;
+
+			case kFieldTypeSint64:
+				addSint64(*l, strct.getSint(*l));
+				break;
+
+			case kFieldTypeFloat:
+				addFloat(*l, strct.getDouble(*l));
+				break;
+
+			case kFieldTypeDouble:
+				addDouble(*l, strct.getDouble(*l));
+				break;
+
+			case kFieldTypeExoString:
+				addString(*l, strct.getString(*l));
+				break;
+
+			case kFieldTypeResRef:
+				addResRef(*l, strct.getString(*l));
+				break;
+
+			case kFieldTypeLocString:
+				{
+					LocString str;
+					strct.getLocString(*l, str);
+
+					addLocString(*l, str);
+				}
+				break;
+
+			case kFieldTypeVoid:
+				{
+					Common::SeekableReadStream *data = strct.getData(*l);
+
+					std::vector<byte> buffer(data->size());
+					if (!buffer.empty())
+						data->read(&buffer[0], buffer.size());
+
+					delete data;
+
+					addData(*l, buffer.empty() ? 0 : &buffer[0], buffer.size());
+				}
+				break;
+
+			case kFieldTypeVector:
+				{
+					float x, y, z;
+					strct.getVector(*l, x, y, z);
+
+					addVector(*l, x, y, z);
+				}
+				break;
+
+			case kFieldTypeOrientation:
+				{
+					float a, b, c, d;
+					strct.getOrientation(*l, a, b, c, d);
+
+					addOrientation(*l, a, b, c, d);
+				}
+				break;
+
+			case kFieldTypeStruct:
+				{
+					const GFFStruct &child = strct.getStruct(*l);
+
+					addStruct(*l, child.getID()).addFields(child);
+				}
+				break;
+
+			case kFieldTypeList:
+				{
+					List list = addList(*l);
+
+					const GFFList &children = strct.getList(*l);
+					for (GFFList::const_iterator c = children.begin(); c != children.end(); ++c)
+						list.addStruct((*c)->getID()).addFields(**c);
+				}
+				break;
+
+			default:
+				throw Common::Exception("Can't copy GFF field \"%s\" of type %d",
+				                        l->getString().c_str(), (int) strct.getType(*l));
+		}
+	}
+}
+
+
+GFFWriter::List::List(GFFWriter &writer, uint32 index) : _writer(&writer), _index(index) {
+}
+
+GFFWriter::Struct GFFWriter::List::addStruct(uint32 id) {
+	const uint32 index = _writer->addStruct(id);
+
+	_writer->_lists[_index].push_back(index);
+
+	return Struct(*_writer, index);
+}
+
+uint32 GFFWriter::List::getSize() const {
+	return _writer->_lists[_index].size();
+}
+
+
+GFFWriter::GFFWriter(uint32 id) : _id(id) {
+	// The top-level struct
+	addStruct(0xFFFFFFFF);
+}
+
+GFFWriter::~GFFWriter() {
+}
+
+GFFWriter::Struct GFFWriter::getTopLevel() {
+	return Struct(*this, 0);
+}
+
+uint32 GFFWriter::addStruct(uint32 id) {
+	_structs.push_back(StructEntry(id));
+
+	return _structs.size() - 1;
+}
+
+uint32 GFFWriter::addLabel(const GFFLabel &label) {
+	std::map<GFFLabel, uint32>::const_iterator l = _labelMap.find(label);
+	if (l != _labelMap.end())
+		return l->second;
+
+	_labels.push_back(label);
+	_labelMap.insert(std::make_pair(label, _labels.size() - 1));
+
+	return _labels.size() - 1;
+}
+
+uint32 GFFWriter::addFieldData(const byte *data, uint32 size) {
+	const uint32 hash = hashData(data, size);
+
+	// Reuse identical data that's already there
+	std::pair<FieldDataMap::const_iterator, FieldDataMap::const_iterator> range = _fieldDataMap.equal_range(hash);
+	for (FieldDataMap::const_iterator d = range.first; d != range.second; ++d)
+		if ((d->second.second == size) && ((size == 0) || !std::memcmp(&_fieldData[d->second.first], data, size)))
+			return d->second.first;
+
+	const uint32 offset = _fieldData.size();
+
+	_fieldData.insert(_fieldData.end(), data, data + size);
+	_fieldDataMap.insert(std::make_pair(hash, std::make_pair(offset, size)));
+
+	return offset;
+}
+
+void GFFWriter::write(Common::WriteStream &stream) const {
+	// Flatten the field indices of all structs with more than one field
+	uint32 fieldIndicesCount = 0;
+	for (std::vector<StructEntry>::const_iterator s = _structs.begin(); s != _structs.end(); ++s)
+		if (s->fields.size() > 1)
+			fieldIndicesCount += s->fields.size();
+
+	// Lists are referenced by their byte offset into the list indices
+	std::vector<uint32> listOffsets;
+	listOffsets.reserve(_lists.size());
+
+	uint32 listIndicesCount = 0;
+	for (std::vector<StructList>::const_iterator l = _lists.begin(); l != _lists.end(); ++l) {
+		listOffsets.push_back(listIndicesCount * 4);
+
+		listIndicesCount += 1 + l->size();
+	}
+
+	const uint32 structOffset       = kHeaderSize;
+	const uint32 fieldOffset        = structOffset       + _structs.size() * 12;
+	const uint32 labelOffset        = fieldOffset        + _fields.size()  * 12;
+	const uint32 fieldDataOffset    = labelOffset        + _labels.size()  * GFFLabel::kMaxLength;
+	const uint32 fieldIndicesOffset = fieldDataOffset    + _fieldData.size();
+	const uint32 listIndicesOffset  = fieldIndicesOffset + fieldIndicesCount * 4;
+
+	stream.writeUint32BE(_id);
+	stream.writeUint32BE(kVersion32);
+
+	stream.writeUint32LE(structOffset);
+	stream.writeUint32LE(_structs.size());
+	stream.writeUint32LE(fieldOffset);
+	stream.writeUint32LE(_fields.size());
+	stream.writeUint32LE(labelOffset);
+	stream.writeUint32LE(_labels.size());
+	stream.writeUint32LE(fieldDataOffset);
+	stream.writeUint32LE(_fieldData.size());
+	stream.writeUint32LE(fieldIndicesOffset);
+	stream.writeUint32LE(fieldIndicesCount * 4);
+	stream.writeUint32LE(listIndicesOffset);
+	stream.writeUint32LE(listIndicesCount * 4);
+
+	// Structs
+	uint32 fieldIndex = 0;
+	for (std::vector<StructEntry>::const_iterator s = _structs.begin(); s != _structs.end(); ++s) {
+		stream.writeUint32LE(s->id);
+
+		if        (s->fields.size() == 1) {
+			stream.writeUint32LE(s->fields.front());
+		} else if (s->fields.size() >  1) {
+			stream.writeUint32LE(fieldIndex * 4);
+			fieldIndex += s->fields.size();
+		} else
+			stream.writeUint32LE(0xFFFFFFFF);
+
+		stream.writeUint32LE(s->fields.size());
+	}
+
+	// Fields
+	for (std::vector<FieldEntry>::const_iterator f = _fields.begin(); f != _fields.end(); ++f) {
+		stream.writeUint32LE((uint32) f->type);
+		stream.writeUint32LE(f->label);
+		stream.writeUint32LE((f->type == kFieldTypeList) ? listOffsets[f->data] : f->data);
+	}
+
+	// Labels
+	for (std::vector<GFFLabel>::const_iterator l = _labels.begin(); l != _labels.end(); ++l)
+		stream.write(l->_label, GFFLabel::kMaxLength);
+
+	// Field data
+	if (!_fieldData.empty())
+		stream.write(&_fieldData[0], _fieldData.size());
+
+	// Field indices
+	for (std::vector<StructEntry>::const_iterator s = _structs.begin(); s != _structs.end(); ++s)
+		if (s->fields.size() > 1)
+			for (std::vector<uint32>::const_iterator f = s->fields.begin(); f != s->fields.end(); ++f)
+				stream.writeUint32LE(*f);
+
+	// List indices
+	for (std::vector<StructList>::const_iterator l = _lists.begin(); l != _lists.end(); ++l) {
+		stream.writeUint32LE(l->size());
+
+		for (StructList::const_iterator s = l->begin(); s != l->end(); ++s)
+			stream.writeUint32LE(*s);
+	}
+
+	if (stream.err())
+		throw Common::Exception(Common::kWriteError);
+}
+
+
+GFFPatcher::GFFPatcher(byte *data, uint32 size, uint32 id) : _data(data), _size(size),
+	_gff(new Common::MemoryReadStream(data, size), id) {
+
+}
+
+GFFPatcher::~GFFPatcher() {
+}
+
+const GFFStruct &GFFPatcher::getTopLevel() const {
+	return _gff.getTopLevel();
+}
+
+GFFFile::Field &GFFPatcher::getField(const GFFStruct &strct, const GFFLabel &field) {
+	if (strct._parent != &_gff)
+		throw Common::Exception("GFF struct doesn't belong to this GFF");
+
+	const GFFFile::Field *f = strct.getField(field);
+	if (!f)
+		throw Common::Exception("No such field \"%s\"", field.getString().c_str());
+
+	switch (f->type) {
+		case kFieldTypeByte:
+		case kFieldTypeChar:
+		case kFieldTypeUint16:
+		case kFieldTypeSint16:
+		case kFieldTypeUint32:
+		case kFieldTypeSint32:
+		case kFieldTypeUint64:
+		case kFieldTypeSint64:
+		case kFieldTypeFloat:
+		case kFieldTypeDouble:
+		case kFieldTypeVector:
+		case kFieldTypeOrientation:
+			break;
+
+		default:
+			throw Common::Exception("Field \"%s\" has no fixed size", field.getString().c_str());
+	}
+
+	return _gff._fields[f - &_gff._fields[0]];
+}
+
+byte *GFFPatcher::getData(const GFFFile::Field &field, uint32 size) {
+	uint32 offset;
+
+	if (field.extended)
+		offset = _gff._header.fieldDataOffset + field.data;
+	else
+		offset = _gff._header.fieldOffset + (&field - &_gff._fields[0]) * 12 + 8;
+
+	if ((offset > _size) || (size > (_size - offset)))
+		throw Common::Exception("Field data out of range");
+
+	return _data + offset;
+}
+
+void GFFPatcher::setInt(const GFFStruct &strct, const GFFLabel &field, uint64 value, bool isSigned) {
+	GFFFile::Field &f = getField(strct, field);
+
+	const int64 sValue = (int64) value;
+
+	bool fits = true;
+	switch (f.type) {
+		case kFieldTypeByte:
+			fits = isSigned ? ((sValue >= 0) && (sValue <= 0xFF)) : (value <= 0xFF);
+			break;
+
+		case kFieldTypeChar:
+			fits = isSigned ? ((sValue >= -128) && (sValue <= 127)) : (value <= 127);
+			break;
+
+		case kFieldTypeUint16:
+			fits = isSigned ? ((sValue >= 0) && (sValue <= 0xFFFF)) : (value <= 0xFFFF);
+			break;
+
+		case kFieldTypeSint16:
+			fits = isSigned ? ((sValue >= -32768) && (sValue <= 32767)) : (value <= 32767);
+			break;
+
+		case kFieldTypeUint32:
+			fits = isSigned ? ((sValue >= 0) && (sValue <= 0xFFFFFFFFLL)) : (value <= 0xFFFFFFFFULL);
+			break;
+
+		case kFieldTypeSint32:
+			fits = isSigned ? ((sValue >= -2147483647LL - 1) && (sValue <= 2147483647LL)) : (value <= 2147483647ULL);
+			break;
+
+		case kFieldTypeUint64:
+			fits = !isSigned || (sValue >= 0);
+			break;
+
+		case kFieldTypeSint64:
+			fits = isSigned || (value <= 0x7FFFFFFFFFFFFFFFULL);
+			break;
+
+		default:
+			throw Common::Exception("Field \"%s\" is not an int type", field.getString().c_str());
+	}
+
+	if (!fits)
+		throw Common::Exception("Value doesn't fit into field \"%s\"", field.getString().c_str());
+
+	if ((f.type == kFieldTypeUint64) || (f.type == kFieldTypeSint64)) {
+		WRITE_LE_UINT64(getData(f, 8), value);
+		return;
+	}
+
+	// Small values are stored directly in the field, zero-extended
+	uint32 data = (uint32) value;
+	if      ((f.type == kFieldTypeByte) || (f.type == kFieldTypeChar))
+		data &= 0xFF;
+	else if ((f.type == kFieldTypeUint16) || (f.type == kFieldTypeSint16))
+		data &= 0xFFFF;
+
+	WRITE_LE_UINT32(getData(f, 4), data);
+	f.data = data;
+}
+
+void GFFPatcher::setUint(const GFFStruct &strct, const GFFLabel &field, uint64 value) {
+	setInt(strct, field, value, false);
+}
+
+void GFFPatcher::setSint(const GFFStruct &strct, const GFFLabel &field, int64 value) {
+	setInt(strct, field, (uint64) value, true);
+}
+
+void GFFPatcher::setDouble(const GFFStruct &strct, const GFFLabel &field, double value) {
+	GFFFile::Field &f = getField(strct, field);
+
+	if (f.type == kFieldTypeFloat) {
+		f.data = convertIEEEFloat((float) value);
+		WRITE_LE_UINT32(getData(f, 4), f.data);
+		return;
+	}
+
+	if (f.type == kFieldTypeDouble) {
+		WRITE_LE_UINT64(getData(f, 8), convertIEEEDouble(value));
+		return;
+	}
+
+	throw Common::Exception("Field \"%s\" is not a double type", field.getString().c_str());
+}
+
+void GFFPatcher::setVector(const GFFStruct &strct, const GFFLabel &field, float x, float y, float z) {
+	GFFFile::Field &f = getField(strct, field);
+	if (f.type != kFieldTypeVector)
+		throw Common::Exception("Field \"%s\" is not a vector type", field.getString().c_str());
+
+	byte *data = getData(f, 12);
+
+	WRITE_LE_UINT32(data + 0, convertIEEEFloat(x));
+	WRITE_LE_UINT32(data + 4, convertIEEEFloat(y));
+	WRITE_LE_UINT32(data + 8, convertIEEEFloat(z));
+}
+
+void GFFPatcher::setOrientation(const GFFStruct &strct, const GFFLabel &field,
+                                float a, float b, float c, float d) {
+
+	GFFFile::Field &f = getField(strct, field);
+	if (f.type != kFieldTypeOrientation)
+		throw Common::Exception("Field \"%s\" is not an orientation type", field.getString().c_str());
+
+	byte *data = getData(f, 16);
+
+	WRITE_LE_UINT32(data +  0, convertIEEEFloat(a));
+	WRITE_LE_UINT32(data +  4, convertIEEEFloat(b));
+	WRITE_LE_UINT32(data +  8, convertIEEEFloat(c));
+	WRITE_LE_UINT32(data + 12, convertIEEEFloat(d));
+}
+
+} // End of namespace Aurora
@@ -0,0 +1,218 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/gffwriter.h
+ *  Writing and patching BioWare's GFFs (generic file format).
+ */
+
+#ifndef AURORA_GFFWRITER_H
+#define AURORA_GFFWRITER_H
+
+#include <vector>
+#include <map>
+
+#include "common/types.h"
+#include "common/ustring.h"
+#include "common/noncopyable.h"
+
+#include "aurora/gfffile.h"
+
+namespace Common {
+	class WriteStream;
+}
+
+namespace Aurora {
+
+class LocString;
+
+/** Builds a V3.2 GFF from scratch.
+ *
+ *  The struct, field, label and list tables are built while fields are
+ *  added, so writing the GFF out is a single pass over them. Labels and
+ *  extended field data are deduplicated.
+ */
+class GFFWriter : public Common::NonCopyable {
+public:
+	class List;
+
+	/** A struct within the GFF being built. Cheap to copy. */
+	class Struct {
+	public:
+		void addByte  (const GFFLabel &field, uint8  value);
+		void addChar  (const GFFLabel &field, int8   value);
+		void addUint16(const GFFLabel &field, uint16 value);
+		void addSint16(const GFFLabel &field, int16  value);
+		void addUint32(const GFFLabel &field, uint32 value);
+		void addSint32(const GFFLabel &field, int32  value);
+		void addUint64(const GFFLabel &field, uint64 value);
+		void addSint64(const GFFLabel &field, int64  value);
+
+		void addFloat (const GFFLabel &field, float  value);
+		void addDouble(const GFFLabel &field, double value);
+
+		/** Add a string of arbitrary length. */
+		void addString(const GFFLabel &field, const Common::UString &value);
+		/** Add a resource name, at most 16 characters long. */
+		void addResRef(const GFFLabel &field, const Common::UString &value);
+
+		void addLocString(const GFFLabel &field, const LocString &value);
+
+		void addData(const GFFLabel &field, const byte *data, uint32 size);
+
+		void addVector     (const GFFLabel &field, float x, float y, float z);
+		void addOrientation(const GFFLabel &field, float a, float b, float c, float d);
+
+		/** Add a child struct. */
+		Struct addStruct(const GFFLabel &field, uint32 id = 0);
+		/** Add a list of structs. */
+		List   addList  (const GFFLabel &field);
+
+		/** Copy all fields of a parsed GFF struct, including all child structs and lists. */
+		void addFields(const GFFStruct &strct);
+
+	private:
+		GFFWriter *_writer;
+		uint32     _index; ///< Index into the writer's struct array.
+
+		Struct(GFFWriter &writer, uint32 index);
+
+		void addField(const GFFLabel &field, GFFFieldType type, uint32 data);
+		void addField(const GFFLabel &field, GFFFieldType type, const byte *data, uint32 size);
+
+		friend class GFFWriter;
+	};
+
+	/** A list of structs within the GFF being built. Cheap to copy. */
+	class List {
+	public:
+		/** Add a struct to the end of the list. */
+		Struct addStruct(uint32 id = 0);
+
+		/** Return the number of structs in the list. */
+		uint32 getSize() const;
+
+	private:
+		GFFWriter *_writer;
+		uint32     _index; ///< Index into the writer's list array.
+
+		List(GFFWriter &writer, uint32 index);
+
+		friend class GFFWriter;
+	};
+
+	GFFWriter(uint32 id);
+	~GFFWriter();
+
+	/** Return the top-level struct. */
+	Struct getTopLevel();
+
+	/** Write the GFF into a stream. */
+	void write(Common::WriteStream &stream) const;
+
+private:
+	/** A struct being built. */
+	struct StructEntry {
+		uint32 id;                  ///< The struct's ID.
+		std::vector<uint32> fields; ///< Indices into the field array.
+
+		StructEntry(uint32 i);
+	};
+
+	/** A field being built. */
+	struct FieldEntry {
+		GFFFieldType type;  ///< The field's type.
+		uint32       label; ///< Index into the label array.
+		uint32       data;  ///< The field's data, or its offset into the field data.
+	};
+
+	typedef std::vector<uint32> StructList;
+
+	/** Extended field data already written, indexed by its hash. */
+	typedef std::multimap<uint32, std::pair<uint32, uint32> > FieldDataMap;
+
+	uint32 _id; ///< The GFF's ID.
+
+	std::vector<StructEntry> _structs;
+	std::vector<FieldEntry>  _fields;
+	std::vector<GFFLabel>    _labels;
+	std::vector<StructList>  _lists;
+
+	std::map<GFFLabel, uint32> _labelMap; ///< Label -> index into the label array.
+
+	std::vector<byte> _fieldData;
+	FieldDataMap      _fieldDataMap;
+
+	uint32 addStruct(uint32 id);
+	uint32 addLabel(const GFFLabel &label);
+	uint32 addFieldData(const byte *data, uint32 size);
+
+	friend class Struct;
+	friend class List;
+};
+
+/** Changes the values of fields in a GFF held in memory, without rebuilding it.
+ *
+ *  The GFF is parsed as usual, so the structs to patch can be found with the
+ *  normal GFFStruct accessors. Only fields whose size doesn't depend on their
+ *  value can be patched: integers, floats, doubles, vectors and orientations.
+ *  All changes are done directly in the memory the GFF was read from.
+ */
+class GFFPatcher : public Common::NonCopyable {
+public:
+	/** Parse the GFF in this memory. The memory is not taken over. */
+	GFFPatcher(byte *data, uint32 size, uint32 id);
+	~GFFPatcher();
+
+	/** Return the top-level struct. */
+	const GFFStruct &getTopLevel() const;
+
+	/** Set an integer field. Throws if the value doesn't fit the field. */
+	void setUint(const GFFStruct &strct, const GFFLabel &field, uint64 value);
+	/** Set an integer field. Throws if the value doesn't fit the field. */
+	void setSint(const GFFStruct &strct, const GFFLabel &field, int64 value);
+
+	/** Set a float or double field. */
+	void setDouble(const GFFStruct &strct, const GFFLabel &field, double value);
+
+	void setVector     (const GFFStruct &strct, const GFFLabel &field, float x, float y, float z);
+	void setOrientation(const GFFStruct &strct, const GFFLabel &field, float a, float b, float c, float d);
+
+private:
+	byte  *_data;
+	uint32 _size;
+
+	GFFFile _gff;
+
+	/** Return the field with this label, making sure it's of a patchable type. */
+	GFFFile::Field &getField(const GFFStruct &strct, const GFFLabel &field);
+	/** Return the field's data within the GFF's memory. */
+	byte *getData(const GFFFile::Field &field, uint32 size);
+
+	void setInt(const GFFStruct &strct, const GFFLabel &field, uint64 value, bool isSigned);
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_GFFWRITER_H
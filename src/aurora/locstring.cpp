@@ -90,6 +90,14 @@ static const int languageToStorage[] = {
 };
 
 /** Quickly map a language ID to storage space. */
+static inline Aurora::Language mapStorageToLanguage(int n) {
+	// The asian languages are stored after the european ones
+	if ((n >= 12) && (n < 20))
+		return (Aurora::Language) (Aurora::kLanguageKoreanMale + (n - 12));
+
+	return (Aurora::Language) n;
+}
+
 static inline int mapLanguageToStorage(Aurora::Language language) {
 	if (((int) language) >= ARRAYSIZE(languageToStorage))
 		return 0;
@@ -193,4 +201,22 @@ void LocString::readLocString(Common::SeekableReadStream &stream) {
 	readLocString(stream, id, count);
 }
 
+void LocString::writeLocString(Common::WriteStream &stream) const {
+	uint32 count = 0;
+	for (int i = 0; i < kStringCount; i++)
+		if (!_strings[i].empty())
+			count++;
+
+	stream.writeUint32LE(_id);
+	stream.writeUint32LE(count);
+
+	for (int i = 0; i < kStringCount; i++) {
+		if (_strings[i].empty())
+			continue;
+
+		stream.writeUint32LE((uint32) mapStorageToLanguage(i));
+		_strings[i].writeLatin9(stream, true);
+	}
+}
+
 } // End of namespace Aurora
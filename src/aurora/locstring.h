@@ -37,6 +37,7 @@
 
 namespace Common {
 	class SeekableReadStream;
+	class WriteStream;
 }
 
 namespace Aurora {
@@ -82,6 +83,9 @@ public:
 	/** Read a LocString out of a stream. */
 	void readLocString(Common::SeekableReadStream &stream);
 
+	/** Write the LocString into a stream, in the same format readLocString() reads. */
+	void writeLocString(Common::WriteStream &stream) const;
+
 private:
 	uint32 _id; ///< The string's ID / StrRef. */
 
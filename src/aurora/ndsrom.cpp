@@ -33,6 +33,7 @@
 
 #include "common/util.h"
 #include "common/file.h"
+#include "common/filepool.h"
 #include "common/stream.h"
 
 #include "aurora/ndsrom.h"
@@ -43,9 +44,13 @@ namespace Aurora {
 
 NDSFile::NDSFile(const Common::UString &fileName) : _fileName(fileName) {
 	load();
+
+	// Map the whole NDS into memory, so resources can be read without copying
+	_mappedFile = Common::mapFile(_fileName);
 }
 
 NDSFile::~NDSFile() {
+	FilePool.close(_fileName);
 }
 
 void NDSFile::clear() {
@@ -150,20 +155,10 @@ Common::SeekableReadStream *NDSFile::getResource(uint32 index) const {
 	if (res.size == 0)
 		return new Common::MemoryReadStream(0, 0);
 
-	Common::File nds;
-	open(nds);
-
-	if (!nds.seek(res.offset))
-		throw Common::Exception(Common::kSeekError);
-
-	Common::SeekableReadStream *resStream = nds.readStream(res.size);
-
-	if (!resStream || (((uint32) resStream->size()) != res.size)) {
-		delete resStream;
-		throw Common::Exception(Common::kReadError);
-	}
+	if (_mappedFile)
+		return new Common::MappedReadStream(_mappedFile, res.offset, res.size);
 
-	return resStream;
+	return FilePool.readStream(_fileName, res.offset, res.size);
 }
 
 void NDSFile::open(Common::File &file) const {
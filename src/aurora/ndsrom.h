@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "common/types.h"
+#include "common/mappedfile.h"
 #include "common/ustring.h"
 
 #include "aurora/types.h"
@@ -84,6 +85,9 @@ private:
 	/** The name of the NDS file. */
 	Common::UString _fileName;
 
+	/** The NDS file mapped into memory, if possible. */
+	Common::MappedFilePtr _mappedFile;
+
 	void open(Common::File &file) const;
 
 	void load();
@@ -0,0 +1,496 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/nwscript/benchmark.cpp
+ *  NWScript interpreter micro-benchmarks.
+ */
+
+#include <cstring>
+#include <map>
+
+#include "common/util.h"
+#include "common/error.h"
+#include "common/stream.h"
+#include "common/timestamp.h"
+
+#include "aurora/nwscript/benchmark.h"
+#include "aurora/nwscript/ncsfile.h"
+#include "aurora/nwscript/ncsreg.h"
+#include "aurora/nwscript/functionman.h"
+#include "aurora/nwscript/object.h"
+#include "aurora/nwscript/objectcontainer.h"
+#include "aurora/nwscript/interner.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** A minimal assembler, writing NCS bytecode. */
+class NCSAssembler {
+public:
+	NCSAssembler() : _stream(true), _count(0) {
+		_stream.write("NCS V1.0", 8);
+
+		// Program size, fixed up in createStream()
+		_stream.writeByte(0x42);
+		_stream.writeUint32BE(0);
+	}
+
+	/** Return the current offset, for use as a jump target. */
+	uint32 pos() const {
+		return _stream.pos();
+	}
+
+	/** Return the number of instructions written. */
+	uint32 getCount() const {
+		return _count;
+	}
+
+	void op(Opcode opcode, InstructionType type = kInstTypeNone) {
+		_stream.writeByte(opcode);
+		_stream.writeByte(type);
+
+		_count++;
+	}
+
+	void opInt(Opcode opcode, InstructionType type, int32 arg) {
+		op(opcode, type);
+		_stream.writeUint32BE((uint32) arg);
+	}
+
+	void opCopy(Opcode opcode, int32 offset, int16 size) {
+		op(opcode, kInstTypeDirect);
+		_stream.writeUint32BE((uint32) offset);
+		_stream.writeUint16BE((uint16) size);
+	}
+
+	void constInt(int32 value) {
+		opInt(kOpcodeCONST, kInstTypeInt, value);
+	}
+
+	void constFloat(float value) {
+		op(kOpcodeCONST, kInstTypeFloat);
+		_stream.writeIEEEFloatBE(value);
+	}
+
+	void constString(const char *value) {
+		const uint16 length = strlen(value);
+
+		op(kOpcodeCONST, kInstTypeString);
+		_stream.writeUint16BE(length);
+		_stream.write(value, length);
+	}
+
+	void action(uint16 routine, uint8 argCount) {
+		op(kOpcodeACTION);
+		_stream.writeUint16BE(routine);
+		_stream.writeByte(argCount);
+	}
+
+	/** Write a jump to this offset. */
+	void jump(Opcode opcode, uint32 target) {
+		opInt(opcode, kInstTypeNone, target - pos());
+	}
+
+	/** Write a jump whose target is not yet known, returning its offset. */
+	uint32 jumpForward(Opcode opcode) {
+		const uint32 offset = pos();
+
+		opInt(opcode, kInstTypeNone, 0);
+
+		return offset;
+	}
+
+	/** Let the jump written at this offset jump to the current position. */
+	void fixupJump(uint32 offset) {
+		writeAt(offset + 2, pos() - offset);
+	}
+
+	/** Create a stream containing the assembled NCS. */
+	Common::SeekableReadStream *createStream() {
+		writeAt(9, _stream.size());
+
+		byte *data = new byte[_stream.size()];
+		memcpy(data, _stream.getData(), _stream.size());
+
+		return new Common::MemoryReadStream(data, _stream.size(), true);
+	}
+
+private:
+	Common::MemoryWriteStreamDynamic _stream;
+
+	uint32 _count;
+
+	void writeAt(uint32 offset, uint32 value) {
+		WRITE_BE_UINT32(_stream.getData() + offset, value);
+	}
+};
+
+/** The code run in each iteration of a benchmark loop. */
+typedef bool (*BenchmarkBody)(NCSAssembler &ncs);
+
+static bool bodyEmpty(NCSAssembler &) {
+	return true;
+}
+
+static bool bodyIntArithmetic(NCSAssembler &ncs) {
+	ncs.constInt(3);
+	ncs.constInt(7);
+	ncs.op(kOpcodeMUL, kInstTypeIntInt);
+	ncs.constInt(5);
+	ncs.op(kOpcodeADD, kInstTypeIntInt);
+	ncs.opInt(kOpcodeMOVSP, kInstTypeNone, -4);
+
+	return true;
+}
+
+static bool bodyFloatArithmetic(NCSAssembler &ncs) {
+	ncs.constFloat(3.0f);
+	ncs.constFloat(7.5f);
+	ncs.op(kOpcodeMUL, kInstTypeFloatFloat);
+	ncs.constFloat(5.0f);
+	ncs.op(kOpcodeADD, kInstTypeFloatFloat);
+	ncs.opInt(kOpcodeMOVSP, kInstTypeNone, -4);
+
+	return true;
+}
+
+static bool bodyStringConcat(NCSAssembler &ncs) {
+	ncs.constString("Hello, ");
+	ncs.constString("world");
+	ncs.op(kOpcodeADD, kInstTypeStringString);
+	ncs.opInt(kOpcodeMOVSP, kInstTypeNone, -4);
+
+	return true;
+}
+
+static bool bodyStringCompare(NCSAssembler &ncs) {
+	ncs.constString("Hello, world");
+	ncs.opCopy(kOpcodeCPTOPSP, -4, 4);
+	ncs.op(kOpcodeEQ, kInstTypeStringString);
+	ncs.opInt(kOpcodeMOVSP, kInstTypeNone, -4);
+
+	return true;
+}
+
+static bool bodyEngineCall(NCSAssembler &ncs) {
+	FunctionContext ctx;
+	try {
+		ctx = FunctionMan.createContext(0);
+	} catch (Common::Exception &) {
+		return false;
+	}
+
+	// Push the arguments, the first one last
+	const uint32 argCount = ctx.getParamMin();
+	for (uint32 i = argCount; i-- > 0; ) {
+		switch (ctx.getParams()[i].getType()) {
+			case kTypeInt:
+				ncs.constInt(1);
+				break;
+
+			case kTypeFloat:
+				ncs.constFloat(1.0f);
+				break;
+
+			case kTypeString:
+				ncs.constString("");
+				break;
+
+			default:
+				return false;
+		}
+	}
+
+	ncs.action(0, argCount);
+
+	// Throw away the return value
+	switch (ctx.getReturn().getType()) {
+		case kTypeVoid:
+			break;
+
+		case kTypeInt:
+		case kTypeFloat:
+		case kTypeString:
+		case kTypeObject:
+		case kTypeEngineType:
+			ncs.opInt(kOpcodeMOVSP, kInstTypeNone, -4);
+			break;
+
+		case kTypeVector:
+			ncs.opInt(kOpcodeMOVSP, kInstTypeNone, -12);
+			break;
+
+		default:
+			return false;
+	}
+
+	return true;
+}
+
+/** Assemble a script running the body for a number of iterations. */
+static Common::SeekableReadStream *createLoop(BenchmarkBody body, uint32 iterations,
+                                              uint32 &instructions) {
+	NCSAssembler ncs;
+
+	// The loop counter
+	ncs.constInt(iterations);
+
+	const uint32 loopStart = ncs.getCount();
+	const uint32 loop      = ncs.pos();
+
+	ncs.opCopy(kOpcodeCPTOPSP, -4, 4);
+	const uint32 exitJump = ncs.jumpForward(kOpcodeJZ);
+
+	if (!body(ncs))
+		return 0;
+
+	ncs.opInt(kOpcodeDECSP, kInstTypeInt, -4);
+	ncs.jump(kOpcodeJMP, loop);
+
+	const uint32 loopSize = ncs.getCount() - loopStart;
+
+	ncs.fixupJump(exitJump);
+
+	ncs.opInt(kOpcodeMOVSP, kInstTypeNone, -4);
+	ncs.op(kOpcodeRETN);
+
+	/* Every iteration runs the whole loop. The CONST, the last check of
+	 * the loop condition and the clean-up run only once. */
+	instructions = iterations * loopSize + 5;
+
+	return ncs.createStream();
+}
+
+double BenchmarkResult::getInstructionsPerSecond() const {
+	return (instructions * 1000000.0) / MAX<uint64>(time, 1);
+}
+
+void runBenchmarks(uint32 iterations, std::vector<BenchmarkResult> &results) {
+	static const struct {
+		const char *name;
+		BenchmarkBody body;
+	} kBenchmarks[] = {
+		{ "Empty loop"      , &bodyEmpty           },
+		{ "Int arithmetic"  , &bodyIntArithmetic   },
+		{ "Float arithmetic", &bodyFloatArithmetic },
+		{ "String concat"   , &bodyStringConcat    },
+		{ "String compare"  , &bodyStringCompare   },
+		{ "Engine call"     , &bodyEngineCall      }
+	};
+
+	for (uint i = 0; i < ARRAYSIZE(kBenchmarks); i++) {
+		BenchmarkResult result;
+
+		result.name = kBenchmarks[i].name;
+
+		Common::SeekableReadStream *ncs = createLoop(kBenchmarks[i].body, iterations, result.instructions);
+		if (!ncs)
+			continue;
+
+		NCSProgramPtr program;
+		try {
+			program.reset(new NCSProgram(*ncs, "", NCSReg.getOptimize()));
+		} catch (...) {
+			delete ncs;
+			throw;
+		}
+
+		delete ncs;
+
+		// Warm up
+		NCSFile(program).run();
+
+		const uint32 allocations = NCSReg.getStats().stackAllocations;
+
+		{
+			NCSFile script(program);
+
+			const uint64 startTime = Common::getMicroseconds();
+
+			script.run();
+
+			result.time = Common::getMicroseconds() - startTime;
+
+			result.executed = script.getExecutedCount();
+		}
+
+		// The stack's allocations are counted once its memory is returned to the pool
+		result.allocations = NCSReg.getStats().stackAllocations - allocations;
+
+		results.push_back(result);
+	}
+}
+
+/** An object with a fixed tag, for the lookup benchmarks. */
+class BenchmarkObject : public Object {
+public:
+	BenchmarkObject(const Common::UString &tag, StringInterner &interner) : Object(interner) {
+		_tag = tag;
+	}
+};
+
+static const uint32 kBenchmarkVariableCount = 8;
+
+double LookupBenchmarkResult::getOperationsPerSecond() const {
+	return (operations * 1000000.0) / MAX<uint64>(time, 1);
+}
+
+double LookupBenchmarkResult::getBaselineOperationsPerSecond() const {
+	return (operations * 1000000.0) / MAX<uint64>(baselineTime, 1);
+}
+
+void runLookupBenchmarks(uint32 objects, std::vector<LookupBenchmarkResult> &results) {
+	typedef std::multimap<Common::UString, Object *> TagTree;
+	typedef std::map<Common::UString, Variable> VariableTree;
+
+	objects = MAX<uint32>(objects, 4);
+
+	const uint32 operations = MAX<uint32>(objects * 4, 100000);
+
+	std::vector<Common::UString> tags, variables;
+	for (uint32 i = 0; i < (objects / 4); i++)
+		tags.push_back(Common::UString::sprintf("bench_tag_%u", i));
+	for (uint32 i = 0; i < kBenchmarkVariableCount; i++)
+		variables.push_back(Common::UString::sprintf("bench_var_%u", i));
+
+	// The same pseudo-random order of lookups for all benchmarks
+	std::vector<uint32> order;
+	order.reserve(operations);
+
+	uint32 random = 1;
+	for (uint32 i = 0; i < operations; i++) {
+		random = random * 1103515245 + 12345;
+		order.push_back(random >> 8);
+	}
+
+	// Keep the throwaway names out of the global interner, which never forgets them
+	StringInterner interner;
+
+	ObjectContainer container(interner);
+
+	std::vector<Object *> objs;
+	std::vector<VariableTree> trees(objects);
+
+	TagTree tagTree;
+
+	for (uint32 i = 0; i < objects; i++) {
+		objs.push_back(new BenchmarkObject(tags[i / 4], interner));
+
+		container.addObject(*objs.back());
+		tagTree.insert(std::make_pair(objs.back()->getTag(), objs.back()));
+
+		for (uint32 j = 0; j < kBenchmarkVariableCount; j++) {
+			objs.back()->setVariable(variables[j], Variable((int32) j));
+			trees[i][variables[j]] = Variable((int32) j);
+		}
+	}
+
+	LookupBenchmarkResult result;
+
+	result.operations = operations;
+
+	uint32 found = 0;
+
+	// Tag lookups
+
+	result.name = "Tag lookup";
+
+	uint64 startTime = Common::getMicroseconds();
+
+	for (uint32 i = 0; i < operations; i++)
+		if (container.findObject(tags[order[i] % tags.size()]))
+			found++;
+
+	result.time = Common::getMicroseconds() - startTime;
+
+	startTime = Common::getMicroseconds();
+
+	for (uint32 i = 0; i < operations; i++)
+		if (tagTree.find(tags[order[i] % tags.size()]) != tagTree.end())
+			found++;
+
+	result.baselineTime = Common::getMicroseconds() - startTime;
+
+	results.push_back(result);
+
+	// Getting local variables
+
+	result.name = "Local get";
+
+	startTime = Common::getMicroseconds();
+
+	for (uint32 i = 0; i < operations; i++)
+		found += objs[order[i] % objects]->getVariable(variables[i % kBenchmarkVariableCount], kTypeInt).getInt();
+
+	result.time = Common::getMicroseconds() - startTime;
+
+	startTime = Common::getMicroseconds();
+
+	for (uint32 i = 0; i < operations; i++) {
+		VariableTree &tree = trees[order[i] % objects];
+
+		VariableTree::iterator v = tree.find(variables[i % kBenchmarkVariableCount]);
+		if (v == tree.end())
+			v = tree.insert(std::make_pair(variables[i % kBenchmarkVariableCount], Variable(kTypeInt))).first;
+
+		found += v->second.getInt();
+	}
+
+	result.baselineTime = Common::getMicroseconds() - startTime;
+
+	results.push_back(result);
+
+	// Setting local variables
+
+	result.name = "Local set";
+
+	startTime = Common::getMicroseconds();
+
+	for (uint32 i = 0; i < operations; i++)
+		objs[order[i] % objects]->setVariable(variables[i % kBenchmarkVariableCount], Variable((int32) i));
+
+	result.time = Common::getMicroseconds() - startTime;
+
+	startTime = Common::getMicroseconds();
+
+	for (uint32 i = 0; i < operations; i++)
+		trees[order[i] % objects][variables[i % kBenchmarkVariableCount]] = Variable((int32) i);
+
+	result.baselineTime = Common::getMicroseconds() - startTime;
+
+	results.push_back(result);
+
+	// The objects remove themselves from the container
+	for (std::vector<Object *>::iterator o = objs.begin(); o != objs.end(); ++o)
+		delete *o;
+
+	if (found == 0)
+		warning("runLookupBenchmarks(): Found nothing");
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
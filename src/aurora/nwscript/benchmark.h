@@ -0,0 +1,99 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/nwscript/benchmark.h
+ *  NWScript interpreter micro-benchmarks.
+ */
+
+#ifndef AURORA_NWSCRIPT_BENCHMARK_H
+#define AURORA_NWSCRIPT_BENCHMARK_H
+
+#include <vector>
+
+#include "common/types.h"
+#include "common/ustring.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** The result of one NWScript micro-benchmark. */
+struct BenchmarkResult {
+	Common::UString name; ///< The name of the benchmark.
+
+	uint32 instructions; ///< Number of instructions in the unoptimized script's execution.
+	uint32 executed;     ///< Number of instructions actually executed.
+	uint32 allocations;  ///< Number of heap allocations made by the script stack.
+	uint64 time;         ///< Time the execution took, in microseconds.
+
+	/** Return the number of instructions executed per second. */
+	double getInstructionsPerSecond() const;
+};
+
+/** Run the NWScript micro-benchmarks.
+ *
+ *  Each benchmark is a hand-assembled script looping over a small
+ *  piece of code (arithmetic, string concatenation, engine calls, ...)
+ *  for the given number of iterations, measuring the raw speed of the
+ *  interpreter. Every script is run once before measuring, so that the
+ *  pooled stack memory is already warmed up, like for a script that is
+ *  run over and over again.
+ *
+ *  The engine call benchmark calls engine function 0 and is skipped if
+ *  the current game has no such function with simple parameters.
+ */
+void runBenchmarks(uint32 iterations, std::vector<BenchmarkResult> &results);
+
+/** The result of one object or variable lookup benchmark. */
+struct LookupBenchmarkResult {
+	Common::UString name; ///< The name of the benchmark.
+
+	uint32 operations;   ///< Number of lookups done.
+	uint64 time;         ///< Time the lookups took, in microseconds.
+	uint64 baselineTime; ///< Time the lookups took with string-keyed trees, in microseconds.
+
+	/** Return the number of lookups per second. */
+	double getOperationsPerSecond() const;
+	/** Return the number of lookups per second with string-keyed trees. */
+	double getBaselineOperationsPerSecond() const;
+};
+
+/** Run the object and variable lookup benchmarks.
+ *
+ *  Fills an object container with the given number of objects, four
+ *  of them sharing each tag and each with a handful of local variables,
+ *  and measures finding objects by tag and getting and setting their
+ *  variables. For comparison, the same is done with the trees keyed by
+ *  strings that the containers used before interning.
+ *
+ *  The tags and variable names stay interned afterwards.
+ */
+void runLookupBenchmarks(uint32 objects, std::vector<LookupBenchmarkResult> &results);
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+#endif // AURORA_NWSCRIPT_BENCHMARK_H
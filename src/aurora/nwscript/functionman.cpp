@@ -31,6 +31,7 @@
 #include "common/error.h"
 
 #include "aurora/nwscript/functionman.h"
+#include "aurora/nwscript/profiler.h"
 
 DECLARE_SINGLETON(Aurora::NWScript::FunctionManager)
 
@@ -97,7 +98,11 @@ FunctionContext FunctionManager::createContext(uint32 function) const {
 }
 
 void FunctionManager::call(uint32 function, FunctionContext &ctx) const {
-	find(function).func(ctx);
+	const FunctionEntry &f = find(function);
+
+	FunctionProfileScope profile(function, f.ctx.getName());
+
+	f.func(ctx);
 }
 
 const FunctionManager::FunctionEntry &FunctionManager::find(const Common::UString &function) const {
@@ -0,0 +1,209 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/nwscript/interner.cpp
+ *  The global table of interned NWScript names.
+ */
+
+#include <cstring>
+
+#include "common/util.h"
+#include "common/error.h"
+
+#include "aurora/nwscript/interner.h"
+
+DECLARE_SINGLETON(Aurora::NWScript::StringInterner)
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** Number of strings interned since the last table rebuild that trigger a new one. */
+static const uint32 kMinRebuildCount = 64;
+
+std::size_t StringInterner::Hash::operator()(const Common::UString &str) const {
+	return StringInterner::hash(str);
+}
+
+
+StringInterner::StringInterner() : _size(0), _table(0) {
+	for (uint32 i = 0; i < kMaxChunks; i++)
+		_chunks[i] = 0;
+
+	_chunks[0] = new Common::UString[kChunkSize];
+
+	// The empty string always has the ID 0
+	_size = 1;
+
+	rebuild();
+}
+
+StringInterner::~StringInterner() {
+	for (std::vector<const Table *>::iterator t = _oldTables.begin(); t != _oldTables.end(); ++t)
+		delete *t;
+
+	delete _table;
+
+	for (uint32 i = 0; i < kMaxChunks; i++)
+		delete[] _chunks[i];
+}
+
+uint32 StringInterner::intern(const Common::UString &str) {
+	const uint32 strHash = hash(str);
+
+	uint32 id = lookup(*_table, str, strHash);
+	if (id != kInvalidID)
+		return id;
+
+	Common::StackLock lock(_mutex);
+
+	// Another thread might have interned it in the meantime
+	id = lookupLocked(str, strHash);
+	if (id != kInvalidID)
+		return id;
+
+	id = _size;
+	if ((id >> kChunkBits) >= kMaxChunks)
+		throw Common::Exception("StringInterner::intern(): Too many strings");
+
+	if (!_chunks[id >> kChunkBits])
+		_chunks[id >> kChunkBits] = new Common::UString[kChunkSize];
+
+	// Only publish the ID once the string is in place
+	_chunks[id >> kChunkBits][id & kChunkMask] = str;
+	_size = id + 1;
+
+	_recent.insert(std::make_pair(str, id));
+
+	// Merge the new strings into the table once they make up a good part of it
+	if (_recent.size() >= MAX<uint32>(kMinRebuildCount, _size / 4))
+		rebuild();
+
+	return id;
+}
+
+uint32 StringInterner::find(const Common::UString &str) const {
+	const uint32 strHash = hash(str);
+
+	const Table &table = *_table;
+
+	// If the table already holds all strings, there's nothing else to search
+	uint32 id = lookup(table, str, strHash);
+	if ((id != kInvalidID) || (table.size == _size))
+		return id;
+
+	Common::StackLock lock(_mutex);
+
+	return lookupLocked(str, strHash);
+}
+
+const Common::UString &StringInterner::getString(uint32 id) const {
+	if (id >= _size)
+		throw Common::Exception("StringInterner::getString(): Invalid ID %u", id);
+
+	return _chunks[id >> kChunkBits][id & kChunkMask];
+}
+
+uint32 StringInterner::size() const {
+	return _size;
+}
+
+uint32 StringInterner::hash(const Common::UString &str) {
+	// 32bit FNV-1a over the UTF-8 bytes, avoiding decoding the code points
+	uint32 h = 0x811C9DC5;
+
+	for (const byte *s = (const byte *) str.c_str(); *s; s++)
+		h = (h ^ *s) * 16777619;
+
+	return h;
+}
+
+uint32 StringInterner::lookup(const Table &table, const Common::UString &str, uint32 strHash) const {
+	for (uint32 i = strHash & table.mask; ; i = (i + 1) & table.mask) {
+		const Slot &slot = table.slots[i];
+
+		if (slot.id == kInvalidID)
+			return kInvalidID;
+
+		// Equal UTF-8 bytes mean equal strings, no need to decode them
+		if ((slot.hash == strHash) &&
+		    !std::strcmp(_chunks[slot.id >> kChunkBits][slot.id & kChunkMask].c_str(), str.c_str()))
+			return slot.id;
+	}
+}
+
+uint32 StringInterner::lookupLocked(const Common::UString &str, uint32 strHash) const {
+	uint32 id = lookup(*_table, str, strHash);
+	if (id != kInvalidID)
+		return id;
+
+	StringMap::const_iterator s = _recent.find(str);
+	if (s != _recent.end())
+		return s->second;
+
+	return kInvalidID;
+}
+
+void StringInterner::rebuild() {
+	uint32 capacity = 64;
+	while (capacity < (_size * 2))
+		capacity *= 2;
+
+	Table *table = new Table;
+
+	Slot empty;
+	empty.hash = 0;
+	empty.id   = kInvalidID;
+
+	table->mask = capacity - 1;
+	table->size = _size;
+	table->slots.resize(capacity, empty);
+
+	for (uint32 id = 0; id < _size; id++) {
+		const uint32 strHash = hash(_chunks[id >> kChunkBits][id & kChunkMask]);
+
+		uint32 i = strHash & table->mask;
+		while (table->slots[i].id != kInvalidID)
+			i = (i + 1) & table->mask;
+
+		table->slots[i].hash = strHash;
+		table->slots[i].id   = id;
+	}
+
+	/* Readers still probing the old table find everything in there they
+	 * would have found before, so it has to stay valid. The table is
+	 * complete before it is published with a single pointer store. */
+	const Table *oldTable = _table;
+	if (oldTable)
+		_oldTables.push_back(oldTable);
+
+	_table = table;
+
+	_recent.clear();
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
@@ -0,0 +1,128 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/nwscript/interner.h
+ *  The global table of interned NWScript names.
+ */
+
+#ifndef AURORA_NWSCRIPT_INTERNER_H
+#define AURORA_NWSCRIPT_INTERNER_H
+
+#include <vector>
+
+#include <boost/unordered/unordered_map.hpp>
+
+#include "common/types.h"
+#include "common/ustring.h"
+#include "common/singleton.h"
+#include "common/mutex.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** The global table of interned names, like object tags and variable names.
+ *
+ *  Every distinct string is assigned a small, permanent ID, so that
+ *  containers can key on integers instead of comparing strings. Strings
+ *  are never removed again.
+ *
+ *  Lookups are read-mostly: they probe an immutable hash table without
+ *  locking. Newly interned strings are collected under a mutex and, once
+ *  enough of them have accumulated, merged into a new table which then
+ *  replaces the old one. Old tables are kept around until destruction,
+ *  in case a reader is still probing them.
+ */
+class StringInterner : public Common::Singleton<StringInterner> {
+public:
+	static const uint32 kInvalidID = 0xFFFFFFFF; ///< The ID of strings that were never interned.
+	static const uint32 kEmptyID   = 0;          ///< The ID of the empty string.
+
+	StringInterner();
+	~StringInterner();
+
+	/** Return the ID of a string, interning it if necessary. */
+	uint32 intern(const Common::UString &str);
+	/** Return the ID of a string, or kInvalidID if it was never interned. */
+	uint32 find(const Common::UString &str) const;
+
+	/** Return the string with this ID. */
+	const Common::UString &getString(uint32 id) const;
+
+	/** Return the number of interned strings. */
+	uint32 size() const;
+
+private:
+	static const uint32 kChunkBits = 10;
+	static const uint32 kChunkSize = 1 << kChunkBits;
+	static const uint32 kChunkMask = kChunkSize - 1;
+	static const uint32 kMaxChunks = 4096;
+
+	/** A slot in the hash table. */
+	struct Slot {
+		uint32 hash;
+		uint32 id;
+	};
+
+	/** An immutable open addressing hash table of interned strings. */
+	struct Table {
+		uint32 mask;
+		uint32 size; ///< The number of strings in the table.
+		std::vector<Slot> slots;
+	};
+
+	/** Hashes the bytes of a string. */
+	struct Hash {
+		std::size_t operator()(const Common::UString &str) const;
+	};
+
+	typedef boost::unordered_map<Common::UString, uint32, Hash> StringMap;
+
+	Common::UString *_chunks[kMaxChunks]; ///< The strings, by ID.
+	volatile uint32 _size;                ///< The number of interned strings.
+
+	const Table * volatile _table;   ///< The current table, probed without locking.
+	std::vector<const Table *> _oldTables; ///< Tables replaced by newer ones.
+
+	mutable Common::Mutex _mutex; ///< Protects everything below, and adding strings.
+
+	StringMap _recent; ///< Strings interned since the current table was built.
+
+	static uint32 hash(const Common::UString &str);
+
+	uint32 lookup(const Table &table, const Common::UString &str, uint32 hash) const;
+	uint32 lookupLocked(const Common::UString &str, uint32 hash) const;
+
+	void rebuild();
+};
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+/** Shortcut for accessing the string interner. */
+#define Interner ::Aurora::NWScript::StringInterner::instance()
+
+#endif // AURORA_NWSCRIPT_INTERNER_H
@@ -37,7 +37,11 @@
 #include "aurora/resman.h"
 
 #include "aurora/nwscript/ncsfile.h"
+#include "aurora/nwscript/ncsreg.h"
+#include "aurora/nwscript/ncsoptimizer.h"
+#include "aurora/nwscript/profiler.h"
 #include "aurora/nwscript/object.h"
+#include "aurora/nwscript/enginetype.h"
 #include "aurora/nwscript/functionman.h"
 
 using Common::kDebugScripts;
@@ -53,15 +57,42 @@ namespace Aurora {
 
 namespace NWScript {
 
-NCSStack::NCSStack() {
-	reset();
+/** Maximum number of strings an arena keeps around after an execution. */
+static const uint32 kMaxPooledStrings = 1024;
+
+/** The string referenced by empty string cells. */
+static const Common::UString kEmptyString;
+
+NCSStackMemory::NCSStackMemory() : stringCount(0), allocations(0) {
+}
+
+NCSStackMemory::~NCSStackMemory() {
+	release();
+}
+
+void NCSStackMemory::release() {
+	stringCount = 0;
+
+	// Keep the strings, so that their memory can be reused. Unless there are too many
+	if (strings.size() > kMaxPooledStrings)
+		strings.resize(kMaxPooledStrings);
+
+	for (std::vector<EngineType *>::iterator e = engineTypes.begin(); e != engineTypes.end(); ++e)
+		delete *e;
+
+	engineTypes.clear();
+}
+
+
+NCSStack::NCSStack() : _memory(NCSReg.acquireStackMemory()), _stackPtr(-1), _basePtr(-1) {
 }
 
 NCSStack::~NCSStack() {
+	NCSReg.releaseStackMemory(_memory);
 }
 
 void NCSStack::reset() {
-	clear();
+	_memory->release();
 
 	_stackPtr = -1;
 	_basePtr  = -1;
@@ -71,33 +102,243 @@ bool NCSStack::empty() const {
 	return _stackPtr < 0;
 }
 
-Variable &NCSStack::top() {
+NCSStackCell &NCSStack::at(int32 pos) {
+	return _memory->cells[pos];
+}
+
+NCSStackCell &NCSStack::top() {
 	if (_stackPtr == -1)
 		throw Common::Exception("NCSStack: Stack underflow");
 
 	return at(_stackPtr);
 }
 
-Variable NCSStack::pop() {
+NCSStackCell NCSStack::pop() {
 	if (_stackPtr == -1)
 		throw Common::Exception("NCSStack: Stack underflow");
 
 	return at(_stackPtr--);
 }
 
-void NCSStack::push(const Variable &obj) {
+int32 NCSStack::popInt() {
+	const NCSStackCell &cell = top();
+	if (cell.type != kTypeInt)
+		throw Common::Exception("NCSStack: Can't pop an int value from a non-int cell");
+
+	_stackPtr--;
+	return cell.value.i;
+}
+
+float NCSStack::popFloat() {
+	const NCSStackCell &cell = top();
+	if (cell.type != kTypeFloat)
+		throw Common::Exception("NCSStack: Can't pop a float value from a non-float cell");
+
+	_stackPtr--;
+	return cell.value.f;
+}
+
+const Common::UString &NCSStack::popString() {
+	const NCSStackCell &cell = top();
+	if (cell.type != kTypeString)
+		throw Common::Exception("NCSStack: Can't pop a string value from a non-string cell");
+
+	_stackPtr--;
+	return *cell.value.string;
+}
+
+Object *NCSStack::popObject() {
+	const NCSStackCell &cell = top();
+	if (cell.type != kTypeObject)
+		throw Common::Exception("NCSStack: Can't pop an object value from a non-object cell");
+
+	_stackPtr--;
+	return cell.value.object;
+}
+
+Variable NCSStack::popVariable() {
+	return getVariable(pop());
+}
+
+void NCSStack::push(const NCSStackCell &cell) {
 	if (_stackPtr == 0x7FFFFFFF) // Like this will ever happen :P
 		throw Common::Exception("NCSStack: Stack overflow");
 
-	if (_stackPtr == (int32)size() - 1)
-		push_back(obj);
-	else
-		at(_stackPtr + 1) = obj;
+	std::vector<NCSStackCell> &cells = _memory->cells;
+
+	if (_stackPtr == (int32)cells.size() - 1) {
+		if (cells.size() == cells.capacity())
+			_memory->allocations++;
+
+		cells.push_back(cell);
+	} else
+		cells[_stackPtr + 1] = cell;
 
 	_stackPtr++;
 }
 
-Variable &NCSStack::getRelSP(int32 pos) {
+void NCSStack::push(Type type) {
+	NCSStackCell cell;
+
+	cell.type = type;
+
+	switch (type) {
+		case kTypeInt:
+			cell.value.i = 0;
+			break;
+
+		case kTypeFloat:
+			cell.value.f = 0.0f;
+			break;
+
+		case kTypeString:
+			cell.value.string = &kEmptyString;
+			break;
+
+		case kTypeObject:
+			cell.value.object = 0;
+			break;
+
+		case kTypeEngineType:
+			cell.value.engineType = 0;
+			break;
+
+		default:
+			throw Common::Exception("NCSStack::push(): Invalid type %d", type);
+	}
+
+	push(cell);
+}
+
+void NCSStack::pushInt(int32 value) {
+	NCSStackCell cell;
+
+	cell.type    = kTypeInt;
+	cell.value.i = value;
+
+	push(cell);
+}
+
+void NCSStack::pushFloat(float value) {
+	NCSStackCell cell;
+
+	cell.type    = kTypeFloat;
+	cell.value.f = value;
+
+	push(cell);
+}
+
+void NCSStack::pushString(const Common::UString &value) {
+	NCSStackCell cell;
+
+	cell.type         = kTypeString;
+	cell.value.string = &value;
+
+	push(cell);
+}
+
+void NCSStack::pushObject(Object *value) {
+	NCSStackCell cell;
+
+	cell.type         = kTypeObject;
+	cell.value.object = value;
+
+	push(cell);
+}
+
+void NCSStack::pushVariable(const Variable &var) {
+	switch (var.getType()) {
+		case kTypeInt:
+			pushInt(var.getInt());
+			break;
+
+		case kTypeFloat:
+			pushFloat(var.getFloat());
+			break;
+
+		case kTypeString: {
+			Common::UString &str = createString();
+
+			str = var.getString();
+			pushString(str);
+			break;
+		}
+
+		case kTypeObject:
+			pushObject(var.getObject());
+			break;
+
+		case kTypeEngineType: {
+			NCSStackCell cell;
+
+			cell.type             = kTypeEngineType;
+			cell.value.engineType = 0;
+
+			if (var.getEngineType()) {
+				cell.value.engineType = var.getEngineType()->clone();
+
+				_memory->engineTypes.push_back(cell.value.engineType);
+				_memory->allocations++;
+			}
+
+			push(cell);
+			break;
+		}
+
+		case kTypeVector: {
+			float x, y, z;
+			var.getVector(x, y, z);
+
+			pushFloat(x);
+			pushFloat(y);
+			pushFloat(z);
+			break;
+		}
+
+		default:
+			throw Common::Exception("NCSStack::pushVariable(): Invalid type %d", var.getType());
+	}
+}
+
+Common::UString &NCSStack::createString() {
+	if (_memory->stringCount < _memory->strings.size())
+		return _memory->strings[_memory->stringCount++];
+
+	_memory->strings.push_back(Common::UString());
+	_memory->stringCount++;
+	_memory->allocations++;
+
+	return _memory->strings.back();
+}
+
+Variable NCSStack::getVariable(const NCSStackCell &cell) const {
+	switch (cell.type) {
+		case kTypeVoid:
+			return Variable();
+
+		case kTypeInt:
+			return Variable(cell.value.i);
+
+		case kTypeFloat:
+			return Variable(cell.value.f);
+
+		case kTypeString:
+			return Variable(*cell.value.string);
+
+		case kTypeObject:
+			return Variable(cell.value.object);
+
+		case kTypeEngineType:
+			return Variable((const EngineType *) cell.value.engineType);
+
+		default:
+			break;
+	}
+
+	throw Common::Exception("NCSStack::getVariable(): Invalid type %d", cell.type);
+}
+
+NCSStackCell &NCSStack::getRelSP(int32 pos) {
 	if ((pos > -4) || ((pos % 4) != 0))
 		throw Common::Exception("NCSStack::get(): Illegal position %d", pos);
 
@@ -108,7 +349,7 @@ Variable &NCSStack::getRelSP(int32 pos) {
 	return at(stackPos);
 }
 
-void NCSStack::setRelSP(int32 pos, const Variable &obj) {
+void NCSStack::setRelSP(int32 pos, const NCSStackCell &cell) {
 	if ((pos > -4) || ((pos % 4) != 0))
 		throw Common::Exception("NCSStack::set(): Illegal position %d", pos);
 
@@ -116,10 +357,10 @@ void NCSStack::setRelSP(int32 pos, const Variable &obj) {
 	if (stackPos < 0)
 		throw Common::Exception("NCSStack::set(): Position %d below the bottom", pos);
 
-	at(stackPos) = obj;
+	at(stackPos) = cell;
 }
 
-Variable &NCSStack::getRelBP(int32 pos) {
+NCSStackCell &NCSStack::getRelBP(int32 pos) {
 	if ((pos > -4) || ((pos % 4) != 0))
 		throw Common::Exception("NCSStack::get(): Illegal position %d", pos);
 
@@ -130,7 +371,7 @@ Variable &NCSStack::getRelBP(int32 pos) {
 	return at(stackPos);
 }
 
-void NCSStack::setRelBP(int32 pos, const Variable &obj) {
+void NCSStack::setRelBP(int32 pos, const NCSStackCell &cell) {
 	if ((pos > -4) || ((pos % 4) != 0))
 		throw Common::Exception("NCSStack::set(): Illegal position %d", pos);
 
@@ -138,7 +379,7 @@ void NCSStack::setRelBP(int32 pos, const Variable &obj) {
 	if (stackPos < 0)
 		throw Common::Exception("NCSStack::set(): Position %d below the bottom", pos);
 
-	at(stackPos) = obj;
+	at(stackPos) = cell;
 }
 
 int32 NCSStack::getStackPtr() {
@@ -151,8 +392,13 @@ void NCSStack::setStackPtr(int32 pos) {
 
 	_stackPtr = (pos / -4) - 1;
 
-	if ((int32)size() < (_stackPtr + 1))
-		resize(_stackPtr + 1);
+	std::vector<NCSStackCell> &cells = _memory->cells;
+	if ((int32)cells.size() < (_stackPtr + 1)) {
+		if (cells.capacity() < (uint32) (_stackPtr + 1))
+			_memory->allocations++;
+
+		cells.resize(_stackPtr + 1);
+	}
 }
 
 int32 NCSStack::getBasePtr() {
@@ -172,25 +418,57 @@ void NCSStack::print() const {
 
 	debugC(2, kDebugScripts, ".--- %d ---.", _stackPtr);
 	for (int32 i = _stackPtr; i >= 0; i--) {
-		const Variable &var = at(i);
-
-		if      (var.getType() == kTypeInt)
-			debugC(2, kDebugScripts, "| %d: %d", var.getType(), var.getInt());
-		else if (var.getType() == kTypeFloat)
-			debugC(2, kDebugScripts, "| %d: %f", var.getType(), var.getFloat());
-		else if (var.getType() == kTypeString)
-			debugC(2, kDebugScripts, "| %d: \"%s\"", var.getType(), var.getString().c_str());
-		else if (var.getType() == kTypeObject) {
-			if (!var.getObject())
-				debugC(2, kDebugScripts, "| %d: 0", var.getType());
+		const NCSStackCell &cell = _memory->cells[i];
+
+		if      (cell.type == kTypeInt)
+			debugC(2, kDebugScripts, "| %d: %d", cell.type, cell.value.i);
+		else if (cell.type == kTypeFloat)
+			debugC(2, kDebugScripts, "| %d: %f", cell.type, cell.value.f);
+		else if (cell.type == kTypeString)
+			debugC(2, kDebugScripts, "| %d: \"%s\"", cell.type, cell.value.string->c_str());
+		else if (cell.type == kTypeObject) {
+			if (!cell.value.object)
+				debugC(2, kDebugScripts, "| %d: 0", cell.type);
 			else
-				debugC(2, kDebugScripts, "| %d: \"%s\"", var.getType(), var.getObject()->getTag().c_str());
+				debugC(2, kDebugScripts, "| %d: \"%s\"", cell.type, cell.value.object->getTag().c_str());
 		} else
-			debugC(2, kDebugScripts, "| %d", var.getType());
+			debugC(2, kDebugScripts, "| %d", cell.type);
 	}
 	debugC(2, kDebugScripts, "'--- ---'");
 }
 
+/** Compare two stack cells for equality. */
+static bool compareCells(const NCSStackCell &cell1, const NCSStackCell &cell2) {
+	if (cell1.type != cell2.type)
+		return false;
+
+	switch (cell1.type) {
+		case kTypeVoid:
+			return true;
+
+		case kTypeInt:
+			return cell1.value.i == cell2.value.i;
+
+		case kTypeFloat:
+			return cell1.value.f == cell2.value.f;
+
+		case kTypeString:
+			// Copies of a string cell reference the very same string
+			if (cell1.value.string == cell2.value.string)
+				return true;
+
+			return *cell1.value.string == *cell2.value.string;
+
+		case kTypeObject:
+			return cell1.value.object == cell2.value.object;
+
+		default:
+			break;
+	}
+
+	return false;
+}
+
 
 #define OPCODE(x) { &NCSFile::x, #x }
 
@@ -253,49 +531,81 @@ void NCSFile::setupOpcodes() {
 		OPCODE(o_restorebp),
 		// 0x2C
 		OPCODE(o_storestate),
-		OPCODE(o_nop)
+		OPCODE(o_nop),
+		OPCODE(o_illegal),
+		// Superinstructions
+		OPCODE(o_movdownsp),
+		OPCODE(o_jzsp),
+		OPCODE(o_jnzsp)
 	};
 
 	_opcodes = opcodes;
 	_opcodeListSize = ARRAYSIZE(opcodes);
+	assert(_opcodeListSize == kOpcodeMAX);
 }
 
 #undef OPCODE
 
-NCSFile::NCSFile(Common::SeekableReadStream *ncs) : _owner(0), _triggerer(0) {
-	_script = ncs;
+NCSProgram::NCSProgram(Common::SeekableReadStream &ncs, const Common::UString &name,
+                       bool optimize) : _name(name), _size(0), _end(0), _decodedCount(0) {
 
-	load();
+	load(ncs, optimize);
 }
 
-NCSFile::NCSFile(const Common::UString &ncs) : _name(ncs), _script(0),
-	_owner(0), _triggerer(0) {
+NCSProgram::~NCSProgram() {
+}
 
-	_script = ResMan.getResource(ncs, kFileTypeNCS);
-	if (!_script)
-		throw Common::Exception("No such NCS \"%s\"", ncs.c_str());
+const Common::UString &NCSProgram::getName() const {
+	return _name;
+}
 
-	load();
+uint32 NCSProgram::getSize() const {
+	return _size;
 }
 
-NCSFile::~NCSFile() {
-	delete _script;
+uint32 NCSProgram::getInstructionCount() const {
+	return _instructions.size();
 }
 
-const Common::UString &NCSFile::getName() const {
-	return _name;
+uint32 NCSProgram::getDecodedInstructionCount() const {
+	return _decodedCount;
 }
 
-ScriptState NCSFile::getEmptyState() {
-	ScriptState state;
+const NCSInstruction *NCSProgram::getInstructions() const {
+	if (_instructions.empty())
+		return 0;
 
-	state.offset = 13; // 8 byte header + 5 byte program size dummy op
+	return &_instructions[0];
+}
 
-	return state;
+const Common::UString &NCSProgram::getString(uint32 index) const {
+	assert(index < _strings.size());
+
+	return _strings[index];
 }
 
-void NCSFile::load() {
-	readHeader(*_script);
+uint32 NCSProgram::findInstruction(uint32 offset) const {
+	if (offset == _end)
+		return _instructions.size();
+
+	// Binary search, the instructions are sorted by offset
+	uint32 low = 0, high = _instructions.size();
+	while (low < high) {
+		uint32 mid = low + (high - low) / 2;
+
+		if      (_instructions[mid].offset < offset)
+			low  = mid + 1;
+		else if (_instructions[mid].offset > offset)
+			high = mid;
+		else
+			return mid;
+	}
+
+	return kInvalidInstruction;
+}
+
+void NCSProgram::load(Common::SeekableReadStream &ncs, bool optimize) {
+	readHeader(ncs);
 
 	if (_id != kNCSTag)
 		throw Common::Exception("Try to load non-NCS file");
@@ -303,15 +613,213 @@ void NCSFile::load() {
 	if (_version != kVersion10)
 		throw Common::Exception("Unsupported NCS file version %08X", _version);
 
-	byte lengthOpcode = _script->readByte();
+	byte lengthOpcode = ncs.readByte();
 	if (lengthOpcode != 0x42)
 		throw Common::Exception("Script size opcode != 0x42 (0x%02X)", lengthOpcode);
 
-	uint32 length = _script->readUint32BE();
-	if (length > ((uint32) _script->size()))
-		throw Common::Exception("Script size %d > stream size %d", length, _script->size());
-	if (length < ((uint32) _script->size()))
-		warning("TODO: NCSFile::load(): Script size %d < stream size %d", length, _script->size());
+	uint32 length = ncs.readUint32BE();
+	if (length > ((uint32) ncs.size()))
+		throw Common::Exception("Script size %d > stream size %d", length, ncs.size());
+	if (length < ((uint32) ncs.size()))
+		warning("TODO: NCSProgram::load(): Script size %d < stream size %d", length, ncs.size());
+
+	_size = ncs.size();
+
+	// Like before, execution runs on until the end of the stream
+	decode(ncs, _size);
+	resolveJumps();
+
+	_decodedCount = _instructions.size();
+
+	if (optimize)
+		NCSOptimizer(_instructions).optimize();
+}
+
+void NCSProgram::decode(Common::SeekableReadStream &ncs, uint32 length) {
+	_end = length;
+
+	if (!ncs.seek(13)) // 8 byte header + 5 byte program size dummy op
+		throw Common::Exception(Common::kSeekError);
+
+	while ((uint32) ncs.pos() < length) {
+		NCSInstruction instr;
+
+		instr.offset = ncs.pos();
+
+		bool legal = decodeInstruction(ncs, instr);
+
+		if (ncs.err())
+			throw Common::Exception(Common::kReadError);
+
+		if (ncs.eos() || ((uint32) ncs.pos() > length)) {
+			// Truncated instruction. Treat it as the end of the program
+			_end = instr.offset;
+			break;
+		}
+
+		_instructions.push_back(instr);
+
+		if (!legal) {
+			// We can't know where the next instruction would start
+			_end = length;
+			break;
+		}
+	}
+}
+
+bool NCSProgram::decodeInstruction(Common::SeekableReadStream &ncs, NCSInstruction &instr) {
+	instr.opcode = ncs.readByte();
+	instr.type   = ncs.readByte();
+
+	instr.args[0].u = 0;
+	instr.args[1].u = 0;
+	instr.args[2].u = 0;
+
+	switch (instr.opcode) {
+		case kOpcodeCPDOWNSP:
+		case kOpcodeCPTOPSP:
+		case kOpcodeCPDOWNBP:
+		case kOpcodeCPTOPBP:
+			instr.args[0].i = ncs.readSint32BE();
+			instr.args[1].i = ncs.readSint16BE();
+			break;
+
+		case kOpcodeCONST:
+			switch (instr.type) {
+				case kInstTypeInt:
+					instr.args[0].i = ncs.readSint32BE();
+					break;
+
+				case kInstTypeFloat:
+					instr.args[0].f = ncs.readIEEEFloatBE();
+					break;
+
+				case kInstTypeString:
+					instr.args[0].u = _strings.size();
+
+					_strings.push_back(Common::UString());
+					_strings.back().readFixedASCII(ncs, ncs.readUint16BE());
+					break;
+
+				case kInstTypeObject:
+					instr.args[0].u = ncs.readUint32BE();
+					break;
+
+				default:
+					// Errors out when executed
+					break;
+			}
+			break;
+
+		case kOpcodeACTION:
+			instr.args[0].u = ncs.readUint16BE();
+			instr.args[1].u = ncs.readByte();
+			break;
+
+		case kOpcodeEQ:
+		case kOpcodeNEQ:
+			if (instr.type == kInstTypeStructStruct)
+				instr.args[0].u = ncs.readUint16BE();
+			break;
+
+		case kOpcodeMOVSP:
+		case kOpcodeDECSP:
+		case kOpcodeINCSP:
+		case kOpcodeDECBP:
+		case kOpcodeINCBP:
+			instr.args[0].i = ncs.readSint32BE();
+			break;
+
+		case kOpcodeJMP:
+		case kOpcodeJSR:
+		case kOpcodeJZ:
+		case kOpcodeJNZ:
+			// The target offset, relative to the start of the instruction. Resolved later
+			instr.args[0].u = instr.offset + ncs.readSint32BE();
+			break;
+
+		case kOpcodeDESTRUCT:
+			instr.args[0].i = ncs.readSint16BE();
+			instr.args[1].i = ncs.readSint16BE();
+			instr.args[2].i = ncs.readSint16BE();
+			break;
+
+		case kOpcodeSTORESTATE:
+			instr.args[0].u = ncs.readUint32BE();
+			instr.args[1].u = ncs.readUint32BE();
+			break;
+
+		default:
+			if (instr.opcode >= kOpcodeIllegal) {
+				instr.args[0].u = instr.opcode;
+				instr.opcode    = kOpcodeIllegal;
+
+				return false;
+			}
+			break;
+	}
+
+	return true;
+}
+
+void NCSProgram::resolveJumps() {
+	for (std::vector<NCSInstruction>::iterator i = _instructions.begin(); i != _instructions.end(); ++i)
+		if ((i->opcode == kOpcodeJMP) || (i->opcode == kOpcodeJSR) ||
+		    (i->opcode == kOpcodeJZ ) || (i->opcode == kOpcodeJNZ))
+			i->args[0].u = findInstruction(i->args[0].u);
+}
+
+
+NCSFile::NCSFile(Common::SeekableReadStream *ncs) : _instructions(0), _instructionCount(0), _pc(0),
+	_executedCount(0), _owner(0), _triggerer(0) {
+
+	assert(ncs);
+
+	try {
+		_program.reset(new NCSProgram(*ncs, "", NCSReg.getOptimize()));
+	} catch (...) {
+		delete ncs;
+		throw;
+	}
+
+	delete ncs;
+
+	load();
+}
+
+NCSFile::NCSFile(const Common::UString &ncs) : _program(NCSReg.get(ncs)),
+	_instructions(0), _instructionCount(0), _pc(0), _executedCount(0), _owner(0), _triggerer(0) {
+
+	load();
+}
+
+NCSFile::NCSFile(const NCSProgramPtr &program) : _program(program),
+	_instructions(0), _instructionCount(0), _pc(0), _executedCount(0), _owner(0), _triggerer(0) {
+
+	assert(_program);
+
+	load();
+}
+
+NCSFile::~NCSFile() {
+}
+
+const Common::UString &NCSFile::getName() const {
+	return _program->getName();
+}
+
+ScriptState NCSFile::getEmptyState() {
+	ScriptState state;
+
+	state.offset = 13; // 8 byte header + 5 byte program size dummy op
+
+	return state;
+}
+
+void NCSFile::load() {
+	// Execute straight out of the shared program
+	_instructions     = _program->getInstructions();
+	_instructionCount = _program->getInstructionCount();
 
 	setupOpcodes();
 
@@ -327,7 +835,9 @@ void NCSFile::reset() {
 	_storedState.setType(kTypeVoid);
 	_return.setType(kTypeVoid);
 
-	_script->seek(13); // 8 byte header + 5 byte program size dummy op
+	_pc = 0;
+
+	_executedCount = 0;
 }
 
 const Variable &NCSFile::run(Object *owner, Object *triggerer) {
@@ -336,22 +846,24 @@ const Variable &NCSFile::run(Object *owner, Object *triggerer) {
 
 const Variable &NCSFile::run(const ScriptState &state, Object *owner, Object *triggerer) {
 	debugC(1, kDebugScripts, "=== Running script \"%s\" (%d) ===",
-	       _name.c_str(), state.offset);
+	       getName().c_str(), state.offset);
 
 	reset();
 
-	_script->seek(state.offset);
+	_pc = _program->findInstruction(state.offset);
+	if (_pc == NCSProgram::kInvalidInstruction)
+		throw Common::Exception("NCSFile::run(): No instruction at offset %d", state.offset);
 
 	// Push global variables
 	std::vector<class Variable>::const_reverse_iterator var;
 	for (var = state.globals.rbegin(); var != state.globals.rend(); ++var)
-		_stack.push(*var);
+		_stack.pushVariable(*var);
 
 	_stack.setBasePtr(_stack.getStackPtr());
 
 	// Push local variables
 	for (var = state.locals.rbegin(); var != state.locals.rend(); ++var)
-		_stack.push(*var);
+		_stack.pushVariable(*var);
 
 	return execute(owner, triggerer);
 }
@@ -360,57 +872,74 @@ const Variable &NCSFile::execute(Object *owner, Object *triggerer) {
 	_owner     = owner;
 	_triggerer = triggerer;
 
-	while (!_script->eos() && !_script->err())
-		executeStep();
+	ScriptProfileScope profile(getName());
 
-	if (_script->err())
-		throw Common::Exception(Common::kReadError);
+	uint32 executed = 0;
 
-	if (!_stack.empty())
-		_return = _stack.top();
+	/* The instructions are already decoded, so each step is only a call
+	 * through the opcode table. Tracing is decided once per run, to keep
+	 * it out of the common path. */
+	if (DebugMan.isEnabled(1, kDebugScripts)) {
 
-	if (!_stack.empty() && (_stack.top().getType() == kTypeInt))
-		debugC(1, kDebugScripts, "=> Script\"%s\" returns: %d",
-		       _name.c_str(), _stack.top().getInt());
+		while (_pc < _instructionCount) {
+			const NCSInstruction &instr = _instructions[_pc++];
+			executed++;
 
-	_owner     = 0;
-	_triggerer = 0;
+			debugC(1, kDebugScripts, "NWScript opcode %s [0x%02X]",
+			       _opcodes[instr.opcode].desc, instr.opcode);
 
-	return _return;
-}
+			(this->*(_opcodes[instr.opcode].proc))((InstructionType) instr.type, instr);
 
-void NCSFile::executeStep() {
-	byte opcode = _script->readByte();
-	InstructionType type = (InstructionType)_script->readByte();
+			_stack.print();
+			debugC(2, kDebugScripts, "[RETURN: %d]",
+			       _returnOffsets.empty() ? -1 : _returnOffsets.top());
+		}
 
-	if (opcode >= _opcodeListSize)
-		throw Common::Exception("NCSFile::executeStep(): Illegal instruction 0x%02x", opcode);
+	} else {
 
-	debugC(1, kDebugScripts, "NWScript opcode %s [0x%02X]", _opcodes[opcode].desc, opcode);
+		while (_pc < _instructionCount) {
+			const NCSInstruction &instr = _instructions[_pc++];
+			executed++;
+
+			(this->*(_opcodes[instr.opcode].proc))((InstructionType) instr.type, instr);
+		}
 
-	try {
-		(this->*(_opcodes[opcode].proc))(type);
-	} catch (Common::Exception e) {
-		throw e;
 	}
 
-	_stack.print();
-	debugC(2, kDebugScripts, "[RETURN: %d]",
-	       _returnOffsets.empty() ? -1 : _returnOffsets.top());
+	_executedCount = executed;
+	NCSReg.addRun(executed);
+	profile.setInstructions(executed);
+
+	if (!_stack.empty())
+		_return = _stack.getVariable(_stack.top());
+
+	if (_return.getType() == kTypeInt)
+		debugC(1, kDebugScripts, "=> Script\"%s\" returns: %d",
+		       getName().c_str(), _return.getInt());
+
+	// Everything the execution created is released in one go
+	_stack.reset();
+
+	_owner     = 0;
+	_triggerer = 0;
+
+	return _return;
 }
 
-void NCSFile::decompile() {
-	uint32 oldScriptPos = _script->pos();
-	_script->seek(13); // 8 byte header + 5 byte program size dummy op
+uint32 NCSFile::getExecutedCount() const {
+	return _executedCount;
+}
 
-	// TODO
+void NCSFile::jump(uint32 instruction) {
+	if (instruction == NCSProgram::kInvalidInstruction)
+		throw Common::Exception("NCSFile::jump(): Jump to an invalid offset");
 
-	_script->seek(oldScriptPos);
+	_pc = instruction;
 }
 
 // OPCODES!
 
-void NCSFile::o_rsadd(InstructionType type) {
+void NCSFile::o_rsadd(InstructionType type, const NCSInstruction &instr) {
 	switch (type) {
 		case kInstTypeInt:
 			_stack.push(kTypeInt);
@@ -441,31 +970,29 @@ void NCSFile::o_rsadd(InstructionType type) {
 	}
 }
 
-void NCSFile::o_const(InstructionType type) {
+void NCSFile::o_const(InstructionType type, const NCSInstruction &instr) {
 	switch (type) {
 		case kInstTypeInt:
-			_stack.push(_script->readSint32BE());
+			_stack.pushInt(instr.args[0].i);
 			break;
 
 		case kInstTypeFloat:
-			_stack.push(_script->readIEEEFloatBE());
+			_stack.pushFloat(instr.args[0].f);
 			break;
 
-		case kInstTypeString: {
-			_stack.push(kTypeString);
-			_stack.top().getString().readFixedASCII(*_script, _script->readUint16BE());
+		case kInstTypeString:
+			_stack.pushString(_program->getString(instr.args[0].u));
 			break;
-		}
 
 		case kInstTypeObject: {
-			uint32 objectID = _script->readUint32BE();
+			uint32 objectID = instr.args[0].u;
 
 			if      (objectID == kScriptObjectSelf)
-				_stack.push(_owner);
+				_stack.pushObject(_owner);
 			else if (objectID == kScriptObjectInvalid)
-				_stack.push((Object *) 0);
+				_stack.pushObject(0);
 			else if (objectID == kScriptObjectTypeInvalid)
-				_stack.push((Object *) 0);
+				_stack.pushObject(0);
 			else
 				throw Common::Exception("NCSFile::o_const(): Illegal object ID %d", objectID);
 
@@ -498,13 +1025,13 @@ void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
 			case kTypeString:
 			case kTypeObject:
 			case kTypeEngineType:
-				param = _stack.pop();
+				param = _stack.popVariable();
 				break;
 
 			case kTypeVector: {
-				float z = _stack.pop().getFloat();
-				float y = _stack.pop().getFloat();
-				float x = _stack.pop().getFloat();
+				float z = _stack.popFloat();
+				float y = _stack.popFloat();
+				float x = _stack.popFloat();
 
 				param.setVector(x, y, z);
 				break;
@@ -537,18 +1064,9 @@ void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
 		case kTypeString:
 		case kTypeObject:
 		case kTypeEngineType:
-			_stack.push(retVal);
-			break;
-
-		case kTypeVector: {
-			float x, y, z;
-			retVal.getVector(x, y, z);
-
-			_stack.push(x);
-			_stack.push(y);
-			_stack.push(z);
+		case kTypeVector:
+			_stack.pushVariable(retVal);
 			break;
-		}
 
 		default:
 			throw Common::Exception("NCSFile::callEngine(): Invalid return type %d",
@@ -557,12 +1075,12 @@ void NCSFile::callEngine(Aurora::NWScript::FunctionContext &ctx,
 	}
 }
 
-void NCSFile::o_action(InstructionType type) {
+void NCSFile::o_action(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_action(): Illegal type %d", type);
 
-	uint16 routineNumber = _script->readUint16BE();
-	uint8  argCount      = _script->readByte();
+	uint16 routineNumber = instr.args[0].u;
+	uint8  argCount      = instr.args[1].u;
 
 	Aurora::NWScript::FunctionContext ctx = FunctionMan.createContext(routineNumber);
 
@@ -575,98 +1093,96 @@ void NCSFile::o_action(InstructionType type) {
 	}
 }
 
-void NCSFile::o_logand(InstructionType type) {
+void NCSFile::o_logand(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_logand(): Illegal type %d", type);
 
 	try {
-		int32 arg1 = _stack.pop().getInt();
-		int32 arg2 = _stack.pop().getInt();
-		_stack.push(arg1 && arg2);
+		int32 arg1 = _stack.popInt();
+		int32 arg2 = _stack.popInt();
+		_stack.pushInt(arg1 && arg2);
 	} catch (Common::Exception e) {
 		throw e;
 	}
 }
 
-void NCSFile::o_logor(InstructionType type) {
+void NCSFile::o_logor(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_logor(): Illegal type %d", type);
 
 	try {
-		int32 arg1 = _stack.pop().getInt();
-		int32 arg2 = _stack.pop().getInt();
-		_stack.push(arg1 || arg2);
+		int32 arg1 = _stack.popInt();
+		int32 arg2 = _stack.popInt();
+		_stack.pushInt(arg1 || arg2);
 	} catch (Common::Exception e) {
 		throw e;
 	}
 }
 
-void NCSFile::o_incor(InstructionType type) {
+void NCSFile::o_incor(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_incor(): Illegal type %d", type);
 
 	try {
-		int32 arg1 = _stack.pop().getInt();
-		int32 arg2 = _stack.pop().getInt();
-		_stack.push(arg1 | arg2);
+		int32 arg1 = _stack.popInt();
+		int32 arg2 = _stack.popInt();
+		_stack.pushInt(arg1 | arg2);
 	} catch (Common::Exception e) {
 		throw e;
 	}
 }
 
-void NCSFile::o_excor(InstructionType type) {
+void NCSFile::o_excor(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_excor(): Illegal type %d", type);
 
 	try {
-		int32 arg1 = _stack.pop().getInt();
-		int32 arg2 = _stack.pop().getInt();
-		_stack.push(arg1 ^ arg2);
+		int32 arg1 = _stack.popInt();
+		int32 arg2 = _stack.popInt();
+		_stack.pushInt(arg1 ^ arg2);
 	} catch (Common::Exception e) {
 		throw e;
 	}
 }
 
-void NCSFile::o_booland(InstructionType type) {
+void NCSFile::o_booland(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_booland(): Illegal type %d", type);
 
 	try {
-		int32 arg1 = _stack.pop().getInt();
-		int32 arg2 = _stack.pop().getInt();
-		_stack.push(arg1 && arg2);
+		int32 arg1 = _stack.popInt();
+		int32 arg2 = _stack.popInt();
+		_stack.pushInt(arg1 && arg2);
 	} catch (Common::Exception e) {
 		throw e;
 	}
 }
 
-void NCSFile::o_eq(InstructionType type) {
-	if (type == kInstTypeStructStruct) // TODO!
-		_script->readUint16BE();
+void NCSFile::o_eq(InstructionType type, const NCSInstruction &instr) {
+	// TODO: Struct comparison. The struct size is in instr.args[0]
 
-	Variable arg1 = _stack.pop();
-	Variable arg2 = _stack.pop();
+	NCSStackCell arg1 = _stack.pop();
+	NCSStackCell arg2 = _stack.pop();
 
-	_stack.push(arg1 == arg2);
+	_stack.pushInt(compareCells(arg1, arg2));
 }
 
-void NCSFile::o_neq(InstructionType type) {
-	if (type == kInstTypeStructStruct) // TODO!
-		_script->readUint16BE();
+void NCSFile::o_neq(InstructionType type, const NCSInstruction &instr) {
+	// TODO: Struct comparison. The struct size is in instr.args[0]
 
-	Variable arg1 = _stack.pop();
-	Variable arg2 = _stack.pop();
+	NCSStackCell arg1 = _stack.pop();
+	NCSStackCell arg2 = _stack.pop();
 
-	_stack.push(arg1 != arg2);
+	_stack.pushInt(!compareCells(arg1, arg2));
 }
 
-void NCSFile::o_geq(InstructionType type) {
+void NCSFile::o_geq(InstructionType type, const NCSInstruction &instr) {
 	switch (type) {
 		case kInstTypeIntInt:
 			try {
-				int32 arg1 = _stack.pop().getInt();
-				int32 arg2 = _stack.pop().getInt();
-				_stack.push(arg2 >= arg1);
+				int32 arg1 = _stack.popInt();
+				int32 arg2 = _stack.popInt();
+				_stack.pushInt(arg2 >= arg1);
 			} catch (Common::Exception e) {
 				throw e;
 			}
@@ -674,9 +1190,9 @@ void NCSFile::o_geq(InstructionType type) {
 
 		case kInstTypeFloatFloat:
 			try {
-				float arg1 = _stack.pop().getFloat();
-				float arg2 = _stack.pop().getFloat();
-				_stack.push(arg2 >= arg1);
+				float arg1 = _stack.popFloat();
+				float arg2 = _stack.popFloat();
+				_stack.pushInt(arg2 >= arg1);
 			} catch (Common::Exception e) {
 				throw e;
 			}
@@ -687,13 +1203,13 @@ void NCSFile::o_geq(InstructionType type) {
 	}
 }
 
-void NCSFile::o_gt(InstructionType type) {
+void NCSFile::o_gt(InstructionType type, const NCSInstruction &instr) {
 	switch (type) {
 		case kInstTypeIntInt:
 			try {
-				int32 arg1 = _stack.pop().getInt();
-				int32 arg2 = _stack.pop().getInt();
-				_stack.push(arg2 > arg1);
+				int32 arg1 = _stack.popInt();
+				int32 arg2 = _stack.popInt();
+				_stack.pushInt(arg2 > arg1);
 			} catch (Common::Exception e) {
 				throw e;
 			}
@@ -701,9 +1217,9 @@ void NCSFile::o_gt(InstructionType type) {
 
 		case kInstTypeFloatFloat:
 			try {
-				float arg1 = _stack.pop().getFloat();
-				float arg2 = _stack.pop().getFloat();
-				_stack.push(arg2 > arg1);
+				float arg1 = _stack.popFloat();
+				float arg2 = _stack.popFloat();
+				_stack.pushInt(arg2 > arg1);
 			} catch (Common::Exception e) {
 				throw e;
 			}
@@ -714,13 +1230,13 @@ void NCSFile::o_gt(InstructionType type) {
 	}
 }
 
-void NCSFile::o_lt(InstructionType type) {
+void NCSFile::o_lt(InstructionType type, const NCSInstruction &instr) {
 	switch (type) {
 		case kInstTypeIntInt:
 			try {
-				int32 arg1 = _stack.pop().getInt();
-				int32 arg2 = _stack.pop().getInt();
-				_stack.push(arg2 < arg1);
+				int32 arg1 = _stack.popInt();
+				int32 arg2 = _stack.popInt();
+				_stack.pushInt(arg2 < arg1);
 			} catch (Common::Exception e) {
 				throw e;
 			}
@@ -728,9 +1244,9 @@ void NCSFile::o_lt(InstructionType type) {
 
 		case kInstTypeFloatFloat:
 			try {
-				float arg1 = _stack.pop().getFloat();
-				float arg2 = _stack.pop().getFloat();
-				_stack.push(arg2 < arg1);
+				float arg1 = _stack.popFloat();
+				float arg2 = _stack.popFloat();
+				_stack.pushInt(arg2 < arg1);
 			} catch (Common::Exception e) {
 				throw e;
 			}
@@ -741,13 +1257,13 @@ void NCSFile::o_lt(InstructionType type) {
 	}
 }
 
-void NCSFile::o_leq(InstructionType type) {
+void NCSFile::o_leq(InstructionType type, const NCSInstruction &instr) {
 	switch (type) {
 		case kInstTypeIntInt:
 			try {
-				int32 arg1 = _stack.pop().getInt();
-				int32 arg2 = _stack.pop().getInt();
-				_stack.push(arg2 <= arg1);
+				int32 arg1 = _stack.popInt();
+				int32 arg2 = _stack.popInt();
+				_stack.pushInt(arg2 <= arg1);
 			} catch (Common::Exception e) {
 				throw e;
 			}
@@ -755,9 +1271,9 @@ void NCSFile::o_leq(InstructionType type) {
 
 		case kInstTypeFloatFloat:
 			try {
-				float arg1 = _stack.pop().getFloat();
-				float arg2 = _stack.pop().getFloat();
-				_stack.push(arg2 <= arg1);
+				float arg1 = _stack.popFloat();
+				float arg2 = _stack.popFloat();
+				_stack.pushInt(arg2 <= arg1);
 			} catch (Common::Exception e) {
 				throw e;
 			}
@@ -768,71 +1284,71 @@ void NCSFile::o_leq(InstructionType type) {
 	}
 }
 
-void NCSFile::o_shleft(InstructionType type) {
+void NCSFile::o_shleft(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_shleft(): Illegal type %d", type);
 
 	try {
-		int32 arg1 = _stack.pop().getInt();
-		int32 arg2 = _stack.pop().getInt();
-		_stack.push(arg2 << arg1);
+		int32 arg1 = _stack.popInt();
+		int32 arg2 = _stack.popInt();
+		_stack.pushInt(arg2 << arg1);
 	} catch (Common::Exception e) {
 		throw e;
 	}
 }
 
-void NCSFile::o_shright(InstructionType type) {
+void NCSFile::o_shright(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_shright(): Illegal type %d", type);
 
 	try {
-		int32 arg1 = _stack.pop().getInt();
-		int32 arg2 = _stack.pop().getInt();
-		_stack.push(arg2 >> arg1);
+		int32 arg1 = _stack.popInt();
+		int32 arg2 = _stack.popInt();
+		_stack.pushInt(arg2 >> arg1);
 	} catch (Common::Exception e) {
 		throw e;
 	}
 }
 
-void NCSFile::o_ushright(InstructionType type) {
+void NCSFile::o_ushright(InstructionType type, const NCSInstruction &instr) {
 	// TODO: Difference between this and o_shright
 
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_ushright(): Illegal type %d", type);
 
 	try {
-		int32 arg1 = _stack.pop().getInt();
-		int32 arg2 = _stack.pop().getInt();
-		_stack.push(arg2 >> arg1);
+		int32 arg1 = _stack.popInt();
+		int32 arg2 = _stack.popInt();
+		_stack.pushInt(arg2 >> arg1);
 	} catch (Common::Exception e) {
 		throw e;
 	}
 }
 
-void NCSFile::o_mod(InstructionType type) {
+void NCSFile::o_mod(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeIntInt)
 		throw Common::Exception("NCSFile::o_mod(): Illegal type %d", type);
 
 	try {
-		int32 arg1 = _stack.pop().getInt();
-		int32 arg2 = _stack.pop().getInt();
+		int32 arg1 = _stack.popInt();
+		int32 arg2 = _stack.popInt();
 
 		if (arg1 == 0)
 			throw Common::Exception("NCSFile::o_mod(): Modulus by zero");
 		else if (arg1 < 0 || arg2 < 0)
 			throw Common::Exception("NCSFile::o_mod(): Modulus by negative number (%d %% %d)", arg2, arg1);
 
-		_stack.push(arg2 % arg1);
+		_stack.pushInt(arg2 % arg1);
 	} catch (Common::Exception e) {
 		throw e;
 	}
 }
 
-void NCSFile::o_neg(InstructionType type) {
+void NCSFile::o_neg(InstructionType type, const NCSInstruction &instr) {
 	switch (type) {
 		case kInstTypeInt:
 			try {
-				_stack.push(-_stack.pop().getInt());
+				_stack.pushInt(-_stack.popInt());
 			} catch (Common::Exception e) {
 				throw e;
 			}
@@ -840,7 +1356,7 @@ void NCSFile::o_neg(InstructionType type) {
 
 		case kInstTypeFloat:
 			try {
-				_stack.push(-_stack.pop().getFloat());
+				_stack.pushFloat(-_stack.popFloat());
 			} catch (Common::Exception e) {
 				throw e;
 			}
@@ -851,120 +1367,131 @@ void NCSFile::o_neg(InstructionType type) {
 	}
 }
 
-void NCSFile::o_comp(InstructionType type) {
+void NCSFile::o_comp(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeInt)
 		throw Common::Exception("NCSFile::o_comp(): Illegal type %d", type);
 
 	try {
-		_stack.push(~_stack.pop().getInt());
+		_stack.pushInt(~_stack.popInt());
 	} catch (Common::Exception e) {
 		throw e;
 	}
 }
 
-void NCSFile::o_movsp(InstructionType type) {
+void NCSFile::o_movsp(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_movsp(): Illegal type %d", type);
 
-	_stack.setStackPtr(_stack.getStackPtr() - _script->readSint32BE());
+	_stack.setStackPtr(_stack.getStackPtr() - instr.args[0].i);
 }
 
-void NCSFile::o_jmp(InstructionType type) {
+void NCSFile::o_jmp(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_jmp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-	_script->seek(offset - 6, SEEK_CUR);
+	jump(instr.args[0].u);
 }
 
-void NCSFile::o_jz(InstructionType type) {
+void NCSFile::o_jz(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_jz(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-
-	if (!_stack.pop().getInt())
-		_script->seek(offset - 6, SEEK_CUR);
+	if (!_stack.popInt())
+		jump(instr.args[0].u);
 }
 
-void NCSFile::o_not(InstructionType type) {
+void NCSFile::o_not(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeInt)
 		throw Common::Exception("NCSFile::o_not(): Illegal type %d", type);
 
-	_stack.push(!_stack.pop().getInt());
+	_stack.pushInt(!_stack.popInt());
 }
 
-void NCSFile::o_decsp(InstructionType type) {
+void NCSFile::o_decsp(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeInt)
 		throw Common::Exception("NCSFile::o_decsp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
+	int32 offset = instr.args[0].i;
 
-	_stack.setRelSP(offset, _stack.getRelSP(offset).getInt() - 1);
+	NCSStackCell &cell = _stack.getRelSP(offset);
+	if (cell.type != kTypeInt)
+		throw Common::Exception("NCSFile::o_decsp(): Not an int");
+
+	cell.value.i--;
 }
 
-void NCSFile::o_incsp(InstructionType type) {
+void NCSFile::o_incsp(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeInt)
 		throw Common::Exception("NCSFile::o_incsp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
+	int32 offset = instr.args[0].i;
+
+	NCSStackCell &cell = _stack.getRelSP(offset);
+	if (cell.type != kTypeInt)
+		throw Common::Exception("NCSFile::o_incsp(): Not an int");
 
-	_stack.setRelSP(offset, _stack.getRelSP(offset).getInt() + 1);
+	cell.value.i++;
 }
 
-void NCSFile::o_jnz(InstructionType type) {
+void NCSFile::o_jnz(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_jnz(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-
-	if (_stack.pop().getInt())
-		_script->seek(offset - 6, SEEK_CUR);
+	if (_stack.popInt())
+		jump(instr.args[0].u);
 }
 
-void NCSFile::o_decbp(InstructionType type) {
+void NCSFile::o_decbp(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeInt)
 		throw Common::Exception("NCSFile::o_decbp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
+	int32 offset = instr.args[0].i;
 
-	_stack.setRelBP(offset, _stack.getRelBP(offset).getInt() - 1);
+	NCSStackCell &cell = _stack.getRelBP(offset);
+	if (cell.type != kTypeInt)
+		throw Common::Exception("NCSFile::o_decbp(): Not an int");
+
+	cell.value.i--;
 }
 
-void NCSFile::o_incbp(InstructionType type) {
+void NCSFile::o_incbp(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeInt)
 		throw Common::Exception("NCSFile::o_incbp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
+	int32 offset = instr.args[0].i;
+
+	NCSStackCell &cell = _stack.getRelBP(offset);
+	if (cell.type != kTypeInt)
+		throw Common::Exception("NCSFile::o_incbp(): Not an int");
 
-	_stack.setRelBP(offset, _stack.getRelBP(offset).getInt() + 1);
+	cell.value.i++;
 }
 
-void NCSFile::o_savebp(InstructionType type) {
+void NCSFile::o_savebp(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_savebp(): Illegal type %d", type);
 
-	_stack.push(_stack.getBasePtr());
+	_stack.pushInt(_stack.getBasePtr());
 	_stack.setBasePtr(_stack.getStackPtr());
 }
 
-void NCSFile::o_restorebp(InstructionType type) {
+void NCSFile::o_restorebp(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_restorebp(): Illegal type %d", type);
 
-	_stack.setBasePtr(_stack.pop().getInt());
+	_stack.setBasePtr(_stack.popInt());
 }
 
-void NCSFile::o_nop(InstructionType type) {
+void NCSFile::o_nop(InstructionType type, const NCSInstruction &instr) {
 	// Nothing! Yay!
 }
 
-void NCSFile::o_cpdownsp(InstructionType type) {
+void NCSFile::o_cpdownsp(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeDirect)
 		throw Common::Exception("NCSFile::o_cpdownsp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = instr.args[0].i;
+	int16 size   = instr.args[1].i;
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cpdownsp(): Illegal size %d", size);
@@ -979,12 +1506,12 @@ void NCSFile::o_cpdownsp(InstructionType type) {
 	}
 }
 
-void NCSFile::o_cptopsp(InstructionType type) {
+void NCSFile::o_cptopsp(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeDirect)
 		throw Common::Exception("NCSFile::o_cptopsp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-	int16 size   = _script->readSint16BE();
+	int32 offset = instr.args[0].i;
+	int16 size   = instr.args[1].i;
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cptopsp(): Illegal size %d", size);
@@ -996,59 +1523,65 @@ void NCSFile::o_cptopsp(InstructionType type) {
 	}
 }
 
-void NCSFile::o_add(InstructionType type) {
+void NCSFile::o_add(InstructionType type, const NCSInstruction &instr) {
 	switch (type) {
 		case kInstTypeIntInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _stack.popInt();
+			int32 op1 = _stack.popInt();
 
-			_stack.push((int32) (op1.getInt() + op2.getInt()));
+			_stack.pushInt(op1 + op2);
 			break;
 		}
 
 		case kInstTypeFloatFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _stack.popFloat();
+			float op1 = _stack.popFloat();
 
-			_stack.push(op1.getFloat() + op2.getFloat());
+			_stack.pushFloat(op1 + op2);
 			break;
 		}
 
 		case kInstTypeIntFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _stack.popFloat();
+			int32 op1 = _stack.popInt();
 
-			_stack.push(((float) op1.getInt()) + op2.getFloat());
+			_stack.pushFloat(((float) op1) + op2);
 			break;
 		}
 
 		case kInstTypeFloatInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _stack.popInt();
+			float op1 = _stack.popFloat();
 
-			_stack.push(op1.getFloat() + ((float) op2.getInt()));
+			_stack.pushFloat(op1 + ((float) op2));
 			break;
 		}
 
 		case kInstTypeStringString: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			const Common::UString &op2 = _stack.popString();
+			const Common::UString &op1 = _stack.popString();
 
-			_stack.push(op1.getString() + op2.getString());
+			// Build the result in the arena, reusing an old string's memory
+			Common::UString &result = _stack.createString();
+
+			result  = op1;
+			result += op2;
+
+			_stack.pushString(result);
 			break;
 		}
 
 		case kInstTypeVectorVector: {
-			Variable op2z = _stack.pop();
-			Variable op2y = _stack.pop();
-			Variable op2x = _stack.pop();
-			Variable op1z = _stack.pop();
-			Variable op1y = _stack.pop();
-			Variable op1x = _stack.pop();
-
-			_stack.push(op1z.getFloat() + op2z.getFloat());
-			_stack.push(op1y.getFloat() + op2y.getFloat());
-			_stack.push(op1x.getFloat() + op2x.getFloat());
+			float op2z = _stack.popFloat();
+			float op2y = _stack.popFloat();
+			float op2x = _stack.popFloat();
+			float op1z = _stack.popFloat();
+			float op1y = _stack.popFloat();
+			float op1x = _stack.popFloat();
+
+			_stack.pushFloat(op1z + op2z);
+			_stack.pushFloat(op1y + op2y);
+			_stack.pushFloat(op1x + op2x);
 			break;
 		}
 
@@ -1057,51 +1590,51 @@ void NCSFile::o_add(InstructionType type) {
 	}
 }
 
-void NCSFile::o_sub(InstructionType type) {
+void NCSFile::o_sub(InstructionType type, const NCSInstruction &instr) {
 	switch (type) {
 		case kInstTypeIntInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _stack.popInt();
+			int32 op1 = _stack.popInt();
 
-			_stack.push((int32) (op1.getInt() - op2.getInt()));
+			_stack.pushInt(op1 - op2);
 			break;
 		}
 
 		case kInstTypeFloatFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _stack.popFloat();
+			float op1 = _stack.popFloat();
 
-			_stack.push(op1.getFloat() - op2.getFloat());
+			_stack.pushFloat(op1 - op2);
 			break;
 		}
 
 		case kInstTypeIntFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _stack.popFloat();
+			int32 op1 = _stack.popInt();
 
-			_stack.push(((float) op1.getInt()) - op2.getFloat());
+			_stack.pushFloat(((float) op1) - op2);
 			break;
 		}
 
 		case kInstTypeFloatInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _stack.popInt();
+			float op1 = _stack.popFloat();
 
-			_stack.push(op1.getFloat() - ((float) op2.getInt()));
+			_stack.pushFloat(op1 - ((float) op2));
 			break;
 		}
 
 		case kInstTypeVectorVector: {
-			Variable op2z = _stack.pop();
-			Variable op2y = _stack.pop();
-			Variable op2x = _stack.pop();
-			Variable op1z = _stack.pop();
-			Variable op1y = _stack.pop();
-			Variable op1x = _stack.pop();
-
-			_stack.push(op1z.getFloat() - op2z.getFloat());
-			_stack.push(op1y.getFloat() - op2y.getFloat());
-			_stack.push(op1x.getFloat() - op2x.getFloat());
+			float op2z = _stack.popFloat();
+			float op2y = _stack.popFloat();
+			float op2x = _stack.popFloat();
+			float op1z = _stack.popFloat();
+			float op1y = _stack.popFloat();
+			float op1x = _stack.popFloat();
+
+			_stack.pushFloat(op1z - op2z);
+			_stack.pushFloat(op1y - op2y);
+			_stack.pushFloat(op1x - op2x);
 			break;
 		}
 
@@ -1110,61 +1643,61 @@ void NCSFile::o_sub(InstructionType type) {
 	}
 }
 
-void NCSFile::o_mul(InstructionType type) {
+void NCSFile::o_mul(InstructionType type, const NCSInstruction &instr) {
 	switch (type) {
 		case kInstTypeIntInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _stack.popInt();
+			int32 op1 = _stack.popInt();
 
-			_stack.push((int32) (op1.getInt() * op2.getInt()));
+			_stack.pushInt(op1 * op2);
 			break;
 		}
 
 		case kInstTypeFloatFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _stack.popFloat();
+			float op1 = _stack.popFloat();
 
-			_stack.push(op1.getFloat() * op2.getFloat());
+			_stack.pushFloat(op1 * op2);
 			break;
 		}
 
 		case kInstTypeIntFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _stack.popFloat();
+			int32 op1 = _stack.popInt();
 
-			_stack.push(((float) op1.getInt()) * op2.getFloat());
+			_stack.pushFloat(((float) op1) * op2);
 			break;
 		}
 
 		case kInstTypeFloatInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _stack.popInt();
+			float op1 = _stack.popFloat();
 
-			_stack.push(op1.getFloat() * ((float) op2.getInt()));
+			_stack.pushFloat(op1 * ((float) op2));
 			break;
 		}
 
 		case kInstTypeVectorFloat: {
-			Variable op2  = _stack.pop();
-			Variable op1z = _stack.pop();
-			Variable op1y = _stack.pop();
-			Variable op1x = _stack.pop();
-
-			_stack.push(op1z.getFloat() * op2.getFloat());
-			_stack.push(op1y.getFloat() * op2.getFloat());
-			_stack.push(op1x.getFloat() * op2.getFloat());
+			float op2  = _stack.popFloat();
+			float op1z = _stack.popFloat();
+			float op1y = _stack.popFloat();
+			float op1x = _stack.popFloat();
+
+			_stack.pushFloat(op1z * op2);
+			_stack.pushFloat(op1y * op2);
+			_stack.pushFloat(op1x * op2);
 			break;
 		}
 
 		case kInstTypeFloatVector: {
-			Variable op2z = _stack.pop();
-			Variable op2y = _stack.pop();
-			Variable op2x = _stack.pop();
-			Variable op1  = _stack.pop();
-
-			_stack.push(op1.getFloat() * op2z.getFloat());
-			_stack.push(op1.getFloat() * op2y.getFloat());
-			_stack.push(op1.getFloat() * op2x.getFloat());
+			float op2z = _stack.popFloat();
+			float op2y = _stack.popFloat();
+			float op2x = _stack.popFloat();
+			float op1  = _stack.popFloat();
+
+			_stack.pushFloat(op1 * op2z);
+			_stack.pushFloat(op1 * op2y);
+			_stack.pushFloat(op1 * op2x);
 			break;
 		}
 
@@ -1173,82 +1706,82 @@ void NCSFile::o_mul(InstructionType type) {
 	}
 }
 
-void NCSFile::o_div(InstructionType type) {
+void NCSFile::o_div(InstructionType type, const NCSInstruction &instr) {
 	switch (type) {
 		case kInstTypeIntInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _stack.popInt();
+			int32 op1 = _stack.popInt();
 
-			if (op2.getInt() == 0)
+			if (op2 == 0)
 				throw Common::Exception("NCSFile::o_div(): Divide by zero");
 
-			if (op1.getInt() == INT32_MIN && op2.getInt() == -1)
+			if (op1 == INT32_MIN && op2 == -1)
 				throw Common::Exception("NCSFile::o_div: Quotient overflow");
 
-			_stack.push((int32) (op1.getInt() / op2.getInt()));
+			_stack.pushInt(op1 / op2);
 			break;
 		}
 
 		case kInstTypeFloatFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _stack.popFloat();
+			float op1 = _stack.popFloat();
 
-			if (op2.getFloat() == 0.0f)
+			if (op2 == 0.0f)
 				throw Common::Exception("NCSFile::o_div(): Divide by zero");
 
-			_stack.push(op1.getFloat() / op2.getFloat());
+			_stack.pushFloat(op1 / op2);
 			break;
 		}
 
 		case kInstTypeIntFloat: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			float op2 = _stack.popFloat();
+			int32 op1 = _stack.popInt();
 
-			if (op2.getFloat() == 0.0f)
+			if (op2 == 0.0f)
 				throw Common::Exception("NCSFile::o_div(): Divide by zero");
 
-			_stack.push(((float) op1.getInt()) / op2.getFloat());
+			_stack.pushFloat(((float) op1) / op2);
 			break;
 		}
 
 		case kInstTypeFloatInt: {
-			Variable op2 = _stack.pop();
-			Variable op1 = _stack.pop();
+			int32 op2 = _stack.popInt();
+			float op1 = _stack.popFloat();
 
-			if (op2.getInt() == 0)
+			if (op2 == 0)
 				throw Common::Exception("NCSFile::o_div(): Divide by zero");
 
-			_stack.push(op1.getFloat() / ((float) op2.getInt()));
+			_stack.pushFloat(op1 / ((float) op2));
 			break;
 		}
 
 		case kInstTypeVectorFloat: {
-			Variable op2  = _stack.pop();
-			Variable op1z = _stack.pop();
-			Variable op1y = _stack.pop();
-			Variable op1x = _stack.pop();
+			float op2  = _stack.popFloat();
+			float op1z = _stack.popFloat();
+			float op1y = _stack.popFloat();
+			float op1x = _stack.popFloat();
 
-			if (op2.getFloat() == 0.0f)
+			if (op2 == 0.0f)
 				throw Common::Exception("NCSFile::o_div(): Divide by zero");
 
-			_stack.push(op1z.getFloat() / op2.getFloat());
-			_stack.push(op1y.getFloat() / op2.getFloat());
-			_stack.push(op1x.getFloat() / op2.getFloat());
+			_stack.pushFloat(op1z / op2);
+			_stack.pushFloat(op1y / op2);
+			_stack.pushFloat(op1x / op2);
 			break;
 		}
 
 		case kInstTypeFloatVector: {
-			Variable op2z = _stack.pop();
-			Variable op2y = _stack.pop();
-			Variable op2x = _stack.pop();
-			Variable op1  = _stack.pop();
+			float op2z = _stack.popFloat();
+			float op2y = _stack.popFloat();
+			float op2x = _stack.popFloat();
+			float op1  = _stack.popFloat();
 
-			if (op2x.getFloat() == 0.0f || op2y.getFloat() == 0.0f || op2z.getFloat() == 0.0f)
+			if (op2x == 0.0f || op2y == 0.0f || op2z == 0.0f)
 				throw Common::Exception("NCSFile::o_div(): Divide by zero");
 
-			_stack.push(op1.getFloat() / op2z.getFloat());
-			_stack.push(op1.getFloat() / op2y.getFloat());
-			_stack.push(op1.getFloat() / op2x.getFloat());
+			_stack.pushFloat(op1 / op2z);
+			_stack.pushFloat(op1 / op2y);
+			_stack.pushFloat(op1 / op2x);
 			break;
 		}
 
@@ -1257,7 +1790,7 @@ void NCSFile::o_div(InstructionType type) {
 	}
 }
 
-void NCSFile::o_storestateall(InstructionType type) {
+void NCSFile::o_storestateall(InstructionType type, const NCSInstruction &instr) {
 	uint8  offset = (uint8) type;
 
 	// TODO: NCSFile::o_storestateall(): See o_storestate.
@@ -1265,32 +1798,30 @@ void NCSFile::o_storestateall(InstructionType type) {
 	warning("TODO: NCSFile::o_storestateall(): %d", offset);
 }
 
-void NCSFile::o_jsr(InstructionType type) {
+void NCSFile::o_jsr(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeNone)
 		throw Common::Exception("NCSFile::o_jsr(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE();
-
-	// Push the current script position
-	_returnOffsets.push(_script->pos());
+	// Push the position of the next instruction
+	_returnOffsets.push(_pc);
 
-	_script->seek(offset - 6, SEEK_CUR);
+	jump(instr.args[0].u);
 }
 
-void NCSFile::o_retn(InstructionType type) {
-	uint32 returnAddress = _script->size();
+void NCSFile::o_retn(InstructionType type, const NCSInstruction &instr) {
+	uint32 returnAddress = _instructionCount;
 	if (!_returnOffsets.empty()) {
 		returnAddress = _returnOffsets.top();
 		_returnOffsets.pop();
 	}
 
-	_script->seek(returnAddress);
+	_pc = returnAddress;
 }
 
-void NCSFile::o_destruct(InstructionType type) {
-	int16 stackSize        = _script->readSint16BE();
-	int16 dontRemoveOffset = _script->readSint16BE();
-	int16 dontRemoveSize   = _script->readSint16BE();
+void NCSFile::o_destruct(InstructionType type, const NCSInstruction &instr) {
+	int16 stackSize        = instr.args[0].i;
+	int16 dontRemoveOffset = instr.args[1].i;
+	int16 dontRemoveSize   = instr.args[2].i;
 
 	if ((stackSize % 4) != 0)
 		throw Common::Exception("NCSFile::o_destruct(): Illegal stack size %d", stackSize);
@@ -1299,7 +1830,7 @@ void NCSFile::o_destruct(InstructionType type) {
 	if ((dontRemoveSize % 4) != 0)
 		throw Common::Exception("NCSFile::o_destruct(): Illegal size %d", dontRemoveSize);
 
-	std::vector<Variable> tmp;
+	std::vector<NCSStackCell> tmp;
 	tmp.reserve(dontRemoveSize / 4);
 
 	while (stackSize > 0) {
@@ -1313,16 +1844,16 @@ void NCSFile::o_destruct(InstructionType type) {
 		stackSize -= 4;
 	}
 
-	for (std::vector<Variable>::const_reverse_iterator t = tmp.rbegin(); t != tmp.rend(); ++t)
+	for (std::vector<NCSStackCell>::const_reverse_iterator t = tmp.rbegin(); t != tmp.rend(); ++t)
 		_stack.push(*t);
 }
 
-void NCSFile::o_cpdownbp(InstructionType type) {
+void NCSFile::o_cpdownbp(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeDirect)
 		throw Common::Exception("NCSFile::o_cpdownbp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE() - 4;
-	int16 size   = _script->readSint16BE();
+	int32 offset = instr.args[0].i - 4;
+	int16 size   = instr.args[1].i;
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cpdownbp(): Illegal size %d", size);
@@ -1337,12 +1868,12 @@ void NCSFile::o_cpdownbp(InstructionType type) {
 	}
 }
 
-void NCSFile::o_cptopbp(InstructionType type) {
+void NCSFile::o_cptopbp(InstructionType type, const NCSInstruction &instr) {
 	if (type != kInstTypeDirect)
 		throw Common::Exception("NCSFile::o_cptopbp(): Illegal type %d", type);
 
-	int32 offset = _script->readSint32BE() - 4;
-	int16 size   = _script->readSint16BE();
+	int32 offset = instr.args[0].i - 4;
+	int16 size   = instr.args[1].i;
 
 	if ((size % 4) != 0)
 		throw Common::Exception("NCSFile::o_cptopbp(): Illegal size %d", size);
@@ -1355,10 +1886,10 @@ void NCSFile::o_cptopbp(InstructionType type) {
 	}
 }
 
-void NCSFile::o_storestate(InstructionType type) {
+void NCSFile::o_storestate(InstructionType type, const NCSInstruction &instr) {
 	uint8  offset = (uint8) type;
-	uint32 sizeBP = _script->readUint32BE();
-	uint32 sizeSP = _script->readUint32BE();
+	uint32 sizeBP = instr.args[0].u;
+	uint32 sizeSP = instr.args[1].u;
 
 	if ((sizeBP % 4) != 0)
 		throw Common::Exception("NCSFile::o_storestate(): Illegal BP size %d", sizeBP);
@@ -1368,16 +1899,46 @@ void NCSFile::o_storestate(InstructionType type) {
 	_storedState.setType(kTypeScriptState);
 	ScriptState &state = _storedState.getScriptState();
 
-	state.offset = _script->pos() - 10 + offset;
+	state.offset = instr.offset + offset;
 
 	sizeBP /= 4;
 	sizeSP /= 4;
 
 	for (int32 posBP = -4; sizeBP > 0; sizeBP--, posBP -= 4)
-		state.globals.push_back(_stack.getRelBP(posBP));
+		state.globals.push_back(_stack.getVariable(_stack.getRelBP(posBP)));
 
 	for (int32 posSP = -4; sizeSP > 0; sizeSP--, posSP -= 4)
-		state.locals.push_back(_stack.getRelSP(posSP));
+		state.locals.push_back(_stack.getVariable(_stack.getRelSP(posSP)));
+}
+
+void NCSFile::o_illegal(InstructionType type, const NCSInstruction &instr) {
+	throw Common::Exception("NCSFile::o_illegal(): Illegal instruction 0x%02x", instr.args[0].u);
+}
+
+// Superinstructions
+
+void NCSFile::o_movdownsp(InstructionType type, const NCSInstruction &instr) {
+	o_cpdownsp(kInstTypeDirect, instr);
+
+	_stack.setStackPtr(_stack.getStackPtr() + instr.args[1].i);
+}
+
+void NCSFile::o_jzsp(InstructionType type, const NCSInstruction &instr) {
+	const NCSStackCell &cell = _stack.getRelSP(instr.args[1].i);
+	if (cell.type != kTypeInt)
+		throw Common::Exception("NCSFile::o_jzsp(): Not an int");
+
+	if (!cell.value.i)
+		jump(instr.args[0].u);
+}
+
+void NCSFile::o_jnzsp(InstructionType type, const NCSInstruction &instr) {
+	const NCSStackCell &cell = _stack.getRelSP(instr.args[1].i);
+	if (cell.type != kTypeInt)
+		throw Common::Exception("NCSFile::o_jnzsp(): Not an int");
+
+	if (cell.value.i)
+		jump(instr.args[0].u);
 }
 
 } // End of namespace NWScript
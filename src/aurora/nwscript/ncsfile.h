@@ -31,9 +31,13 @@
 #define AURORA_NWSCRIPT_NCSFILE_H
 
 #include <vector>
+#include <deque>
 #include <stack>
 
+#include <boost/shared_ptr.hpp>
+
 #include "common/types.h"
+#include "common/ustring.h"
 
 #include "aurora/types.h"
 #include "aurora/aurorafile.h"
@@ -42,7 +46,6 @@
 #include "aurora/nwscript/variable.h"
 
 namespace Common {
-	class UString;
 	class SeekableReadStream;
 }
 
@@ -50,24 +53,90 @@ namespace Aurora {
 
 namespace NWScript {
 
-class NCSStack : public std::vector<Variable> {
+/** A cell on the NCS stack.
+ *
+ *  Like in the NCS stack model, each cell is one 4-byte slot, so a vector
+ *  takes up three cells. Values are stored unboxed. Strings and engine
+ *  types are only referenced, pointing either into the arenas of the stack
+ *  or into the constants of the program.
+ */
+struct NCSStackCell {
+	Type type;
+
+	union {
+		int32 i;
+		float f;
+		const Common::UString *string;
+		Object *object;
+		EngineType *engineType;
+	} value;
+};
+
+/** The memory of an NCS stack.
+ *
+ *  Holds the cells, and arenas for all strings and engine types created
+ *  during one script execution. The arenas are released wholesale once
+ *  the execution ends, but their memory is kept for the next one.
+ */
+struct NCSStackMemory {
+	std::vector<NCSStackCell> cells;
+
+	std::deque<Common::UString> strings; ///< The strings arena. Never invalidates references.
+	uint32 stringCount;                  ///< The number of strings in use.
+
+	std::vector<EngineType *> engineTypes; ///< The engine types arena.
+
+	uint32 allocations; ///< Number of heap allocations made by the stack.
+
+	NCSStackMemory();
+	~NCSStackMemory();
+
+	/** Release everything in the arenas. */
+	void release();
+};
+
+class NCSStack {
 public:
 	NCSStack();
 	~NCSStack();
 
+	/** Empty the stack and release everything it references. */
 	void reset();
 
 	bool empty() const;
 
-	Variable &top();
-	Variable pop();
-	void push(const Variable &obj);
+	NCSStackCell &top();
+
+	NCSStackCell pop();
+	int32 popInt();
+	float popFloat();
+	const Common::UString &popString();
+	Object *popObject();
+	/** Pop a cell and convert it into a variable. */
+	Variable popVariable();
+
+	void push(const NCSStackCell &cell);
+	/** Push an empty value of this type. */
+	void push(Type type);
+	void pushInt(int32 value);
+	void pushFloat(float value);
+	/** Push a reference to a string that lives at least as long as the execution. */
+	void pushString(const Common::UString &value);
+	void pushObject(Object *value);
+	/** Push a variable, copying its string or engine type value into the arenas. */
+	void pushVariable(const Variable &var);
 
-	Variable &getRelSP(int32 pos);
-	void setRelSP(int32 pos, const Variable &obj);
+	/** Create a new, empty string in the strings arena. */
+	Common::UString &createString();
 
-	Variable &getRelBP(int32 pos);
-	void setRelBP(int32 pos, const Variable &obj);
+	/** Convert a cell into a variable. */
+	Variable getVariable(const NCSStackCell &cell) const;
+
+	NCSStackCell &getRelSP(int32 pos);
+	void setRelSP(int32 pos, const NCSStackCell &cell);
+
+	NCSStackCell &getRelBP(int32 pos);
+	void setRelBP(int32 pos, const NCSStackCell &cell);
 
 	int32 getStackPtr();
 	void  setStackPtr(int32 pos);
@@ -78,17 +147,210 @@ public:
 	void print() const;
 
 private:
+	NCSStackMemory *_memory;
+
 	int32 _stackPtr;
 	int32 _basePtr;
+
+	NCSStackCell &at(int32 pos);
 };
 
-#define DECLARE_OPCODE(x) void x(InstructionType type)
+/** The opcodes of NCS instructions. */
+enum Opcode {
+	kOpcodeNOP           = 0x00,
+	kOpcodeCPDOWNSP      = 0x01,
+	kOpcodeRSADD         = 0x02,
+	kOpcodeCPTOPSP       = 0x03,
+	kOpcodeCONST         = 0x04,
+	kOpcodeACTION        = 0x05,
+	kOpcodeLOGAND        = 0x06,
+	kOpcodeLOGOR         = 0x07,
+	kOpcodeINCOR         = 0x08,
+	kOpcodeEXCOR         = 0x09,
+	kOpcodeBOOLAND       = 0x0A,
+	kOpcodeEQ            = 0x0B,
+	kOpcodeNEQ           = 0x0C,
+	kOpcodeGEQ           = 0x0D,
+	kOpcodeGT            = 0x0E,
+	kOpcodeLT            = 0x0F,
+	kOpcodeLEQ           = 0x10,
+	kOpcodeSHLEFT        = 0x11,
+	kOpcodeSHRIGHT       = 0x12,
+	kOpcodeUSHRIGHT      = 0x13,
+	kOpcodeADD           = 0x14,
+	kOpcodeSUB           = 0x15,
+	kOpcodeMUL           = 0x16,
+	kOpcodeDIV           = 0x17,
+	kOpcodeMOD           = 0x18,
+	kOpcodeNEG           = 0x19,
+	kOpcodeCOMP          = 0x1A,
+	kOpcodeMOVSP         = 0x1B,
+	kOpcodeSTORESTATEALL = 0x1C,
+	kOpcodeJMP           = 0x1D,
+	kOpcodeJSR           = 0x1E,
+	kOpcodeJZ            = 0x1F,
+	kOpcodeRETN          = 0x20,
+	kOpcodeDESTRUCT      = 0x21,
+	kOpcodeNOT           = 0x22,
+	kOpcodeDECSP         = 0x23,
+	kOpcodeINCSP         = 0x24,
+	kOpcodeJNZ           = 0x25,
+	kOpcodeCPDOWNBP      = 0x26,
+	kOpcodeCPTOPBP       = 0x27,
+	kOpcodeDECBP         = 0x28,
+	kOpcodeINCBP         = 0x29,
+	kOpcodeSAVEBP        = 0x2A,
+	kOpcodeRESTOREBP     = 0x2B,
+	kOpcodeSTORESTATE    = 0x2C,
+	kOpcodeNOP2          = 0x2D,
+
+	/** Not a real opcode: raises an error about the illegal opcode in argument 0. */
+	kOpcodeIllegal       = 0x2E,
+
+	// Superinstructions, only created by the NCSOptimizer
+
+	/** CPDOWNSP + MOVSP: Move the top of the stack down. Arguments are those of CPDOWNSP. */
+	kOpcodeMOVDOWNSP     = 0x2F,
+	/** CPTOPSP + JZ: Jump to argument 0 if the stack cell at argument 1 is zero. */
+	kOpcodeJZSP          = 0x30,
+	/** CPTOPSP + JNZ: Jump to argument 0 if the stack cell at argument 1 is not zero. */
+	kOpcodeJNZSP         = 0x31,
+
+	kOpcodeMAX
+};
+
+/** The types of NCS instructions. */
+enum InstructionType {
+	// Unary
+	kInstTypeNone      =  0,
+	kInstTypeDirect    =  1,
+	kInstTypeInt       =  3,
+	kInstTypeFloat     =  4,
+	kInstTypeString    =  5,
+	kInstTypeObject    =  6,
+	kInstTypeEffect    = 16,
+	kInstTypeEvent     = 17,
+	kInstTypeLocation  = 18,
+	kInstTypeTalent    = 19,
+
+	// Binary
+	kInstTypeIntInt           = 32,
+	kInstTypeFloatFloat       = 33,
+	kInstTypeObjectObject     = 34,
+	kInstTypeStringString     = 35,
+	kInstTypeStructStruct     = 36,
+	kInstTypeIntFloat         = 37,
+	kInstTypeFloatInt         = 38,
+	kInstTypeEffectEffect     = 48,
+	kInstTypeEventEvent       = 49,
+	kInstTypeLocationLocation = 50,
+	kInstTypeTalentTalent     = 51,
+	kInstTypeVectorVector     = 58,
+	kInstTypeVectorFloat      = 59,
+	kInstTypeFloatVector      = 60
+};
 
-/** An NCS, BioWare's NWN Compile Script. */
-class NCSFile : public AuroraBase {
+/** A decoded NCS instruction. */
+struct NCSInstruction {
+	/** An argument of an instruction. */
+	union Argument {
+		int32  i;
+		uint32 u;
+		float  f;
+	};
+
+	uint32 offset; ///< Offset of the instruction within the NCS file.
+
+	uint8 opcode; ///< The instruction's Opcode.
+	uint8 type;   ///< The instruction's InstructionType.
+
+	/** The instruction's arguments, already in host byte order.
+	 *
+	 *  Jump targets are indices into the program's instructions, and
+	 *  string constants are indices into the program's strings.
+	 */
+	Argument args[3];
+};
+
+/** The loaded bytecode of an NCS.
+ *
+ *  On load, the bytecode is decoded into an array of instructions, with
+ *  jump targets resolved and constants already parsed. Unless disabled,
+ *  the instructions are then optimized by the NCSOptimizer.
+ *
+ *  A program is never modified after it has been loaded, so one
+ *  instance can be shared by any number of script executions.
+ */
+class NCSProgram : public AuroraBase {
+public:
+	/** The instruction index representing "no instruction". */
+	static const uint32 kInvalidInstruction = 0xFFFFFFFF;
+
+	/** Load a program out of this stream. */
+	NCSProgram(Common::SeekableReadStream &ncs, const Common::UString &name = "",
+	           bool optimize = true);
+	~NCSProgram();
+
+	/** Return the name of the script. */
+	const Common::UString &getName() const;
+
+	/** Return the size of the NCS file. */
+	uint32 getSize() const;
+
+	/** Return the number of instructions in the program. */
+	uint32 getInstructionCount() const;
+	/** Return the number of instructions in the program before it was optimized. */
+	uint32 getDecodedInstructionCount() const;
+	/** Return all instructions. */
+	const NCSInstruction *getInstructions() const;
+
+	/** Return a string constant. */
+	const Common::UString &getString(uint32 index) const;
+
+	/** Find the index of the instruction starting at this offset within the NCS file.
+	 *
+	 *  The end of the program is a valid offset, returning getInstructionCount().
+	 *
+	 *  @return The index, or kInvalidInstruction if no instruction starts there.
+	 */
+	uint32 findInstruction(uint32 offset) const;
+
+private:
+	Common::UString _name;
+
+	uint32 _size; ///< Size of the NCS file.
+	uint32 _end;  ///< Offset of the end of the program.
+
+	uint32 _decodedCount; ///< Number of instructions before optimization.
+
+	std::vector<NCSInstruction>  _instructions;
+	std::vector<Common::UString> _strings;
+
+	void load(Common::SeekableReadStream &ncs, bool optimize);
+
+	void decode(Common::SeekableReadStream &ncs, uint32 length);
+	bool decodeInstruction(Common::SeekableReadStream &ncs, NCSInstruction &instr);
+	void resolveJumps();
+};
+
+typedef boost::shared_ptr<const NCSProgram> NCSProgramPtr;
+
+#define DECLARE_OPCODE(x) void x(InstructionType type, const NCSInstruction &instr)
+
+/** An NCS, BioWare's NWN Compile Script.
+ *
+ *  This holds the state of one execution of the script: the stack, the return
+ *  offsets and the owner and triggerer. The bytecode itself lives in a shared
+ *  NCSProgram, so creating an NCSFile out of an already loaded program is cheap.
+ */
+class NCSFile {
 public:
+	/** Load a script out of this stream, taking over the stream. */
 	NCSFile(Common::SeekableReadStream *ncs);
+	/** Load a script, reusing an already loaded program of the same name. */
 	NCSFile(const Common::UString &ncs);
+	/** Create a script execution context for this program. */
+	NCSFile(const NCSProgramPtr &program);
 	~NCSFile();
 
 	const Common::UString &getName() const;
@@ -99,43 +361,22 @@ public:
 	/** Run the current script, from this state to finish. */
 	const Variable &run(const ScriptState &state, Object *owner = 0, Object *triggerer = 0);
 
+	/** Return the number of instructions executed by the last run. */
+	uint32 getExecutedCount() const;
+
 	static ScriptState getEmptyState();
 
 private:
-	enum InstructionType {
-		// Unary
-		kInstTypeNone      =  0,
-		kInstTypeDirect    =  1,
-		kInstTypeInt       =  3,
-		kInstTypeFloat     =  4,
-		kInstTypeString    =  5,
-		kInstTypeObject    =  6,
-		kInstTypeEffect    = 16,
-		kInstTypeEvent     = 17,
-		kInstTypeLocation  = 18,
-		kInstTypeTalent    = 19,
-
-		// Binary
-		kInstTypeIntInt           = 32,
-		kInstTypeFloatFloat       = 33,
-		kInstTypeObjectObject     = 34,
-		kInstTypeStringString     = 35,
-		kInstTypeStructStruct     = 36,
-		kInstTypeIntFloat         = 37,
-		kInstTypeFloatInt         = 38,
-		kInstTypeEffectEffect     = 48,
-		kInstTypeEventEvent       = 49,
-		kInstTypeLocationLocation = 50,
-		kInstTypeTalentTalent     = 51,
-		kInstTypeVectorVector     = 58,
-		kInstTypeVectorFloat      = 59,
-		kInstTypeFloatVector      = 60
-	};
+	NCSProgramPtr _program; ///< The script's bytecode.
 
-	Common::UString _name;
+	const NCSInstruction *_instructions; ///< The program's instructions.
+	uint32 _instructionCount;            ///< The number of instructions in the program.
+
+	uint32 _pc; ///< Index of the next instruction to execute.
+
+	uint32 _executedCount; ///< Number of instructions executed by the last run.
 
 	NCSStack _stack;
-	Common::SeekableReadStream *_script;
 
 	Variable _return;
 
@@ -146,7 +387,7 @@ private:
 
 	Variable _storedState;
 
-	typedef void (NCSFile::*OpcodeProc)(InstructionType type);
+	typedef void (NCSFile::*OpcodeProc)(InstructionType type, const NCSInstruction &instr);
 	struct Opcode {
 		OpcodeProc proc;
 		const char *desc;
@@ -162,10 +403,8 @@ private:
 
 	const Variable &execute(Object *owner = 0, Object *triggerer = 0);
 
-	/** Execute one script step. */
-	void executeStep();
-
-	void decompile(); // TODO
+	/** Jump to this instruction. */
+	void jump(uint32 instruction);
 
 	void callEngine(Aurora::NWScript::FunctionContext &ctx, uint32 function, uint8 argCount);
 
@@ -215,6 +454,12 @@ private:
 	DECLARE_OPCODE(o_savebp);
 	DECLARE_OPCODE(o_restorebp);
 	DECLARE_OPCODE(o_storestate);
+	DECLARE_OPCODE(o_illegal);
+
+	// Superinstructions
+	DECLARE_OPCODE(o_movdownsp);
+	DECLARE_OPCODE(o_jzsp);
+	DECLARE_OPCODE(o_jnzsp);
 };
 
 #undef DECLARE_OPCODE
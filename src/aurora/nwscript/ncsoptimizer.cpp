@@ -0,0 +1,397 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/nwscript/ncsoptimizer.cpp
+ *  A peephole optimizer for decoded NCS programs.
+ */
+
+#include <algorithm>
+
+#include "common/util.h"
+#include "common/error.h"
+
+#include "aurora/nwscript/ncsoptimizer.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+static bool isJump(uint8 opcode) {
+	return (opcode == kOpcodeJMP ) || (opcode == kOpcodeJSR  ) || (opcode == kOpcodeJZ) ||
+	       (opcode == kOpcodeJNZ ) || (opcode == kOpcodeJZSP ) || (opcode == kOpcodeJNZSP);
+}
+
+/** Get the number of bytes an instruction pushes onto the stack (negative when popping).
+ *
+ *  Conditional jumps have the same effect whether they are taken or not.
+ *
+ *  @return false if the instruction's effect is unknown to the optimizer.
+ */
+static bool getStackEffect(const NCSInstruction &instr, int32 &effect) {
+	switch (instr.opcode) {
+		case kOpcodeNOP:
+		case kOpcodeNOP2:
+		case kOpcodeCPDOWNSP:
+		case kOpcodeINCSP:
+		case kOpcodeDECSP:
+		case kOpcodeJMP:
+		case kOpcodeJZSP:
+		case kOpcodeJNZSP:
+			effect = 0;
+			return true;
+
+		case kOpcodeRSADD:
+		case kOpcodeCONST:
+			effect = 4;
+			return true;
+
+		case kOpcodeCPTOPSP:
+			effect = instr.args[1].i;
+			return true;
+
+		case kOpcodeMOVSP:
+			effect = instr.args[0].i;
+			return true;
+
+		case kOpcodeJZ:
+		case kOpcodeJNZ:
+			effect = -4;
+			return true;
+
+		case kOpcodeMOVDOWNSP:
+			effect = -instr.args[1].i;
+			return true;
+
+		default:
+			break;
+	}
+
+	return false;
+}
+
+static NCSInstruction createNOP() {
+	NCSInstruction nop;
+
+	nop.offset    = 0;
+	nop.opcode    = kOpcodeNOP;
+	nop.type      = kInstTypeNone;
+	nop.args[0].u = 0;
+	nop.args[1].u = 0;
+	nop.args[2].u = 0;
+
+	return nop;
+}
+
+static bool isMOVSP(const NCSInstruction &instr, int32 size) {
+	return (instr.opcode == kOpcodeMOVSP) && (instr.args[0].i == -size);
+}
+
+
+NCSOptimizer::NCSOptimizer(std::vector<NCSInstruction> &instructions) : _instructions(instructions) {
+}
+
+NCSOptimizer::~NCSOptimizer() {
+}
+
+void NCSOptimizer::optimize() {
+	if (_instructions.empty())
+		return;
+
+	findLeaders();
+
+	_removed.assign(_instructions.size(), false);
+
+	while (optimizePass())
+		compact();
+}
+
+void NCSOptimizer::findLeaders() {
+	_leaders.assign(_instructions.size(), false);
+
+	// Scripts start at the first instruction
+	_leaders[0] = true;
+
+	for (uint32 i = 0; i < _instructions.size(); i++) {
+		const NCSInstruction &instr = _instructions[i];
+
+		if (isJump(instr.opcode) && (instr.args[0].u < _instructions.size()))
+			_leaders[instr.args[0].u] = true;
+
+		// Subroutines return to the instruction following the call
+		if ((instr.opcode == kOpcodeJSR) && ((i + 1) < _instructions.size()))
+			_leaders[i + 1] = true;
+
+		// Stored states are resumed at an offset
+		if (instr.opcode == kOpcodeSTORESTATE)
+			markLeader(instr.offset + instr.type);
+	}
+}
+
+static bool compareOffset(const NCSInstruction &instr, uint32 offset) {
+	return instr.offset < offset;
+}
+
+void NCSOptimizer::markLeader(uint32 offset) {
+	std::vector<NCSInstruction>::const_iterator instr =
+		std::lower_bound(_instructions.begin(), _instructions.end(), offset, compareOffset);
+
+	if ((instr != _instructions.end()) && (instr->offset == offset))
+		_leaders[instr - _instructions.begin()] = true;
+}
+
+uint32 NCSOptimizer::next(uint32 i) const {
+	for (i++; (i < _instructions.size()) && _removed[i]; i++)
+		;
+
+	return i;
+}
+
+bool NCSOptimizer::optimizePass() {
+	bool changed = false;
+
+	for (uint32 i = 0; i < _instructions.size(); i++)
+		while (!_removed[i] && optimizeAt(i))
+			changed = true;
+
+	return changed;
+}
+
+bool NCSOptimizer::optimizeAt(uint32 i) {
+	const uint32 n = _instructions.size();
+
+	// The following instructions, which can only be fused if nothing else jumps to them
+	uint32 f[3];
+	uint32 fCount = 0;
+	for (uint32 j = next(i); (fCount < 3) && (j < n) && !_leaders[j]; j = next(j))
+		f[fCount++] = j;
+
+	const NCSInstruction &instr = _instructions[i];
+	const NCSInstruction *follow[3];
+	for (uint32 j = 0; j < fCount; j++)
+		follow[j] = &_instructions[f[j]];
+
+	// What to replace instructions with when they can be removed completely
+	const NCSInstruction nop = createNOP();
+	const uint32 nopCount = _leaders[i] ? 1 : 0;
+
+	switch (instr.opcode) {
+		case kOpcodeNOP:
+		case kOpcodeNOP2:
+			// NOP => nothing
+			if (!_leaders[i])
+				return rewrite(i, 1, 0, 0);
+			break;
+
+		case kOpcodeRSADD:
+			// RSADD x, CONST x c, CPDOWNSP -8 4, MOVSP -4 => CONST x c
+			if ((fCount >= 3) &&
+			    (follow[0]->opcode == kOpcodeCONST) && (follow[0]->type == instr.type) &&
+			    (follow[1]->opcode == kOpcodeCPDOWNSP) &&
+			    (follow[1]->args[0].i == -8) && (follow[1]->args[1].i == 4) &&
+			    isMOVSP(*follow[2], 4))
+				return rewrite(i, 4, follow[0], 1);
+			break;
+
+		case kOpcodeCPTOPSP: {
+			const int32 offset = instr.args[0].i;
+			const int32 size   = instr.args[1].i;
+
+			if (fCount < 1)
+				break;
+
+			// CPTOPSP o s, MOVSP -s => nothing
+			if (isMOVSP(*follow[0], size))
+				return rewrite(i, 2, &nop, nopCount);
+
+			if (size != 4)
+				break;
+
+			// CPTOPSP o 4, JZ t => JZSP t o
+			if ((follow[0]->opcode == kOpcodeJZ) || (follow[0]->opcode == kOpcodeJNZ)) {
+				NCSInstruction jump = *follow[0];
+
+				jump.opcode    = (follow[0]->opcode == kOpcodeJZ) ? kOpcodeJZSP : kOpcodeJNZSP;
+				jump.args[1].i = offset;
+
+				return rewrite(i, 2, &jump, 1);
+			}
+
+			// CPTOPSP o 4, INCSP o-4, MOVSP -4 => INCSP o
+			if ((fCount >= 2) &&
+			    ((follow[0]->opcode == kOpcodeINCSP) || (follow[0]->opcode == kOpcodeDECSP)) &&
+			    (follow[0]->args[0].i == (offset - 4)) && isMOVSP(*follow[1], 4)) {
+
+				NCSInstruction inc = *follow[0];
+
+				inc.args[0].i = offset;
+
+				return rewrite(i, 3, &inc, 1);
+			}
+			break;
+		}
+
+		case kOpcodeCPDOWNSP:
+			// CPDOWNSP o s, MOVSP -s => MOVDOWNSP o s
+			if ((fCount >= 1) && isMOVSP(*follow[0], instr.args[1].i)) {
+				NCSInstruction move = instr;
+
+				move.opcode = kOpcodeMOVDOWNSP;
+
+				return rewrite(i, 2, &move, 1);
+			}
+			break;
+
+		case kOpcodeCONST:
+			// CONST c, JZ t => JMP t, or nothing
+			if ((instr.type == kInstTypeInt) && (fCount >= 1) &&
+			    ((follow[0]->opcode == kOpcodeJZ) || (follow[0]->opcode == kOpcodeJNZ))) {
+
+				const bool taken = (follow[0]->opcode == kOpcodeJZ) ?
+				                   (instr.args[0].i == 0) : (instr.args[0].i != 0);
+
+				if (!taken)
+					return rewrite(i, 2, &nop, nopCount);
+
+				NCSInstruction jump = *follow[0];
+
+				jump.opcode = kOpcodeJMP;
+
+				return rewrite(i, 2, &jump, 1);
+			}
+			break;
+
+		case kOpcodeINCSP:
+		case kOpcodeDECSP:
+			// INCSP o, DECSP o => nothing
+			if ((fCount >= 1) &&
+			    (follow[0]->opcode == ((instr.opcode == kOpcodeINCSP) ? kOpcodeDECSP : kOpcodeINCSP)) &&
+			    (follow[0]->type == instr.type) && (follow[0]->args[0].i == instr.args[0].i))
+				return rewrite(i, 2, &nop, nopCount);
+			break;
+
+		case kOpcodeJMP:
+			// JMP to the next instruction => nothing
+			if (!_leaders[i] && (instr.args[0].u == next(i)))
+				return rewrite(i, 1, 0, 0);
+			break;
+
+		default:
+			break;
+	}
+
+	return false;
+}
+
+bool NCSOptimizer::rewrite(uint32 i, uint32 count,
+                           const NCSInstruction *replacement, uint32 replacementCount) {
+
+	assert(replacementCount <= count);
+
+	// Collect the instructions to replace
+	std::vector<uint32> replaced;
+	for (uint32 j = i; (replaced.size() < count) && (j < _instructions.size()); j = next(j))
+		replaced.push_back(j);
+
+	if (replaced.size() != count)
+		return false;
+
+	// Verify that the replacement has the same effect on the stack
+	int32 oldEffect = 0, newEffect = 0;
+	for (uint32 j = 0; j < count; j++) {
+		int32 effect;
+		if (!getStackEffect(_instructions[replaced[j]], effect))
+			return false;
+
+		oldEffect += effect;
+	}
+
+	for (uint32 j = 0; j < replacementCount; j++) {
+		int32 effect;
+		if (!getStackEffect(replacement[j], effect))
+			return false;
+
+		newEffect += effect;
+	}
+
+	if (oldEffect != newEffect) {
+		warning("NCSOptimizer: Rewrite at offset %d changes the stack by %d instead of %d",
+		        _instructions[i].offset, newEffect, oldEffect);
+		return false;
+	}
+
+	// Copy the replacements first, the originals might be among them
+	std::vector<NCSInstruction> replacements(replacement, replacement + replacementCount);
+
+	for (uint32 j = 0; j < count; j++) {
+		NCSInstruction &instr = _instructions[replaced[j]];
+
+		if (j >= replacementCount) {
+			_removed[replaced[j]] = true;
+			continue;
+		}
+
+		const uint32 offset = instr.offset;
+
+		instr        = replacements[j];
+		instr.offset = offset;
+	}
+
+	return true;
+}
+
+void NCSOptimizer::compact() {
+	const uint32 n = _instructions.size();
+
+	// Map old to new instruction indices. The end of the program stays the end
+	std::vector<uint32> newIndex(n + 1);
+
+	uint32 count = 0;
+	for (uint32 i = 0; i < n; i++) {
+		newIndex[i] = count;
+
+		if (_removed[i])
+			continue;
+
+		_instructions[count] = _instructions[i];
+		_leaders     [count] = _leaders     [i];
+
+		count++;
+	}
+
+	newIndex[n] = count;
+
+	_instructions.resize(count);
+	_leaders.resize(count);
+	_removed.assign(count, false);
+
+	// Jump targets are leaders, and leaders are never removed
+	for (std::vector<NCSInstruction>::iterator i = _instructions.begin(); i != _instructions.end(); ++i)
+		if (isJump(i->opcode) && (i->args[0].u <= n))
+			i->args[0].u = newIndex[i->args[0].u];
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
@@ -0,0 +1,97 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/nwscript/ncsoptimizer.h
+ *  A peephole optimizer for decoded NCS programs.
+ */
+
+#ifndef AURORA_NWSCRIPT_NCSOPTIMIZER_H
+#define AURORA_NWSCRIPT_NCSOPTIMIZER_H
+
+#include <vector>
+
+#include "common/types.h"
+
+#include "aurora/nwscript/ncsfile.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** A peephole optimizer for decoded NCS programs.
+ *
+ *  BioWare's compiler emits a lot of redundant instruction sequences, like
+ *  copying a value to the top of the stack only to remove it again. The
+ *  optimizer fuses common sequences into superinstructions, and removes
+ *  stack shuffles that have no effect at all.
+ *
+ *  Instructions that are jumped to, returned to or resumed at are never
+ *  fused into a preceding instruction, and every rewrite is verified to
+ *  have the same effect on the stack as the instructions it replaces.
+ */
+class NCSOptimizer {
+public:
+	NCSOptimizer(std::vector<NCSInstruction> &instructions);
+	~NCSOptimizer();
+
+	/** Optimize the instructions, in place. */
+	void optimize();
+
+private:
+	std::vector<NCSInstruction> &_instructions;
+
+	/** Is the instruction a target of jumps, returns or stored states? */
+	std::vector<bool> _leaders;
+	/** Has the instruction been removed? */
+	std::vector<bool> _removed;
+
+	void findLeaders();
+	void markLeader(uint32 offset);
+
+	/** Run one pass over all instructions. Return true if anything changed. */
+	bool optimizePass();
+	/** Try to optimize the sequence starting at this instruction. */
+	bool optimizeAt(uint32 i);
+
+	/** Return the index of the next instruction that hasn't been removed. */
+	uint32 next(uint32 i) const;
+
+	/** Replace count instructions starting at i with these replacements.
+	 *
+	 *  The replacements keep the offset of the first replaced instruction.
+	 *
+	 *  @return false if the rewrite failed verification and wasn't done.
+	 */
+	bool rewrite(uint32 i, uint32 count, const NCSInstruction *replacement, uint32 replacementCount);
+
+	/** Drop all removed instructions and update the jumps. */
+	void compact();
+};
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+#endif // AURORA_NWSCRIPT_NCSOPTIMIZER_H
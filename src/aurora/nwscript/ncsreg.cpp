@@ -0,0 +1,177 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/nwscript/ncsreg.cpp
+ *  The global registry of loaded NCS programs.
+ */
+
+#include "common/error.h"
+#include "common/stream.h"
+#include "common/timestamp.h"
+
+#include "aurora/resman.h"
+
+#include "aurora/nwscript/ncsreg.h"
+
+DECLARE_SINGLETON(Aurora::NWScript::NCSRegistry)
+
+/** Maximum number of stack memories to keep around, enough for nested scripts. */
+static const uint32 kMaxPooledStacks = 8;
+
+namespace Aurora {
+
+namespace NWScript {
+
+NCSRegistry::Stats::Stats() : hits(0), misses(0), count(0), size(0), loadTime(0),
+	instructions(0), decodedInstructions(0), runs(0), executedInstructions(0),
+	stacks(0), stackAllocations(0) {
+}
+
+
+NCSRegistry::NCSRegistry() : _size(0), _instructions(0), _decodedInstructions(0), _optimize(true) {
+}
+
+NCSRegistry::~NCSRegistry() {
+	clear();
+
+	for (std::vector<NCSStackMemory *>::iterator s = _stackPool.begin(); s != _stackPool.end(); ++s)
+		delete *s;
+}
+
+void NCSRegistry::clear() {
+	_programs.clear();
+
+	_size = 0;
+
+	_instructions        = 0;
+	_decodedInstructions = 0;
+}
+
+void NCSRegistry::setOptimize(bool optimize) {
+	if (optimize == _optimize)
+		return;
+
+	clear();
+
+	_optimize = optimize;
+}
+
+bool NCSRegistry::getOptimize() const {
+	return _optimize;
+}
+
+void NCSRegistry::addRun(uint32 executedInstructions) {
+	_stats.runs++;
+	_stats.executedInstructions += executedInstructions;
+}
+
+NCSProgramPtr NCSRegistry::get(const Common::UString &name) {
+	ProgramMap::const_iterator program = _programs.find(name);
+	if (program != _programs.end()) {
+		// Entry exists => return
+		_stats.hits++;
+		return program->second;
+	}
+
+	// Entry doesn't exist => load and add
+
+	NCSProgramPtr newProgram = load(name);
+
+	_programs.insert(std::make_pair(name, newProgram));
+	_size += newProgram->getSize();
+
+	_instructions        += newProgram->getInstructionCount();
+	_decodedInstructions += newProgram->getDecodedInstructionCount();
+
+	return newProgram;
+}
+
+NCSStackMemory *NCSRegistry::acquireStackMemory() {
+	if (_stackPool.empty())
+		return new NCSStackMemory;
+
+	NCSStackMemory *memory = _stackPool.back();
+	_stackPool.pop_back();
+
+	return memory;
+}
+
+void NCSRegistry::releaseStackMemory(NCSStackMemory *memory) {
+	memory->release();
+
+	_stats.stackAllocations += memory->allocations;
+	memory->allocations = 0;
+
+	if (_stackPool.size() >= kMaxPooledStacks) {
+		delete memory;
+		return;
+	}
+
+	_stackPool.push_back(memory);
+}
+
+NCSRegistry::Stats NCSRegistry::getStats() const {
+	Stats stats = _stats;
+
+	stats.count  = _programs.size();
+	stats.size   = _size;
+	stats.stacks = _stackPool.size();
+
+	stats.instructions        = _instructions;
+	stats.decodedInstructions = _decodedInstructions;
+
+	return stats;
+}
+
+void NCSRegistry::resetStats() {
+	_stats = Stats();
+}
+
+NCSProgramPtr NCSRegistry::load(const Common::UString &name) {
+	const uint64 startTime = Common::getMicroseconds();
+
+	Common::SeekableReadStream *ncs = ResMan.getResource(name, kFileTypeNCS);
+	if (!ncs)
+		throw Common::Exception("No such NCS \"%s\"", name.c_str());
+
+	NCSProgramPtr program;
+	try {
+		program.reset(new NCSProgram(*ncs, name, _optimize));
+	} catch (...) {
+		delete ncs;
+		throw;
+	}
+
+	delete ncs;
+
+	_stats.misses++;
+	_stats.loadTime += Common::getMicroseconds() - startTime;
+
+	return program;
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
@@ -0,0 +1,132 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/nwscript/ncsreg.h
+ *  The global registry of loaded NCS programs.
+ */
+
+#ifndef AURORA_NWSCRIPT_NCSREG_H
+#define AURORA_NWSCRIPT_NCSREG_H
+
+#include <map>
+#include <vector>
+
+#include "common/types.h"
+#include "common/ustring.h"
+#include "common/singleton.h"
+
+#include "aurora/nwscript/ncsfile.h"
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** The global NCS registry, holding the programs of all scripts run so far.
+ *
+ *  Since scripts are run over and over again, for example as heartbeats,
+ *  their bytecode is only loaded on the first run and then shared between
+ *  all executions. The registry needs to be cleared whenever the scripts
+ *  available through the resource manager might change.
+ *
+ *  The registry also pools the memory of script stacks, so that executions
+ *  can reuse the cells and arenas of previous ones.
+ */
+class NCSRegistry : public Common::Singleton<NCSRegistry> {
+public:
+	/** Statistics about the registry's usage. */
+	struct Stats {
+		uint32 hits;   ///< Number of requests for already loaded programs.
+		uint32 misses; ///< Number of requests that had to load a program.
+
+		uint32 count; ///< Number of programs currently loaded.
+		uint32 size;  ///< Number of bytes of bytecode currently loaded.
+
+		uint64 loadTime; ///< Time spent loading programs, in microseconds.
+
+		uint32 instructions;        ///< Number of instructions in the loaded programs.
+		uint32 decodedInstructions; ///< Number of instructions in the loaded programs before optimization.
+
+		uint32 runs;                 ///< Number of script executions.
+		uint64 executedInstructions; ///< Number of instructions executed.
+
+		uint32 stacks;           ///< Number of stack memories currently pooled.
+		uint32 stackAllocations; ///< Number of heap allocations made by script stacks.
+
+		Stats();
+	};
+
+	NCSRegistry();
+	~NCSRegistry();
+
+	/** Remove all programs. Scripts currently running keep theirs. */
+	void clear();
+
+	/** Get the program of a script, loading it if necessary. */
+	NCSProgramPtr get(const Common::UString &name);
+
+	/** Should newly loaded programs be optimized? Clears the registry when changed. */
+	void setOptimize(bool optimize);
+	bool getOptimize() const;
+
+	/** Count a finished script execution. */
+	void addRun(uint32 executedInstructions);
+
+	/** Get memory for a script stack, reusing pooled memory if possible. */
+	NCSStackMemory *acquireStackMemory();
+	/** Return the memory of a script stack to the pool. */
+	void releaseStackMemory(NCSStackMemory *memory);
+
+	/** Return the usage statistics. */
+	Stats getStats() const;
+	/** Reset the usage statistics. */
+	void resetStats();
+
+private:
+	typedef std::map<Common::UString, NCSProgramPtr, Common::UString::iless> ProgramMap;
+
+	ProgramMap _programs;
+
+	std::vector<NCSStackMemory *> _stackPool;
+
+	uint32 _size; ///< Number of bytes of bytecode currently loaded.
+
+	uint32 _instructions;        ///< Number of instructions currently loaded.
+	uint32 _decodedInstructions; ///< Number of instructions currently loaded, before optimization.
+
+	bool _optimize;
+
+	Stats _stats;
+
+	NCSProgramPtr load(const Common::UString &name);
+};
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+/** Shortcut for accessing the NCS registry. */
+#define NCSReg ::Aurora::NWScript::NCSRegistry::instance()
+
+#endif // AURORA_NWSCRIPT_NCSREG_H
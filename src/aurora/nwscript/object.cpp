@@ -36,7 +36,12 @@ namespace Aurora {
 
 namespace NWScript {
 
-Object::Object() : _id(kObjectIDInvalid), _objectContainer(0) {
+Object::Object() : _id(kObjectIDInvalid), _objectContainer(0), _objectContainerTag(0),
+	_objectContainerIndex(0), _objectContainerTagIndex(0) {
+}
+
+Object::Object(StringInterner &interner) : VariableContainer(interner), _id(kObjectIDInvalid),
+	_objectContainer(0), _objectContainerTag(0), _objectContainerIndex(0), _objectContainerTagIndex(0) {
 }
 
 Object::~Object() {
@@ -44,11 +44,12 @@ namespace NWScript {
 class ObjectContainer;
 
 typedef std::map<uint32, class Object *> ObjectIDMap;
-typedef std::multimap<Common::UString, class Object *> ObjectTagMap;
 
 class Object : public VariableContainer {
 public:
 	Object();
+	/** Create an object interning its variable names in this interner. */
+	explicit Object(StringInterner &interner);
 	virtual ~Object();
 
 	uint32 getID() const;
@@ -64,7 +65,10 @@ protected:
 
 private:
 	ObjectContainer *_objectContainer;
-	ObjectTagMap::iterator _objectContainerTag;
+	uint32 _objectContainerTag; ///< The interned tag the container indexed us under.
+
+	uint32 _objectContainerIndex;    ///< Our slot in the container's list of all objects.
+	uint32 _objectContainerTagIndex; ///< Our slot in the container's list of objects with our tag.
 
 	friend class ObjectContainer;
 };
@@ -27,17 +27,31 @@
  *  An NWScript object container.
  */
 
+#include <cassert>
+
+#include <algorithm>
+
 #include "common/error.h"
 
 #include "aurora/types.h"
 
 #include "aurora/nwscript/objectcontainer.h"
+#include "aurora/nwscript/interner.h"
 
 namespace Aurora {
 
 namespace NWScript {
 
-ObjectContainer::SearchContext::SearchContext() : _empty(true), _object(0) {
+ObjectContainer::ObjectSlot::ObjectSlot(uint32 i, Object *o) : id(i), object(o) {
+}
+
+
+ObjectContainer::ObjectList::ObjectList() : removed(0), generation(0) {
+}
+
+
+ObjectContainer::SearchContext::SearchContext() : _empty(true), _object(0), _list(0), _index(0),
+	_lastID(kObjectIDInvalid), _generation(0) {
 }
 
 ObjectContainer::SearchContext::~SearchContext() {
@@ -48,74 +62,124 @@ Object *ObjectContainer::SearchContext::getObject() const {
 }
 
 
-ObjectContainer::ObjectContainer() : _currentID(0) {
+ObjectContainer::ObjectContainer() : _interner(0), _currentID(0) {
+}
+
+ObjectContainer::ObjectContainer(StringInterner &interner) : _interner(&interner), _currentID(0) {
 }
 
 ObjectContainer::~ObjectContainer() {
 }
 
 void ObjectContainer::addObject(Object &obj) {
-	Common::StackLock lock(_mutex);
+	if (obj._objectContainer)
+		obj._objectContainer->removeObject(obj);
 
-	removeObject(obj);
+	Common::StackWriteLock lock(_lock);
 
 	obj._id = ++_currentID;
 
 	obj._objectContainer    = this;
-	obj._objectContainerTag = _objects.insert(std::make_pair(obj.getTag(), &obj));
+	obj._objectContainerTag = getInterner().intern(obj.getTag());
+
+	ObjectList &tagged = _tags[obj._objectContainerTag];
+
+	obj._objectContainerIndex    = _objects.slots.size();
+	obj._objectContainerTagIndex = tagged.slots.size();
+
+	_objects.slots.push_back(ObjectSlot(obj._id, &obj));
+	tagged.slots.push_back(ObjectSlot(obj._id, &obj));
 }
 
 void ObjectContainer::removeObject(Object &obj) {
-	Common::StackLock lock(_mutex);
+	Common::StackWriteLock lock(_lock);
 
-	if (!obj._objectContainer)
+	if (obj._objectContainer != this)
 		return;
 
+	removeSlot(_objects, obj._objectContainerIndex, &Object::_objectContainerIndex);
+	removeSlot(_tags[obj._objectContainerTag], obj._objectContainerTagIndex, &Object::_objectContainerTagIndex);
+
 	obj._id = kObjectIDInvalid;
 
 	obj._objectContainer = 0;
-
-	_objects.erase(obj._objectContainerTag);
-	obj._objectContainerTag = _objects.end();
 }
 
 bool ObjectContainer::findObjectInit(SearchContext &ctx) const {
-	ctx._object = 0;
-	ctx._tag    = "";
-	ctx._range  = std::make_pair(_objects.begin(), _objects.end());
-	ctx._empty  = ctx._range.first == ctx._range.second;
+	Common::StackReadLock lock(_lock);
+
+	ctx._object     = 0;
+	ctx._list       = &_objects;
+	ctx._index      = 0;
+	ctx._lastID     = kObjectIDInvalid;
+	ctx._generation = _objects.generation;
+	ctx._empty      = _objects.slots.size() == _objects.removed;
 
 	return !ctx._empty;
 }
 
 bool ObjectContainer::findObjectInit(SearchContext &ctx, const Common::UString &tag) const {
-	ctx._object = 0;
-	ctx._tag    = tag;
-	ctx._range  = _objects.equal_range(tag);
-	ctx._empty  = ctx._range.first == ctx._range.second;
+	ctx._object     = 0;
+	ctx._list       = 0;
+	ctx._index      = 0;
+	ctx._lastID     = kObjectIDInvalid;
+	ctx._generation = 0;
+
+	const uint32 tagID = getInterner().find(tag);
+
+	Common::StackReadLock lock(_lock);
+
+	// A tag that was never interned can't belong to any object
+	ObjectTagMap::const_iterator tagged = _tags.find(tagID);
+	if (tagged != _tags.end()) {
+		ctx._list       = &tagged->second;
+		ctx._generation = tagged->second.generation;
+	}
+
+	ctx._empty = !ctx._list || (ctx._list->slots.size() == ctx._list->removed);
 
 	return !ctx._empty;
 }
 
 Object *ObjectContainer::findNextObject(SearchContext &ctx) const {
-	if (ctx._empty || (ctx._range.first == ctx._range.second)) {
+	Common::StackReadLock lock(_lock);
+
+	if (ctx._empty || !ctx._list) {
 		ctx._empty  = true;
 		ctx._object = 0;
 		return 0;
 	}
 
-	ctx._object = ctx._range.first->second;
+	const std::vector<ObjectSlot> &slots = ctx._list->slots;
+
+	// If the list was compacted in the meantime, find where we left off
+	if (ctx._generation != ctx._list->generation) {
+		if (ctx._index > 0)
+			ctx._index = std::upper_bound(slots.begin(), slots.end(), ctx._lastID, compareSlotID) - slots.begin();
+
+		ctx._generation = ctx._list->generation;
+	}
 
-	++ctx._range.first;
+	while ((ctx._index < slots.size()) && !slots[ctx._index].object)
+		ctx._index++;
+
+	if (ctx._index >= slots.size()) {
+		ctx._empty  = true;
+		ctx._object = 0;
+		return 0;
+	}
+
+	ctx._object = slots[ctx._index++].object;
+	ctx._lastID = ctx._object->getID();
 
 	return ctx._object;
 }
 
 Object *ObjectContainer::findObject() const {
-	if (_objects.empty())
-		return 0;
+	SearchContext ctx;
+	findObjectInit(ctx);
 
-	return _objects.begin()->second;
+	return findNextObject(ctx);
 }
 
 Object *ObjectContainer::findObject(const Common::UString &tag) const {
@@ -125,6 +189,41 @@ Object *ObjectContainer::findObject(const Common::UString &tag) const {
 	return findNextObject(ctx);
 }
 
+StringInterner &ObjectContainer::getInterner() const {
+	return _interner ? *_interner : Interner;
+}
+
+bool ObjectContainer::compareSlotID(uint32 id, const ObjectSlot &slot) {
+	return id < slot.id;
+}
+
+void ObjectContainer::removeSlot(ObjectList &list, uint32 index, uint32 Object::*indexMember) {
+	assert(index < list.slots.size());
+
+	list.slots[index].object = 0;
+	list.removed++;
+
+	if ((list.removed * 2) > list.slots.size())
+		compact(list, indexMember);
+}
+
+void ObjectContainer::compact(ObjectList &list, uint32 Object::*indexMember) {
+	std::vector<ObjectSlot>::iterator to = list.slots.begin();
+	for (std::vector<ObjectSlot>::iterator from = list.slots.begin(); from != list.slots.end(); ++from) {
+		if (!from->object)
+			continue;
+
+		from->object->*indexMember = to - list.slots.begin();
+
+		*to++ = *from;
+	}
+
+	list.slots.erase(to, list.slots.end());
+
+	list.removed = 0;
+	list.generation++;
+}
+
 } // End of namespace NWScript
 
 } // End of namespace Aurora
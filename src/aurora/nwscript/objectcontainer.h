@@ -30,6 +30,10 @@
 #ifndef AURORA_NWSCRIPT_OBJECTCONTAINER_H
 #define AURORA_NWSCRIPT_OBJECTCONTAINER_H
 
+#include <vector>
+
+#include <boost/unordered/unordered_map.hpp>
+
 #include "common/mutex.h"
 
 #include "aurora/nwscript/object.h"
@@ -38,7 +42,41 @@ namespace Aurora {
 
 namespace NWScript {
 
+class StringInterner;
+
+/** A container of objects, searchable by tag.
+ *
+ *  Objects are indexed by the IDs of their interned tags, interned in the
+ *  global StringInterner unless told otherwise. Adding and
+ *  removing objects takes a write lock, finding them a read lock, so
+ *  that lookups never see a list while it grows or the tag map rehashes.
+ *
+ *  All lists are sorted by object ID, since new objects always get a
+ *  higher ID and are appended. Removing an object only empties its slots,
+ *  which searches skip. Once more than half of a list is empty slots, the
+ *  list is compacted; a search running across that continues after the ID
+ *  of the object it found last, so it doesn't skip any others.
+ */
 class ObjectContainer {
+private:
+	/** A slot in an object list. */
+	struct ObjectSlot {
+		uint32 id;      ///< The ID the object had when added, kept after removal.
+		Object *object; ///< The object, or 0 if it was removed.
+
+		ObjectSlot(uint32 i, Object *o);
+	};
+
+	/** A list of objects, sorted by ID. */
+	struct ObjectList {
+		std::vector<ObjectSlot> slots;
+
+		uint32 removed;    ///< Number of empty slots.
+		uint32 generation; ///< Incremented whenever the list is compacted.
+
+		ObjectList();
+	};
+
 public:
 	class SearchContext {
 	public:
@@ -50,13 +88,17 @@ public:
 	private:
 		bool _empty;
 		Object *_object;
-		Common::UString _tag;
-		std::pair<ObjectTagMap::const_iterator, ObjectTagMap::const_iterator> _range;
+
+		const ObjectList *_list;
+		uint32 _index;      ///< The list index of the next object.
+		uint32 _lastID;     ///< The ID of the object found last.
+		uint32 _generation; ///< The generation of the list _index refers to.
 
 		friend class ObjectContainer;
 	};
 
 	ObjectContainer();
+	explicit ObjectContainer(StringInterner &interner);
 	~ObjectContainer();
 
 	/** Add an object to this container. */
@@ -78,11 +120,25 @@ public:
 	Object *findObject(const Common::UString &tag) const;
 
 private:
-	Common::Mutex _mutex;
+	typedef boost::unordered_map<uint32, ObjectList> ObjectTagMap;
+
+	mutable Common::ReadWriteLock _lock;
+
+	StringInterner *_interner; ///< Our own string interner, or 0 for the global one.
 
 	uint32 _currentID;
 
-	ObjectTagMap _objects;
+	ObjectList   _objects; ///< All objects.
+	ObjectTagMap _tags;    ///< All objects, by tag ID. Lists are never removed.
+
+	StringInterner &getInterner() const;
+
+	static bool compareSlotID(uint32 id, const ObjectSlot &slot);
+
+	/** Empty an object's slot in a list, compacting the list if it's mostly empty. */
+	static void removeSlot(ObjectList &list, uint32 index, uint32 Object::*indexMember);
+	/** Remove all empty slots from a list, updating the objects' slot indices. */
+	static void compact(ObjectList &list, uint32 Object::*indexMember);
 };
 
 } // End of namespace NWScript
@@ -0,0 +1,289 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/nwscript/profiler.cpp
+ *  A profiler for scripts and engine functions.
+ */
+
+#include <algorithm>
+
+#include "common/util.h"
+#include "common/stream.h"
+#include "common/timestamp.h"
+
+#include "aurora/nwscript/profiler.h"
+
+DECLARE_SINGLETON(Aurora::NWScript::ScriptProfiler)
+
+static const uint32 kDefaultSampleRate = 16;
+
+namespace Aurora {
+
+namespace NWScript {
+
+ScriptProfiler::Entry::Entry(const Common::UString &n, uint32 i) : name(n), id(i),
+	calls(0), sampledCalls(0), inclusiveTime(0), exclusiveTime(0), instructions(0),
+	frameInstructions(0), budgetExceeded(0), _frame(0), _frameInstructions(0) {
+}
+
+double ScriptProfiler::Entry::getInclusiveTime() const {
+	if (sampledCalls == 0)
+		return 0.0;
+
+	return (inclusiveTime * (double) calls) / sampledCalls;
+}
+
+double ScriptProfiler::Entry::getExclusiveTime() const {
+	if (sampledCalls == 0)
+		return 0.0;
+
+	return (exclusiveTime * (double) calls) / sampledCalls;
+}
+
+
+ScriptProfiler::Call::Call(Entry *e, bool sc, bool t, uint64 s) : entry(e), script(sc), timed(t),
+	start(s), childTime(0) {
+}
+
+
+ScriptProfiler::ScriptProfiler() : _enabled(false), _sampleRate(kDefaultSampleRate),
+	_budget(0), _frame(0) {
+
+}
+
+ScriptProfiler::~ScriptProfiler() {
+}
+
+void ScriptProfiler::setEnabled(bool enabled) {
+	if (enabled == _enabled)
+		return;
+
+	// Calls in progress were started in the other state, so forget about them
+	_calls.clear();
+
+	_enabled = enabled;
+}
+
+void ScriptProfiler::setSampleRate(uint32 rate) {
+	_sampleRate = MAX<uint32>(rate, 1);
+}
+
+uint32 ScriptProfiler::getSampleRate() const {
+	return _sampleRate;
+}
+
+void ScriptProfiler::setInstructionBudget(uint32 budget) {
+	_budget = budget;
+}
+
+uint32 ScriptProfiler::getInstructionBudget() const {
+	return _budget;
+}
+
+void ScriptProfiler::reset() {
+	_calls.clear();
+
+	_scripts.clear();
+	_functions.clear();
+}
+
+void ScriptProfiler::nextFrame() {
+	_frame++;
+}
+
+void ScriptProfiler::beginScript(const Common::UString &name) {
+	ScriptMap::iterator script = _scripts.find(name);
+	if (script == _scripts.end())
+		script = _scripts.insert(std::make_pair(name, Entry(name))).first;
+
+	script->second.calls++;
+
+	_calls.push_back(Call(&script->second, true, true, Common::getMicroseconds()));
+}
+
+void ScriptProfiler::endScript(uint32 instructions) {
+	if (_calls.empty())
+		return;
+
+	uint64 inclusive, exclusive;
+	endCall(_calls.back(), inclusive, exclusive);
+
+	Entry &script = *_calls.back().entry;
+	_calls.pop_back();
+
+	script.sampledCalls++;
+	script.inclusiveTime += inclusive;
+	script.exclusiveTime += exclusive;
+	script.instructions  += instructions;
+
+	// Scripts run on a different thread than the frames are rendered on,
+	// so this is only accurate to a frame or so, which is good enough
+	const uint32 frame = _frame;
+	if (script._frame != frame) {
+		script._frame             = frame;
+		script._frameInstructions = 0;
+	}
+
+	const uint32 before = script._frameInstructions;
+
+	script._frameInstructions += instructions;
+	script.frameInstructions   = MAX(script.frameInstructions, script._frameInstructions);
+
+	if ((_budget == 0) || (before > _budget) || (script._frameInstructions <= _budget))
+		return;
+
+	if (script.budgetExceeded++ == 0)
+		warning("Script \"%s\" executed %u instructions in one frame, exceeding the budget of %u",
+		        script.name.c_str(), script._frameInstructions, _budget);
+}
+
+void ScriptProfiler::beginFunction(uint32 id, const Common::UString &name) {
+	FunctionMap::iterator function = _functions.find(id);
+	if (function == _functions.end())
+		function = _functions.insert(std::make_pair(id, Entry(name, id))).first;
+
+	const bool timed = ((function->second.calls++ % _sampleRate) == 0);
+
+	_calls.push_back(Call(&function->second, false, timed, timed ? Common::getMicroseconds() : 0));
+}
+
+void ScriptProfiler::endFunction() {
+	if (_calls.empty())
+		return;
+
+	uint64 inclusive, exclusive;
+	endCall(_calls.back(), inclusive, exclusive);
+
+	Entry &function = *_calls.back().entry;
+	const bool timed = _calls.back().timed;
+
+	_calls.pop_back();
+
+	if (!timed)
+		return;
+
+	function.sampledCalls++;
+	function.inclusiveTime += inclusive;
+	function.exclusiveTime += exclusive;
+}
+
+void ScriptProfiler::endCall(Call &call, uint64 &inclusive, uint64 &exclusive) {
+	inclusive = 0;
+	exclusive = 0;
+
+	uint64 parentTime = call.childTime;
+
+	if (call.timed) {
+		inclusive = Common::getMicroseconds() - call.start;
+		exclusive = inclusive - MIN(inclusive, call.childTime);
+
+		/* Of an engine function only every n-th call is timed. To keep the
+		 * exclusive time of the caller unbiased, the exclusive time of this
+		 * call stands in for the untimed calls as well. The time spent in
+		 * nested scripts is always known exactly. */
+		if (call.script)
+			parentTime = inclusive;
+		else
+			parentTime += exclusive * _sampleRate;
+	}
+
+	if (_calls.size() >= 2)
+		_calls[_calls.size() - 2].childTime += parentTime;
+}
+
+static bool compareExclusiveTime(const ScriptProfiler::Entry &a, const ScriptProfiler::Entry &b) {
+	return a.getExclusiveTime() > b.getExclusiveTime();
+}
+
+void ScriptProfiler::getScripts(std::vector<Entry> &scripts) const {
+	scripts.clear();
+	scripts.reserve(_scripts.size());
+
+	for (ScriptMap::const_iterator s = _scripts.begin(); s != _scripts.end(); ++s)
+		scripts.push_back(s->second);
+
+	std::sort(scripts.begin(), scripts.end(), compareExclusiveTime);
+}
+
+void ScriptProfiler::getFunctions(std::vector<Entry> &functions) const {
+	functions.clear();
+	functions.reserve(_functions.size());
+
+	for (FunctionMap::const_iterator f = _functions.begin(); f != _functions.end(); ++f)
+		functions.push_back(f->second);
+
+	std::sort(functions.begin(), functions.end(), compareExclusiveTime);
+}
+
+void ScriptProfiler::dump(Common::WriteStream &out) const {
+	std::vector<Entry> entries;
+
+	getScripts(entries);
+
+	out.writeString("# Scripts\n");
+	out.writeString("# name calls inclusive_us exclusive_us instructions max_frame_instructions budget_exceeded\n");
+	for (std::vector<Entry>::const_iterator s = entries.begin(); s != entries.end(); ++s)
+		out.writeString(Common::UString::sprintf("%s %u %.0f %.0f %llu %u %u\n", s->name.c_str(),
+		                s->calls, s->getInclusiveTime(), s->getExclusiveTime(),
+		                (unsigned long long) s->instructions, s->frameInstructions, s->budgetExceeded));
+
+	getFunctions(entries);
+
+	out.writeString("\n# Engine functions\n");
+	out.writeString("# id name calls sampled_calls inclusive_us exclusive_us\n");
+	for (std::vector<Entry>::const_iterator f = entries.begin(); f != entries.end(); ++f)
+		out.writeString(Common::UString::sprintf("%u %s %u %u %.0f %.0f\n", f->id, f->name.c_str(),
+		                f->calls, f->sampledCalls, f->getInclusiveTime(), f->getExclusiveTime()));
+}
+
+
+ScriptProfileScope::ScriptProfileScope(const Common::UString &name) :
+	_enabled(ScriptProf.isEnabled()), _instructions(0) {
+
+	if (_enabled)
+		ScriptProf.beginScript(name);
+}
+
+ScriptProfileScope::~ScriptProfileScope() {
+	if (_enabled)
+		ScriptProf.endScript(_instructions);
+}
+
+
+FunctionProfileScope::FunctionProfileScope(uint32 id, const Common::UString &name) :
+	_enabled(ScriptProf.isEnabled()) {
+
+	if (_enabled)
+		ScriptProf.beginFunction(id, name);
+}
+
+FunctionProfileScope::~FunctionProfileScope() {
+	if (_enabled)
+		ScriptProf.endFunction();
+}
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
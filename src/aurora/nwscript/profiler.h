@@ -0,0 +1,198 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/nwscript/profiler.h
+ *  A profiler for scripts and engine functions.
+ */
+
+#ifndef AURORA_NWSCRIPT_PROFILER_H
+#define AURORA_NWSCRIPT_PROFILER_H
+
+#include <map>
+#include <vector>
+
+#include "common/types.h"
+#include "common/ustring.h"
+#include "common/singleton.h"
+
+namespace Common {
+	class WriteStream;
+}
+
+namespace Aurora {
+
+namespace NWScript {
+
+/** The global NWScript profiler.
+ *
+ *  When enabled, it records how often each script and each engine function
+ *  is called, how much time they take and how many instructions the scripts
+ *  execute. Exclusive times exclude the engine functions and nested scripts
+ *  called from within.
+ *
+ *  Scripts are timed on every run. Engine functions are called far more
+ *  often and are mostly short, so only every n-th call of each function is
+ *  timed and the times of the other calls are extrapolated from those.
+ *
+ *  Scripts executing more instructions within one frame than the budget
+ *  allows are flagged, with a warning for the first offense.
+ */
+class ScriptProfiler : public Common::Singleton<ScriptProfiler> {
+public:
+	/** The profile of one script or engine function. */
+	struct Entry {
+		Common::UString name; ///< The name of the script or function.
+
+		uint32 id; ///< The ID of the engine function.
+
+		uint32 calls;        ///< Number of calls.
+		uint32 sampledCalls; ///< Number of calls that were timed.
+
+		uint64 inclusiveTime; ///< Time spent in the timed calls, in microseconds.
+		uint64 exclusiveTime; ///< Time spent in the timed calls, without the calls within.
+
+		uint64 instructions;      ///< Number of instructions executed.
+		uint32 frameInstructions; ///< Most instructions executed within one frame.
+
+		uint32 budgetExceeded; ///< Number of frames in which the budget was exceeded.
+
+		Entry(const Common::UString &n = "", uint32 i = 0);
+
+		/** Return the estimated time of all calls, in microseconds. */
+		double getInclusiveTime() const;
+		/** Return the estimated time of all calls without the calls within, in microseconds. */
+		double getExclusiveTime() const;
+
+	private:
+		uint32 _frame;             ///< The frame the instruction count belongs to.
+		uint32 _frameInstructions; ///< Instructions executed in that frame.
+
+		friend class ScriptProfiler;
+	};
+
+	ScriptProfiler();
+	~ScriptProfiler();
+
+	/** Enable or disable profiling. Disabling keeps the collected profiles. */
+	void setEnabled(bool enabled);
+	/** Is profiling enabled? */
+	bool isEnabled() const { return _enabled; }
+
+	/** Time only every n-th call of each engine function. 1 times every call. */
+	void setSampleRate(uint32 rate);
+	uint32 getSampleRate() const;
+
+	/** Set the number of instructions a script may execute per frame. 0 disables the budget. */
+	void setInstructionBudget(uint32 budget);
+	uint32 getInstructionBudget() const;
+
+	/** Remove all collected profiles. */
+	void reset();
+
+	/** Mark the start of a new frame. */
+	void nextFrame();
+
+	/** Start profiling a script run. */
+	void beginScript(const Common::UString &name);
+	/** Finish profiling the current script run. */
+	void endScript(uint32 instructions);
+
+	/** Start profiling an engine function call. */
+	void beginFunction(uint32 id, const Common::UString &name);
+	/** Finish profiling the current engine function call. */
+	void endFunction();
+
+	/** Return the script profiles, sorted by exclusive time. */
+	void getScripts(std::vector<Entry> &scripts) const;
+	/** Return the engine function profiles, sorted by exclusive time. */
+	void getFunctions(std::vector<Entry> &functions) const;
+
+	/** Write all collected profiles into a stream, as text. */
+	void dump(Common::WriteStream &out) const;
+
+private:
+	/** A script run or engine function call currently in progress. */
+	struct Call {
+		Entry *entry;
+
+		bool script; ///< Is this a script run, or an engine function call?
+		bool timed;  ///< Is this call timed?
+
+		uint64 start;     ///< Timestamp of the start of the call.
+		uint64 childTime; ///< Time spent in calls within this call.
+
+		Call(Entry *e, bool sc, bool t, uint64 s);
+	};
+
+	typedef std::map<Common::UString, Entry> ScriptMap;
+	typedef std::map<uint32, Entry> FunctionMap;
+
+	bool _enabled;
+
+	uint32 _sampleRate;
+	uint32 _budget;
+
+	volatile uint32 _frame;
+
+	ScriptMap   _scripts;
+	FunctionMap _functions;
+
+	std::vector<Call> _calls;
+
+	void endCall(Call &call, uint64 &inclusive, uint64 &exclusive);
+};
+
+/** Profiles a script run for as long as it is in scope. */
+class ScriptProfileScope {
+public:
+	ScriptProfileScope(const Common::UString &name);
+	~ScriptProfileScope();
+
+	/** Set the number of instructions the run has executed. */
+	void setInstructions(uint32 instructions) { _instructions = instructions; }
+
+private:
+	bool _enabled;
+	uint32 _instructions;
+};
+
+/** Profiles an engine function call for as long as it is in scope. */
+class FunctionProfileScope {
+public:
+	FunctionProfileScope(uint32 id, const Common::UString &name);
+	~FunctionProfileScope();
+
+private:
+	bool _enabled;
+};
+
+} // End of namespace NWScript
+
+} // End of namespace Aurora
+
+/** Shortcut for accessing the script profiler. */
+#define ScriptProf ::Aurora::NWScript::ScriptProfiler::instance()
+
+#endif // AURORA_NWSCRIPT_PROFILER_H
@@ -30,36 +30,46 @@
 #include "common/error.h"
 
 #include "aurora/nwscript/variablecontainer.h"
+#include "aurora/nwscript/interner.h"
 
 namespace Aurora {
 
 namespace NWScript {
 
-VariableContainer::VariableContainer() {
+VariableContainer::VariableContainer() : _interner(0) {
+}
+
+VariableContainer::VariableContainer(StringInterner &interner) : _interner(&interner) {
 }
 
 VariableContainer::~VariableContainer() {
 }
 
 bool VariableContainer::hasVariable(const Common::UString &var) const {
-	return _variables.find(var) != _variables.end();
+	const uint32 id = getInterner().find(var);
+	if (id == StringInterner::kInvalidID)
+		return false;
+
+	return _variables.find(id) != _variables.end();
 }
 
 Variable &VariableContainer::getVariable(const Common::UString &var, Type type) {
-	VariableMap::iterator v = _variables.find(var);
-	if ((v == _variables.end()) && (type != kTypeVoid)) {
-		std::pair<VariableMap::iterator, bool> result;
+	// Only intern names of variables we're going to create
+	const uint32 id = (type != kTypeVoid) ? getInterner().intern(var) : getInterner().find(var);
 
-		result = _variables.insert(std::make_pair(var, Variable(type)));
+	VariableMap::iterator v = _variables.find(id);
+	if (v == _variables.end()) {
+		if (type == kTypeVoid)
+			throw Common::Exception("VariableContainer::getVariable(): No such variable \"%s\"", var.c_str());
 
-		v = result.first;
+		v = _variables.insert(std::make_pair(id, Variable(type))).first;
 	}
 
 	return v->second;
 }
 
 const Variable &VariableContainer::getVariable(const Common::UString &var) const {
-	VariableMap::const_iterator v = _variables.find(var);
+	VariableMap::const_iterator v = _variables.find(getInterner().find(var));
 	if (v == _variables.end())
 		throw Common::Exception("VariableContainer::getVariable(): No such variable \"%s\"", var.c_str());
 
@@ -67,19 +77,25 @@ const Variable &VariableContainer::getVariable(const Common::UString &var) const
 }
 
 void VariableContainer::setVariable(const Common::UString &var, const Variable &value) {
-	_variables[var] = value;
+	_variables[getInterner().intern(var)] = value;
 }
 
 void VariableContainer::removeVariable(const Common::UString &var) {
-	VariableMap::iterator v = _variables.find(var);
-	if (v != _variables.end())
-		_variables.erase(v);
+	const uint32 id = getInterner().find(var);
+	if (id == StringInterner::kInvalidID)
+		return;
+
+	_variables.erase(id);
 }
 
 void VariableContainer::clearVariables() {
 	_variables.clear();
 }
 
+StringInterner &VariableContainer::getInterner() const {
+	return _interner ? *_interner : Interner;
+}
+
 } // End of namespace NWScript
 
 } // End of namespace Aurora
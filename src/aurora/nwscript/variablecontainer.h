@@ -30,8 +30,9 @@
 #ifndef AURORA_NWSCRIPT_VARIABLECONTAINER_H
 #define AURORA_NWSCRIPT_VARIABLECONTAINER_H
 
-#include <map>
+#include <boost/unordered/unordered_map.hpp>
 
+#include "common/types.h"
 #include "common/ustring.h"
 
 #include "aurora/nwscript/variable.h"
@@ -40,9 +41,17 @@ namespace Aurora {
 
 namespace NWScript {
 
+class StringInterner;
+
+/** A container of named variables, like the local variables of an object.
+ *
+ *  The variables are keyed by the IDs of their interned names. Unless
+ *  told otherwise, the names are interned in the global StringInterner.
+ */
 class VariableContainer {
 public:
 	VariableContainer();
+	explicit VariableContainer(StringInterner &interner);
 	virtual ~VariableContainer();
 
 	bool hasVariable(const Common::UString &var) const;
@@ -56,9 +65,13 @@ public:
 	void clearVariables();
 
 private:
-	typedef std::map<Common::UString, Variable> VariableMap;
+	typedef boost::unordered_map<uint32, Variable> VariableMap;
+
+	StringInterner *_interner; ///< Our own string interner, or 0 for the global one.
 
 	VariableMap _variables;
+
+	StringInterner &getInterner() const;
 };
 
 } // End of namespace NWScript
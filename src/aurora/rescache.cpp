@@ -0,0 +1,212 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/rescache.cpp
+ *  A cache of decompressed resource data.
+ */
+
+#include "common/error.h"
+
+#include "aurora/rescache.h"
+
+namespace Aurora {
+
+CachedReadStream::CachedReadStream(const boost::shared_array<byte> &data, uint32 size) :
+	Common::MemoryReadStream(data.get(), size), _data(data) {
+
+}
+
+CachedReadStream::~CachedReadStream() {
+}
+
+
+ResourceCache::Stats::Stats() : hits(0), misses(0), evictions(0), count(0), size(0), maxSize(0),
+	timeSaved(0) {
+
+}
+
+
+ResourceCache::ResourceCache(uint32 maxSize) : _maxSize(maxSize), _size(0), _released(_mutex) {
+}
+
+ResourceCache::~ResourceCache() {
+}
+
+void ResourceCache::clear() {
+	Common::StackLock lock(_mutex);
+
+	_entryMap.clear();
+	_entries.clear();
+
+	_size = 0;
+}
+
+void ResourceCache::setMaxSize(uint32 maxSize) {
+	Common::StackLock lock(_mutex);
+
+	_maxSize = maxSize;
+
+	evict(_maxSize);
+}
+
+void ResourceCache::removeArchive(const Archive *archive) {
+	Common::StackLock lock(_mutex);
+
+	EntryMap::iterator entry = _entryMap.lower_bound(Key(archive, 0));
+	while ((entry != _entryMap.end()) && (entry->first.first == archive))
+		removeEntry(entry++);
+}
+
+Common::SeekableReadStream *ResourceCache::get(const Archive *archive, uint32 index) {
+	Common::StackLock lock(_mutex);
+
+	const Key key(archive, index);
+
+	// Someone is reading the resource right now, wait for them
+	while (_reserved.find(key) != _reserved.end())
+		_released.wait();
+
+	EntryMap::iterator entry = _entryMap.find(key);
+	if (entry == _entryMap.end()) {
+		_stats.misses++;
+		return 0;
+	}
+
+	// Move the resource to the front of the list, marking it as most recently used
+	_entries.splice(_entries.begin(), _entries, entry->second);
+
+	_stats.hits++;
+	_stats.timeSaved += entry->second->loadTime;
+
+	return new CachedReadStream(entry->second->data, entry->second->size);
+}
+
+bool ResourceCache::reserve(const Archive *archive, uint32 index) {
+	Common::StackLock lock(_mutex);
+
+	const Key key(archive, index);
+
+	if (_entryMap.find(key) != _entryMap.end())
+		return false;
+
+	return _reserved.insert(key).second;
+}
+
+void ResourceCache::release(const Archive *archive, uint32 index) {
+	Common::StackLock lock(_mutex);
+
+	if (_reserved.erase(Key(archive, index)) > 0)
+		_released.broadcast();
+}
+
+Common::SeekableReadStream *ResourceCache::add(const Archive *archive, uint32 index,
+		Common::SeekableReadStream *stream, uint64 loadTime) {
+
+	const uint32 size = stream->size();
+
+	{
+		Common::StackLock lock(_mutex);
+
+		if (size > _maxSize)
+			return stream;
+	}
+
+	// Read the data outside the lock, it might take a while
+	boost::shared_array<byte> data(new byte[size]);
+
+	try {
+		if (!stream->seek(0) || (stream->read(data.get(), size) != size))
+			throw Common::Exception(Common::kReadError);
+	} catch (...) {
+		delete stream;
+		throw;
+	}
+
+	delete stream;
+
+	Common::StackLock lock(_mutex);
+
+	if (size > _maxSize)
+		return new CachedReadStream(data, size);
+
+	const Key key(archive, index);
+
+	// Someone else might have added the resource in the meantime
+	EntryMap::iterator entry = _entryMap.find(key);
+	if (entry != _entryMap.end())
+		removeEntry(entry);
+
+	evict(_maxSize - size);
+
+	_entries.push_front(Entry());
+
+	Entry &newEntry = _entries.front();
+
+	newEntry.key      = key;
+	newEntry.data     = data;
+	newEntry.size     = size;
+	newEntry.loadTime = loadTime;
+
+	_entryMap.insert(std::make_pair(key, _entries.begin()));
+
+	_size += size;
+
+	return new CachedReadStream(data, size);
+}
+
+ResourceCache::Stats ResourceCache::getStats() const {
+	Common::StackLock lock(_mutex);
+
+	Stats stats = _stats;
+
+	stats.count   = _entries.size();
+	stats.size    = _size;
+	stats.maxSize = _maxSize;
+
+	return stats;
+}
+
+void ResourceCache::resetStats() {
+	Common::StackLock lock(_mutex);
+
+	_stats = Stats();
+}
+
+void ResourceCache::removeEntry(EntryMap::iterator entry) {
+	_size -= entry->second->size;
+
+	_entries.erase(entry->second);
+	_entryMap.erase(entry);
+}
+
+void ResourceCache::evict(uint32 maxSize) {
+	while (!_entries.empty() && (_size > maxSize)) {
+		removeEntry(_entryMap.find(_entries.back().key));
+
+		_stats.evictions++;
+	}
+}
+
+} // End of namespace Aurora
@@ -0,0 +1,173 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file aurora/rescache.h
+ *  A cache of decompressed resource data.
+ */
+
+#ifndef AURORA_RESCACHE_H
+#define AURORA_RESCACHE_H
+
+#include <list>
+#include <map>
+#include <set>
+#include <utility>
+
+#include <boost/shared_array.hpp>
+
+#include "common/types.h"
+#include "common/noncopyable.h"
+#include "common/mutex.h"
+#include "common/stream.h"
+
+namespace Aurora {
+
+class Archive;
+
+/** A read-only stream over resource data shared with the resource cache. */
+class CachedReadStream : public Common::MemoryReadStream {
+public:
+	CachedReadStream(const boost::shared_array<byte> &data, uint32 size);
+	~CachedReadStream();
+
+private:
+	boost::shared_array<byte> _data;
+};
+
+/** A size-bounded cache of resources that are expensive to read.
+ *
+ *  Resources are identified by their archive and their index within it, and
+ *  kept in memory whole. When the cache grows over its budget, the least
+ *  recently used resources are evicted. Streams handed out by the cache share
+ *  the cached data, so a cache hit never copies the resource data.
+ *
+ *  A resource can be reserved before it is read, for example by a
+ *  background thread. Requests for a reserved resource wait until it
+ *  has been added to the cache, or the reservation has been released.
+ *
+ *  All methods are thread-safe.
+ */
+class ResourceCache : public Common::NonCopyable {
+public:
+	static const uint32 kDefaultMaxSize = 32 * 1024 * 1024;
+
+	/** Statistics about the cache's usage. */
+	struct Stats {
+		uint32 hits;      ///< Number of requests served from the cache.
+		uint32 misses;    ///< Number of requests not in the cache.
+		uint32 evictions; ///< Number of resources evicted to stay within budget.
+
+		uint32 count;   ///< Number of resources currently in the cache.
+		uint32 size;    ///< Number of bytes currently in the cache.
+		uint32 maxSize; ///< The cache's budget in bytes.
+
+		uint64 timeSaved; ///< Time not spent reading resources, in microseconds.
+
+		Stats();
+	};
+
+	ResourceCache(uint32 maxSize = kDefaultMaxSize);
+	~ResourceCache();
+
+	/** Remove all resources from the cache. */
+	void clear();
+
+	/** Set the number of bytes the cache may hold, evicting resources if necessary. */
+	void setMaxSize(uint32 maxSize);
+
+	/** Remove all resources of this archive from the cache. */
+	void removeArchive(const Archive *archive);
+
+	/** Return a stream of a resource, or 0 if it's not in the cache.
+	 *
+	 *  If the resource is currently reserved, wait for it first.
+	 */
+	Common::SeekableReadStream *get(const Archive *archive, uint32 index);
+
+	/** Reserve a resource that's about to be read and added.
+	 *
+	 *  @return false if the resource is already cached or reserved.
+	 */
+	bool reserve(const Archive *archive, uint32 index);
+	/** Release the reservation of a resource, waking up everyone waiting for it. */
+	void release(const Archive *archive, uint32 index);
+
+	/** Add a resource to the cache.
+	 *
+	 *  The stream is taken over and replaced by one reading from the cache.
+	 *  Resources too big for the cache are not added, and their stream
+	 *  is returned as is.
+	 *
+	 *  @param  archive The archive the resource is from.
+	 *  @param  index The resource's index within the archive.
+	 *  @param  stream The resource's data.
+	 *  @param  loadTime The time reading the resource took, in microseconds.
+	 *  @return A stream of the resource's data.
+	 */
+	Common::SeekableReadStream *add(const Archive *archive, uint32 index,
+	                                Common::SeekableReadStream *stream, uint64 loadTime);
+
+	/** Return the usage statistics. */
+	Stats getStats() const;
+	/** Reset the usage statistics. */
+	void resetStats();
+
+private:
+	typedef std::pair<const Archive *, uint32> Key;
+
+	/** A cached resource. */
+	struct Entry {
+		Key key;
+
+		boost::shared_array<byte> data;
+		uint32 size;
+
+		uint64 loadTime; ///< Time reading the resource took, in microseconds.
+	};
+
+	typedef std::list<Entry> EntryList;
+	typedef std::map<Key, EntryList::iterator> EntryMap;
+	typedef std::set<Key> KeySet;
+
+	uint32 _maxSize;
+	uint32 _size;
+
+	EntryList _entries; ///< All cached resources, the most recently used first.
+	EntryMap  _entryMap;
+
+	KeySet _reserved; ///< Resources currently being read.
+
+	Stats _stats;
+
+	mutable Common::Mutex _mutex;
+	Common::Condition _released;
+
+	void removeEntry(EntryMap::iterator entry);
+	void evict(uint32 maxSize);
+};
+
+} // End of namespace Aurora
+
+#endif // AURORA_RESCACHE_H
@@ -29,10 +29,20 @@
 
 #include <boost/algorithm/string.hpp>
 
+#include <algorithm>
+
+#include <boost/bind.hpp>
+
 #include "common/util.h"
+#include "common/error.h"
+#include "common/debug.h"
+#include "common/timestamp.h"
 #include "common/stream.h"
 #include "common/filepath.h"
 #include "common/file.h"
+#include "common/mappedfile.h"
+#include "common/threadpool.h"
+#include "common/uuid.h"
 
 #include "aurora/resman.h"
 #include "aurora/util.h"
@@ -59,15 +69,25 @@ static const char *kArchiveGlob[Aurora::kArchiveMAX] = {
 	".*\\.key", ".*\\.bif", ".*\\.(erf|mod|hak|nwm)", ".*\\.rim", ".*\\.zip", ".*\\.exe"
 };
 
-namespace Aurora {
+static const uint32 kKEYIndexID      = MKTAG('X', 'K', 'I', 'X');
+static const uint32 kKEYIndexVersion = 1;
 
-ResourceManager::Resource::Resource() : type(kFileTypeNone), priority(0),
-		source(kSourceNone), archive(0), archiveIndex(0xFFFFFFFF) {
-}
+/** The size of a KEY index without any BIFs, and with an empty KEY file name. */
+static const uint32 kKEYIndexMinSize = 4 + 4 + (1 + 4 + 8) + 4 + 4;
+
+/** Marks an unused hash table entry or the end of a resource chain. */
+static const uint32 kResourceNone    = 0xFFFFFFFF;
+/** Marks a deleted hash table entry. */
+static const uint32 kResourceDeleted = 0xFFFFFFFE;
 
+/** Default number of I/O threads used for prefetching resources. */
+static const uint32 kPrefetchThreads = 2;
 
-bool ResourceManager::Resource::operator<(const Resource &right) const {
-	return priority < right.priority;
+namespace Aurora {
+
+ResourceManager::Resource::Resource() : hash(0), name(Common::StringArena::kInvalidOffset),
+		type(kFileTypeNone), priority(0), source(kSourceNone), archive(0),
+		archiveIndex(0xFFFFFFFF), path(Common::StringArena::kInvalidOffset), next(kResourceNone) {
 }
 
 
@@ -86,7 +106,52 @@ ResourceManager::ChangeID::ChangeID(ChangeSetList::iterator c) : _empty(false),
 }
 
 
-ResourceManager::ResourceManager() : _rimsAreERFs(false), _hashAlgo(Common::kHashFNV64) {
+struct ResourceManager::PrefetchState {
+	uint32 pending; ///< Number of resources still to be read.
+
+	PrefetchCallback callback;
+
+	Common::Mutex     mutex;
+	Common::Condition done;
+
+	PrefetchState(uint32 p, const PrefetchCallback &c) : pending(p), callback(c), done(mutex) {
+	}
+};
+
+
+ResourceManager::PrefetchID::PrefetchID() {
+}
+
+ResourceManager::PrefetchID::PrefetchID(const boost::shared_ptr<PrefetchState> &state) : _state(state) {
+}
+
+bool ResourceManager::PrefetchID::empty() const {
+	return !_state;
+}
+
+bool ResourceManager::PrefetchID::isDone() const {
+	if (!_state)
+		return true;
+
+	Common::StackLock lock(_state->mutex);
+
+	return _state->pending == 0;
+}
+
+void ResourceManager::PrefetchID::wait() const {
+	if (!_state)
+		return;
+
+	Common::StackLock lock(_state->mutex);
+
+	while (_state->pending > 0)
+		_state->done.wait();
+}
+
+
+ResourceManager::ResourceManager() : _rimsAreERFs(false), _hashAlgo(Common::kHashFNV64),
+	_hashCount(0), _hashUsed(0), _indexTime(0), _prefetchThreads(kPrefetchThreads), _prefetchPool(0) {
+
 	_resourceTypeTypes[kResourceImage].push_back(kFileTypeDDS);
 	_resourceTypeTypes[kResourceImage].push_back(kFileTypeTPC);
 	_resourceTypeTypes[kResourceImage].push_back(kFileTypeTXB);
@@ -121,6 +186,8 @@ ResourceManager::ResourceManager() : _rimsAreERFs(false), _hashAlgo(Common::kHas
 ResourceManager::~ResourceManager() {
 	clear();
 
+	delete _prefetchPool;
+
 	for (int i = 0; i < kResourceMAX; i++)
 		_resourceTypeTypes[i].clear();
 }
@@ -133,6 +200,8 @@ void ResourceManager::clear() {
 }
 
 void ResourceManager::clearResources() {
+	waitPrefetch();
+
 	_cursorRemap.clear();
 
 	_baseDir.clear();
@@ -142,11 +211,22 @@ void ResourceManager::clearResources() {
 		_archiveFiles[i].clear();
 	}
 
+	_cache.clear();
+
 	for (ArchiveList::iterator archive = _archives.begin(); archive != _archives.end(); ++archive)
 		delete *archive;
 	_archives.clear();
 
 	_resources.clear();
+	_freeResources.clear();
+
+	_hashTable.clear();
+	_hashCount = 0;
+	_hashUsed  = 0;
+
+	_names.clear();
+
+	_indexTime = 0;
 
 	_typeAliases.clear();
 
@@ -158,7 +238,7 @@ void ResourceManager::setRIMsAreERFs(bool rimsAreERFs) {
 }
 
 void ResourceManager::setHashAlgo(Common::HashAlgo algo) {
-	if ((algo != _hashAlgo) && !_resources.empty())
+	if ((algo != _hashAlgo) && (_hashCount > 0))
 		throw Common::Exception("ResourceManager::setHashAlgo(): We already have resources!");
 
 	_hashAlgo = algo;
@@ -168,6 +248,10 @@ void ResourceManager::setCursorRemap(const std::vector<Common::UString> &remap)
 	_cursorRemap = remap;
 }
 
+void ResourceManager::setIndexCache(const Common::UString &directory) {
+	_indexCache = directory;
+}
+
 void ResourceManager::registerDataBaseDir(const Common::UString &path) {
 	clearResources();
 
@@ -201,7 +285,7 @@ void ResourceManager::addArchiveDir(ArchiveType archive, const Common::UString &
 }
 
 Common::UString ResourceManager::findArchive(const Common::UString &file,
-		const DirectoryList &dirs, const Common::FileList &files) {
+		const DirectoryList &dirs, const Common::FileList &files) const {
 
 	Common::UString escapedFile = Common::FilePath::escapeStringLiteral(file);
 	Common::FileList nameMatch;
@@ -230,72 +314,169 @@ bool ResourceManager::hasArchive(ArchiveType archive, const Common::UString &fil
 ResourceManager::ChangeID ResourceManager::addArchive(ArchiveType archive,
 		const Common::UString &file, uint32 priority) {
 
-	// NDS aren't found in resource directories, they are used /instead/ of directories
-	if (archive == kArchiveNDS) {
-		NDSFile *nds = new NDSFile(file);
+	waitPrefetch();
 
-		ChangeID change = newChangeSet();
+	const uint64 startTime = Common::getMicroseconds();
 
-		return indexArchive(nds, priority, change);
-	}
+	ChangeID change = openArchive(archive, file, priority);
 
-	// HERF files are only found inside NDS files
-	if (archive == kArchiveHERF) {
-		HERFFile *herf = new HERFFile(file);
+	const uint64 time = Common::getMicroseconds() - startTime;
+	debugC(1, Common::kDebugResources, "Indexed archive \"%s\" in %.3fms", file.c_str(), time / 1000.0);
 
-		ChangeID change = newChangeSet();
+	_indexTime += time;
 
-		return indexArchive(herf, priority, change);
-	}
+	return change;
+}
 
-	assert((archive >= 0) && (archive < kArchiveMAX));
+ResourceManager::BatchArchive::BatchArchive(ArchiveType t, const Common::UString &f, uint32 p, bool o) :
+	type(t), file(f), priority(p), optional(o), added(false) {
+}
 
-	if (archive == kArchiveBIF)
-		throw Common::Exception("Attempted to index a lone BIF");
+ResourceManager::LoadedArchive::LoadedArchive() : failed(false) {
+}
 
-	Common::UString realName = findArchive(file, _archiveDirs[archive], _archiveFiles[archive]);
-	if (realName.empty())
-		throw Common::Exception("No such archive file \"%s\"", file.c_str());
+void ResourceManager::addArchives(ArchiveBatch &batch, uint32 threadCount) {
+	if (batch.empty())
+		return;
 
-	if (archive == kArchiveKEY)
-		return indexKEY(realName, priority);
+	waitPrefetch();
+
+	const uint64 startTime = Common::getMicroseconds();
+
+	if (threadCount == 0)
+		threadCount = Common::ThreadPool::getCoreCount();
+
+	// The archives use the file type manager while loading, make sure it exists beforehand
+	FileTypeManager::instance();
 
-	if (archive == kArchiveERF) {
-		ERFFile *erf = new ERFFile(realName);
+	std::vector<LoadedArchive> loaded(batch.size());
 
-		ChangeID change = newChangeSet();
+	// Read all archives in parallel
+	{
+		Common::ThreadPool pool(MIN<uint32>(threadCount, batch.size()));
 
-		return indexArchive(erf, priority, change);
+		for (uint32 i = 0; i < batch.size(); i++) {
+			batch[i].added = false;
+			batch[i].change.clear();
+
+			// HERF files are found inside NDS files, so those need to be indexed first
+			if (batch[i].type == kArchiveHERF)
+				continue;
+
+			pool.addJob(boost::bind(&ResourceManager::loadBatchArchive, this,
+			                        boost::cref(batch[i]), boost::ref(loaded[i])));
+		}
+
+		pool.wait();
 	}
 
-	if (archive == kArchiveRIM) {
-		RIMFile *rim = new RIMFile(realName);
+	// Index them in order, so that the resources resolve like they would when added one by one
+	try {
+		for (uint32 i = 0; i < batch.size(); i++) {
+			if (batch[i].type == kArchiveHERF)
+				loadBatchArchive(batch[i], loaded[i]);
+
+			if (loaded[i].failed) {
+				if (batch[i].optional)
+					continue;
 
-		ChangeID change = newChangeSet();
+				throw loaded[i].error;
+			}
 
-		return indexArchive(rim, priority, change);
+			batch[i].change = indexArchives(loaded[i].archives, batch[i].priority);
+			batch[i].added  = true;
+		}
+	} catch (...) {
+		// Free all archives we didn't get to index
+		for (std::vector<LoadedArchive>::iterator l = loaded.begin(); l != loaded.end(); ++l)
+			for (std::vector<Archive *>::iterator a = l->archives.begin(); a != l->archives.end(); ++a)
+				delete *a;
+
+		_indexTime += Common::getMicroseconds() - startTime;
+		throw;
 	}
 
-	if (archive == kArchiveZIP) {
-		ZIPFile *zip = new ZIPFile(realName);
+	const uint64 time = Common::getMicroseconds() - startTime;
+	debugC(1, Common::kDebugResources, "Indexed %u archives with %u threads in %.3fms",
+	       (uint) batch.size(), threadCount, time / 1000.0);
 
-		ChangeID change = newChangeSet();
+	_indexTime += time;
+}
 
-		return indexArchive(zip, priority, change);
+void ResourceManager::loadBatchArchive(const BatchArchive &archive, LoadedArchive &loaded) const {
+	try {
+		loadArchive(archive.type, archive.file, loaded.archives);
+	} catch (Common::Exception &e) {
+		loaded.error  = e;
+		loaded.failed = true;
+	} catch (std::exception &e) {
+		loaded.error  = Common::Exception("%s", e.what());
+		loaded.failed = true;
 	}
+}
+
+ResourceManager::ChangeID ResourceManager::openArchive(ArchiveType archive,
+		const Common::UString &file, uint32 priority) {
+
+	std::vector<Archive *> archives;
+	loadArchive(archive, file, archives);
 
-	if (archive == kArchiveEXE) {
-		PEFile *pe = new PEFile(realName, _cursorRemap);
+	return indexArchives(archives, priority);
+}
 
-		ChangeID change = newChangeSet();
+void ResourceManager::loadArchive(ArchiveType archive, const Common::UString &file,
+		std::vector<Archive *> &archives) const {
 
-		return indexArchive(pe, priority, change);
+	// NDS aren't found in resource directories, they are used /instead/ of directories
+	if (archive == kArchiveNDS) {
+		archives.push_back(new NDSFile(file));
+		return;
 	}
 
-	return ChangeID();
+	// HERF files are only found inside NDS files
+	if (archive == kArchiveHERF) {
+		archives.push_back(new HERFFile(file));
+		return;
+	}
+
+	assert((archive >= 0) && (archive < kArchiveMAX));
+
+	if (archive == kArchiveBIF)
+		throw Common::Exception("Attempted to index a lone BIF");
+
+	Common::UString realName = findArchive(file, _archiveDirs[archive], _archiveFiles[archive]);
+	if (realName.empty())
+		throw Common::Exception("No such archive file \"%s\"", file.c_str());
+
+	if (archive == kArchiveKEY)
+		loadKEY(realName, archives);
+	else if (archive == kArchiveERF)
+		archives.push_back(new ERFFile(realName));
+	else if (archive == kArchiveRIM)
+		archives.push_back(new RIMFile(realName));
+	else if (archive == kArchiveZIP)
+		archives.push_back(new ZIPFile(realName));
+	else if (archive == kArchiveEXE)
+		archives.push_back(new PEFile(realName, _cursorRemap));
+}
+
+ResourceManager::ChangeID ResourceManager::indexArchives(std::vector<Archive *> &archives, uint32 priority) {
+	if (archives.empty())
+		return ChangeID();
+
+	ChangeID change = newChangeSet();
+
+	// The resource manager owns the archives from here on
+	std::vector<Archive *> toIndex;
+	toIndex.swap(archives);
+
+	for (std::vector<Archive *>::iterator archive = toIndex.begin(); archive != toIndex.end(); ++archive)
+		indexArchive(*archive, priority, change);
+
+	return change;
 }
 
-void ResourceManager::findBIFs(const KEYFile &key, std::vector<Common::UString> &bifs) {
+void ResourceManager::findBIFs(const KEYFile &key, std::vector<Common::UString> &bifs) const {
 	const KEYFile::BIFList &keyBIFs = key.getBIFs();
 
 	bifs.resize(keyBIFs.size());
@@ -312,7 +493,7 @@ void ResourceManager::findBIFs(const KEYFile &key, std::vector<Common::UString>
 }
 
 void ResourceManager::mergeKEYBIF(const KEYFile &key, std::vector<Common::UString> &bifs,
-		std::vector<BIFFile *> &bifFiles) {
+		std::vector<BIFFile *> &bifFiles) const {
 
 	bifFiles.reserve(bifs.size());
 
@@ -339,22 +520,193 @@ void ResourceManager::mergeKEYBIF(const KEYFile &key, std::vector<Common::UStrin
 
 }
 
-ResourceManager::ChangeID ResourceManager::indexKEY(const Common::UString &file, uint32 priority) {
-	KEYFile key(file);
-
-	// Search the correct BIFs
-	std::vector<Common::UString> bifs;
-	findBIFs(key, bifs);
+void ResourceManager::loadKEY(const Common::UString &file, std::vector<Archive *> &archives) const {
+	const uint64 startTime = Common::getMicroseconds();
 
 	std::vector<BIFFile *> bifFiles;
-	mergeKEYBIF(key, bifs, bifFiles);
 
-	ChangeID change = newChangeSet();
+	const bool cached = readKEYIndex(file, bifFiles);
+	if (!cached) {
+		KEYFile key(file);
 
-	for (std::vector<BIFFile *>::iterator bifFile = bifFiles.begin(); bifFile != bifFiles.end(); ++bifFile)
-		indexArchive(*bifFile, priority, change);
+		// Search the correct BIFs
+		std::vector<Common::UString> bifs;
+		findBIFs(key, bifs);
 
-	return change;
+		mergeKEYBIF(key, bifs, bifFiles);
+
+		writeKEYIndex(file, bifs, bifFiles);
+	}
+
+	archives.insert(archives.end(), bifFiles.begin(), bifFiles.end());
+
+	status("Loaded \"%s\"%s in %.3fms", Common::FilePath::getFile(file).c_str(),
+	       cached ? " from the cache" : "", (Common::getMicroseconds() - startTime) / 1000.0);
+}
+
+Common::UString ResourceManager::getIndexCacheFile(const Common::UString &key) const {
+	const uint64 hash = Common::hashString(Common::FilePath::makeAbsolute(key), Common::kHashFNV64);
+
+	return _indexCache + "/" + Common::UString::sprintf("%016llX.idx", (unsigned long long) hash);
+}
+
+/** Does the file still have the same size and modification time as when it was indexed? */
+static bool isFileUnchanged(const Common::UString &file, uint32 size, uint64 time) {
+	if (!Common::FilePath::isRegularFile(file))
+		return false;
+
+	return (Common::FilePath::getFileSize(file) == size) &&
+	       (Common::FilePath::getModificationTime(file) == time);
+}
+
+static void writeFileStamp(Common::WriteStream &index, const Common::UString &file) {
+	index.writeString(file);
+	index.writeByte(0);
+
+	index.writeUint32LE(Common::FilePath::getFileSize(file));
+	index.writeUint64LE(Common::FilePath::getModificationTime(file));
+}
+
+static bool readFileStamp(Common::SeekableReadStream &index, Common::UString &file) {
+	file.readUTF8(index);
+
+	const uint32 size = index.readUint32LE();
+	const uint64 time = index.readUint64LE();
+
+	return isFileUnchanged(file, size, time);
+}
+
+bool ResourceManager::readKEYIndex(const Common::UString &key, std::vector<BIFFile *> &bifFiles) const {
+	if (_indexCache.empty())
+		return false;
+
+	const Common::UString cacheFile = getIndexCacheFile(key);
+	if (!Common::FilePath::isRegularFile(cacheFile))
+		return false;
+
+	// Can't be a complete index, like an empty file left behind by a crash
+	const uint32 cacheSize = Common::FilePath::getFileSize(cacheFile);
+	if ((cacheSize == Common::kFileInvalid) || (cacheSize < kKEYIndexMinSize)) {
+		debugC(1, Common::kDebugResources, "Rejecting truncated index \"%s\" of \"%s\"",
+		       cacheFile.c_str(), key.c_str());
+		return false;
+	}
+
+	// Read the whole index in one go, directly from a mapping if possible
+	Common::SeekableReadStream *index = 0;
+
+	Common::MappedFilePtr mappedIndex = Common::mapFile(cacheFile);
+	if (mappedIndex) {
+		index = new Common::MappedReadStream(mappedIndex, 0, mappedIndex->size());
+	} else {
+		Common::File file;
+		if (!file.open(cacheFile))
+			return false;
+
+		index = file.readStream(file.size());
+	}
+
+	std::vector<BIFFile *> indexBIFs;
+
+	try {
+		if ((index->readUint32LE() != kKEYIndexID) || (index->readUint32LE() != kKEYIndexVersion))
+			throw Common::Exception("Not a KEY index");
+
+		Common::UString keyFile;
+		if (!readFileStamp(*index, keyFile) || (keyFile != key))
+			throw Common::Exception("KEY changed");
+
+		const uint32 bifCount = index->readUint32LE();
+		if (bifCount > ((uint32) index->size()))
+			throw Common::Exception("Invalid KEY index");
+
+		indexBIFs.reserve(bifCount);
+		for (uint32 i = 0; i < bifCount; i++) {
+			Common::UString bifFile;
+			if (!readFileStamp(*index, bifFile))
+				throw Common::Exception("BIF \"%s\" changed", bifFile.c_str());
+
+			indexBIFs.push_back(new BIFFile(bifFile, *index));
+		}
+
+		if (index->readUint32LE() != kKEYIndexID)
+			throw Common::Exception("Invalid KEY index");
+
+		if (index->err() || index->eos())
+			throw Common::Exception(Common::kReadError);
+
+	} catch (Common::Exception &e) {
+		for (std::vector<BIFFile *>::iterator bif = indexBIFs.begin(); bif != indexBIFs.end(); ++bif)
+			delete *bif;
+
+		delete index;
+
+		debugC(1, Common::kDebugResources, "Rejecting index \"%s\" of \"%s\": %s",
+		       cacheFile.c_str(), key.c_str(), e.what());
+		return false;
+	}
+
+	delete index;
+
+	bifFiles.insert(bifFiles.end(), indexBIFs.begin(), indexBIFs.end());
+	return true;
+}
+
+void ResourceManager::writeKEYIndex(const Common::UString &key, const std::vector<Common::UString> &bifs,
+		const std::vector<BIFFile *> &bifFiles) const {
+
+	if (_indexCache.empty() || (bifs.size() != bifFiles.size()))
+		return;
+
+	if (!Common::FilePath::createDirectories(_indexCache)) {
+		warning("Failed to create the index cache directory \"%s\"", _indexCache.c_str());
+		return;
+	}
+
+	const Common::UString cacheFile = getIndexCacheFile(key);
+
+	/* Write into a temporary file, and only replace the cache file once the
+	 * index is complete. A crash, or another instance reading or writing the
+	 * same index at the same time, never sees a partial file. */
+	const Common::UString tempFile = cacheFile + "." + Common::generateIDRandomString() + ".tmp";
+
+	Common::DumpFile index;
+	if (!index.open(tempFile)) {
+		warning("Failed to open the index cache file \"%s\"", tempFile.c_str());
+		return;
+	}
+
+	index.writeUint32LE(kKEYIndexID);
+	index.writeUint32LE(kKEYIndexVersion);
+
+	writeFileStamp(index, key);
+
+	index.writeUint32LE(bifFiles.size());
+	for (uint32 i = 0; i < bifFiles.size(); i++) {
+		writeFileStamp(index, bifs[i]);
+
+		bifFiles[i]->writeIndex(index);
+	}
+
+	// Mark the index as complete
+	index.writeUint32LE(kKEYIndexID);
+
+	const bool written = index.flush() && !index.err();
+
+	index.close();
+
+	if (!written) {
+		warning("Failed to write the index cache file \"%s\"", tempFile.c_str());
+
+		Common::FilePath::removeFile(tempFile);
+		return;
+	}
+
+	if (!Common::FilePath::renameFile(tempFile, cacheFile)) {
+		warning("Failed to replace the index cache file \"%s\"", cacheFile.c_str());
+
+		Common::FilePath::removeFile(tempFile);
+	}
 }
 
 ResourceManager::ChangeID ResourceManager::indexArchive(Archive *archive, uint32 priority, ChangeID &change) {
@@ -369,6 +721,8 @@ ResourceManager::ChangeID ResourceManager::indexArchive(Archive *archive, uint32
 	change._change->archives.push_back(--_archives.end());
 
 	const Archive::ResourceList &resources = archive->getResources();
+	reserveResources(resources.size());
+
 	for (Archive::ResourceList::const_iterator resource = resources.begin(); resource != resources.end(); ++resource) {
 		// Build the resource record
 		Resource res;
@@ -376,7 +730,8 @@ ResourceManager::ChangeID ResourceManager::indexArchive(Archive *archive, uint32
 		res.source       = kSourceArchive;
 		res.archive      = archive;
 		res.archiveIndex = resource->index;
-		res.name         = resource->name;
+		res.name         = resource->name.empty() ? Common::StringArena::kInvalidOffset :
+		                                                _names.intern(resource->name.c_str());
 		res.type         = resource->type;
 
 		// And add it to our list
@@ -394,6 +749,10 @@ ResourceManager::ChangeID ResourceManager::indexArchive(Archive *archive, uint32
 ResourceManager::ChangeID ResourceManager::addResourceDir(const Common::UString &dir,
 		const char *glob, int depth, uint32 priority) {
 
+	waitPrefetch();
+
+	const uint64 startTime = Common::getMicroseconds();
+
 	// Find the directory
 	Common::UString directory = Common::FilePath::findSubDirectory(_baseDir, dir, true);
 	if (directory.empty())
@@ -408,15 +767,20 @@ ResourceManager::ChangeID ResourceManager::addResourceDir(const Common::UString
 	if (!glob) {
 		// Add the files
 		addResources(files, change, priority);
-		return change;
+	} else {
+		// Find files matching the glob pattern
+		Common::FileList globFiles;
+		files.getSubList(glob, globFiles, true);
+
+		// Add the files
+		addResources(globFiles, change, priority);
 	}
 
-	// Find files matching the glob pattern
-	Common::FileList globFiles;
-	files.getSubList(glob, globFiles, true);
+	const uint64 time = Common::getMicroseconds() - startTime;
+	debugC(1, Common::kDebugResources, "Indexed directory \"%s\" in %.3fms", dir.c_str(), time / 1000.0);
+
+	_indexTime += time;
 
-	// Add the files
-	addResources(globFiles, change, priority);
 	return change;
 }
 
@@ -425,20 +789,20 @@ void ResourceManager::undo(ChangeID &change) {
 		// Nothing to do
 		return;
 
-	// Go through all changes in the resource map
-	for (std::list<ResourceChange>::iterator resChange = change._change->resources.begin();
-	     resChange != change._change->resources.end(); ++resChange) {
+	// Running prefetches might still read from the archives we're about to remove
+	waitPrefetch();
 
-		// Remove the resource, and the name list too if it's empty
-		resChange->hashIt->second.erase(resChange->resIt);
-		if (resChange->hashIt->second.empty())
-			_resources.erase(resChange->hashIt);
-	}
+	// Go through all changes in the resource index
+	for (std::vector<uint32>::const_iterator resChange = change._change->resources.begin();
+	     resChange != change._change->resources.end(); ++resChange)
+		removeResource(*resChange);
 
 	// Removing all changes in the archive list
 	for (std::list<ArchiveList::iterator>::iterator archiveChange = change._change->archives.begin();
 	     archiveChange != change._change->archives.end(); ++archiveChange) {
 
+		_cache.removeArchive(**archiveChange);
+
 		delete **archiveChange;
 		_archives.erase(*archiveChange);
 	}
@@ -456,22 +820,28 @@ void ResourceManager::addTypeAlias(FileType alias, FileType realType) {
 }
 
 void ResourceManager::blacklist(const Common::UString &name, FileType type) {
-	ResourceMap::iterator resList = _resources.find(getHash(name, type));
-	if (resList == _resources.end())
+	waitPrefetch();
+
+	const uint32 entry = findHashEntry(getHash(name, type));
+	if (entry == kResourceNone)
 		return;
 
-	for (ResourceList::iterator res = resList->second.begin(); res != resList->second.end(); ++res)
-		res->priority = 0;
+	for (uint32 r = _hashTable[entry].resource; r != kResourceNone; r = _resources[r].next)
+		_resources[r].priority = 0;
 }
 
 void ResourceManager::declareResource(const Common::UString &name, FileType type) {
-	ResourceMap::iterator resList = _resources.find(getHash(name, type));
-	if (resList == _resources.end())
+	waitPrefetch();
+
+	const uint32 entry = findHashEntry(getHash(name, type));
+	if (entry == kResourceNone)
 		return;
 
-	for (ResourceList::iterator r = resList->second.begin(); r != resList->second.end(); ++r) {
-		r->name = name;
-		r->type = type;
+	const uint32 nameOffset = _names.intern(name.c_str());
+
+	for (uint32 r = _hashTable[entry].resource; r != kResourceNone; r = _resources[r].next) {
+		_resources[r].name = nameOffset;
+		_resources[r].type = type;
 	}
 }
 
@@ -507,7 +877,7 @@ uint32 ResourceManager::getResourceSize(const Resource &res) const {
 	}
 
 	if (res.source == kSourceFile)
-		return Common::FilePath::getFileSize(res.path);
+		return Common::FilePath::getFileSize(_names.get(res.path));
 
 	return 0xFFFFFFFF;
 }
@@ -516,7 +886,19 @@ Common::SeekableReadStream *ResourceManager::getArchiveResource(const Resource &
 	if ((res.archive == 0) || (res.archiveIndex == 0xFFFFFFFF))
 		throw Common::Exception("Archive resource has no archive");
 
-	return res.archive->getResource(res.archiveIndex);
+	// Reading compressed resources is expensive, so keep them around decompressed
+	if (!res.archive->isResourceCompressed(res.archiveIndex))
+		return res.archive->getResource(res.archiveIndex);
+
+	Common::SeekableReadStream *stream = _cache.get(res.archive, res.archiveIndex);
+	if (stream)
+		return stream;
+
+	const uint64 startTime = Common::getMicroseconds();
+
+	stream = res.archive->getResource(res.archiveIndex);
+
+	return _cache.add(res.archive, res.archiveIndex, stream, Common::getMicroseconds() - startTime);
 }
 
 Common::SeekableReadStream *ResourceManager::getResource(const Common::UString &name, FileType type) const {
@@ -551,7 +933,7 @@ Common::SeekableReadStream *ResourceManager::getResource(const Common::UString &
 
 		Common::File *file = new Common::File;
 
-		if (!file->open(res->path)) {
+		if (!file->open(_names.get(res->path))) {
 			delete file;
 			return 0;
 		}
@@ -576,15 +958,156 @@ Common::SeekableReadStream *ResourceManager::getResource(ResourceType resType,
 	return 0;
 }
 
+ResourceManager::PrefetchID ResourceManager::prefetch(const std::list<ResourceID> &resources,
+		const PrefetchCallback &callback) {
+
+	std::vector<PrefetchJob> jobs;
+	jobs.reserve(resources.size());
+
+	if (_prefetchThreads > 0) {
+		// Look up all resources now, the I/O threads never touch the index
+		for (std::list<ResourceID>::const_iterator r = resources.begin(); r != resources.end(); ++r) {
+			const Resource *res = getRes(r->name, r->type);
+			if (!res)
+				continue;
+
+			PrefetchJob job;
+
+			job.archive      = 0;
+			job.archiveIndex = 0xFFFFFFFF;
+			job.compressed   = false;
+
+			if        (res->source == kSourceArchive) {
+				if ((res->archive == 0) || (res->archiveIndex == 0xFFFFFFFF))
+					continue;
+
+				job.archive      = res->archive;
+				job.archiveIndex = res->archiveIndex;
+				job.compressed   = res->archive->isResourceCompressed(res->archiveIndex);
+
+				// Already cached or being read by someone else
+				if (job.compressed && !_cache.reserve(job.archive, job.archiveIndex))
+					continue;
+
+			} else if (res->source == kSourceFile) {
+				job.path = _names.get(res->path);
+			} else
+				continue;
+
+			jobs.push_back(job);
+		}
+	}
+
+	boost::shared_ptr<PrefetchState> state(new PrefetchState(jobs.size(), callback));
+
+	if (jobs.empty()) {
+		if (callback)
+			callback();
+
+		return PrefetchID(state);
+	}
+
+	debugC(2, Common::kDebugResources, "Prefetching %u resources", (uint) jobs.size());
+
+	if (!_prefetchPool)
+		_prefetchPool = new Common::ThreadPool(_prefetchThreads);
+
+	for (std::vector<PrefetchJob>::iterator j = jobs.begin(); j != jobs.end(); ++j) {
+		j->state = state;
+
+		_prefetchPool->addJob(boost::bind(&ResourceManager::prefetchResource, this, *j));
+	}
+
+	return PrefetchID(state);
+}
+
+void ResourceManager::prefetchResource(const PrefetchJob &job) {
+	Common::SeekableReadStream *stream = 0;
+
+	try {
+		const uint64 startTime = Common::getMicroseconds();
+
+		if (job.archive) {
+			Common::SeekableReadStream *data = job.archive->getResource(job.archiveIndex);
+
+			if (job.compressed)
+				delete _cache.add(job.archive, job.archiveIndex, data, Common::getMicroseconds() - startTime);
+			else
+				stream = data;
+
+		} else {
+			Common::File *file = new Common::File;
+			if (file->open(job.path))
+				stream = file;
+			else
+				delete file;
+		}
+
+		// Read through the whole resource once, pulling its data into memory
+		if (stream) {
+			byte buffer[4096];
+			while (stream->read(buffer, sizeof(buffer)) == sizeof(buffer))
+				;
+		}
+
+	} catch (Common::Exception &e) {
+		// A failed prefetch isn't fatal; the resource will just be read again when needed
+		debugC(1, Common::kDebugResources, "Failed prefetching resource: %s", e.what());
+	} catch (...) {
+	}
+
+	delete stream;
+
+	if (job.compressed)
+		_cache.release(job.archive, job.archiveIndex);
+
+	PrefetchCallback callback;
+
+	{
+		Common::StackLock lock(job.state->mutex);
+
+		if (--job.state->pending > 0)
+			return;
+
+		job.state->done.broadcast();
+
+		callback = job.state->callback;
+	}
+
+	if (callback)
+		callback();
+}
+
+void ResourceManager::waitPrefetch() {
+	if (_prefetchPool)
+		_prefetchPool->wait();
+}
+
+void ResourceManager::setPrefetchThreads(uint32 count) {
+	if (count == _prefetchThreads)
+		return;
+
+	waitPrefetch();
+
+	delete _prefetchPool;
+	_prefetchPool = 0;
+
+	_prefetchThreads = count;
+}
+
 void ResourceManager::getAvailableResources(FileType type,
 		std::list<ResourceID> &list) const {
 
-	for (ResourceMap::const_iterator r = _resources.begin(); r != _resources.end(); ++r) {
-		if (!r->second.empty() && (r->second.front().type == type)) {
+	for (HashTable::const_iterator h = _hashTable.begin(); h != _hashTable.end(); ++h) {
+		if ((h->resource == kResourceNone) || (h->resource == kResourceDeleted))
+			continue;
+
+		const Resource &res = _resources[h->resource];
+		if (res.type == type) {
 			list.push_back(ResourceID());
 
-			list.back().name = r->second.front().name;
-			list.back().type = r->second.front().type;
+			list.back().name = _names.get(res.name);
+			list.back().type = res.type;
 		}
 	}
 }
@@ -592,13 +1115,17 @@ void ResourceManager::getAvailableResources(FileType type,
 void ResourceManager::getAvailableResources(const std::vector<FileType> &types,
 		std::list<ResourceID> &list) const {
 
-	for (ResourceMap::const_iterator r = _resources.begin(); r != _resources.end(); ++r) {
+	for (HashTable::const_iterator h = _hashTable.begin(); h != _hashTable.end(); ++h) {
+		if ((h->resource == kResourceNone) || (h->resource == kResourceDeleted))
+			continue;
+
+		const Resource &res = _resources[h->resource];
 		for (std::vector<FileType>::const_iterator t = types.begin(); t != types.end(); ++t) {
-			if (!r->second.empty() && (r->second.front().type == *t)) {
+			if (res.type == *t) {
 				list.push_back(ResourceID());
 
-				list.back().name = r->second.front().name;
-				list.back().type = r->second.front().type;
+				list.back().name = _names.get(res.name);
+				list.back().type = res.type;
 			}
 		}
 
@@ -611,6 +1138,20 @@ void ResourceManager::getAvailableResources(ResourceType type,
 	getAvailableResources(_resourceTypeTypes[type], list);
 }
 
+void ResourceManager::getAvailableResources(std::list<ResourceID> &list) const {
+	for (HashTable::const_iterator h = _hashTable.begin(); h != _hashTable.end(); ++h) {
+		if ((h->resource == kResourceNone) || (h->resource == kResourceDeleted))
+			continue;
+
+		const Resource &res = _resources[h->resource];
+
+		list.push_back(ResourceID());
+
+		list.back().name = _names.get(res.name);
+		list.back().type = res.type;
+	}
+}
+
 void ResourceManager::normalizeType(Resource &resource) {
 	// Normalize resource type *sigh*
 	if      (resource.type == kFileTypeQST2)
@@ -638,18 +1179,18 @@ inline uint64 ResourceManager::getHash(Common::UString name) const {
 	return Common::hashString(name, _hashAlgo);
 }
 
-void ResourceManager::checkHashCollision(const Resource &resource, ResourceMap::const_iterator resList) {
-	if (resource.name.empty() || resList->second.empty())
+void ResourceManager::checkHashCollision(const Resource &resource, uint32 first) {
+	if (resource.name == Common::StringArena::kInvalidOffset)
 		return;
 
-	Common::UString newName = TypeMan.setFileType(resource.name, resource.type);
+	Common::UString newName = TypeMan.setFileType(_names.get(resource.name), resource.type);
 	newName.tolower();
 
-	for (ResourceList::const_iterator r = resList->second.begin(); r != resList->second.end(); ++r) {
-		if (r->name.empty())
+	for (uint32 r = first; r != kResourceNone; r = _resources[r].next) {
+		if (_resources[r].name == Common::StringArena::kInvalidOffset)
 			continue;
 
-		Common::UString oldName = TypeMan.setFileType(r->name, r->type);
+		Common::UString oldName = TypeMan.setFileType(_names.get(_resources[r].name), _resources[r].type);
 		oldName.tolower();
 
 		if (oldName != newName) {
@@ -660,32 +1201,161 @@ void ResourceManager::checkHashCollision(const Resource &resource, ResourceMap::
 	}
 }
 
-void ResourceManager::addResource(Resource &resource, uint64 hash, ChangeID &change) {
-	normalizeType(resource);
+/** Map a hashed name onto a hash table slot. */
+static inline uint32 getHashSlot(uint64 hash, uint32 mask) {
+	// Mix all bits of the hash into the lower ones, to be safe against weaker name hashes
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDLL;
+	hash ^= hash >> 33;
+
+	return ((uint32) hash) & mask;
+}
+
+uint32 ResourceManager::findHashEntry(uint64 hash) const {
+	if (_hashTable.empty())
+		return kResourceNone;
+
+	const uint32 mask = _hashTable.size() - 1;
+
+	for (uint32 slot = getHashSlot(hash, mask); ; slot = (slot + 1) & mask) {
+		const HashEntry &entry = _hashTable[slot];
+
+		if (entry.resource == kResourceNone)
+			return kResourceNone;
+
+		if ((entry.resource != kResourceDeleted) && (entry.hash == hash))
+			return slot;
+	}
+}
+
+uint32 ResourceManager::addHashEntry(uint64 hash) {
+	const uint32 entry = findHashEntry(hash);
+	if (entry != kResourceNone)
+		return entry;
+
+	// Keep the table at most half full, deleted entries included
+	if (((_hashUsed + 1) * 2) > _hashTable.size())
+		rehash(NEXTPOWER2((_hashCount + 1) * 2));
+
+	const uint32 mask = _hashTable.size() - 1;
+
+	uint32 slot = getHashSlot(hash, mask);
+	while ((_hashTable[slot].resource != kResourceNone) && (_hashTable[slot].resource != kResourceDeleted))
+		slot = (slot + 1) & mask;
+
+	if (_hashTable[slot].resource == kResourceNone)
+		_hashUsed++;
+
+	_hashTable[slot].hash     = hash;
+	_hashTable[slot].resource = kResourceNone;
+
+	_hashCount++;
+
+	return slot;
+}
+
+void ResourceManager::removeHashEntry(uint32 entry) {
+	_hashTable[entry].resource = kResourceDeleted;
+
+	_hashCount--;
+}
+
+void ResourceManager::rehash(uint32 size) {
+	size = MAX<uint32>(size, 64);
+
+	HashTable table(size);
+	for (HashTable::iterator h = table.begin(); h != table.end(); ++h) {
+		h->hash     = 0;
+		h->resource = kResourceNone;
+	}
+
+	const uint32 mask = size - 1;
+
+	for (HashTable::const_iterator h = _hashTable.begin(); h != _hashTable.end(); ++h) {
+		if ((h->resource == kResourceNone) || (h->resource == kResourceDeleted))
+			continue;
 
-	ResourceMap::iterator resList = _resources.find(hash);
-	if (resList == _resources.end()) {
-		// We don't have a resource with this name yet, create a new resource list for it
+		uint32 slot = getHashSlot(h->hash, mask);
+		while (table[slot].resource != kResourceNone)
+			slot = (slot + 1) & mask;
 
-		std::pair<ResourceMap::iterator, bool> result;
+		table[slot] = *h;
+	}
+
+	_hashTable.swap(table);
+
+	_hashUsed = _hashCount;
+}
+
+void ResourceManager::reserveResources(uint32 count) {
+	const uint32 needed = _resources.size() - _freeResources.size() + count;
+	if (needed > _resources.capacity())
+		_resources.reserve(needed);
 
-		result = _resources.insert(std::make_pair(hash, ResourceList()));
+	// Reserve for the worst case of all resources having distinct names
+	if (((_hashCount + count) * 2) > _hashTable.size())
+		rehash(NEXTPOWER2((_hashCount + count) * 2));
+}
+
+uint32 ResourceManager::allocResource() {
+	if (!_freeResources.empty()) {
+		const uint32 index = _freeResources.back();
+		_freeResources.pop_back();
 
-		resList = result.first;
+		return index;
 	}
 
+	_resources.push_back(Resource());
+
+	return _resources.size() - 1;
+}
+
+void ResourceManager::removeResource(uint32 index) {
+	const uint32 entry = findHashEntry(_resources[index].hash);
+	if (entry == kResourceNone)
+		return;
+
+	// Unlink the resource from its hash's resource chain
+	uint32 *link = &_hashTable[entry].resource;
+	while ((*link != kResourceNone) && (*link != index))
+		link = &_resources[*link].next;
+
+	if (*link == index)
+		*link = _resources[index].next;
+
+	// Remove the hash if that was the last resource with it
+	if (_hashTable[entry].resource == kResourceNone)
+		removeHashEntry(entry);
+
+	_resources[index] = Resource();
+	_freeResources.push_back(index);
+}
+
+void ResourceManager::addResource(Resource &resource, uint64 hash, ChangeID &change) {
+	normalizeType(resource);
+
+	resource.hash = hash;
+
+	const uint32 entry = addHashEntry(hash);
+
 #ifdef CHECK_HASH_COLLISION
-	checkHashCollision(resource, resList);
+	checkHashCollision(resource, _hashTable[entry].resource);
 #endif
 
-	// Add the resource to the list and sort by priority
-	resList->second.push_back(resource);
-	resList->second.sort();
+	const uint32 index = allocResource();
+
+	// Find the resource's place in the chain, sorted by priority. Of resources with
+	// the same priority, the one added last takes precedence.
+	uint32 *link = &_hashTable[entry].resource;
+	while ((*link != kResourceNone) && (_resources[*link].priority > resource.priority))
+		link = &_resources[*link].next;
+
+	resource.next     = *link;
+	_resources[index] = resource;
+	*link             = index;
 
 	// Remember the resource in the change set
-	change._change->resources.push_back(ResourceChange());
-	change._change->resources.back().hashIt = resList;
-	change._change->resources.back().resIt  = --resList->second.end();
+	change._change->resources.push_back(index);
 }
 
 void ResourceManager::addResource(Resource &resource, const Common::UString &name, ChangeID &change) {
@@ -696,12 +1366,14 @@ void ResourceManager::addResource(Resource &resource, const Common::UString &nam
 }
 
 void ResourceManager::addResources(const Common::FileList &files, ChangeID &change, uint32 priority) {
+	reserveResources(files.size());
+
 	for (Common::FileList::const_iterator file = files.begin(); file != files.end(); ++file) {
 		Resource res;
 		res.priority = priority;
 		res.source   = kSourceFile;
-		res.path     = *file;
-		res.name     = Common::FilePath::getStem(*file);
+		res.path     = _names.intern(file->c_str());
+		res.name     = _names.intern(Common::FilePath::getStem(*file).c_str());
 		res.type     = TypeMan.getFileType(*file);
 
 		addResource(res, Common::FilePath::getFile(*file), change);
@@ -709,11 +1381,15 @@ void ResourceManager::addResources(const Common::FileList &files, ChangeID &chan
 }
 
 const ResourceManager::Resource *ResourceManager::getRes(uint64 hash) const {
-	ResourceMap::const_iterator r = _resources.find(hash);
-	if ((r == _resources.end()) || r->second.empty() || (r->second.back().priority == 0))
+	const uint32 entry = findHashEntry(hash);
+	if (entry == kResourceNone)
 		return 0;
 
-	return &r->second.back();
+	const Resource &res = _resources[_hashTable[entry].resource];
+	if (res.priority == 0)
+		return 0;
+
+	return &res;
 }
 
 const ResourceManager::Resource *ResourceManager::getRes(const Common::UString &name,
@@ -734,6 +1410,10 @@ const ResourceManager::Resource *ResourceManager::getRes(const Common::UString &
 	return getRes(name, types);
 }
 
+bool ResourceManager::compareHashEntries(const HashEntry &a, const HashEntry &b) {
+	return a.hash < b.hash;
+}
+
 void ResourceManager::dumpResourcesList(const Common::UString &fileName) const {
 	Common::DumpFile file;
 
@@ -743,15 +1423,22 @@ void ResourceManager::dumpResourcesList(const Common::UString &fileName) const {
 	file.writeString("                Name                 |        Hash        |     Size    \n");
 	file.writeString("-------------------------------------|--------------------|-------------\n");
 
-	for (ResourceMap::const_iterator r = _resources.begin(); r != _resources.end(); ++r) {
-		if (r->second.empty())
-			continue;
+	// Sort the resources by hash, for a stable output
+	std::vector<HashEntry> entries;
+	entries.reserve(_hashCount);
 
-		const Resource &res = r->second.back();
+	for (HashTable::const_iterator h = _hashTable.begin(); h != _hashTable.end(); ++h)
+		if ((h->resource != kResourceNone) && (h->resource != kResourceDeleted))
+			entries.push_back(*h);
 
-		const Common::UString &name = res.name;
+	std::sort(entries.begin(), entries.end(), compareHashEntries);
+
+	for (std::vector<HashEntry>::const_iterator e = entries.begin(); e != entries.end(); ++e) {
+		const Resource &res = _resources[e->resource];
+
+		const Common::UString  name = _names.get(res.name);
 		const Common::UString   ext = TypeMan.setFileType("", res.type);
-		const uint64           hash = r->first;
+		const uint64           hash = e->hash;
 		const uint32           size = getResourceSize(res);
 
 		const Common::UString line =
@@ -769,6 +1456,31 @@ void ResourceManager::dumpResourcesList(const Common::UString &fileName) const {
 	file.close();
 }
 
+void ResourceManager::getIndexStats(IndexStats &stats) const {
+	stats.resourceCount = _resources.size() - _freeResources.size();
+	stats.hashCount     = _hashCount;
+	stats.hashTableSize = _hashTable.size();
+	stats.nameCount     = _names.getStringCount();
+	stats.indexTime     = _indexTime;
+
+	stats.memoryUsage = _resources.capacity()     * sizeof(Resource) +
+	                    _freeResources.capacity() * sizeof(uint32)   +
+	                    _hashTable.capacity()     * sizeof(HashEntry) +
+	                    _names.getMemoryUsage();
+}
+
+void ResourceManager::setCacheSize(uint32 size) {
+	_cache.setMaxSize(size);
+}
+
+ResourceCache::Stats ResourceManager::getCacheStats() const {
+	return _cache.getStats();
+}
+
+void ResourceManager::resetCacheStats() {
+	_cache.resetStats();
+}
+
 ResourceManager::ChangeID ResourceManager::newChangeSet() {
 	// Generate a new change set
 
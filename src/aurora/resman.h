@@ -35,16 +35,23 @@
 #include <vector>
 #include <map>
 
+#include <boost/shared_ptr.hpp>
+#include <boost/function.hpp>
+
 #include "common/types.h"
 #include "common/ustring.h"
+#include "common/error.h"
 #include "common/singleton.h"
 #include "common/filelist.h"
 #include "common/hash.h"
+#include "common/stringarena.h"
 
 #include "aurora/types.h"
+#include "aurora/rescache.h"
 
 namespace Common {
 	class SeekableReadStream;
+	class ThreadPool;
 }
 
 namespace Aurora {
@@ -74,8 +81,9 @@ private:
 
 	/** A resource. */
 	struct Resource {
-		Common::UString name; ///< The resource's name.
-		FileType        type; ///< The resource's type.
+		uint64   hash; ///< The resource's hashed name.
+		uint32   name; ///< The resource's name, as an offset into the name arena.
+		FileType type; ///< The resource's type.
 
 		uint32 priority; ///< The resource's priority over others with the same name and type.
 
@@ -86,32 +94,48 @@ private:
 		uint32   archiveIndex; ///< Index into the archive.
 
 		// For kSourceFile
-		Common::UString path; ///< The file's path.
+		uint32 path; ///< The file's path, as an offset into the name arena.
 
-		Resource();
+		/** Index of the next resource with the same hash, but a lower priority. */
+		uint32 next;
 
-		bool operator<(const Resource &right) const;
+		Resource();
 	};
 
-	/** List of resources, sorted by priority. */
-	typedef std::list<Resource> ResourceList;
-	/** Map over resources, indexed by their hashed name. */
-	typedef std::map<uint64, ResourceList> ResourceMap;
+	/** All resources, in one contiguous block. */
+	typedef std::vector<Resource> ResourcePool;
 
-	/** A change produced by a manager operation. */
-	struct ResourceChange {
-		ResourceMap::iterator  hashIt;
-		ResourceList::iterator resIt;
+	/** An entry in the resource hash table. */
+	struct HashEntry {
+		uint64 hash;     ///< The hashed name.
+		uint32 resource; ///< Index of the highest priority resource with this hash.
 	};
 
+	/** Open-addressing hash table over the resources, indexed by their hashed name. */
+	typedef std::vector<HashEntry> HashTable;
+
 	/** A set of changes produced by a manager operation. */
 	struct ChangeSet {
-		std::list<ArchiveList::iterator> archives;
-		std::list<ResourceChange>        resources;
+		std::list<ArchiveList::iterator> archives;  ///< The added archives.
+		std::vector<uint32>              resources; ///< The added resources' pool indices.
 	};
 
 	typedef std::list<ChangeSet> ChangeSetList;
 
+	/** The shared state of a prefetch operation. */
+	struct PrefetchState;
+
+	/** A resource to be read by a prefetch operation. */
+	struct PrefetchJob {
+		Archive *archive;      ///< The archive the resource is in, or 0 for a direct file.
+		uint32   archiveIndex; ///< Index into the archive.
+		bool     compressed;   ///< Should the resource be decompressed into the cache?
+
+		Common::UString path; ///< The file's path, for direct files.
+
+		boost::shared_ptr<PrefetchState> state;
+	};
+
 public:
 	struct ResourceID {
 		Common::UString name;
@@ -136,6 +160,29 @@ public:
 		friend class ResourceManager;
 	};
 
+	/** Called once all resources of a prefetch operation have been read. */
+	typedef boost::function<void ()> PrefetchCallback;
+
+	/** ID of a prefetch operation. */
+	class PrefetchID {
+	public:
+		PrefetchID();
+
+		bool empty() const;
+
+		/** Have all resources of the prefetch operation been read? */
+		bool isDone() const;
+		/** Wait until all resources of the prefetch operation have been read. */
+		void wait() const;
+
+	private:
+		PrefetchID(const boost::shared_ptr<PrefetchState> &state);
+
+		boost::shared_ptr<PrefetchState> _state;
+
+		friend class ResourceManager;
+	};
+
 	ResourceManager();
 	~ResourceManager();
 
@@ -151,6 +198,15 @@ public:
 	/** Set the array used to map cursor ID to cursor names. */
 	void setCursorRemap(const std::vector<Common::UString> &remap);
 
+	/** Set the directory the indices of KEY files are cached in.
+	 *
+	 *  A KEY file whose cached index is still valid, i.e. neither the KEY
+	 *  nor any of its BIFs changed, does not need to be parsed again.
+	 *
+	 *  @param directory The cache directory. An empty one disables the cache.
+	 */
+	void setIndexCache(const Common::UString &directory);
+
 	/** Register a path to be the base data directory.
 	 *
 	 *  @param path The path to a base data directory.
@@ -184,6 +240,36 @@ public:
 	 */
 	ChangeID addArchive(ArchiveType archive, const Common::UString &file, uint32 priority = 1);
 
+	/** An archive file to be added as part of a batch. */
+	struct BatchArchive {
+		ArchiveType     type;     ///< The type of archive to add.
+		Common::UString file;     ///< The name of the archive file to index.
+		uint32          priority; ///< The priority of the archive's resources.
+		bool            optional; ///< Silently skip the archive if it can't be added?
+
+		ChangeID change; ///< The collective changes done by adding the archive file.
+		bool     added;  ///< Was the archive file added?
+
+		BatchArchive(ArchiveType t, const Common::UString &f, uint32 p = 1, bool o = false);
+	};
+
+	typedef std::vector<BatchArchive> ArchiveBatch;
+
+	/** Add a batch of archive files and all their resources to the resource manager.
+	 *
+	 *  The archive files are read in parallel, but indexed in the order they
+	 *  appear in the batch. The result is the same as calling addArchive()
+	 *  on each of them in turn.
+	 *
+	 *  If a non-optional archive can't be added, an exception is thrown, after
+	 *  all the archives preceding it in the batch have been added.
+	 *
+	 *  @param batch The archives to add.
+	 *  @param threadCount The number of threads to read the archives with.
+	 *                     0 means one for each available processor core.
+	 */
+	void addArchives(ArchiveBatch &batch, uint32 threadCount = 0);
+
 	/** Add a directory's contents to the resource manager.
 	 *
 	 *  Relative to the base directory.
@@ -296,6 +382,32 @@ public:
 	Common::SeekableReadStream *getResource(ResourceType resType,
 			const Common::UString &name, FileType *foundType = 0) const;
 
+	/** Read resources in the background, ahead of them being needed.
+	 *
+	 *  The resources are looked up immediately, and then read by a pool of
+	 *  I/O threads. Compressed resources are decompressed into the resource
+	 *  cache; a getResource() call for a resource still being read waits for
+	 *  it to finish. Other resources are read through once, so that their
+	 *  data is in memory by the time they're needed.
+	 *
+	 *  Changing the resources the manager knows about, by adding or removing
+	 *  archives and directories, waits for all prefetch operations to finish.
+	 *
+	 *  @param  resources The resources to read. Unknown ones are ignored.
+	 *  @param  callback Called once all resources have been read, from one of
+	 *                   the I/O threads. If there's nothing to read, it's called
+	 *                   immediately.
+	 *  @return An ID for the prefetch operation.
+	 */
+	PrefetchID prefetch(const std::list<ResourceID> &resources,
+	                    const PrefetchCallback &callback = PrefetchCallback());
+
+	/** Wait until all prefetch operations have finished. */
+	void waitPrefetch();
+
+	/** Set the number of I/O threads used for prefetching. 0 disables prefetching. */
+	void setPrefetchThreads(uint32 count);
+
 	/** Return a list of all available resources of the specified type. */
 	void getAvailableResources(FileType type, std::list<ResourceID> &list) const;
 	/** Return a list of all available resources of the specified type. */
@@ -303,9 +415,33 @@ public:
 	/** Return a list of all available resources of the specified type. */
 	void getAvailableResources(ResourceType type, std::list<ResourceID> &list) const;
 
+	/** Return a list of all available resources. */
+	void getAvailableResources(std::list<ResourceID> &list) const;
+
 	/** Dump a list of all resources into a file. */
 	void dumpResourcesList(const Common::UString &fileName) const;
 
+	/** Statistics about the resource index. */
+	struct IndexStats {
+		uint32 resourceCount; ///< Number of indexed resources.
+		uint32 hashCount;     ///< Number of distinct hashed names.
+		uint32 hashTableSize; ///< Number of slots in the hash table.
+		uint32 nameCount;     ///< Number of distinct interned names and paths.
+		uint32 memoryUsage;   ///< Number of bytes used by the index.
+		uint64 indexTime;     ///< Total time spent building the index, in microseconds.
+	};
+
+	/** Return statistics about the resource index. */
+	void getIndexStats(IndexStats &stats) const;
+
+	/** Set the number of bytes of decompressed resources that may be cached. */
+	void setCacheSize(uint32 size);
+
+	/** Return statistics about the decompressed resource cache. */
+	ResourceCache::Stats getCacheStats() const;
+	/** Reset the statistics about the decompressed resource cache. */
+	void resetCacheStats();
+
 private:
 	bool _rimsAreERFs; ///< Are .rim files actually ERF files?
 
@@ -315,6 +451,8 @@ private:
 
 	Common::UString _baseDir;     ///< The data base directory.
 
+	Common::UString _indexCache; ///< The directory KEY indices are cached in.
+
 	DirectoryList    _archiveDirs [kArchiveMAX]; ///< Archive directories.
 	Common::FileList _archiveFiles[kArchiveMAX]; ///< Archive files.
 
@@ -322,7 +460,21 @@ private:
 
 	std::map<FileType, FileType> _typeAliases;
 
-	ResourceMap _resources;
+	ResourcePool        _resources;     ///< All resources.
+	std::vector<uint32> _freeResources; ///< Unused slots in the resource pool.
+
+	HashTable _hashTable; ///< The resource hash table.
+	uint32    _hashCount; ///< Number of hash table entries in use.
+	uint32    _hashUsed;  ///< Number of hash table entries in use or deleted.
+
+	Common::StringArena _names; ///< All resource names and paths.
+
+	uint64 _indexTime; ///< Total time spent building the index, in microseconds.
+
+	mutable ResourceCache _cache; ///< Decompressed resources.
+
+	uint32 _prefetchThreads;           ///< Number of I/O threads used for prefetching.
+	Common::ThreadPool *_prefetchPool; ///< The I/O threads used for prefetching.
 
 	ChangeSetList _changes;
 
@@ -332,20 +484,52 @@ private:
 	void clearResources();
 
 	Common::UString findArchive(const Common::UString &file,
-			const DirectoryList &dirs, const Common::FileList &files);
+			const DirectoryList &dirs, const Common::FileList &files) const;
+
+	/** The result of loading an archive, ready to be indexed. */
+	struct LoadedArchive {
+		std::vector<Archive *> archives; ///< The archive, or all BIFs of a KEY.
+
+		bool failed;            ///< Did loading the archive fail?
+		Common::Exception error; ///< Why did loading the archive fail?
+
+		LoadedArchive();
+	};
+
+	ChangeID openArchive(ArchiveType archive, const Common::UString &file, uint32 priority);
 
-	ChangeID indexKEY(const Common::UString &file, uint32 priority);
+	void loadArchive(ArchiveType archive, const Common::UString &file, std::vector<Archive *> &archives) const;
+	void loadKEY(const Common::UString &file, std::vector<Archive *> &archives) const;
+	void loadBatchArchive(const BatchArchive &archive, LoadedArchive &loaded) const;
+
+	ChangeID indexArchives(std::vector<Archive *> &archives, uint32 priority);
 	ChangeID indexArchive(Archive *archive, uint32 priority, ChangeID &change);
 
 	// KEY/BIF loading helpers
-	void findBIFs   (const KEYFile &key, std::vector<Common::UString> &bifs);
-	void mergeKEYBIF(const KEYFile &key, std::vector<Common::UString> &bifs, std::vector<BIFFile *> &bifFiles);
+	void findBIFs   (const KEYFile &key, std::vector<Common::UString> &bifs) const;
+	void mergeKEYBIF(const KEYFile &key, std::vector<Common::UString> &bifs, std::vector<BIFFile *> &bifFiles) const;
+
+	// KEY index cache helpers
+	Common::UString getIndexCacheFile(const Common::UString &key) const;
+	bool readKEYIndex(const Common::UString &key, std::vector<BIFFile *> &bifFiles) const;
+	void writeKEYIndex(const Common::UString &key, const std::vector<Common::UString> &bifs,
+	                   const std::vector<BIFFile *> &bifFiles) const;
 
 	void normalizeType(Resource &resource);
 
 	inline uint64 getHash(const Common::UString &name, FileType type) const;
 	inline uint64 getHash(Common::UString name) const;
 
+	// Resource hash table helpers
+	uint32 findHashEntry(uint64 hash) const;
+	uint32 addHashEntry(uint64 hash);
+	void   removeHashEntry(uint32 entry);
+	void   rehash(uint32 size);
+
+	void   reserveResources(uint32 count);
+	uint32 allocResource();
+	void   removeResource(uint32 index);
+
 	void addResource(Resource &resource, uint64 hash, ChangeID &change);
 	void addResource(Resource &resource, const Common::UString &name, ChangeID &change);
 
@@ -357,11 +541,15 @@ private:
 
 	Common::SeekableReadStream *getArchiveResource(const Resource &res) const;
 
+	void prefetchResource(const PrefetchJob &job);
+
 	uint32 getResourceSize(const Resource &res) const;
 
 	ChangeID newChangeSet();
 
-	void checkHashCollision(const Resource &resource, ResourceMap::const_iterator resList);
+	void checkHashCollision(const Resource &resource, uint32 first);
+
+	static bool compareHashEntries(const HashEntry &a, const HashEntry &b);
 };
 
 } // End of namespace Aurora
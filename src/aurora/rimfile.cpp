@@ -29,6 +29,8 @@
 
 #include "common/stream.h"
 #include "common/util.h"
+#include "common/file.h"
+#include "common/filepool.h"
 
 #include "aurora/rimfile.h"
 #include "aurora/error.h"
@@ -40,9 +42,13 @@ namespace Aurora {
 
 RIMFile::RIMFile(const Common::UString &fileName) : _fileName(fileName) {
 	load();
+
+	// Map the whole RIM into memory, so resources can be read without copying
+	_mappedFile = Common::mapFile(_fileName);
 }
 
 RIMFile::~RIMFile() {
+	FilePool.close(_fileName);
 }
 
 void RIMFile::clear() {
@@ -122,20 +128,10 @@ Common::SeekableReadStream *RIMFile::getResource(uint32 index) const {
 	if (res.size == 0)
 		return new Common::MemoryReadStream(0, 0);
 
-	Common::File rim;
-	open(rim);
-
-	if (!rim.seek(res.offset))
-		throw Common::Exception(Common::kSeekError);
-
-	Common::SeekableReadStream *resStream = rim.readStream(res.size);
-
-	if (!resStream || (((uint32) resStream->size()) != res.size)) {
-		delete resStream;
-		throw Common::Exception(Common::kReadError);
-	}
+	if (_mappedFile)
+		return new Common::MappedReadStream(_mappedFile, res.offset, res.size);
 
-	return resStream;
+	return FilePool.readStream(_fileName, res.offset, res.size);
 }
 
 void RIMFile::open(Common::File &file) const {
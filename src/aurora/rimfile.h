@@ -33,6 +33,7 @@
 #include <vector>
 
 #include "common/types.h"
+#include "common/mappedfile.h"
 #include "common/ustring.h"
 #include "common/file.h"
 
@@ -83,6 +84,9 @@ private:
 	/** The name of the RIM file. */
 	Common::UString _fileName;
 
+	/** The RIM file mapped into memory, if possible. */
+	Common::MappedFilePtr _mappedFile;
+
 	void open(Common::File &file) const;
 
 	void load();
@@ -121,11 +121,12 @@ const Common::UString &TalkManager::getString(uint32 strRef, Gender gender) {
 	if (strRef == kStrRefInvalid)
 		return kEmptyString;
 
-	const TalkTable::Entry *entry = getEntry(strRef, gender);
-	if (!entry)
+	const TalkTable::Entry *entry = 0;
+	const TalkTable *table = findTable(strRef, gender, entry);
+	if (!table)
 		return kEmptyString;
 
-	return entry->text;
+	return table->getText(*entry);
 }
 
 const Common::UString &TalkManager::getSoundResRef(uint32 strRef, Gender gender) {
@@ -136,14 +137,16 @@ const Common::UString &TalkManager::getSoundResRef(uint32 strRef, Gender gender)
 	if (strRef == kStrRefInvalid)
 		return kEmptyString;
 
-	const TalkTable::Entry *entry = getEntry(strRef, gender);
-	if (!entry)
+	const TalkTable::Entry *entry = 0;
+	const TalkTable *table = findTable(strRef, gender, entry);
+	if (!table)
 		return kEmptyString;
 
-	return entry->soundResRef;
+	return table->getSoundResRef(*entry);
 }
 
-const TalkTable::Entry *TalkManager::getEntry(uint32 strRef, Gender gender) {
+const TalkTable *TalkManager::findTable(uint32 strRef, Gender gender,
+                                        const TalkTable::Entry *&entry) const {
 	if (strRef == 0xFFFFFFFF)
 		return 0;
 
@@ -151,22 +154,21 @@ const TalkTable::Entry *TalkManager::getEntry(uint32 strRef, Gender gender) {
 
 	strRef &= 0x00FFFFFF;
 
-	const TalkTable::Entry *entry = 0;
 	if (alt) {
-		if ((gender == kGenderFemale) && _altTableF)
-			entry = _altTableF->getEntry(strRef);
+		if ((gender == kGenderFemale) && _altTableF && (entry = _altTableF->getEntry(strRef)))
+			return _altTableF;
 
-		if (!entry && _altTableM)
-			entry = _altTableM->getEntry(strRef);
+		if (_altTableM && (entry = _altTableM->getEntry(strRef)))
+			return _altTableM;
 	}
 
-	if (!entry && (gender == kGenderFemale) && _mainTableF)
-		entry = _mainTableF->getEntry(strRef);
+	if ((gender == kGenderFemale) && _mainTableF && (entry = _mainTableF->getEntry(strRef)))
+		return _mainTableF;
 
-	if (!entry && _mainTableM)
-		entry = _mainTableM->getEntry(strRef);
+	if (_mainTableM && (entry = _mainTableM->getEntry(strRef)))
+		return _mainTableM;
 
-	return entry;
+	return 0;
 }
 
 } // End of namespace Aurora
@@ -72,7 +72,8 @@ private:
 	TalkTable *_altTableM;
 	TalkTable *_altTableF;
 
-	const TalkTable::Entry *getEntry(uint32 strRef, Gender gender);
+	/** Find the talk table holding the string, and the string's entry within it. */
+	const TalkTable *findTable(uint32 strRef, Gender gender, const TalkTable::Entry *&entry) const;
 
 	void addTable(const Common::UString &name, TalkTable *&m, TalkTable *&f);
 };
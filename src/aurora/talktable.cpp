@@ -27,6 +27,8 @@
  *  Handling BioWare's TLKs (talk tables).
  */
 
+#include <cstring>
+
 #include "common/stream.h"
 #include "common/util.h"
 
@@ -39,18 +41,61 @@ static const uint32 kVersion4  = MKTAG('V', '4', '.', '0');
 
 namespace Aurora {
 
-TalkTable::TalkTable(Common::SeekableReadStream *tlk) : _tlk(tlk), _stringsOffset(0) {
+/** Decode a Latin-9 (ISO-8859-15) string, up to its first \0, into UTF-8. */
+static void decodeLatin9(std::string &str, const byte *data, uint32 length) {
+	str.clear();
+
+	for (; (length > 0) && (*data != 0); length--, data++) {
+		uint32 c = *data;
+
+		if (c < 0x80) {
+			str += (char) c;
+			continue;
+		}
+
+		// Where Latin-9 differs from Latin-1
+		switch (c) {
+			case 0xA4: c = 0x20AC; break;
+			case 0xA6: c = 0x0160; break;
+			case 0xA8: c = 0x0161; break;
+			case 0xB4: c = 0x017D; break;
+			case 0xB8: c = 0x017E; break;
+			case 0xBC: c = 0x0152; break;
+			case 0xBD: c = 0x0153; break;
+			case 0xBE: c = 0x0178; break;
+			default: break;
+		}
+
+		if (c < 0x800) {
+			str += (char) (0xC0 | (c >> 6));
+		} else {
+			str += (char) (0xE0 | (c >> 12));
+			str += (char) (0x80 | ((c >> 6) & 0x3F));
+		}
+
+		str += (char) (0x80 | (c & 0x3F));
+	}
+}
+
+TalkTable::TalkTable(Common::SeekableReadStream *tlk) : _language(kLanguageInvalid) {
 	assert(tlk);
 
-	load();
+	try {
+		load(*tlk);
+	} catch (...) {
+		delete tlk;
+		throw;
+	}
+
+	// Everything has been read, we don't need the stream anymore
+	delete tlk;
 }
 
 TalkTable::~TalkTable() {
-	delete _tlk;
 }
 
-void TalkTable::load() {
-	readHeader(*_tlk);
+void TalkTable::load(Common::SeekableReadStream &tlk) {
+	readHeader(tlk);
 
 	if (_id != kTLKID)
 		throw Common::Exception("Not a TLK file");
@@ -58,30 +103,35 @@ void TalkTable::load() {
 	if (_version != kVersion3 && _version != kVersion4)
 		throw Common::Exception("Unsupported TLK file version %08X", _version);
 
-	_language = (Language) (_tlk->readUint32LE() * 2);
+	_language = (Language) (tlk.readUint32LE() * 2);
 
-	uint32 stringCount = _tlk->readUint32LE();
+	uint32 stringCount = tlk.readUint32LE();
 	_entryList.resize(stringCount);
 
 	// V4 added this field; it's right after the header in V3
 	uint32 tableOffset = 20;
 	if (_version == kVersion4)
-		tableOffset = _tlk->readUint32LE();
+		tableOffset = tlk.readUint32LE();
 
-	_stringsOffset = _tlk->readUint32LE();
+	uint32 stringsOffset = tlk.readUint32LE();
 
 	// Go to the table
-	_tlk->seek(tableOffset);
+	tlk.seek(tableOffset);
 
 	try {
 
+		// Absolute offsets and lengths of all texts
+		std::vector<uint32> offsets, lengths;
+
 		// Read in all the table data
 		if (_version == kVersion3)
-			readEntryTableV3();
+			readEntryTableV3(tlk, offsets, lengths);
 		else
-			readEntryTableV4();
+			readEntryTableV4(tlk, offsets, lengths);
+
+		readStrings(tlk, stringsOffset, offsets, lengths);
 
-		if (_tlk->err())
+		if (tlk.err())
 			throw Common::Exception(Common::kReadError);
 
 	} catch (Common::Exception &e) {
@@ -91,55 +141,149 @@ void TalkTable::load() {
 
 }
 
-void TalkTable::readEntryTableV3() {
-	for (EntryList::iterator entry = _entryList.begin(); entry != _entryList.end(); ++entry) {
-		entry->flags          = _tlk->readUint32LE();
-		entry->soundResRef.readFixedASCII(*_tlk, 16);
-		entry->volumeVariance = _tlk->readUint32LE();
-		entry->pitchVariance  = _tlk->readUint32LE();
-		entry->offset         = _tlk->readUint32LE() + _stringsOffset;
-		entry->length         = _tlk->readUint32LE();
-		entry->soundLength    = _tlk->readIEEEFloatLE();
+void TalkTable::readEntryTableV3(Common::SeekableReadStream &tlk, std::vector<uint32> &offsets,
+                                 std::vector<uint32> &lengths) {
+
+	offsets.resize(_entryList.size());
+	lengths.resize(_entryList.size());
+
+	// Index 0 is the empty string
+	_strings.resize(1);
+
+	for (uint32 i = 0; i < _entryList.size(); i++) {
+		Entry &entry = _entryList[i];
+
+		entry.flags = tlk.readUint32LE();
+
+		Common::UString soundResRef;
+		soundResRef.readFixedASCII(tlk, 16);
+
+		entry.soundResRef = 0;
+		if (!soundResRef.empty()) {
+			entry.soundResRef = _strings.size();
+			_strings.push_back(soundResRef);
+		}
+
+		tlk.skip(8); // Volume and pitch variance, unused
+
+		offsets[i] = tlk.readUint32LE();
+		lengths[i] = tlk.readUint32LE();
+
+		entry.soundLength = tlk.readIEEEFloatLE();
+		entry.soundID     = 0;
+		entry.text        = 0;
 	}
 }
 
-void TalkTable::readEntryTableV4() {
-	for (EntryList::iterator entry = _entryList.begin(); entry != _entryList.end(); ++entry) {
-		entry->soundID = _tlk->readUint32LE();
-		entry->offset  = _tlk->readUint32LE();
-		entry->length  = _tlk->readUint16LE();
-		entry->flags   = kFlagTextPresent;
+void TalkTable::readEntryTableV4(Common::SeekableReadStream &tlk, std::vector<uint32> &offsets,
+                                 std::vector<uint32> &lengths) {
+
+	offsets.resize(_entryList.size());
+	lengths.resize(_entryList.size());
+
+	// Index 0 is the empty string
+	_strings.resize(1);
+
+	for (uint32 i = 0; i < _entryList.size(); i++) {
+		Entry &entry = _entryList[i];
+
+		entry.soundID = tlk.readUint32LE();
+		offsets[i]    = tlk.readUint32LE();
+		lengths[i]    = tlk.readUint16LE();
+
+		entry.flags       = kFlagTextPresent;
+		entry.soundResRef = 0;
+		entry.soundLength = 0.0;
+		entry.text        = 0;
 	}
 }
 
-void TalkTable::readString(Entry &entry) {
-	if (!entry.text.empty() || (entry.length == 0) || !(entry.flags & kFlagTextPresent))
-		// We already have the string
+void TalkTable::readStrings(Common::SeekableReadStream &tlk, uint32 stringsOffset,
+                            const std::vector<uint32> &offsets, const std::vector<uint32> &lengths) {
+
+	// V3 string offsets are relative to the string data, V4 ones are absolute
+	if (_version != kVersion3)
+		stringsOffset = 0;
+
+	const uint32 size = tlk.size();
+
+	// Find the area the texts are in, and read it all at once
+
+	uint32 dataStart = size, dataEnd = 0, textCount = 0;
+	for (uint32 i = 0; i < _entryList.size(); i++) {
+		if ((lengths[i] == 0) || !(_entryList[i].flags & kFlagTextPresent))
+			continue;
+
+		const uint32 start = MIN(stringsOffset + offsets[i], size);
+
+		dataStart = MIN(dataStart, start);
+		dataEnd   = MAX(dataEnd  , start + MIN(lengths[i], size - start));
+
+		textCount++;
+	}
+
+	if (dataStart >= dataEnd)
 		return;
 
-	assert(_tlk);
+	std::vector<byte> data(dataEnd - dataStart);
 
-	if (!_tlk->seek(entry.offset))
+	if (!tlk.seek(dataStart))
 		throw Common::Exception(Common::kSeekError);
+	if (tlk.read(&data[0], data.size()) != data.size())
+		throw Common::Exception(Common::kReadError);
+
+	// Decode all texts into the string pool
+
+	_strings.reserve(_strings.size() + textCount);
+
+	std::string text;
+	for (uint32 i = 0; i < _entryList.size(); i++) {
+		if ((lengths[i] == 0) || !(_entryList[i].flags & kFlagTextPresent))
+			continue;
 
-	// TODO: Different encodings for different languages, probably
-	entry.text.readFixedLatin9(*_tlk, MIN<uint32>(entry.length, _tlk->size() - _tlk->pos()));
+		const uint32 start = MIN(stringsOffset + offsets[i], size);
+
+		// TODO: Different encodings for different languages, probably
+		decodeLatin9(text, &data[start - dataStart], MIN(lengths[i], size - start));
+		if (text.empty())
+			continue;
+
+		_entryList[i].text = _strings.size();
+		_strings.push_back(text);
+	}
 }
 
 Language TalkTable::getLanguage() const {
 	return _language;
 }
 
-const TalkTable::Entry *TalkTable::getEntry(uint32 strRef) {
+uint32 TalkTable::getEntryCount() const {
+	return _entryList.size();
+}
+
+const TalkTable::Entry *TalkTable::getEntry(uint32 strRef) const {
 	// If invalid or not loaded, return 0
 	if (strRef >= _entryList.size())
 		return 0;
 
-	Entry &entry = _entryList[strRef];
+	return &_entryList[strRef];
+}
+
+const Common::UString &TalkTable::getText(const Entry &entry) const {
+	return _strings[entry.text];
+}
+
+const Common::UString &TalkTable::getSoundResRef(const Entry &entry) const {
+	return _strings[entry.soundResRef];
+}
+
+uint32 TalkTable::getMemoryUsage() const {
+	uint32 size = _entryList.capacity() * sizeof(Entry);
 
-	readString(entry);
+	for (std::vector<Common::UString>::const_iterator s = _strings.begin(); s != _strings.end(); ++s)
+		size += sizeof(Common::UString) + std::strlen(s->c_str()) + 1;
 
-	return &entry;
+	return size;
 }
 
 } // End of namespace Aurora
@@ -44,7 +44,12 @@ namespace Common {
 
 namespace Aurora {
 
-/** Class to hold string resoures. */
+/** Class to hold string resoures.
+ *
+ *  All strings are read and decoded in one go when the talk table is loaded,
+ *  into a single pool that's never modified afterwards. A loaded talk table
+ *  is therefore safe to read from several threads at once, without locking.
+ */
 class TalkTable : public AuroraBase {
 public:
 	/** The entries' flags. */
@@ -56,50 +61,57 @@ public:
 
 	/** A talk resource entry. */
 	struct Entry {
-		Common::UString text;
-		uint32 offset;
-		uint32 length;
+		uint32 text;        ///< Index of the text in the string pool.
+		uint32 soundResRef; ///< Index of the sound ResRef in the string pool.
 
-		// V3
 		uint32 flags;
-		Common::UString soundResRef;
-		uint32 volumeVariance; // Unused
-		uint32 pitchVariance; // Unused
-		float soundLength; // In seconds
-
-		// V4
-		uint32 soundID;
+		float  soundLength; ///< In seconds (V3).
+		uint32 soundID;     ///< V4.
 	};
 
 	typedef std::vector<Entry> EntryList;
 
+	/** Load a talk table, taking over the stream. */
 	TalkTable(Common::SeekableReadStream *tlk);
 	~TalkTable();
 
 	/** Return the language of the talk table. */
 	Language getLanguage() const;
 
+	/** Return the number of entries in the talk table. */
+	uint32 getEntryCount() const;
+
 	/** Get an entry.
 	 *
 	 *  @param strRef a handle to a string (index).
 	 *  @return 0 if strRef is invalid, otherwise the Entry from the list.
 	 */
-	const Entry *getEntry(uint32 strRef);
+	const Entry *getEntry(uint32 strRef) const;
 
-private:
-	Common::SeekableReadStream *_tlk;
+	/** Return the text of an entry. */
+	const Common::UString &getText(const Entry &entry) const;
+	/** Return the sound ResRef of an entry. */
+	const Common::UString &getSoundResRef(const Entry &entry) const;
 
-	uint32 _stringsOffset;
+	/** Return the approximate number of bytes used by the talk table. */
+	uint32 getMemoryUsage() const;
 
+private:
 	Language _language;
 
 	EntryList _entryList;
 
-	void load();
+	/** All texts and sound ResRefs. Index 0 is the empty string. */
+	std::vector<Common::UString> _strings;
+
+	void load(Common::SeekableReadStream &tlk);
 
-	void readEntryTableV3();
-	void readEntryTableV4();
-	void readString(Entry &entry);
+	void readEntryTableV3(Common::SeekableReadStream &tlk, std::vector<uint32> &offsets,
+	                      std::vector<uint32> &lengths);
+	void readEntryTableV4(Common::SeekableReadStream &tlk, std::vector<uint32> &offsets,
+	                      std::vector<uint32> &lengths);
+	void readStrings(Common::SeekableReadStream &tlk, uint32 stringsOffset,
+	                 const std::vector<uint32> &offsets, const std::vector<uint32> &lengths);
 };
 
 } // End of namespace Aurora
@@ -63,6 +63,11 @@ Common::SeekableReadStream *ZIPFile::getResource(uint32 index) const {
 	return _zipFile->getFile(index);
 }
 
+bool ZIPFile::isResourceCompressed(uint32 index) const {
+	// Even uncompressed files are read whole into new memory
+	return true;
+}
+
 void ZIPFile::load() {
 	const Common::ZipFile::FileList &files = _zipFile->getFiles();
 	for (Common::ZipFile::FileList::const_iterator file = files.begin(); file != files.end(); ++file) {
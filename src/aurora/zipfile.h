@@ -64,6 +64,9 @@ public:
 	/** Return a stream of the resource's contents. */
 	Common::SeekableReadStream *getResource(uint32 index) const;
 
+	/** Does the resource need to be decompressed when read? */
+	bool isResourceCompressed(uint32 index) const;
+
 private:
 	/** The actual zip file. */
 	Common::ZipFile *_zipFile;
@@ -46,16 +46,6 @@ void BoundingBox::clear() {
 	_empty    = true;
 	_absolute = true;
 
-	// Set to boundaries
-	_coords[0][0] =  FLT_MAX; _coords[0][1] =  FLT_MAX; _coords[0][2] =  FLT_MAX;
-	_coords[1][0] =  FLT_MAX; _coords[1][1] =  FLT_MAX; _coords[1][2] = -FLT_MAX;
-	_coords[2][0] =  FLT_MAX; _coords[2][1] = -FLT_MAX; _coords[2][2] =  FLT_MAX;
-	_coords[3][0] =  FLT_MAX; _coords[3][1] = -FLT_MAX; _coords[3][2] = -FLT_MAX;
-	_coords[4][0] = -FLT_MAX; _coords[4][1] =  FLT_MAX; _coords[4][2] =  FLT_MAX;
-	_coords[5][0] = -FLT_MAX; _coords[5][1] =  FLT_MAX; _coords[5][2] = -FLT_MAX;
-	_coords[6][0] = -FLT_MAX; _coords[6][1] = -FLT_MAX; _coords[6][2] =  FLT_MAX;
-	_coords[7][0] = -FLT_MAX; _coords[7][1] = -FLT_MAX; _coords[7][2] = -FLT_MAX;
-
 	_min[0] = 0.0; _min[1] = 0.0; _min[2] = 0.0;
 	_max[0] = 0.0; _max[1] = 0.0; _max[2] = 0.0;
 
@@ -78,15 +68,12 @@ void BoundingBox::getMin(float &x, float &y, float &z) const {
 		return;
 	}
 
-	TransformationMatrix min = _origin;
-	min.translate(_min[0], _min[1], _min[2]);
-
-	TransformationMatrix max = _origin;
-	max.translate(_max[0], _max[1], _max[2]);
+	const Vec3 min = _origin.transformPoint(Vec3(_min));
+	const Vec3 max = _origin.transformPoint(Vec3(_max));
 
-	x = MIN(min.getX(), max.getX());
-	y = MIN(min.getY(), max.getY());
-	z = MIN(min.getZ(), max.getZ());
+	x = MIN(min[0], max[0]);
+	y = MIN(min[1], max[1]);
+	z = MIN(min[2], max[2]);
 }
 
 void BoundingBox::getMax(float &x, float &y, float &z) const {
@@ -97,15 +84,12 @@ void BoundingBox::getMax(float &x, float &y, float &z) const {
 		return;
 	}
 
-	TransformationMatrix min = _origin;
-	min.translate(_min[0], _min[1], _min[2]);
-
-	TransformationMatrix max = _origin;
-	max.translate(_max[0], _max[1], _max[2]);
+	const Vec3 min = _origin.transformPoint(Vec3(_min));
+	const Vec3 max = _origin.transformPoint(Vec3(_max));
 
-	x = MAX(min.getX(), max.getX());
-	y = MAX(min.getY(), max.getY());
-	z = MAX(min.getZ(), max.getZ());
+	x = MAX(min[0], max[0]);
+	y = MAX(min[1], max[1]);
+	z = MAX(min[2], max[2]);
 }
 
 float BoundingBox::getWidth() const {
@@ -233,24 +217,16 @@ return false;
 }
 
 void BoundingBox::add(float x, float y, float z) {
-	_coords[0][0] = MIN(_coords[0][0], x); _coords[0][1] = MIN(_coords[0][1], y); _coords[0][2] = MIN(_coords[0][2], z);
-	_coords[1][0] = MIN(_coords[1][0], x); _coords[1][1] = MIN(_coords[1][1], y); _coords[1][2] = MAX(_coords[1][2], z);
-	_coords[2][0] = MIN(_coords[2][0], x); _coords[2][1] = MAX(_coords[2][1], y); _coords[2][2] = MIN(_coords[2][2], z);
-	_coords[3][0] = MIN(_coords[3][0], x); _coords[3][1] = MAX(_coords[3][1], y); _coords[3][2] = MAX(_coords[3][2], z);
-	_coords[4][0] = MAX(_coords[4][0], x); _coords[4][1] = MIN(_coords[4][1], y); _coords[4][2] = MIN(_coords[4][2], z);
-	_coords[5][0] = MAX(_coords[5][0], x); _coords[5][1] = MIN(_coords[5][1], y); _coords[5][2] = MAX(_coords[5][2], z);
-	_coords[6][0] = MAX(_coords[6][0], x); _coords[6][1] = MAX(_coords[6][1], y); _coords[6][2] = MIN(_coords[6][2], z);
-	_coords[7][0] = MAX(_coords[7][0], x); _coords[7][1] = MAX(_coords[7][1], y); _coords[7][2] = MAX(_coords[7][2], z);
-
-	for (int i = 0; i < 3; i++) {
-		float min = getCoordMin(i);
-		float max = getCoordMax(i);
-
-		_min[i] = _empty ? min : MIN(_min[i], min);
-		_max[i] = _empty ? max : MAX(_max[i], max);
+	if (_empty) {
+		_min[0] = x; _min[1] = y; _min[2] = z;
+		_max[0] = x; _max[1] = y; _max[2] = z;
+
+		_empty = false;
+		return;
 	}
 
-	_empty = false;
+	_min[0] = MIN(_min[0], x); _min[1] = MIN(_min[1], y); _min[2] = MIN(_min[2], z);
+	_max[0] = MAX(_max[0], x); _max[1] = MAX(_max[1], y); _max[2] = MAX(_max[2], z);
 }
 
 void BoundingBox::add(const BoundingBox &box) {
@@ -258,8 +234,9 @@ void BoundingBox::add(const BoundingBox &box) {
 		// Don't add an empty bounding box :P
 		return;
 
-	for (int i = 0; i < 8; i++)
-		add(box._coords[i][0], box._coords[i][1], box._coords[i][2]);
+	// The box's own origin is ignored here, only its coordinates are added
+	add(box._min[0], box._min[1], box._min[2]);
+	add(box._max[0], box._max[1], box._max[2]);
 }
 
 void BoundingBox::translate(float x, float y, float z) {
@@ -276,51 +253,18 @@ void BoundingBox::rotate(float angle, float x, float y, float z) {
 	_absolute = false;
 }
 
-void BoundingBox::transform(const Matrix &m) {
+void BoundingBox::transform(const Mat4 &m) {
 	_origin *= m;
 	_absolute = false;
 }
 
-inline float BoundingBox::getCoordMin(int i) const {
-	if (i == 0)
-		return MIN(MIN(MIN(_coords[0][0], _coords[1][0]), _coords[2][0]), _coords[3][0]);
-	if (i == 1)
-		return MIN(MIN(MIN(_coords[0][1], _coords[1][1]), _coords[4][1]), _coords[5][1]);
-	if (i == 2)
-		return MIN(MIN(MIN(_coords[0][2], _coords[2][2]), _coords[4][2]), _coords[6][2]);
-
-	return 0.0;
-}
-
-inline float BoundingBox::getCoordMax(int i) const {
-	if (i == 0)
-		return MAX(MAX(MAX(_coords[4][0], _coords[5][0]), _coords[6][0]), _coords[7][0]);
-	if (i == 1)
-		return MAX(MAX(MAX(_coords[2][1], _coords[3][1]), _coords[6][1]), _coords[7][1]);
-	if (i == 2)
-		return MAX(MAX(MAX(_coords[1][2], _coords[3][2]), _coords[5][2]), _coords[7][2]);
-
-	return 0.0;
-}
-
 void BoundingBox::absolutize() {
 	if (_empty)
 		// Nothing to do
 		return;
 
-	float coords[8][3];
-	for (int i = 0; i < 8; i++) {
-		TransformationMatrix c = _origin;
-
-		c.translate(_coords[i][0], _coords[i][1], _coords[i][2]);
-
-		c.getPosition(coords[i][0], coords[i][1], coords[i][2]);
-	}
-
-	clear();
-
-	for (int i = 0; i < 8; i++)
-		add(coords[i][0], coords[i][1], coords[i][2]);
+	_origin.transformAABB(_min, _max, _min, _max);
+	_origin.loadIdentity();
 
 	_absolute = true;
 }
@@ -66,7 +66,7 @@ public:
 
 	void rotate(float angle, float x, float y, float z);
 
-	void transform(const Matrix &m);
+	void transform(const Mat4 &m);
 
 	/** Apply the origin transformations directly to the coordinates. */
 	void absolutize();
@@ -80,14 +80,9 @@ private:
 
 	TransformationMatrix _origin;
 
-	float _coords[8][3];
-
 	float _min[3];
 	float _max[3];
 
-	inline float getCoordMin(int i) const;
-	inline float getCoordMax(int i) const;
-
 	bool getIntersection(float fDst1, float fDst2,
 	                     float x1, float y1, float z1,
 	                     float x2, float y2, float z2,
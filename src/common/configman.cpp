@@ -502,6 +502,35 @@ UString ConfigManager::getDefaultConfigFile() {
 	return file;
 }
 
+UString ConfigManager::getCacheDirectory() {
+	UString dir;
+
+#if defined(MACOSX)
+	// Mac OS X: The user's cache directory
+	const char *home = getenv("HOME");
+	if (home)
+		dir = UString(home) + "/Library/Caches/xoreos";
+#elif defined(UNIX)
+	// Default Unixoid: XDG_CACHE_HOME
+	const char *cacheHome = getenv("XDG_CACHE_HOME");
+	if (cacheHome)
+		dir = UString(cacheHome) + "/xoreos";
+	else if ((cacheHome = getenv("HOME")))
+		dir = UString(cacheHome) + "/.cache/xoreos";
+#endif
+
+	if (dir.empty()) {
+		// Fallback: Next to the config file
+		dir = FilePath::getDirectory(getDefaultConfigFile());
+		if (dir.empty())
+			dir = ".";
+
+		dir += "/cache";
+	}
+
+	return dir;
+}
+
 bool ConfigManager::hasKey(const ConfigDomain *domain, const UString &key) const {
 	return domain && domain->hasKey(key);
 }
@@ -120,6 +120,9 @@ public:
 	/** Set a config value that came from the command line. */
 	void setCommandlineKey(const UString &key, const UString &value);
 
+	/** Return the directory where generated data can be cached between runs. */
+	static UString getCacheDirectory();
+
 private:
 	static const char *kDomainApp; ///< The name of the application domain.
 
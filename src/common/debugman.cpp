@@ -54,6 +54,7 @@ DebugManager::DebugManager() : _debugLevel(0) {
 	addDebugChannel(kDebugSound   , "GSound"   , "Global sound debug channel");
 	addDebugChannel(kDebugEvents  , "GEvents"  , "Global events debug channel");
 	addDebugChannel(kDebugScripts , "GScripts" , "Global scripts debug channel");
+	addDebugChannel(kDebugResources, "GResources", "Global resource loading debug channel");
 }
 
 DebugManager::~DebugManager() {
@@ -172,10 +173,14 @@ bool DebugManager::openLogFile(const UString &file) {
 }
 
 void DebugManager::closeLogFile() {
+	StackLock lock(_logMutex);
+
 	_logFile.close();
 }
 
 void DebugManager::logString(const UString &str) {
+	StackLock lock(_logMutex);
+
 	if (!_logFile.isOpen())
 		return;
 
@@ -38,6 +38,7 @@
 #include "common/ustring.h"
 #include "common/singleton.h"
 #include "common/file.h"
+#include "common/mutex.h"
 
 namespace Common {
 
@@ -47,7 +48,7 @@ enum DebugChannels {
 	kDebugSound      = 1 <<  1,
 	kDebugEvents     = 1 <<  2,
 	kDebugScripts    = 1 <<  3,
-	kDebugReserved04 = 1 <<  4,
+	kDebugResources  = 1 <<  4,
 	kDebugReserved05 = 1 <<  5,
 	kDebugReserved06 = 1 <<  6,
 	kDebugReserved07 = 1 <<  7,
@@ -136,6 +137,8 @@ private:
 
 	DumpFile _logFile;
 	bool _logFileStartLine;
+
+	Mutex _logMutex; ///< Mutex protecting the log file.
 };
 
 } // End of namespace Common
@@ -27,12 +27,27 @@
  *  File classes implementing the stream interfaces.
  */
 
+#include "common/system.h"
+
+#ifdef UNIX
+	#include <unistd.h>
+#endif
+
 #include "common/file.h"
 #include "common/error.h"
 #include "common/ustring.h"
 
+#ifndef UNIX
+	#include "common/mutex.h"
+#endif
+
 namespace Common {
 
+#ifndef UNIX
+/** Without pread(), positional reads need to be serialized. */
+static Mutex readAtMutex;
+#endif
+
 File::File() : _handle(0), _size(-1) {
 }
 
@@ -124,6 +139,41 @@ uint32 File::read(void *dataPtr, uint32 dataSize) {
 	return std::fread(dataPtr, 1, dataSize, _handle);
 }
 
+uint32 File::readAt(uint32 offset, void *dataPtr, uint32 dataSize) {
+	if (!_handle)
+		return 0;
+
+#ifdef UNIX
+	const int fd = fileno(_handle);
+
+	byte  *data      = (byte *) dataPtr;
+	uint32 bytesRead = 0;
+
+	while (bytesRead < dataSize) {
+		ssize_t n = pread(fd, data + bytesRead, dataSize - bytesRead, offset + bytesRead);
+		if (n <= 0)
+			break;
+
+		bytesRead += n;
+	}
+
+	return bytesRead;
+#else
+	StackLock lock(readAtMutex);
+
+	long oldPos = std::ftell(_handle);
+
+	if (std::fseek(_handle, offset, SEEK_SET) != 0)
+		return 0;
+
+	uint32 bytesRead = std::fread(dataPtr, 1, dataSize, _handle);
+
+	std::fseek(_handle, oldPos, SEEK_SET);
+
+	return bytesRead;
+#endif
+}
+
 
 DumpFile::DumpFile() : _handle(0), _size(-1) {
 }
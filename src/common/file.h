@@ -85,6 +85,19 @@ public:
 	bool seek(int32 offs, int whence = SEEK_SET); // implement abstract SeekableReadStream method
 	uint32 read(void *dataPtr, uint32 dataSize);  // implement abstract SeekableReadStream method
 
+	/**
+	 * Read data from a specific offset in the file.
+	 *
+	 * Unlike seek() followed by read(), this does not use or modify the file's
+	 * current position, so several threads can read from the same file at once.
+	 *
+	 * @param  offset the offset within the file to start reading from
+	 * @param  dataPtr pointer to a buffer into which the data is read
+	 * @param  dataSize number of bytes to be read
+	 * @return the number of bytes which were actually read
+	 */
+	uint32 readAt(uint32 offset, void *dataPtr, uint32 dataSize);
+
 protected:
 	std::FILE *_handle; ///< The actual file handle.
 	int32 _size;        ///< The file's size.
@@ -43,6 +43,8 @@ using boost::filesystem::exists;
 using boost::filesystem::is_regular_file;
 using boost::filesystem::is_directory;
 using boost::filesystem::file_size;
+using boost::filesystem::last_write_time;
+using boost::filesystem::create_directories;
 using boost::filesystem::directory_iterator;
 
 // boost-string_algo
@@ -76,6 +78,21 @@ uint32 FilePath::getFileSize(const UString &p) {
 	return size;
 }
 
+uint64 FilePath::getModificationTime(const UString &p) {
+	try {
+		return (uint64) last_write_time(p.c_str());
+	} catch (...) {
+	}
+
+	return 0;
+}
+
+UString FilePath::getDirectory(const UString &p) {
+	path file(p.c_str());
+
+	return file.parent_path().generic_string();
+}
+
 UString FilePath::getFile(const UString &p) {
 	path file(p.c_str());
 
@@ -268,6 +285,34 @@ UString FilePath::findSubDirectory(const UString &directory, const UString &subD
 	return curDir;
 }
 
+bool FilePath::createDirectories(const UString &p) {
+	try {
+		create_directories(p.c_str());
+	} catch (...) {
+	}
+
+	return isDirectory(p);
+}
+
+bool FilePath::renameFile(const UString &from, const UString &to) {
+	try {
+		boost::filesystem::rename(path(from.c_str()), path(to.c_str()));
+	} catch (...) {
+		return false;
+	}
+
+	return true;
+}
+
+bool FilePath::removeFile(const UString &p) {
+	try {
+		return boost::filesystem::remove(path(p.c_str()));
+	} catch (...) {
+	}
+
+	return false;
+}
+
 UString FilePath::escapeStringLiteral(const UString &str) {
 	const boost::regex esc("[\\^\\.\\$\\|\\(\\)\\[\\]\\*\\+\\?\\/\\\\]");
 	const std::string  rep("\\\\\\1&");
@@ -63,6 +63,23 @@ public:
 	 */
 	static uint32 getFileSize(const UString &p);
 
+	/** Return a file's last modification time.
+	 *
+	 *  @param  p The file to look up.
+	 *  @return The modification time of the file, in seconds since the epoch,
+	 *          or 0 if it could not be determined.
+	 */
+	static uint64 getModificationTime(const UString &p);
+
+	/** Return the directory a file is in.
+	 *
+	 *  Example: "/path/to/file.ext" > "/path/to"
+	 *
+	 *  @param  p The path to manipulate.
+	 *  @return The path's parent directory.
+	 */
+	static UString getDirectory(const UString &p);
+
 	/** Return a file name without its path.
 	 *
 	 *  Example: "/path/to/file.ext" > "file.ext"
@@ -157,6 +174,28 @@ public:
 	static UString findSubDirectory(const UString &directory, const UString &subDirectory,
 	                                bool caseInsensitive = false);
 
+	/** Create a directory, including all its missing parent directories.
+	 *
+	 *  @param  p The directory to create.
+	 *  @return true if the directory exists now, false otherwise.
+	 */
+	static bool createDirectories(const UString &p);
+
+	/** Rename a file, replacing the destination if it already exists.
+	 *
+	 *  @param  from The file to rename.
+	 *  @param  to The new name of the file.
+	 *  @return true if the file was renamed, false otherwise.
+	 */
+	static bool renameFile(const UString &from, const UString &to);
+
+	/** Remove a file.
+	 *
+	 *  @param  p The file to remove.
+	 *  @return true if the file was removed, false otherwise.
+	 */
+	static bool removeFile(const UString &p);
+
 	/** Escape a string literal for use in a regexp. */
 	static UString escapeStringLiteral(const UString &str);
 };
@@ -0,0 +1,153 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/filepool.cpp
+ *  A pool of open files, shared by everything reading from archives.
+ */
+
+#include "common/filepool.h"
+#include "common/file.h"
+#include "common/stream.h"
+#include "common/error.h"
+
+DECLARE_SINGLETON(Common::FilePoolManager)
+
+/** Number of files kept open by default. */
+static const uint32 kDefaultMaxOpen = 64;
+
+namespace Common {
+
+FilePoolManager::Stats::Stats() : reads(0), opens(0), closes(0) {
+}
+
+
+FilePoolManager::FilePoolManager() : _maxOpen(kDefaultMaxOpen) {
+}
+
+FilePoolManager::~FilePoolManager() {
+	clear();
+}
+
+void FilePoolManager::clear() {
+	StackLock lock(_mutex);
+
+	_fileMap.clear();
+	_files.clear();
+}
+
+void FilePoolManager::setMaxOpen(uint32 maxOpen) {
+	StackLock lock(_mutex);
+
+	_maxOpen = MAX<uint32>(maxOpen, 1);
+
+	while (_files.size() > _maxOpen) {
+		_fileMap.erase(_files.back().fileName);
+		_files.pop_back();
+
+		_stats.closes++;
+	}
+}
+
+void FilePoolManager::close(const UString &fileName) {
+	StackLock lock(_mutex);
+
+	FileMap::iterator f = _fileMap.find(fileName);
+	if (f == _fileMap.end())
+		return;
+
+	// Readers still holding on to the file keep it alive until they're finished
+	_files.erase(f->second);
+	_fileMap.erase(f);
+}
+
+FilePoolManager::FilePtr FilePoolManager::getFile(const UString &fileName) {
+	StackLock lock(_mutex);
+
+	_stats.reads++;
+
+	FileMap::iterator f = _fileMap.find(fileName);
+	if (f != _fileMap.end()) {
+		// Move the file to the front of the LRU list
+		_files.splice(_files.begin(), _files, f->second);
+
+		return _files.front().file;
+	}
+
+	FilePtr file(new File);
+	if (!file->open(fileName))
+		throw Exception(kOpenError);
+
+	_stats.opens++;
+
+	// Make room for the new file
+	while (!_files.empty() && (_files.size() >= _maxOpen)) {
+		_fileMap.erase(_files.back().fileName);
+		_files.pop_back();
+
+		_stats.closes++;
+	}
+
+	_files.push_front(PoolFile());
+	_files.front().fileName = fileName;
+	_files.front().file     = file;
+
+	_fileMap.insert(std::make_pair(fileName, _files.begin()));
+
+	return file;
+}
+
+void FilePoolManager::read(const UString &fileName, uint32 offset, void *dataPtr, uint32 dataSize) {
+	FilePtr file = getFile(fileName);
+
+	if (file->readAt(offset, dataPtr, dataSize) != dataSize)
+		throw Exception(kReadError);
+}
+
+MemoryReadStream *FilePoolManager::readStream(const UString &fileName, uint32 offset, uint32 dataSize) {
+	byte *data = new byte[dataSize];
+
+	try {
+		read(fileName, offset, data, dataSize);
+	} catch (...) {
+		delete[] data;
+		throw;
+	}
+
+	return new MemoryReadStream(data, dataSize, true);
+}
+
+FilePoolManager::Stats FilePoolManager::getStats() const {
+	StackLock lock(_mutex);
+
+	return _stats;
+}
+
+void FilePoolManager::resetStats() {
+	StackLock lock(_mutex);
+
+	_stats = Stats();
+}
+
+} // End of namespace Common
@@ -0,0 +1,137 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/filepool.h
+ *  A pool of open files, shared by everything reading from archives.
+ */
+
+#ifndef COMMON_FILEPOOL_H
+#define COMMON_FILEPOOL_H
+
+#include <list>
+#include <map>
+
+#include <boost/shared_ptr.hpp>
+
+#include "common/types.h"
+#include "common/ustring.h"
+#include "common/singleton.h"
+#include "common/mutex.h"
+
+namespace Common {
+
+class File;
+class MemoryReadStream;
+
+/** A bounded pool of open, read-only files.
+ *
+ *  Archives read their resources through the pool, so that the same archive
+ *  file doesn't need to be opened anew for every single resource read. When
+ *  the pool is full, the least recently used file is closed.
+ *
+ *  All reads are positional (see File::readAt()), so several threads can read
+ *  from the same pooled file at the same time.
+ */
+class FilePoolManager : public Singleton<FilePoolManager> {
+public:
+	/** Statistics about the pool's usage. */
+	struct Stats {
+		uint32 reads;  ///< Number of read requests.
+		uint32 opens;  ///< Number of times a file had to be opened.
+		uint32 closes; ///< Number of times a file was closed to make room.
+
+		Stats();
+	};
+
+	FilePoolManager();
+	~FilePoolManager();
+
+	/** Close all files. */
+	void clear();
+
+	/** Set the maximum number of files kept open at the same time. */
+	void setMaxOpen(uint32 maxOpen);
+
+	/** Close that file, if it's currently open. */
+	void close(const UString &fileName);
+
+	/** Read data from that file, opening it if necessary.
+	 *
+	 *  Throws an exception if the file can't be opened or the data can't be read.
+	 *
+	 *  @param fileName The name of the file to read from.
+	 *  @param offset The offset within the file to start reading from.
+	 *  @param dataPtr The buffer to read the data into.
+	 *  @param dataSize The number of bytes to read.
+	 */
+	void read(const UString &fileName, uint32 offset, void *dataPtr, uint32 dataSize);
+
+	/** Read data from that file into a new memory stream.
+	 *
+	 *  @param fileName The name of the file to read from.
+	 *  @param offset The offset within the file to start reading from.
+	 *  @param dataSize The number of bytes to read.
+	 *  @return A stream holding the data.
+	 */
+	MemoryReadStream *readStream(const UString &fileName, uint32 offset, uint32 dataSize);
+
+	/** Return the usage statistics. */
+	Stats getStats() const;
+	/** Reset the usage statistics. */
+	void resetStats();
+
+private:
+	typedef boost::shared_ptr<File> FilePtr;
+
+	/** A file kept open by the pool. */
+	struct PoolFile {
+		UString fileName;
+		FilePtr file;
+	};
+
+	/** Open files, the most recently used first. */
+	typedef std::list<PoolFile> FileList;
+	/** Open files, indexed by their name. */
+	typedef std::map<UString, FileList::iterator> FileMap;
+
+	uint32 _maxOpen;
+
+	FileList _files;
+	FileMap  _fileMap;
+
+	Stats _stats;
+
+	mutable Mutex _mutex;
+
+	/** Return the open file, opening it if necessary. */
+	FilePtr getFile(const UString &fileName);
+};
+
+} // End of namespace Common
+
+/** Shortcut for accessing the file pool. */
+#define FilePool Common::FilePoolManager::instance()
+
+#endif // COMMON_FILEPOOL_H
@@ -0,0 +1,145 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/mappedfile.cpp
+ *  Read-only memory-mapped files.
+ */
+
+#include "common/system.h"
+
+#ifdef UNIX
+	#include <sys/types.h>
+	#include <sys/stat.h>
+	#include <sys/mman.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+#include "common/mappedfile.h"
+#include "common/ustring.h"
+#include "common/error.h"
+
+namespace Common {
+
+MappedFile::MappedFile() : _data(0), _size(0) {
+}
+
+MappedFile::~MappedFile() {
+	close();
+}
+
+bool MappedFile::open(const UString &fileName) {
+	assert(!isOpen());
+
+#ifdef UNIX
+	int fd = ::open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if ((fstat(fd, &st) != 0) || (st.st_size <= 0) || ((uint64) st.st_size > 0x7FFFFFFF)) {
+		::close(fd);
+		return false;
+	}
+
+	void *data = mmap(0, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+
+	// The mapping stays valid after the descriptor is closed
+	::close(fd);
+
+	if (data == MAP_FAILED)
+		return false;
+
+	_data = (const byte *) data;
+	_size = st.st_size;
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+void MappedFile::close() {
+	if (!_data)
+		return;
+
+#ifdef UNIX
+	munmap((void *) _data, _size);
+#endif
+
+	_data = 0;
+	_size = 0;
+}
+
+bool MappedFile::isOpen() const {
+	return _data != 0;
+}
+
+const byte *MappedFile::getData() const {
+	return _data;
+}
+
+uint32 MappedFile::size() const {
+	return _size;
+}
+
+
+static volatile bool kFileMapping = true;
+
+void setFileMapping(bool enabled) {
+	kFileMapping = enabled;
+}
+
+MappedFilePtr mapFile(const UString &fileName) {
+	if (!kFileMapping)
+		return MappedFilePtr();
+
+	MappedFilePtr file(new MappedFile);
+	if (!file->open(fileName))
+		file.reset();
+
+	return file;
+}
+
+
+MappedReadStream::MappedReadStream(const MappedFilePtr &file, uint32 offset, uint32 size) :
+	MemoryReadStream(getData(file, offset, size), size), _file(file) {
+
+}
+
+MappedReadStream::~MappedReadStream() {
+}
+
+const byte *MappedReadStream::getData(const MappedFilePtr &file, uint32 offset, uint32 size) {
+	if (!file || !file->isOpen())
+		throw Exception("File not mapped");
+
+	if ((offset > file->size()) || (size > (file->size() - offset)))
+		throw Exception(kReadError);
+
+	return file->getData() + offset;
+}
+
+} // End of namespace Common
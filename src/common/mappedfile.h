@@ -0,0 +1,115 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/mappedfile.h
+ *  Read-only memory-mapped files.
+ */
+
+#ifndef COMMON_MAPPEDFILE_H
+#define COMMON_MAPPEDFILE_H
+
+#include <boost/shared_ptr.hpp>
+
+#include "common/types.h"
+#include "common/stream.h"
+#include "common/noncopyable.h"
+
+namespace Common {
+
+class UString;
+
+/** A file mapped read-only into memory.
+ *
+ *  Only available on systems that support mmap(). Everywhere else, open()
+ *  always fails and users need to fall back to reading the file normally.
+ */
+class MappedFile : public NonCopyable {
+public:
+	MappedFile();
+	~MappedFile();
+
+	/** Try to map the file with the given name into memory.
+	 *
+	 *  @param  fileName the name of the file to map
+	 *  @return true if the file was mapped successfully, false otherwise
+	 */
+	bool open(const UString &fileName);
+
+	/** Unmap the file, if mapped. */
+	void close();
+
+	/** Is the file currently mapped? */
+	bool isOpen() const;
+
+	/** Return the mapped data. */
+	const byte *getData() const;
+	/** Return the size of the mapped data. */
+	uint32 size() const;
+
+private:
+	const byte *_data;
+	uint32 _size;
+};
+
+typedef boost::shared_ptr<MappedFile> MappedFilePtr;
+
+/** Map a file into memory, returning an empty pointer if that's not possible. */
+MappedFilePtr mapFile(const UString &fileName);
+
+/** Enable or disable mapping files. While disabled, mapFile() always fails.
+ *
+ *  Archives opened while mapping is disabled read their resources through
+ *  the file pool instead, which is useful for comparing both.
+ */
+void setFileMapping(bool enabled);
+
+/** A stream reading directly from a part of a memory-mapped file.
+ *
+ *  The stream shares ownership of the mapping, so the file stays mapped for
+ *  as long as the stream exists, even when the MappedFile's original owner
+ *  is already gone.
+ */
+class MappedReadStream : public MemoryReadStream {
+public:
+	/** Create a stream over the data of the mapped file.
+	 *
+	 *  Throws an exception if the area lies outside the mapped file.
+	 *
+	 *  @param file The mapped file.
+	 *  @param offset The offset of the stream's data within the file.
+	 *  @param size The size of the stream's data.
+	 */
+	MappedReadStream(const MappedFilePtr &file, uint32 offset, uint32 size);
+	~MappedReadStream();
+
+private:
+	MappedFilePtr _file;
+
+	static const byte *getData(const MappedFilePtr &file, uint32 offset, uint32 size);
+};
+
+} // End of namespace Common
+
+#endif // COMMON_MAPPEDFILE_H
@@ -0,0 +1,511 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/mat4.cpp
+ *  A 4x4 matrix.
+ */
+
+#include <cstring>
+
+#include "common/mat4.h"
+#include "common/simd.h"
+#include "common/util.h"
+#include "common/maths.h"
+#include "common/error.h"
+
+static const float kIdentity[] = {
+	1.0, 0.0, 0.0, 0.0,
+	0.0, 1.0, 0.0, 0.0,
+	0.0, 0.0, 1.0, 0.0,
+	0.0, 0.0, 0.0, 1.0
+};
+
+namespace Common {
+
+#ifdef XOREOS_SSE2
+
+// The matrix isn't necessarily 16-byte aligned (new only guarantees 8 bytes on
+// some platforms), so all loads and stores here are unaligned. On any CPU with
+// SSE2 worth caring about, these are as fast as aligned ones when the data is aligned.
+
+static inline __m128 splat(__m128 v, int i) {
+	switch (i) {
+		case 0:
+			return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+		case 1:
+			return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+		case 2:
+			return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+		default:
+			break;
+	}
+
+	return _mm_shuffle_ps(v, v, _MM_SHUFFLE(3, 3, 3, 3));
+}
+
+/** Linear combination of the first three columns, plus the fourth: c0 * x + c1 * y + c2 * z + c3. */
+static inline __m128 combine(const float *m, float x, float y, float z) {
+	__m128 r = _mm_loadu_ps(m + 12);
+
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m + 0), _mm_set1_ps(x)));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m + 4), _mm_set1_ps(y)));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m + 8), _mm_set1_ps(z)));
+
+	return r;
+}
+
+/** out = a * b. out may point to either a or b. */
+static void multiply(float *out, const float *a, const float *b) {
+	const __m128 a0 = _mm_loadu_ps(a +  0);
+	const __m128 a1 = _mm_loadu_ps(a +  4);
+	const __m128 a2 = _mm_loadu_ps(a +  8);
+	const __m128 a3 = _mm_loadu_ps(a + 12);
+
+	// Column i of the result only depends on column i of b
+	for (int i = 0; i < 16; i += 4) {
+		const __m128 bc = _mm_loadu_ps(b + i);
+
+		__m128 r =         _mm_mul_ps(a0, splat(bc, 0));
+		r = _mm_add_ps(r, _mm_mul_ps(a1, splat(bc, 1)));
+		r = _mm_add_ps(r, _mm_mul_ps(a2, splat(bc, 2)));
+		r = _mm_add_ps(r, _mm_mul_ps(a3, splat(bc, 3)));
+
+		_mm_storeu_ps(out + i, r);
+	}
+}
+
+static void multiply(float *out, const float *m, const float *v, int) {
+	const __m128 vc = _mm_loadu_ps(v);
+
+	__m128 r =         _mm_mul_ps(_mm_loadu_ps(m +  0), splat(vc, 0));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m +  4), splat(vc, 1)));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m +  8), splat(vc, 2)));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_loadu_ps(m + 12), splat(vc, 3)));
+
+	_mm_storeu_ps(out, r);
+}
+
+/** (c2[I], c2[I], c1[I], c1[I]) * (c3[J], c3[J], c3[J], c2[J]) - (c3[I], c3[I], c3[I], c2[I]) * (c2[J], c2[J], c1[J], c1[J]). */
+template<int I, int J>
+static inline __m128 getCofactorPairs(__m128 c1, __m128 c2, __m128 c3) {
+	const __m128 a  = _mm_shuffle_ps(c2, c1, _MM_SHUFFLE(I, I, I, I));
+	const __m128 d  = _mm_shuffle_ps(c2, c1, _MM_SHUFFLE(J, J, J, J));
+
+	const __m128 tb = _mm_shuffle_ps(c3, c2, _MM_SHUFFLE(J, J, J, J));
+	const __m128 b  = _mm_shuffle_ps(tb, tb, _MM_SHUFFLE(2, 0, 0, 0));
+
+	const __m128 tc = _mm_shuffle_ps(c3, c2, _MM_SHUFFLE(I, I, I, I));
+	const __m128 c  = _mm_shuffle_ps(tc, tc, _MM_SHUFFLE(2, 0, 0, 0));
+
+	return _mm_sub_ps(_mm_mul_ps(a, b), _mm_mul_ps(c, d));
+}
+
+/** (c1[I], c0[I], c0[I], c0[I]). */
+template<int I>
+static inline __m128 getRowElements(__m128 c0, __m128 c1) {
+	const __m128 t = _mm_shuffle_ps(c1, c0, _MM_SHUFFLE(I, I, I, I));
+
+	return _mm_shuffle_ps(t, t, _MM_SHUFFLE(2, 2, 2, 0));
+}
+
+/** Invert m into out, by way of the adjugate. Returns false if m is singular. */
+static bool invert(float *out, const float *m) {
+	const __m128 c0 = _mm_loadu_ps(m +  0);
+	const __m128 c1 = _mm_loadu_ps(m +  4);
+	const __m128 c2 = _mm_loadu_ps(m +  8);
+	const __m128 c3 = _mm_loadu_ps(m + 12);
+
+	// 2x2 sub-determinants of the lower rows
+	const __m128 fac0 = getCofactorPairs<2, 3>(c1, c2, c3);
+	const __m128 fac1 = getCofactorPairs<1, 3>(c1, c2, c3);
+	const __m128 fac2 = getCofactorPairs<1, 2>(c1, c2, c3);
+	const __m128 fac3 = getCofactorPairs<0, 3>(c1, c2, c3);
+	const __m128 fac4 = getCofactorPairs<0, 2>(c1, c2, c3);
+	const __m128 fac5 = getCofactorPairs<0, 1>(c1, c2, c3);
+
+	const __m128 v0 = getRowElements<0>(c0, c1);
+	const __m128 v1 = getRowElements<1>(c0, c1);
+	const __m128 v2 = getRowElements<2>(c0, c1);
+	const __m128 v3 = getRowElements<3>(c0, c1);
+
+	const __m128 signA = _mm_set_ps(-1.0f,  1.0f, -1.0f,  1.0f);
+	const __m128 signB = _mm_set_ps( 1.0f, -1.0f,  1.0f, -1.0f);
+
+	__m128 i0 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(v1, fac0), _mm_mul_ps(v2, fac1)), _mm_mul_ps(v3, fac2));
+	__m128 i1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(v0, fac0), _mm_mul_ps(v2, fac3)), _mm_mul_ps(v3, fac4));
+	__m128 i2 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(v0, fac1), _mm_mul_ps(v1, fac3)), _mm_mul_ps(v3, fac5));
+	__m128 i3 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(v0, fac2), _mm_mul_ps(v1, fac4)), _mm_mul_ps(v2, fac5));
+
+	i0 = _mm_mul_ps(i0, signA);
+	i1 = _mm_mul_ps(i1, signB);
+	i2 = _mm_mul_ps(i2, signA);
+	i3 = _mm_mul_ps(i3, signB);
+
+	// The determinant is the dot product of the first column with the first row of the adjugate
+	const __m128 r01 = _mm_shuffle_ps(i0, i1, _MM_SHUFFLE(0, 0, 0, 0));
+	const __m128 r23 = _mm_shuffle_ps(i2, i3, _MM_SHUFFLE(0, 0, 0, 0));
+	const __m128 row = _mm_shuffle_ps(r01, r23, _MM_SHUFFLE(2, 0, 2, 0));
+
+	float dot[4];
+	_mm_storeu_ps(dot, _mm_mul_ps(c0, row));
+
+	const float det = (dot[0] + dot[1]) + (dot[2] + dot[3]);
+	if (det == 0.0f)
+		return false;
+
+	const __m128 invDet = _mm_set1_ps(1.0f / det);
+
+	_mm_storeu_ps(out +  0, _mm_mul_ps(i0, invDet));
+	_mm_storeu_ps(out +  4, _mm_mul_ps(i1, invDet));
+	_mm_storeu_ps(out +  8, _mm_mul_ps(i2, invDet));
+	_mm_storeu_ps(out + 12, _mm_mul_ps(i3, invDet));
+
+	return true;
+}
+
+#else // XOREOS_SSE2
+
+/** out = a * b. out may point to either a or b. */
+static void multiply(float *out, const float *a, const float *b) {
+	float t[16];
+
+	for (int i = 0; i < 16; i += 4)
+		for (int j = 0; j < 4; j++)
+			t[i + j] = a[j] * b[i] + a[4 + j] * b[i + 1] + a[8 + j] * b[i + 2] + a[12 + j] * b[i + 3];
+
+	std::memcpy(out, t, sizeof(t));
+}
+
+static void multiply(float *out, const float *m, const float *v, int) {
+	float t[4];
+
+	for (int j = 0; j < 4; j++)
+		t[j] = m[j] * v[0] + m[4 + j] * v[1] + m[8 + j] * v[2] + m[12 + j] * v[3];
+
+	std::memcpy(out, t, sizeof(t));
+}
+
+/** Invert m into out, by way of the adjugate. Returns false if m is singular. */
+static bool invert(float *out, const float *m) {
+	// Element in column c, row r
+	#define E(c, r) m[(c) * 4 + (r)]
+
+	// 2x2 sub-determinants of the lower rows
+	const float f00 = E(2, 2) * E(3, 3) - E(3, 2) * E(2, 3);
+	const float f02 = E(1, 2) * E(3, 3) - E(3, 2) * E(1, 3);
+	const float f03 = E(1, 2) * E(2, 3) - E(2, 2) * E(1, 3);
+	const float f04 = E(2, 1) * E(3, 3) - E(3, 1) * E(2, 3);
+	const float f06 = E(1, 1) * E(3, 3) - E(3, 1) * E(1, 3);
+	const float f07 = E(1, 1) * E(2, 3) - E(2, 1) * E(1, 3);
+	const float f08 = E(2, 1) * E(3, 2) - E(3, 1) * E(2, 2);
+	const float f10 = E(1, 1) * E(3, 2) - E(3, 1) * E(1, 2);
+	const float f11 = E(1, 1) * E(2, 2) - E(2, 1) * E(1, 2);
+	const float f12 = E(2, 0) * E(3, 3) - E(3, 0) * E(2, 3);
+	const float f14 = E(1, 0) * E(3, 3) - E(3, 0) * E(1, 3);
+	const float f15 = E(1, 0) * E(2, 3) - E(2, 0) * E(1, 3);
+	const float f16 = E(2, 0) * E(3, 2) - E(3, 0) * E(2, 2);
+	const float f18 = E(1, 0) * E(3, 2) - E(3, 0) * E(1, 2);
+	const float f19 = E(1, 0) * E(2, 2) - E(2, 0) * E(1, 2);
+	const float f20 = E(2, 0) * E(3, 1) - E(3, 0) * E(2, 1);
+	const float f22 = E(1, 0) * E(3, 1) - E(3, 0) * E(1, 1);
+	const float f23 = E(1, 0) * E(2, 1) - E(2, 0) * E(1, 1);
+
+	float t[16];
+
+	t[ 0] =   E(1, 1) * f00 - E(1, 2) * f04 + E(1, 3) * f08;
+	t[ 1] = -(E(0, 1) * f00 - E(0, 2) * f04 + E(0, 3) * f08);
+	t[ 2] =   E(0, 1) * f02 - E(0, 2) * f06 + E(0, 3) * f10;
+	t[ 3] = -(E(0, 1) * f03 - E(0, 2) * f07 + E(0, 3) * f11);
+
+	t[ 4] = -(E(1, 0) * f00 - E(1, 2) * f12 + E(1, 3) * f16);
+	t[ 5] =   E(0, 0) * f00 - E(0, 2) * f12 + E(0, 3) * f16;
+	t[ 6] = -(E(0, 0) * f02 - E(0, 2) * f14 + E(0, 3) * f18);
+	t[ 7] =   E(0, 0) * f03 - E(0, 2) * f15 + E(0, 3) * f19;
+
+	t[ 8] =   E(1, 0) * f04 - E(1, 1) * f12 + E(1, 3) * f20;
+	t[ 9] = -(E(0, 0) * f04 - E(0, 1) * f12 + E(0, 3) * f20);
+	t[10] =   E(0, 0) * f06 - E(0, 1) * f14 + E(0, 3) * f22;
+	t[11] = -(E(0, 0) * f07 - E(0, 1) * f15 + E(0, 3) * f23);
+
+	t[12] = -(E(1, 0) * f08 - E(1, 1) * f16 + E(1, 2) * f20);
+	t[13] =   E(0, 0) * f08 - E(0, 1) * f16 + E(0, 2) * f20;
+	t[14] = -(E(0, 0) * f10 - E(0, 1) * f18 + E(0, 2) * f22);
+	t[15] =   E(0, 0) * f11 - E(0, 1) * f19 + E(0, 2) * f23;
+
+	const float det = E(0, 0) * t[0] + E(0, 1) * t[4] + E(0, 2) * t[8] + E(0, 3) * t[12];
+
+	#undef E
+
+	if (det == 0.0f)
+		return false;
+
+	const float invDet = 1.0f / det;
+	for (int i = 0; i < 16; i++)
+		out[i] = t[i] * invDet;
+
+	return true;
+}
+
+#endif // XOREOS_SSE2
+
+
+const char *Mat4::getKernelName() {
+#ifdef XOREOS_SSE2
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
+
+Mat4::Mat4() {
+	std::memcpy(_m, kIdentity, sizeof(_m));
+}
+
+Mat4::Mat4(const float *m) {
+	std::memcpy(_m, m, sizeof(_m));
+}
+
+const float *Mat4::get() const {
+	return _m;
+}
+
+void Mat4::set(const float *m) {
+	std::memcpy(_m, m, sizeof(_m));
+}
+
+void Mat4::loadIdentity() {
+	std::memcpy(_m, kIdentity, sizeof(_m));
+}
+
+Mat4 Mat4::operator*(const Mat4 &right) const {
+	Mat4 tmp(*this);
+
+	multiply(tmp._m, _m, right._m);
+
+	return tmp;
+}
+
+Mat4 &Mat4::operator*=(const Mat4 &right) {
+	multiply(_m, _m, right._m);
+
+	return *this;
+}
+
+Vec4 Mat4::operator*(const Vec4 &v) const {
+	Vec4 tmp;
+
+	multiply(tmp.get(), _m, v.get(), 0);
+
+	return tmp;
+}
+
+float Mat4::getDeterminant() const {
+	#define E(c, r) _m[(c) * 4 + (r)]
+
+	const float f0 = E(2, 2) * E(3, 3) - E(3, 2) * E(2, 3);
+	const float f1 = E(2, 1) * E(3, 3) - E(3, 1) * E(2, 3);
+	const float f2 = E(2, 1) * E(3, 2) - E(3, 1) * E(2, 2);
+	const float f3 = E(2, 0) * E(3, 3) - E(3, 0) * E(2, 3);
+	const float f4 = E(2, 0) * E(3, 2) - E(3, 0) * E(2, 2);
+	const float f5 = E(2, 0) * E(3, 1) - E(3, 0) * E(2, 1);
+
+	const float d =
+		E(0, 0) *  (E(1, 1) * f0 - E(1, 2) * f1 + E(1, 3) * f2) +
+		E(0, 1) * -(E(1, 0) * f0 - E(1, 2) * f3 + E(1, 3) * f4) +
+		E(0, 2) *  (E(1, 0) * f1 - E(1, 1) * f3 + E(1, 3) * f5) +
+		E(0, 3) * -(E(1, 0) * f2 - E(1, 1) * f4 + E(1, 2) * f5);
+
+	#undef E
+
+	return d;
+}
+
+bool Mat4::isInvertible() const {
+	return getDeterminant() != 0.0f;
+}
+
+Mat4 Mat4::getTranspose() const {
+	Mat4 tmp;
+
+	for (int i = 0; i < 4; i++)
+		for (int j = 0; j < 4; j++)
+			tmp._m[i * 4 + j] = _m[j * 4 + i];
+
+	return tmp;
+}
+
+Mat4 Mat4::getInverse() const {
+	Mat4 tmp;
+
+	if (!Common::invert(tmp._m, _m))
+		throw Exception("Mat4::getInverse(): Determinant == 0");
+
+	return tmp;
+}
+
+void Mat4::transpose() {
+	*this = getTranspose();
+}
+
+void Mat4::invert() {
+	*this = getInverse();
+}
+
+void Mat4::translate(float x, float y, float z) {
+	// Only the fourth column changes
+#ifdef XOREOS_SSE2
+	_mm_storeu_ps(_m + 12, combine(_m, x, y, z));
+#else
+	for (int j = 0; j < 4; j++)
+		_m[12 + j] += _m[j] * x + _m[4 + j] * y + _m[8 + j] * z;
+#endif
+}
+
+void Mat4::scale(float x, float y, float z) {
+	for (int j = 0; j < 4; j++) {
+		_m[0 + j] *= x;
+		_m[4 + j] *= y;
+		_m[8 + j] *= z;
+	}
+}
+
+void Mat4::rotate(float angle, float x, float y, float z) {
+	// Normalize the axis vector
+	float length = x * x + y * y + z * z;
+	if ((length != 1.0) && (length != 0.0)) {
+		length = sqrtf(length);
+
+		x /= length;
+		y /= length;
+		z /= length;
+	}
+
+	const float c = cosf(deg2rad(angle));
+	const float s = sinf(deg2rad(angle));
+
+	// The upper-left 3x3 of the rotation matrix, column-major.
+	// The fourth column stays as it is.
+	const float r[9] = {
+		(x * x) * (1.0f - c) +     c,
+		(y * x) * (1.0f - c) + z * s,
+		(z * x) * (1.0f - c) - y * s,
+		(x * y) * (1.0f - c) - z * s,
+		(y * y) * (1.0f - c) +     c,
+		(z * y) * (1.0f - c) + x * s,
+		(x * z) * (1.0f - c) + y * s,
+		(y * z) * (1.0f - c) - x * s,
+		(z * z) * (1.0f - c) +     c
+	};
+
+#ifdef XOREOS_SSE2
+	const __m128 c0 = _mm_loadu_ps(_m + 0);
+	const __m128 c1 = _mm_loadu_ps(_m + 4);
+	const __m128 c2 = _mm_loadu_ps(_m + 8);
+
+	for (int i = 0; i < 3; i++) {
+		__m128 t =         _mm_mul_ps(c0, _mm_set1_ps(r[i * 3 + 0]));
+		t = _mm_add_ps(t, _mm_mul_ps(c1, _mm_set1_ps(r[i * 3 + 1])));
+		t = _mm_add_ps(t, _mm_mul_ps(c2, _mm_set1_ps(r[i * 3 + 2])));
+
+		_mm_storeu_ps(_m + i * 4, t);
+	}
+#else
+	float t[12];
+	for (int i = 0; i < 3; i++)
+		for (int j = 0; j < 4; j++)
+			t[i * 4 + j] = _m[j] * r[i * 3 + 0] + _m[4 + j] * r[i * 3 + 1] + _m[8 + j] * r[i * 3 + 2];
+
+	std::memcpy(_m, t, sizeof(t));
+#endif
+}
+
+Vec3 Mat4::transformPoint(const Vec3 &p) const {
+	Vec3 tmp = p;
+
+	transformPoint(tmp[0], tmp[1], tmp[2]);
+
+	return tmp;
+}
+
+void Mat4::transformPoint(float &x, float &y, float &z) const {
+#ifdef XOREOS_SSE2
+	float r[4];
+	_mm_storeu_ps(r, combine(_m, x, y, z));
+
+	x = r[0];
+	y = r[1];
+	z = r[2];
+#else
+	const float tX = _m[0] * x + _m[4] * y + _m[ 8] * z + _m[12];
+	const float tY = _m[1] * x + _m[5] * y + _m[ 9] * z + _m[13];
+	const float tZ = _m[2] * x + _m[6] * y + _m[10] * z + _m[14];
+
+	x = tX;
+	y = tY;
+	z = tZ;
+#endif
+}
+
+void Mat4::transformAABB(const float *min, const float *max, float *outMin, float *outMax) const {
+	// Transform the center as a point, and the half-extents by the absolute of the rotation/scale.
+	// This gives the same box as transforming all eight corners and enclosing them.
+
+	const float cX = (min[0] + max[0]) * 0.5f;
+	const float cY = (min[1] + max[1]) * 0.5f;
+	const float cZ = (min[2] + max[2]) * 0.5f;
+
+	const float eX = (max[0] - min[0]) * 0.5f;
+	const float eY = (max[1] - min[1]) * 0.5f;
+	const float eZ = (max[2] - min[2]) * 0.5f;
+
+#ifdef XOREOS_SSE2
+	const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+
+	const __m128 center = combine(_m, cX, cY, cZ);
+
+	__m128 extent =              _mm_mul_ps(_mm_and_ps(_mm_loadu_ps(_m + 0), absMask), _mm_set1_ps(eX));
+	extent = _mm_add_ps(extent, _mm_mul_ps(_mm_and_ps(_mm_loadu_ps(_m + 4), absMask), _mm_set1_ps(eY)));
+	extent = _mm_add_ps(extent, _mm_mul_ps(_mm_and_ps(_mm_loadu_ps(_m + 8), absMask), _mm_set1_ps(eZ)));
+
+	float rMin[4], rMax[4];
+	_mm_storeu_ps(rMin, _mm_sub_ps(center, extent));
+	_mm_storeu_ps(rMax, _mm_add_ps(center, extent));
+
+	for (int i = 0; i < 3; i++) {
+		outMin[i] = rMin[i];
+		outMax[i] = rMax[i];
+	}
+#else
+	for (int i = 0; i < 3; i++) {
+		const float center = _m[i] * cX + _m[4 + i] * cY + _m[8 + i] * cZ + _m[12 + i];
+		const float extent = ABS(_m[i]) * eX + ABS(_m[4 + i]) * eY + ABS(_m[8 + i]) * eZ;
+
+		outMin[i] = center - extent;
+		outMax[i] = center + extent;
+	}
+#endif
+}
+
+} // End of namespace Common
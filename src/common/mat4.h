@@ -0,0 +1,107 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/mat4.h
+ *  A 4x4 matrix.
+ */
+
+#ifndef COMMON_MAT4_H
+#define COMMON_MAT4_H
+
+#include "common/vec3.h"
+#include "common/vec4.h"
+
+namespace Common {
+
+/** A 4x4 matrix, stored on the stack in column-major order, like OpenGL expects it.
+ *
+ *  Multiplication, inversion and the point/box transformations use SSE2
+ *  where available, with plain C++ fallbacks otherwise.
+ */
+class Mat4 {
+public:
+	/** Create an identity matrix. */
+	Mat4();
+	/** Create a matrix from a flat array, column-major order. */
+	explicit Mat4(const float *m);
+
+	/** Get the matrix elements in a flat array, column-major order. */
+	const float *get() const;
+	/** Set the matrix elements from flat array, column-major order. */
+	void set(const float *m);
+
+	float &operator()(int row, int column) {
+		return _m[(column * 4) + row];
+	}
+
+	float operator()(int row, int column) const {
+		return _m[(column * 4) + row];
+	}
+
+	Mat4  operator* (const Mat4 &right) const;
+	Mat4 &operator*=(const Mat4 &right);
+
+	Vec4 operator*(const Vec4 &v) const;
+
+	void loadIdentity();
+
+	float getDeterminant() const;
+	bool isInvertible() const;
+
+	Mat4 getTranspose() const;
+	/** Return the inverse. Throws if the matrix is singular. */
+	Mat4 getInverse() const;
+
+	void transpose();
+	void invert();
+
+	/** Multiply with a translation matrix. */
+	void translate(float x, float y, float z);
+	/** Multiply with a scaling matrix. */
+	void scale    (float x, float y, float z);
+	/** Multiply with a rotation matrix, of angle degrees around the axis (x, y, z). */
+	void rotate(float angle, float x, float y, float z);
+
+	/** Transform a point, assuming this is an affine transformation. */
+	Vec3 transformPoint(const Vec3 &p) const;
+	/** Transform a point, assuming this is an affine transformation. */
+	void transformPoint(float &x, float &y, float &z) const;
+
+	/** Transform an axis-aligned box, returning the axis-aligned box enclosing the result.
+	 *
+	 *  Assumes this is an affine transformation. The input and output may overlap.
+	 */
+	void transformAABB(const float *min, const float *max, float *outMin, float *outMax) const;
+
+	/** Return the name of the kernels compiled in, "SSE2" or "scalar". */
+	static const char *getKernelName();
+
+protected:
+	float _m[16];
+};
+
+} // End of namespace Common
+
+#endif // COMMON_MAT4_H
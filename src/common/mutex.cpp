@@ -140,4 +140,69 @@ void Condition::signal() {
 	SDL_CondSignal(_condition);
 }
 
+void Condition::broadcast() {
+	SDL_CondBroadcast(_condition);
+}
+
+
+ReadWriteLock::ReadWriteLock() : _condition(_mutex), _readers(0), _writer(false) {
+}
+
+ReadWriteLock::~ReadWriteLock() {
+}
+
+void ReadWriteLock::lockRead() {
+	StackLock lock(_mutex);
+
+	while (_writer)
+		_condition.wait();
+
+	_readers++;
+}
+
+void ReadWriteLock::unlockRead() {
+	StackLock lock(_mutex);
+
+	assert(_readers > 0);
+
+	if (--_readers == 0)
+		_condition.broadcast();
+}
+
+void ReadWriteLock::lockWrite() {
+	StackLock lock(_mutex);
+
+	while (_writer || (_readers > 0))
+		_condition.wait();
+
+	_writer = true;
+}
+
+void ReadWriteLock::unlockWrite() {
+	StackLock lock(_mutex);
+
+	assert(_writer);
+
+	_writer = false;
+	_condition.broadcast();
+}
+
+
+StackReadLock::StackReadLock(ReadWriteLock &lock) : _lock(&lock) {
+	_lock->lockRead();
+}
+
+StackReadLock::~StackReadLock() {
+	_lock->unlockRead();
+}
+
+
+StackWriteLock::StackWriteLock(ReadWriteLock &lock) : _lock(&lock) {
+	_lock->lockWrite();
+}
+
+StackWriteLock::~StackWriteLock() {
+	_lock->unlockWrite();
+}
+
 } // End of namespace Common
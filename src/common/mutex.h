@@ -86,6 +86,7 @@ public:
 
 	bool wait(uint32 timeout = 0);
 	void signal();
+	void broadcast();
 
 private:
 	bool _ownMutex;
@@ -94,6 +95,50 @@ private:
 	SDL_cond *_condition;
 };
 
+/** A lock that lets many threads read, or a single thread write, at a time.
+ *
+ *  Readers take precedence over waiting writers, so a thread may take a
+ *  read lock it already holds. Write locks are not recursive.
+ */
+class ReadWriteLock {
+public:
+	ReadWriteLock();
+	~ReadWriteLock();
+
+	void lockRead();
+	void unlockRead();
+
+	void lockWrite();
+	void unlockWrite();
+
+private:
+	Mutex     _mutex;
+	Condition _condition;
+
+	uint32 _readers; ///< Number of read locks currently held.
+	bool   _writer;  ///< Is the write lock currently held?
+};
+
+/** Convenience class that read-locks a ReadWriteLock on creation and unlocks it on destruction. */
+class StackReadLock {
+public:
+	StackReadLock(ReadWriteLock &lock);
+	~StackReadLock();
+
+private:
+	ReadWriteLock *_lock;
+};
+
+/** Convenience class that write-locks a ReadWriteLock on creation and unlocks it on destruction. */
+class StackWriteLock {
+public:
+	StackWriteLock(ReadWriteLock &lock);
+	~StackWriteLock();
+
+private:
+	ReadWriteLock *_lock;
+};
+
 } // End of namespace Common
 
 #endif // COMMON_MUTEX_H
@@ -0,0 +1,159 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/quat.cpp
+ *  A quaternion.
+ */
+
+#include <cmath>
+
+#include "common/quat.h"
+#include "common/simd.h"
+#include "common/util.h"
+#include "common/maths.h"
+
+namespace Common {
+
+Quat::Quat() {
+	_q[0] = 0.0f; _q[1] = 0.0f; _q[2] = 0.0f; _q[3] = 1.0f;
+}
+
+Quat::Quat(float x, float y, float z, float w) {
+	_q[0] = x; _q[1] = y; _q[2] = z; _q[3] = w;
+}
+
+Quat Quat::fromAxisAngle(float angle, float x, float y, float z) {
+	const float length = sqrtf(x * x + y * y + z * z);
+	if (length == 0.0f)
+		return Quat();
+
+	const float half = deg2rad(angle) * 0.5f;
+	const float s    = sinf(half) / length;
+
+	return Quat(x * s, y * s, z * s, cosf(half));
+}
+
+Quat Quat::operator*(const Quat &right) const {
+	const float *a = _q;
+	const float *b = right._q;
+
+	return Quat(a[3] * b[0] + a[0] * b[3] + a[1] * b[2] - a[2] * b[1],
+	            a[3] * b[1] - a[0] * b[2] + a[1] * b[3] + a[2] * b[0],
+	            a[3] * b[2] + a[0] * b[1] - a[1] * b[0] + a[2] * b[3],
+	            a[3] * b[3] - a[0] * b[0] - a[1] * b[1] - a[2] * b[2]);
+}
+
+float Quat::dot(const Quat &q) const {
+	return _q[0] * q._q[0] + _q[1] * q._q[1] + _q[2] * q._q[2] + _q[3] * q._q[3];
+}
+
+Quat &Quat::normalize() {
+	const float length = sqrtf(dot(*this));
+	if (length == 0.0f) {
+		*this = Quat();
+		return *this;
+	}
+
+	const float s = 1.0f / length;
+
+	_q[0] *= s; _q[1] *= s; _q[2] *= s; _q[3] *= s;
+
+	return *this;
+}
+
+void Quat::getAxisAngle(float &angle, float &x, float &y, float &z) const {
+	const float w = CLIP(_q[3], -1.0f, 1.0f);
+
+	angle = rad2deg(acosf(w) * 2.0f);
+
+	const float s = sqrtf(1.0f - w * w);
+	if (s < 0.0001f) {
+		// No rotation to speak of, so any axis will do
+		x = 1.0f; y = 0.0f; z = 0.0f;
+		return;
+	}
+
+	x = _q[0] / s;
+	y = _q[1] / s;
+	z = _q[2] / s;
+}
+
+Mat4 Quat::getMatrix() const {
+	const float x = _q[0], y = _q[1], z = _q[2], w = _q[3];
+
+	const float m[16] = {
+		1.0f - 2.0f * (y * y + z * z),        2.0f * (x * y + z * w),        2.0f * (x * z - y * w), 0.0f,
+		       2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z),        2.0f * (y * z + x * w), 0.0f,
+		       2.0f * (x * z + y * w),        2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f,
+		0.0f, 0.0f, 0.0f, 1.0f
+	};
+
+	return Mat4(m);
+}
+
+Quat Quat::slerp(const Quat &a, const Quat &b, float t) {
+	float cosTheta = a.dot(b);
+
+	// q and -q are the same rotation; go the short way around
+	float sign = 1.0f;
+	if (cosTheta < 0.0f) {
+		cosTheta = -cosTheta;
+		sign     = -1.0f;
+	}
+
+	float wA, wB;
+	if (cosTheta > 0.9995f) {
+		// Nearly parallel, where sin(theta) approaches 0. Interpolate linearly and renormalize.
+		wA = 1.0f - t;
+		wB = t;
+	} else {
+		const float theta    = acosf(cosTheta);
+		const float sinTheta = sinf(theta);
+
+		wA = sinf((1.0f - t) * theta) / sinTheta;
+		wB = sinf(t * theta) / sinTheta;
+	}
+
+	wB *= sign;
+
+	Quat q;
+
+#ifdef XOREOS_SSE2
+	const __m128 r = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(a._q), _mm_set1_ps(wA)),
+	                            _mm_mul_ps(_mm_loadu_ps(b._q), _mm_set1_ps(wB)));
+
+	_mm_storeu_ps(q._q, r);
+#else
+	for (int i = 0; i < 4; i++)
+		q._q[i] = a._q[i] * wA + b._q[i] * wB;
+#endif
+
+	if (cosTheta > 0.9995f)
+		q.normalize();
+
+	return q;
+}
+
+} // End of namespace Common
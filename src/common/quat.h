@@ -0,0 +1,78 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/quat.h
+ *  A quaternion.
+ */
+
+#ifndef COMMON_QUAT_H
+#define COMMON_QUAT_H
+
+#include "common/mat4.h"
+
+namespace Common {
+
+/** A rotation quaternion, stored on the stack as (x, y, z, w). */
+class Quat {
+public:
+	/** Create the identity rotation. */
+	Quat();
+	Quat(float x, float y, float z, float w);
+
+	/** Create a rotation of angle degrees around the axis (x, y, z). */
+	static Quat fromAxisAngle(float angle, float x, float y, float z);
+
+	const float &operator[](int i) const {
+		return _q[i];
+	}
+
+	float &operator[](int i) {
+		return _q[i];
+	}
+
+	/** Concatenate two rotations, first applying right, then this. */
+	Quat operator*(const Quat &right) const;
+
+	float dot(const Quat &q) const;
+
+	/** Scale the quaternion to unit length. */
+	Quat &normalize();
+
+	/** Get the rotation as angle degrees around a normalized axis. */
+	void getAxisAngle(float &angle, float &x, float &y, float &z) const;
+
+	/** Get the rotation matrix for this quaternion. */
+	Mat4 getMatrix() const;
+
+	/** Spherical linear interpolation between a (t = 0) and b (t = 1), along the shortest arc. */
+	static Quat slerp(const Quat &a, const Quat &b, float t);
+
+private:
+	float _q[4];
+};
+
+} // End of namespace Common
+
+#endif // COMMON_QUAT_H
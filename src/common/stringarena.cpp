@@ -0,0 +1,127 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/stringarena.cpp
+ *  An arena of interned strings.
+ */
+
+#include <cstring>
+
+#include "common/stringarena.h"
+
+namespace Common {
+
+StringArena::StringArena() : _count(0) {
+}
+
+StringArena::~StringArena() {
+}
+
+void StringArena::clear() {
+	_data.clear();
+	_table.clear();
+
+	_count = 0;
+}
+
+uint32 StringArena::hash(const char *str) {
+	// 32bit FNV-1a
+	uint32 h = 0x811C9DC5;
+
+	while (*str)
+		h = (h ^ ((byte) *str++)) * 16777619;
+
+	return h;
+}
+
+uint32 StringArena::findSlot(const char *str, uint32 h) const {
+	const uint32 mask = _table.size() - 1;
+
+	for (uint32 slot = h & mask; ; slot = (slot + 1) & mask)
+		if ((_table[slot] == kInvalidOffset) || !std::strcmp(&_data[_table[slot]], str))
+			return slot;
+}
+
+void StringArena::rehash(uint32 size) {
+	std::vector<uint32> table(size, kInvalidOffset);
+
+	const uint32 mask = size - 1;
+
+	for (std::vector<uint32>::const_iterator o = _table.begin(); o != _table.end(); ++o) {
+		if (*o == kInvalidOffset)
+			continue;
+
+		uint32 slot = hash(&_data[*o]) & mask;
+		while (table[slot] != kInvalidOffset)
+			slot = (slot + 1) & mask;
+
+		table[slot] = *o;
+	}
+
+	_table.swap(table);
+}
+
+uint32 StringArena::intern(const char *str) {
+	// Keep the table at most half full
+	if (((_count + 1) * 2) > _table.size())
+		rehash(_table.empty() ? 64 : (_table.size() * 2));
+
+	const uint32 slot = findSlot(str, hash(str));
+	if (_table[slot] != kInvalidOffset)
+		return _table[slot];
+
+	const uint32 offset = _data.size();
+
+	_data.insert(_data.end(), str, str + std::strlen(str) + 1);
+
+	_table[slot] = offset;
+	_count++;
+
+	return offset;
+}
+
+uint32 StringArena::find(const char *str) const {
+	if (_table.empty())
+		return kInvalidOffset;
+
+	return _table[findSlot(str, hash(str))];
+}
+
+const char *StringArena::get(uint32 offset) const {
+	if ((offset == kInvalidOffset) || (offset >= _data.size()))
+		return "";
+
+	return &_data[offset];
+}
+
+uint32 StringArena::getStringCount() const {
+	return _count;
+}
+
+uint32 StringArena::getMemoryUsage() const {
+	return _data.capacity() + _table.capacity() * sizeof(uint32);
+}
+
+} // End of namespace Common
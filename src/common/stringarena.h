@@ -0,0 +1,99 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/stringarena.h
+ *  An arena of interned strings.
+ */
+
+#ifndef COMMON_STRINGARENA_H
+#define COMMON_STRINGARENA_H
+
+#include <vector>
+
+#include "common/types.h"
+
+namespace Common {
+
+/** An append-only arena of interned strings.
+ *
+ *  Every distinct string is stored exactly once, NUL-terminated, in one
+ *  contiguous block of memory, and is identified by its offset into that
+ *  block. Interning the same string again returns the same offset.
+ *
+ *  Strings are never removed, short of clearing the whole arena.
+ */
+class StringArena {
+public:
+	/** The offset representing "no string". */
+	static const uint32 kInvalidOffset = 0xFFFFFFFF;
+
+	StringArena();
+	~StringArena();
+
+	/** Remove all strings. */
+	void clear();
+
+	/** Add the string to the arena, if it's not already in it.
+	 *
+	 *  @param  str The string to intern.
+	 *  @return The offset of the string within the arena.
+	 */
+	uint32 intern(const char *str);
+
+	/** Find the string in the arena.
+	 *
+	 *  @param  str The string to look for.
+	 *  @return The offset of the string within the arena, or kInvalidOffset if not found.
+	 */
+	uint32 find(const char *str) const;
+
+	/** Return the string at that offset.
+	 *
+	 *  The pointer is only valid until the next string is interned.
+	 *  The empty string is returned for kInvalidOffset.
+	 */
+	const char *get(uint32 offset) const;
+
+	/** Return the number of distinct strings in the arena. */
+	uint32 getStringCount() const;
+	/** Return the number of bytes used by the arena. */
+	uint32 getMemoryUsage() const;
+
+private:
+	std::vector<char>   _data;  ///< The string data.
+	std::vector<uint32> _table; ///< Open-addressing table of string offsets.
+
+	uint32 _count; ///< Number of strings in the arena.
+
+	static uint32 hash(const char *str);
+
+	uint32 findSlot(const char *str, uint32 h) const;
+
+	void rehash(uint32 size);
+};
+
+} // End of namespace Common
+
+#endif // COMMON_STRINGARENA_H
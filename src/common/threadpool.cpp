@@ -0,0 +1,172 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/threadpool.cpp
+ *  A pool of worker threads.
+ */
+
+#if defined(WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#elif defined(UNIX)
+	#include <unistd.h>
+#endif
+
+#include "common/threadpool.h"
+#include "common/util.h"
+
+namespace Common {
+
+ThreadPool::Worker::Worker(ThreadPool &pool) : _pool(&pool) {
+}
+
+ThreadPool::Worker::~Worker() {
+	destroyThread();
+}
+
+bool ThreadPool::Worker::start() {
+	return createThread();
+}
+
+void ThreadPool::Worker::threadMethod() {
+	Job job;
+
+	while (_pool->getJob(job)) {
+		job();
+
+		_pool->finishJob();
+	}
+
+	_pool->finishWorker();
+}
+
+
+ThreadPool::ThreadPool(uint32 threadCount) : _jobsPending(0), _workersFinished(0), _shutdown(false),
+	_jobsAvailable(_mutex), _jobsDone(_mutex), _workerDone(_mutex) {
+
+	if (threadCount == 0)
+		threadCount = getCoreCount();
+
+	_workers.reserve(threadCount);
+	for (uint32 i = 0; i < threadCount; i++) {
+		Worker *worker = new Worker(*this);
+		if (!worker->start()) {
+			warning("ThreadPool: Failed to create worker thread %u", i);
+
+			delete worker;
+			break;
+		}
+
+		_workers.push_back(worker);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	_mutex.lock();
+
+	_shutdown = true;
+	_jobsAvailable.broadcast();
+
+	// Wait for all workers to leave their thread method, so none of them accesses us anymore
+	while (_workersFinished < _workers.size())
+		_workerDone.wait();
+
+	_mutex.unlock();
+
+	for (std::vector<Worker *>::iterator w = _workers.begin(); w != _workers.end(); ++w)
+		delete *w;
+}
+
+uint32 ThreadPool::getThreadCount() const {
+	return _workers.size();
+}
+
+void ThreadPool::addJob(const Job &job) {
+	if (_workers.empty()) {
+		// No threads to run the job in, so run it directly
+		job();
+		return;
+	}
+
+	StackLock lock(_mutex);
+
+	_jobs.push_back(job);
+	_jobsPending++;
+
+	_jobsAvailable.signal();
+}
+
+void ThreadPool::wait() {
+	StackLock lock(_mutex);
+
+	while (_jobsPending > 0)
+		_jobsDone.wait();
+}
+
+bool ThreadPool::getJob(Job &job) {
+	StackLock lock(_mutex);
+
+	while (_jobs.empty() && !_shutdown)
+		_jobsAvailable.wait();
+
+	if (_jobs.empty())
+		return false;
+
+	job = _jobs.front();
+	_jobs.pop_front();
+
+	return true;
+}
+
+void ThreadPool::finishJob() {
+	StackLock lock(_mutex);
+
+	if (--_jobsPending == 0)
+		_jobsDone.broadcast();
+}
+
+void ThreadPool::finishWorker() {
+	StackLock lock(_mutex);
+
+	_workersFinished++;
+	_workerDone.signal();
+}
+
+uint32 ThreadPool::getCoreCount() {
+	long count = 1;
+
+#if defined(WIN32)
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+
+	count = info.dwNumberOfProcessors;
+#elif defined(UNIX) && defined(_SC_NPROCESSORS_ONLN)
+	count = sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+
+	return (count > 0) ? ((uint32) count) : 1;
+}
+
+} // End of namespace Common
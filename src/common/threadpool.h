@@ -0,0 +1,113 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/threadpool.h
+ *  A pool of worker threads.
+ */
+
+#ifndef COMMON_THREADPOOL_H
+#define COMMON_THREADPOOL_H
+
+#include <list>
+#include <vector>
+
+#include <boost/function.hpp>
+
+#include "common/types.h"
+#include "common/noncopyable.h"
+#include "common/thread.h"
+#include "common/mutex.h"
+
+namespace Common {
+
+/** A pool of worker threads, running jobs in parallel. */
+class ThreadPool : NonCopyable {
+public:
+	typedef boost::function<void ()> Job;
+
+	/** Create a thread pool.
+	 *
+	 *  @param threadCount The number of worker threads. If 0, create
+	 *                     one thread for each available processor core.
+	 */
+	ThreadPool(uint32 threadCount = 0);
+	~ThreadPool();
+
+	/** Return the number of worker threads in this pool. */
+	uint32 getThreadCount() const;
+
+	/** Queue a job to be run by one of the worker threads.
+	 *
+	 *  Jobs are started in the order they were added, but may
+	 *  finish in any order. A job must not throw.
+	 */
+	void addJob(const Job &job);
+
+	/** Wait until all queued jobs have finished. */
+	void wait();
+
+	/** Return the number of processor cores available. */
+	static uint32 getCoreCount();
+
+private:
+	/** A worker thread, running jobs out of the pool's queue. */
+	class Worker : public Thread {
+	public:
+		Worker(ThreadPool &pool);
+		~Worker();
+
+		bool start();
+
+	private:
+		ThreadPool *_pool;
+
+		void threadMethod();
+	};
+
+	std::vector<Worker *> _workers;
+
+	std::list<Job> _jobs; ///< Jobs waiting to be run.
+
+	uint32 _jobsPending;     ///< Number of jobs queued or running.
+	uint32 _workersFinished; ///< Number of workers that have shut down.
+
+	bool _shutdown; ///< Should the workers shut down?
+
+	Mutex     _mutex;
+	Condition _jobsAvailable;
+	Condition _jobsDone;
+	Condition _workerDone;
+
+	/** Get the next job to run, waiting for one if necessary. */
+	bool getJob(Job &job);
+	/** Mark a job as finished. */
+	void finishJob();
+	/** Mark a worker thread as shut down. */
+	void finishWorker();
+};
+
+} // End of namespace Common
+
+#endif // COMMON_THREADPOOL_H
@@ -23,70 +23,24 @@
  * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
  */
 
-/** @file common/vector3.h
- *  A 3d vector.
+/** @file common/timestamp.cpp
+ *  High-resolution timestamps, for measuring durations.
  */
 
-#ifndef COMMON_VECTOR3_H
-#define COMMON_VECTOR3_H
+#include <boost/date_time/posix_time/posix_time.hpp>
 
-#include <cmath>
+#include "common/timestamp.h"
 
-namespace Common {
-
-class Vector3 {
-	float _x, _y, _z;
-
-public:
-	Vector3() {
-	}
-
-	Vector3(float x, float y, float z) : _x(x), _y(y), _z(z) {
-	}
-
-	Vector3(const Vector3 &b) : _x(b._x), _y(b._y), _z(b._z) {
-	}
-
-	const float &operator[] (int i) const {
-		return (&_x)[i];
-	}
-
-	float &operator[] (int i) {
-		return (&_x)[i];
-	}
+using boost::posix_time::ptime;
+using boost::posix_time::microsec_clock;
 
-	Vector3 operator - (const Vector3 &v) const {
-		return Vector3(_x - v._x, _y - v._y, _z - v._z);
-	}
+/** The time the program was started, more or less. */
+static const ptime kStartTime = microsec_clock::universal_time();
 
-	Vector3 operator + (const Vector3 &v) const {
-		return Vector3(_x + v._x, _y + v._y, _z + v._z);
-	}
-
-	Vector3 operator * (const float f) const {
-		return Vector3(_x * f, _y * f, _z * f);
-	}
-
-	Vector3 cross(const Vector3 & v) const {
-		return Vector3(_y * v._z - _z * v._y,
-					_z * v._x - _x * v._z,
-					_x * v._y - _y * v._x);
-	}
-
-	float dot(const Vector3 & v) const {
-		return _x * v._x + _y * v._y + _z * v._z;
-	}
-
-	float length() const {
-		return sqrtf((*this).dot(*this));
-	}
-
-	Vector3 & norm() {
-		(*this) = (*this) * (1 / length());
-		return *this;
-	}
-};
+namespace Common {
 
+uint64 getMicroseconds() {
+	return (microsec_clock::universal_time() - kStartTime).total_microseconds();
 }
 
-#endif // COMMON_VECTOR3_H
+} // End of namespace Common
@@ -30,14 +30,15 @@
 #ifndef COMMON_TRANSMATRIX_H
 #define COMMON_TRANSMATRIX_H
 
-#include "common/matrix.h"
+#include "common/mat4.h"
 
 namespace Common {
 
 /** A transformation matrix. */
-class TransformationMatrix : public Matrix {
+class TransformationMatrix : public Mat4 {
 public:
 	TransformationMatrix();
+	TransformationMatrix(const Mat4 &m);
 
 	float getX() const;
 	float getY() const;
@@ -45,14 +46,7 @@ public:
 
 	void getPosition(float &x, float &y, float &z) const;
 
-	void loadIdentity();
-
-	void translate(float x, float y, float z);
-	void scale    (float x, float y, float z);
-
-	void rotate(float angle, float x, float y, float z);
-
-	void transform(const Matrix &m);
+	void transform(const Mat4 &m);
 };
 
 } // End of namespace Common
@@ -112,15 +112,21 @@ static void readLine(SeekableReadStream &stream, std::vector<T> &data,
 /** A manager handling string encoding conversions. */
 class ConversionManager : public Singleton<ConversionManager> {
 public:
-	ConversionManager() : _fromLatin9((iconv_t) -1) {
+	ConversionManager() : _fromLatin9((iconv_t) -1), _toLatin9((iconv_t) -1) {
 		_fromLatin9 = iconv_open("UTF-8", "ISO-8859-15");
 		if (_fromLatin9 == ((iconv_t) -1))
 			throw Exception("Failed to initialize ISO-8859-15 -> UTF-8 conversion");
+
+		_toLatin9 = iconv_open("ISO-8859-15", "UTF-8");
+		if (_toLatin9 == ((iconv_t) -1))
+			throw Exception("Failed to initialize UTF-8 -> ISO-8859-15 conversion");
 	}
 
 	~ConversionManager() {
 		if (_fromLatin9 != ((iconv_t) -1))
 			iconv_close(_fromLatin9);
+		if (_toLatin9 != ((iconv_t) -1))
+			iconv_close(_toLatin9);
 	}
 
 	std::string fromLatin9(byte *data, uint32 n) {
@@ -148,8 +154,36 @@ public:
 		return convStr;
 	}
 
+	std::string toLatin9(const std::string &str) {
+		if (_toLatin9 == ((iconv_t) -1))
+			throw Exception("No iconv context");
+
+		size_t inBytes  = str.size();
+		size_t outBytes = str.size(); // Latin9 is never longer than UTF-8
+
+		char *data = const_cast<char *>(str.c_str());
+
+		byte *convData = new byte[outBytes];
+		byte *outBuf = convData;
+
+		// Reset the converter's state
+		iconv(_toLatin9, 0, 0, 0, 0);
+
+		// Convert
+		if (iconv(_toLatin9, &data, &inBytes, (char **) &outBuf, &outBytes) == ((size_t) -1))
+			warning("Failed completely converting a string to latin9");
+
+		// And this should be our converted string
+		std::string convStr((const char *) convData, str.size() - outBytes);
+
+		delete[] convData;
+
+		return convStr;
+	}
+
 private:
 	iconv_t _fromLatin9;
+	iconv_t _toLatin9;
 };
 
 }
@@ -853,6 +887,15 @@ void UString::readFixedLatin9(SeekableReadStream &stream, uint32 length, bool co
 	recalculateSize();
 }
 
+uint32 UString::writeLatin9(WriteStream &stream, bool writeLength) const {
+	const std::string latin9 = ConvMan.toLatin9(_string);
+
+	if (writeLength)
+		stream.writeUint32LE(latin9.size());
+
+	return stream.write(latin9.c_str(), latin9.size());
+}
+
 void UString::readLineLatin9(SeekableReadStream &stream, bool colorCodes) {
 	clear();
 
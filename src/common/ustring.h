@@ -43,6 +43,7 @@
 namespace Common {
 
 class SeekableReadStream;
+class WriteStream;
 
 /** A class holding an UTF-8 string.
  *
@@ -189,6 +190,14 @@ public:
 	/** Read a line of Latin9 out of a stream. */
 	void readLineLatin9(SeekableReadStream &stream, bool colorCodes = false);
 
+	/** Write the string as Latin9 into a stream.
+	 *
+	 *  @param  stream The stream to write into.
+	 *  @param  writeLength Write the string's length in bytes, as an uint32, first?
+	 *  @return The number of bytes of string data written.
+	 */
+	uint32 writeLatin9(WriteStream &stream, bool writeLength = false) const;
+
 	/** Read UTF-16LE out of a stream. */
 	void readUTF16LE(SeekableReadStream &stream);
 	/** Read UTF-16LE out of a stream. */
@@ -0,0 +1,117 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/vec3.h
+ *  A 3D vector.
+ */
+
+#ifndef COMMON_VEC3_H
+#define COMMON_VEC3_H
+
+#include <cmath>
+
+namespace Common {
+
+/** A 3D vector, stored on the stack. */
+class Vec3 {
+public:
+	Vec3() {
+		_v[0] = 0.0f; _v[1] = 0.0f; _v[2] = 0.0f;
+	}
+
+	Vec3(float x, float y, float z) {
+		_v[0] = x; _v[1] = y; _v[2] = z;
+	}
+
+	explicit Vec3(const float *v) {
+		_v[0] = v[0]; _v[1] = v[1]; _v[2] = v[2];
+	}
+
+	const float &operator[](int i) const {
+		return _v[i];
+	}
+
+	float &operator[](int i) {
+		return _v[i];
+	}
+
+	/** Get the vector elements in a flat array. */
+	const float *get() const {
+		return _v;
+	}
+
+	Vec3 operator+(const Vec3 &v) const {
+		return Vec3(_v[0] + v._v[0], _v[1] + v._v[1], _v[2] + v._v[2]);
+	}
+
+	Vec3 operator-(const Vec3 &v) const {
+		return Vec3(_v[0] - v._v[0], _v[1] - v._v[1], _v[2] - v._v[2]);
+	}
+
+	Vec3 operator*(float f) const {
+		return Vec3(_v[0] * f, _v[1] * f, _v[2] * f);
+	}
+
+	Vec3 &operator+=(const Vec3 &v) {
+		_v[0] += v._v[0]; _v[1] += v._v[1]; _v[2] += v._v[2];
+		return *this;
+	}
+
+	Vec3 &operator-=(const Vec3 &v) {
+		_v[0] -= v._v[0]; _v[1] -= v._v[1]; _v[2] -= v._v[2];
+		return *this;
+	}
+
+	Vec3 &operator*=(float f) {
+		_v[0] *= f; _v[1] *= f; _v[2] *= f;
+		return *this;
+	}
+
+	Vec3 cross(const Vec3 &v) const {
+		return Vec3(_v[1] * v._v[2] - _v[2] * v._v[1],
+		            _v[2] * v._v[0] - _v[0] * v._v[2],
+		            _v[0] * v._v[1] - _v[1] * v._v[0]);
+	}
+
+	float dot(const Vec3 &v) const {
+		return _v[0] * v._v[0] + _v[1] * v._v[1] + _v[2] * v._v[2];
+	}
+
+	float length() const {
+		return sqrtf(dot(*this));
+	}
+
+	/** Scale the vector to unit length. */
+	Vec3 &norm() {
+		return *this *= 1.0f / length();
+	}
+
+private:
+	float _v[3];
+};
+
+} // End of namespace Common
+
+#endif // COMMON_VEC3_H
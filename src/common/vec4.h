@@ -0,0 +1,102 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file common/vec4.h
+ *  A 4D vector.
+ */
+
+#ifndef COMMON_VEC4_H
+#define COMMON_VEC4_H
+
+#include "common/vec3.h"
+
+namespace Common {
+
+/** A 4D vector, stored on the stack. Usually a point or direction in homogeneous coordinates. */
+class Vec4 {
+public:
+	Vec4() {
+		_v[0] = 0.0f; _v[1] = 0.0f; _v[2] = 0.0f; _v[3] = 0.0f;
+	}
+
+	Vec4(float x, float y, float z, float w) {
+		_v[0] = x; _v[1] = y; _v[2] = z; _v[3] = w;
+	}
+
+	Vec4(const Vec3 &v, float w) {
+		_v[0] = v[0]; _v[1] = v[1]; _v[2] = v[2]; _v[3] = w;
+	}
+
+	explicit Vec4(const float *v) {
+		_v[0] = v[0]; _v[1] = v[1]; _v[2] = v[2]; _v[3] = v[3];
+	}
+
+	const float &operator[](int i) const {
+		return _v[i];
+	}
+
+	float &operator[](int i) {
+		return _v[i];
+	}
+
+	/** Get the vector elements in a flat array. */
+	const float *get() const {
+		return _v;
+	}
+
+	float *get() {
+		return _v;
+	}
+
+	Vec4 operator+(const Vec4 &v) const {
+		return Vec4(_v[0] + v._v[0], _v[1] + v._v[1], _v[2] + v._v[2], _v[3] + v._v[3]);
+	}
+
+	Vec4 operator-(const Vec4 &v) const {
+		return Vec4(_v[0] - v._v[0], _v[1] - v._v[1], _v[2] - v._v[2], _v[3] - v._v[3]);
+	}
+
+	Vec4 operator*(float f) const {
+		return Vec4(_v[0] * f, _v[1] * f, _v[2] * f, _v[3] * f);
+	}
+
+	float dot(const Vec4 &v) const {
+		return _v[0] * v._v[0] + _v[1] * v._v[1] + _v[2] * v._v[2] + _v[3] * v._v[3];
+	}
+
+	/** Divide x, y and z by w. */
+	Vec3 getProjected() const {
+		const float w = 1.0f / _v[3];
+
+		return Vec3(_v[0] * w, _v[1] * w, _v[2] * w);
+	}
+
+private:
+	float _v[4];
+};
+
+} // End of namespace Common
+
+#endif // COMMON_VEC4_H
@@ -0,0 +1,255 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file engines/aurora/actionscheduler.cpp
+ *  A scheduler for delayed script actions.
+ */
+
+#include "engines/aurora/actionscheduler.h"
+
+namespace Engines {
+
+DelayedAction::DelayedAction() : owner(0), triggerer(0), timestamp(0), _next(0) {
+	state.offset = 0;
+}
+
+
+ActionScheduler::List::List() : head(0), tail(0), size(0) {
+}
+
+void ActionScheduler::List::push(DelayedAction *action) {
+	action->_next = 0;
+
+	if (tail)
+		tail->_next = action;
+	else
+		head = action;
+
+	tail = action;
+	size++;
+}
+
+DelayedAction *ActionScheduler::List::pop() {
+	DelayedAction *action = head;
+	if (!action)
+		return 0;
+
+	head = action->_next;
+	if (!head)
+		tail = 0;
+
+	action->_next = 0;
+
+	size--;
+	return action;
+}
+
+void ActionScheduler::List::append(List &list) {
+	if (!list.head)
+		return;
+
+	if (tail)
+		tail->_next = list.head;
+	else
+		head = list.head;
+
+	tail  = list.tail;
+	size += list.size;
+
+	list.head = 0;
+	list.tail = 0;
+	list.size = 0;
+}
+
+
+ActionScheduler::ActionScheduler() : _time(0), _free(0), _size(0) {
+	for (uint32 i = 0; i < kLevelCount; i++)
+		_levelSize[i] = 0;
+}
+
+ActionScheduler::~ActionScheduler() {
+	for (std::vector<DelayedAction *>::iterator c = _chunks.begin(); c != _chunks.end(); ++c)
+		delete[] *c;
+}
+
+void ActionScheduler::clear() {
+	for (uint32 i = 0; i < kLevelCount; i++) {
+		for (uint32 j = 0; j < kSlotCount; j++) {
+			DelayedAction *action;
+			while ((action = _slots[i][j].pop()))
+				release(action);
+		}
+
+		_levelSize[i] = 0;
+	}
+
+	DelayedAction *action;
+	while ((action = _due.pop()))
+		release(action);
+
+	_size = 0;
+}
+
+void ActionScheduler::schedule(const Common::UString &script,
+                               const Aurora::NWScript::ScriptState &state,
+                               Aurora::NWScript::Object *owner,
+                               Aurora::NWScript::Object *triggerer, uint32 timestamp) {
+
+	DelayedAction *action = allocate();
+
+	// Reused actions keep the capacity of their state, so this rarely allocates
+	action->script    = script;
+	action->state     = state;
+	action->owner     = owner;
+	action->triggerer = triggerer;
+	action->timestamp = timestamp;
+
+	insert(action);
+
+	_size++;
+}
+
+void ActionScheduler::advance(uint32 now) {
+	while (_time < now) {
+		if (_levelSize[0] == 0) {
+			// Nothing waiting at all
+			if (_size == _due.size) {
+				_time = now;
+				break;
+			}
+
+			// Nothing in the lowest level, so skip to the end of its current turn
+			const uint32 end = _time | kSlotMask;
+			if (end >= now) {
+				_time = now;
+				break;
+			}
+
+			_time = end;
+		}
+
+		_time++;
+
+		if ((_time & kSlotMask) == 0)
+			cascade(1);
+
+		// All actions in the slot are due now
+		List &slot = _slots[0][_time & kSlotMask];
+
+		_levelSize[0] -= slot.size;
+		_due.append(slot);
+	}
+}
+
+DelayedAction *ActionScheduler::pop() {
+	DelayedAction *action = _due.pop();
+	if (!action)
+		return 0;
+
+	_size--;
+
+	return action;
+}
+
+void ActionScheduler::release(DelayedAction *action) {
+	action->script.clear();
+	action->state.globals.clear();
+	action->state.locals.clear();
+
+	action->owner     = 0;
+	action->triggerer = 0;
+
+	action->_next = _free;
+	_free = action;
+}
+
+uint32 ActionScheduler::size() const {
+	return _size;
+}
+
+uint32 ActionScheduler::getDueCount() const {
+	return _due.size;
+}
+
+void ActionScheduler::insert(DelayedAction *action) {
+	if (action->timestamp <= _time) {
+		_due.push(action);
+		return;
+	}
+
+	/* The action goes into the level of the highest slot index in which
+	 * its timestamp differs from the current time. Since it lies in the
+	 * future, its slot there is still ahead in the wheel's current turn. */
+	const uint32 diff = action->timestamp ^ _time;
+
+	uint32 level = 0;
+	while ((level < (kLevelCount - 1)) && (diff >> ((level + 1) * kSlotBits)))
+		level++;
+
+	_slots[level][(action->timestamp >> (level * kSlotBits)) & kSlotMask].push(action);
+	_levelSize[level]++;
+}
+
+void ActionScheduler::cascade(uint32 level) {
+	if (level >= kLevelCount)
+		return;
+
+	const uint32 index = (_time >> (level * kSlotBits)) & kSlotMask;
+
+	// The wheel of this level turned around too
+	if (index == 0)
+		cascade(level + 1);
+
+	// Move the actions of the current slot down into the lower levels
+	List &slot = _slots[level][index];
+
+	DelayedAction *action;
+	while ((action = slot.pop())) {
+		_levelSize[level]--;
+
+		insert(action);
+	}
+}
+
+DelayedAction *ActionScheduler::allocate() {
+	if (!_free) {
+		DelayedAction *chunk = new DelayedAction[kChunkSize];
+		_chunks.push_back(chunk);
+
+		for (uint32 i = 0; i < kChunkSize; i++) {
+			chunk[i]._next = _free;
+			_free = &chunk[i];
+		}
+	}
+
+	DelayedAction *action = _free;
+
+	_free = action->_next;
+	action->_next = 0;
+
+	return action;
+}
+
+} // End of namespace Engines
@@ -0,0 +1,154 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file engines/aurora/actionscheduler.h
+ *  A scheduler for delayed script actions.
+ */
+
+#ifndef ENGINES_AURORA_ACTIONSCHEDULER_H
+#define ENGINES_AURORA_ACTIONSCHEDULER_H
+
+#include <vector>
+
+#include "common/types.h"
+#include "common/ustring.h"
+#include "common/noncopyable.h"
+
+#include "aurora/nwscript/variable.h"
+
+namespace Aurora {
+	namespace NWScript {
+		class Object;
+	}
+}
+
+namespace Engines {
+
+/** A script delayed until a certain time, as by DelayCommand() or AssignCommand().
+ *
+ *  Actions are owned and pooled by their scheduler, and never copied.
+ */
+struct DelayedAction : public Common::NonCopyable {
+	Common::UString script; ///< The script to run.
+
+	Aurora::NWScript::ScriptState state; ///< The state to run the script in.
+	Aurora::NWScript::Object *owner;     ///< The object running the script.
+	Aurora::NWScript::Object *triggerer; ///< The object triggering the script.
+
+	uint32 timestamp; ///< The time the action is due, in milliseconds.
+
+	DelayedAction();
+
+private:
+	DelayedAction *_next; ///< The next action in the same list.
+
+	friend class ActionScheduler;
+};
+
+/** A scheduler for delayed script actions.
+ *
+ *  The actions are sorted into a hierarchical timer wheel, so that
+ *  scheduling an action and finding the due ones takes constant time,
+ *  no matter how many actions are waiting. Four levels of 256 slots
+ *  each, with a resolution of 1ms, cover the whole range of timestamps.
+ *  An action is put into the lowest level its due time falls into, and
+ *  moves down a level whenever the wheel below it has turned around once.
+ *
+ *  Due actions are handed out in the order they became due. After an
+ *  action has been run, it has to be released back to the scheduler,
+ *  which keeps it for reuse.
+ */
+class ActionScheduler : public Common::NonCopyable {
+public:
+	ActionScheduler();
+	~ActionScheduler();
+
+	/** Remove all actions. */
+	void clear();
+
+	/** Schedule a script to be run at a certain time. */
+	void schedule(const Common::UString &script, const Aurora::NWScript::ScriptState &state,
+	              Aurora::NWScript::Object *owner, Aurora::NWScript::Object *triggerer,
+	              uint32 timestamp);
+
+	/** Turn the wheel up to this time, collecting all actions due until then. */
+	void advance(uint32 now);
+
+	/** Take the next due action, or 0 if none is due. */
+	DelayedAction *pop();
+	/** Give an action taken with pop() back to the scheduler. */
+	void release(DelayedAction *action);
+
+	/** Return the number of scheduled actions, due or not. */
+	uint32 size() const;
+	/** Return the number of actions that are due. */
+	uint32 getDueCount() const;
+
+private:
+	static const uint32 kLevelCount = 4;
+	static const uint32 kSlotBits   = 8;
+	static const uint32 kSlotCount  = 1 << kSlotBits;
+	static const uint32 kSlotMask   = kSlotCount - 1;
+
+	static const uint32 kChunkSize = 64; ///< Number of actions allocated at once.
+
+	/** A list of actions, in the order they were added. */
+	struct List {
+		DelayedAction *head;
+		DelayedAction *tail;
+
+		uint32 size;
+
+		List();
+
+		void push(DelayedAction *action);
+		DelayedAction *pop();
+
+		/** Move all actions of another list to the end of this one. */
+		void append(List &list);
+	};
+
+	uint32 _time; ///< The time the wheel has been turned up to.
+
+	List   _slots[kLevelCount][kSlotCount]; ///< The wheel.
+	uint32 _levelSize[kLevelCount];         ///< Number of actions in each level of the wheel.
+
+	List _due; ///< The actions that are due.
+
+	DelayedAction *_free; ///< Actions ready for reuse.
+
+	std::vector<DelayedAction *> _chunks; ///< All allocated actions.
+
+	uint32 _size; ///< The number of scheduled actions.
+
+	void insert(DelayedAction *action);
+	void cascade(uint32 level);
+
+	DelayedAction *allocate();
+};
+
+} // End of namespace Engines
+
+#endif // ENGINES_AURORA_ACTIONSCHEDULER_H
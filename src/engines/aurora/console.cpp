@@ -29,17 +29,46 @@
 
 #include <cstdarg>
 #include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <cstdlib>
+
+#include <set>
 
 #include <boost/bind.hpp>
 
 #include "common/util.h"
+#include "common/file.h"
 #include "common/filepath.h"
 #include "common/readline.h"
-
+#include "common/timestamp.h"
+#include "common/stream.h"
+#include "common/mat4.h"
+#include "common/quat.h"
+#include "common/maths.h"
+#include "common/boundingbox.h"
+#include "common/configman.h"
+#include "common/mappedfile.h"
+
+#include "aurora/util.h"
 #include "aurora/resman.h"
+#include "aurora/biffile.h"
+#include "aurora/2dafile.h"
+#include "aurora/2dareg.h"
+#include "aurora/talktable.h"
+#include "aurora/gfffile.h"
+#include "aurora/gffwriter.h"
+#include "aurora/locstring.h"
+
+#include "aurora/nwscript/ncsreg.h"
+#include "aurora/nwscript/benchmark.h"
+#include "aurora/nwscript/profiler.h"
 
 #include "graphics/graphics.h"
 #include "graphics/font.h"
+#include "graphics/queueman.h"
+#include "graphics/frustum.h"
+#include "graphics/aabbtree.h"
 
 #include "sound/sound.h"
 
@@ -49,9 +78,11 @@
 #include "graphics/aurora/cursorman.h"
 #include "graphics/aurora/text.h"
 #include "graphics/aurora/guiquad.h"
+#include "graphics/aurora/model.h"
 
 #include "engines/aurora/console.h"
 #include "engines/aurora/util.h"
+#include "engines/aurora/actionscheduler.h"
 
 
 static const uint32 kDoubleClickTime = 500;
@@ -686,6 +717,54 @@ Console::Console(const Common::UString &font, int fontHeight) : _neverShown(true
 			"Usage: playsound <sound>\nPlay the specified sound");
 	registerCommand("silence"    , boost::bind(&Console::cmdSilence    , this, _1),
 			"Usage: silence\nStop all playing sounds and music");
+	registerCommand("resindex"   , boost::bind(&Console::cmdResIndex   , this, _1),
+			"Usage: resindex [<rounds>]\nShow resource index statistics and, "
+			"optionally, benchmark resource lookups");
+	registerCommand("rescache"   , boost::bind(&Console::cmdResCache   , this, _1),
+			"Usage: rescache [reset]\nShow decompressed resource cache statistics, "
+			"or reset them");
+	registerCommand("bifbench"   , boost::bind(&Console::cmdBIFBench   , this, _1),
+			"Usage: bifbench <bif>\nBenchmark reading all resources of a BIF file (e.g. "
+			"data/models_01.bif), memory-mapped against through the file pool");
+	registerCommand("gffbench"   , boost::bind(&Console::cmdGFFBench   , this, _1),
+			"Usage: gffbench <type>\nBenchmark loading, walking and writing all GFFs "
+			"of this type (e.g. utc, git, bic)");
+	registerCommand("ncscache"   , boost::bind(&Console::cmdNCSCache   , this, _1),
+			"Usage: ncscache [reset]\nShow statistics about the loaded script programs, "
+			"or reset them");
+	registerCommand("nwscriptbench", boost::bind(&Console::cmdNWScriptBench, this, _1),
+			"Usage: nwscriptbench [<iterations>]\nBenchmark the script interpreter "
+			"with loops of arithmetic, string concatenation and engine calls");
+	registerCommand("nwscriptprof", boost::bind(&Console::cmdNWScriptProf, this, _1),
+			"Usage: nwscriptprof [on|off|reset|budget <n>|sample <n>|dump <file>]\n"
+			"Show the scripts and engine functions taking the most time, control "
+			"the profiler or dump all profiles into a file");
+	registerCommand("lookupbench", boost::bind(&Console::cmdLookupBench, this, _1),
+			"Usage: lookupbench [<objects>]\nBenchmark finding objects by tag and "
+			"getting and setting local variables, with 20000 objects by default");
+	registerCommand("actionbench", boost::bind(&Console::cmdActionBench, this, _1),
+			"Usage: actionbench [<count>]\nBenchmark scheduling and running delayed "
+			"script actions (100000 by default), against a sorted set");
+	registerCommand("mathbench"  , boost::bind(&Console::cmdMathBench  , this, _1),
+			"Usage: mathbench [<iterations>]\nBenchmark matrix transformations against "
+			"heap-allocated matrices, and position updates of all models in the area");
+	registerCommand("cullstats"  , boost::bind(&Console::cmdCullStats  , this, _1),
+			"Usage: cullstats\nShow how many world objects were rendered and culled "
+			"in the last frame");
+	registerCommand("cullbench"  , boost::bind(&Console::cmdCullBench  , this, _1),
+			"Usage: cullbench [<objects>]\nBenchmark frustum culling of a 32x32 tile area "
+			"with 1000 additional objects by default, against testing every object");
+	registerCommand("pickbench"  , boost::bind(&Console::cmdPickBench  , this, _1),
+			"Usage: pickbench [<objects>]\nBenchmark picking the nearest of 500 clickable "
+			"objects by default in a 32x32 tile area with 10000 rays, against testing every object");
+	registerCommand("tlkbench"   , boost::bind(&Console::cmdTLKBench   , this, _1),
+			"Usage: tlkbench [<tlk>]\nBenchmark loading and reading a talk table "
+			"(dialog by default), and show its memory footprint");
+	registerCommand("2dacache"   , boost::bind(&Console::cmd2DACache   , this, _1),
+			"Usage: 2dacache [reset]\nShow 2DA registry statistics, or reset them");
+	registerCommand("2dabench"   , boost::bind(&Console::cmd2DABench   , this, _1),
+			"Usage: 2dabench\nBenchmark loading and reading all 2DAs, and show "
+			"their memory footprint");
 
 	_console->setPrompt(kPrompt);
 
@@ -1161,6 +1240,1172 @@ void Console::cmdSilence(const CommandLine &cl) {
 	SoundMan.stopAll();
 }
 
+void Console::cmdResIndex(const CommandLine &cl) {
+	Aurora::ResourceManager::IndexStats stats;
+	ResMan.getIndexStats(stats);
+
+	printf("%u resources, %u unique names, %u names interned",
+	       stats.resourceCount, stats.hashCount, stats.nameCount);
+	printf("Hash table: %u slots (%.1f%% load), %.1fKB index memory",
+	       stats.hashTableSize, stats.hashTableSize ? (100.0 * stats.hashCount) / stats.hashTableSize : 0.0,
+	       stats.memoryUsage / 1024.0);
+	printf("Indexing took %.3fms", stats.indexTime / 1000.0);
+
+	int rounds = 0;
+	if (!cl.args.empty())
+		sscanf(cl.args.c_str(), "%d", &rounds);
+
+	if (rounds <= 0)
+		return;
+
+	std::list<Aurora::ResourceManager::ResourceID> resources;
+	ResMan.getAvailableResources(resources);
+
+	if (resources.empty())
+		return;
+
+	uint32 found = 0, lookups = 0;
+
+	const uint64 startTime = Common::getMicroseconds();
+
+	for (int i = 0; i < rounds; i++) {
+		for (std::list<Aurora::ResourceManager::ResourceID>::const_iterator r = resources.begin();
+		     r != resources.end(); ++r) {
+
+			// One lookup that hits, and one that misses
+			if (ResMan.hasResource(r->name, r->type))
+				found++;
+			if (ResMan.hasResource(r->name, Aurora::kFileTypeNone))
+				found++;
+
+			lookups += 2;
+		}
+	}
+
+	const uint64 time = MAX<uint64>(Common::getMicroseconds() - startTime, 1);
+
+	printf("%u lookups (%u hits) in %.3fms: %.0f lookups/s",
+	       lookups, found, time / 1000.0, (lookups * 1000000.0) / time);
+}
+
+void Console::cmdResCache(const CommandLine &cl) {
+	if (cl.args == "reset") {
+		ResMan.resetCacheStats();
+		print("Reset the resource cache statistics");
+		return;
+	}
+
+	if (!cl.args.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	const Aurora::ResourceCache::Stats stats = ResMan.getCacheStats();
+
+	const uint32 requests = stats.hits + stats.misses;
+
+	printf("%u resources cached, %.1fMB of %.1fMB", stats.count,
+	       stats.size / (1024.0 * 1024.0), stats.maxSize / (1024.0 * 1024.0));
+	printf("%u hits, %u misses (%.1f%% hit ratio), %u evictions", stats.hits, stats.misses,
+	       requests ? ((100.0 * stats.hits) / requests) : 0.0, stats.evictions);
+	printf("%.3fms saved by cache hits", stats.timeSaved / 1000.0);
+}
+
+/** Get the current and peak resident set size of the process, in KB. Only works on Linux. */
+static bool getResidentMemory(uint32 &current, uint32 &peak) {
+	current = peak = 0;
+
+	std::FILE *status = std::fopen("/proc/self/status", "r");
+	if (!status)
+		return false;
+
+	char line[256];
+	while (std::fgets(line, sizeof(line), status)) {
+		std::sscanf(line, "VmRSS: %u kB", &current);
+		std::sscanf(line, "VmHWM: %u kB", &peak);
+	}
+
+	std::fclose(status);
+
+	return current != 0;
+}
+
+/** The results of reading all resources of a BIF. */
+struct BIFBenchResult {
+	uint32 count; ///< Number of resources read.
+	uint64 size;  ///< Number of bytes read.
+
+	uint64 openTime; ///< Microseconds taken to open the BIF.
+	uint64 readTime; ///< Microseconds taken to read all resources.
+
+	int32 rssGrowth; ///< Growth of the resident set size, in KB, while the BIF is still open.
+};
+
+/** Read all resources of a BIF, with or without mapping it into memory. */
+static void benchBIF(const Common::UString &file, bool mapped, BIFBenchResult &result) {
+	uint32 rssBefore, rssAfter, peak;
+	getResidentMemory(rssBefore, peak);
+
+	Common::setFileMapping(mapped);
+
+	try {
+		uint64 startTime = Common::getMicroseconds();
+
+		Aurora::BIFFile bif(file);
+
+		result.openTime = Common::getMicroseconds() - startTime;
+
+		result.count = 0;
+		result.size  = 0;
+
+		// Read every byte, like a resource loader would
+		byte buffer[4096];
+
+		startTime = Common::getMicroseconds();
+
+		const Aurora::Archive::ResourceList &resources = bif.getResources();
+		for (Aurora::Archive::ResourceList::const_iterator r = resources.begin(); r != resources.end(); ++r) {
+			Common::SeekableReadStream *stream = bif.getResource(r->index);
+
+			uint32 n;
+			while ((n = stream->read(buffer, sizeof(buffer))) > 0) {
+				result.size += n;
+			}
+
+			delete stream;
+
+			result.count++;
+		}
+
+		result.readTime = Common::getMicroseconds() - startTime;
+
+		getResidentMemory(rssAfter, peak);
+		result.rssGrowth = (int32) rssAfter - (int32) rssBefore;
+
+	} catch (...) {
+		Common::setFileMapping(true);
+		throw;
+	}
+
+	Common::setFileMapping(true);
+}
+
+void Console::cmdBIFBench(const CommandLine &cl) {
+	if (cl.args.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	// Relative to the game directory, unless it's a path to an existing file
+	Common::UString file = cl.args;
+	if (!Common::FilePath::isRegularFile(file))
+		file = Common::FilePath::normalize(ConfigMan.getString("path") + "/" + cl.args);
+
+	if (!Common::FilePath::isRegularFile(file)) {
+		printf("No such file \"%s\"", cl.args.c_str());
+		return;
+	}
+
+	BIFBenchResult pool, mapped;
+
+	try {
+		// The first pass only pulls the file into the OS file cache, to make both comparable
+		benchBIF(file, false, pool);
+
+		benchBIF(file, false, pool);
+		benchBIF(file, true , mapped);
+	} catch (Common::Exception &e) {
+		printf("Failed reading \"%s\": %s", file.c_str(), e.what());
+		return;
+	}
+
+	uint32 rss, peak;
+	const bool hasRSS = getResidentMemory(rss, peak);
+
+	printf("%u resources, %.1fMB", pool.count, pool.size / (1024.0 * 1024.0));
+
+	const BIFBenchResult *results[2] = { &pool, &mapped };
+	const char *names[2] = { "File pool", "Mapped   " };
+
+	for (int i = 0; i < 2; i++) {
+		const BIFBenchResult &r = *results[i];
+
+		printf("%s: opened in %.3fms, read in %.3fms (%.2fus per resource)", names[i],
+		       r.openTime / 1000.0, r.readTime / 1000.0, r.readTime / (double) MAX<uint32>(r.count, 1));
+
+		if (hasRSS)
+			printf("%s: resident memory grew by %dKB", names[i], r.rssGrowth);
+	}
+
+	if (hasRSS)
+		printf("Resident memory now %uKB, peak %uKB", rss, peak);
+}
+
+/** Read every field in a GFF struct and all its child structs, returning the number of fields. */
+static uint32 walkGFF(const Aurora::GFFStruct &strct) {
+	std::vector<Aurora::GFFLabel> labels;
+	strct.getFieldLabels(labels);
+
+	uint32 count = labels.size();
+
+	for (std::vector<Aurora::GFFLabel>::const_iterator l = labels.begin(); l != labels.end(); ++l) {
+		switch (strct.getType(*l)) {
+			case Aurora::kFieldTypeStruct:
+				count += walkGFF(strct.getStruct(*l));
+				break;
+
+			case Aurora::kFieldTypeList:
+				{
+					const Aurora::GFFList &list = strct.getList(*l);
+					for (Aurora::GFFList::const_iterator s = list.begin(); s != list.end(); ++s)
+						count += walkGFF(**s);
+				}
+				break;
+
+			case Aurora::kFieldTypeLocString:
+				{
+					Aurora::LocString str;
+					strct.getLocString(*l, str);
+				}
+				break;
+
+			case Aurora::kFieldTypeVoid:
+				delete strct.getData(*l);
+				break;
+
+			case Aurora::kFieldTypeStrRef:
+			case Aurora::kFieldTypeNone:
+				break;
+
+			default:
+				strct.getString(*l);
+				break;
+		}
+	}
+
+	return count;
+}
+
+void Console::cmdGFFBench(const CommandLine &cl) {
+	if (cl.args.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	const Aurora::FileType type = TypeMan.getFileType("." + cl.args);
+	if ((type == Aurora::kFileTypeNone) || (std::strlen(cl.args.c_str()) > 4)) {
+		printf("Unknown file type \"%s\"", cl.args.c_str());
+		return;
+	}
+
+	// The GFF ID is the upper-case extension, padded with spaces
+	char idString[4] = { ' ', ' ', ' ', ' ' };
+	for (uint32 i = 0; cl.args.c_str()[i]; i++)
+		idString[i] = std::toupper(cl.args.c_str()[i]);
+
+	const uint32 id = MKTAG(idString[0], idString[1], idString[2], idString[3]);
+
+	std::list<Aurora::ResourceManager::ResourceID> resources;
+	ResMan.getAvailableResources(type, resources);
+
+	uint32 files = 0, failed = 0, fields = 0, written = 0;
+	uint64 loadTime = 0, walkTime = 0, writeTime = 0;
+
+	for (std::list<Aurora::ResourceManager::ResourceID>::const_iterator r = resources.begin();
+	     r != resources.end(); ++r) {
+
+		try {
+			const uint64 startTime = Common::getMicroseconds();
+
+			Aurora::GFFFile gff(r->name, type, id);
+
+			const uint64 loadedTime = Common::getMicroseconds();
+
+			fields += walkGFF(gff.getTopLevel());
+
+			const uint64 walkedTime = Common::getMicroseconds();
+
+			// Build a copy of the whole GFF and serialize it into memory
+			Aurora::GFFWriter writer(id);
+			writer.getTopLevel().addFields(gff.getTopLevel());
+
+			Common::MemoryWriteStreamDynamic out(true);
+			writer.write(out);
+
+			written += out.size();
+
+			loadTime  += loadedTime - startTime;
+			walkTime  += walkedTime - loadedTime;
+			writeTime += Common::getMicroseconds() - walkedTime;
+
+			files++;
+		} catch (Common::Exception &) {
+			failed++;
+		}
+	}
+
+	printf("%u GFFs (%u failed), %u fields", files, failed, fields);
+	printf("Loading took %.3fms, walking took %.3fms (%.0f fields/s)", loadTime / 1000.0,
+	       walkTime / 1000.0, (fields * 1000000.0) / MAX<uint64>(walkTime, 1));
+	printf("Copying and writing took %.3fms (%.0f fields/s, %.1fKB written)", writeTime / 1000.0,
+	       (fields * 1000000.0) / MAX<uint64>(writeTime, 1), written / 1024.0);
+}
+
+void Console::cmdNCSCache(const CommandLine &cl) {
+	if (cl.args == "reset") {
+		NCSReg.resetStats();
+		print("Reset the script program statistics");
+		return;
+	}
+
+	if (!cl.args.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	const Aurora::NWScript::NCSRegistry::Stats stats = NCSReg.getStats();
+
+	const uint32 requests = stats.hits + stats.misses;
+
+	printf("%u script programs loaded, %.1fKB", stats.count, stats.size / 1024.0);
+	printf("%u hits, %u misses (%.1f%% hit ratio)", stats.hits, stats.misses,
+	       requests ? ((100.0 * stats.hits) / requests) : 0.0);
+	printf("Loading took %.3fms (%.3fms per program)", stats.loadTime / 1000.0,
+	       stats.loadTime / (1000.0 * MAX<uint32>(stats.misses, 1)));
+	printf("%u instructions, %u before optimization (%s)", stats.instructions,
+	       stats.decodedInstructions, NCSReg.getOptimize() ? "enabled" : "disabled");
+	printf("%u runs, %.1f instructions executed per run", stats.runs,
+	       stats.executedInstructions / (double) MAX<uint32>(stats.runs, 1));
+	printf("%u script stacks pooled, %u stack allocations",
+	       stats.stacks, stats.stackAllocations);
+}
+
+void Console::cmdNWScriptBench(const CommandLine &cl) {
+	int iterations = 100000;
+	if (!cl.args.empty())
+		sscanf(cl.args.c_str(), "%d", &iterations);
+
+	if (iterations <= 0) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	std::vector<Aurora::NWScript::BenchmarkResult> results;
+	try {
+		Aurora::NWScript::runBenchmarks(iterations, results);
+	} catch (Common::Exception &e) {
+		printf("Benchmark failed: %s", e.what());
+		return;
+	}
+
+	for (std::vector<Aurora::NWScript::BenchmarkResult>::const_iterator r = results.begin();
+	     r != results.end(); ++r)
+		printf("%-16s: %u instructions (%u executed) in %.3fms (%.0f instructions/s), %u allocations",
+		       r->name.c_str(), r->instructions, r->executed, r->time / 1000.0,
+		       r->getInstructionsPerSecond(), r->allocations);
+}
+
+void Console::cmdNWScriptProf(const CommandLine &cl) {
+	Common::UString command, arg;
+	cl.args.split(cl.args.findFirst(' '), command, arg, true);
+
+	if        (command == "on") {
+		ScriptProf.setEnabled(true);
+		print("Enabled the script profiler");
+		return;
+	} else if (command == "off") {
+		ScriptProf.setEnabled(false);
+		print("Disabled the script profiler");
+		return;
+	} else if (command == "reset") {
+		ScriptProf.reset();
+		print("Reset the script profiles");
+		return;
+	} else if ((command == "budget") || (command == "sample")) {
+		int value = -1;
+		sscanf(arg.c_str(), "%d", &value);
+
+		if (value < 0) {
+			printCommandHelp(cl.cmd);
+			return;
+		}
+
+		if (command == "budget")
+			ScriptProf.setInstructionBudget(value);
+		else
+			ScriptProf.setSampleRate(value);
+
+		printf("Instruction budget of %u per frame, timing 1 in %u engine function calls",
+		       ScriptProf.getInstructionBudget(), ScriptProf.getSampleRate());
+		return;
+	} else if (command == "dump") {
+		if (arg.empty()) {
+			printCommandHelp(cl.cmd);
+			return;
+		}
+
+		Common::DumpFile file;
+		if (!file.open(arg)) {
+			printf("Failed to open \"%s\"", arg.c_str());
+			return;
+		}
+
+		ScriptProf.dump(file);
+		file.flush();
+
+		if (file.err())
+			printf("Failed to write \"%s\"", arg.c_str());
+		else
+			printf("Dumped the script profiles to \"%s\"", arg.c_str());
+		return;
+	} else if (!command.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	printf("The script profiler is %s", ScriptProf.isEnabled() ? "enabled" : "disabled");
+
+	std::vector<Aurora::NWScript::ScriptProfiler::Entry> entries;
+
+	ScriptProf.getScripts(entries);
+	if (!entries.empty())
+		print("Scripts:");
+	for (uint32 i = 0; (i < entries.size()) && (i < 10); i++)
+		printf("%-16s: %u calls, %.3fms (%.3fms exclusive), %.1f instructions per call, "
+		       "%u over budget", entries[i].name.c_str(), entries[i].calls,
+		       entries[i].getInclusiveTime() / 1000.0, entries[i].getExclusiveTime() / 1000.0,
+		       entries[i].instructions / (double) MAX<uint32>(entries[i].calls, 1),
+		       entries[i].budgetExceeded);
+
+	ScriptProf.getFunctions(entries);
+	if (!entries.empty())
+		print("Engine functions:");
+	for (uint32 i = 0; (i < entries.size()) && (i < 10); i++)
+		printf("%-16s: %u calls, %.3fms (%.3fms exclusive)", entries[i].name.c_str(),
+		       entries[i].calls, entries[i].getInclusiveTime() / 1000.0,
+		       entries[i].getExclusiveTime() / 1000.0);
+}
+
+void Console::cmdLookupBench(const CommandLine &cl) {
+	int objects = 20000;
+	if (!cl.args.empty())
+		sscanf(cl.args.c_str(), "%d", &objects);
+
+	if (objects <= 0) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	std::vector<Aurora::NWScript::LookupBenchmarkResult> results;
+	try {
+		Aurora::NWScript::runLookupBenchmarks(objects, results);
+	} catch (Common::Exception &e) {
+		printf("Benchmark failed: %s", e.what());
+		return;
+	}
+
+	for (std::vector<Aurora::NWScript::LookupBenchmarkResult>::const_iterator r = results.begin();
+	     r != results.end(); ++r)
+		printf("%-10s: %u lookups in %.3fms (%.0f/s), %.3fms with string trees (%.0f/s)",
+		       r->name.c_str(), r->operations, r->time / 1000.0, r->getOperationsPerSecond(),
+		       r->baselineTime / 1000.0, r->getBaselineOperationsPerSecond());
+}
+
+/** A delayed action kept in a sorted set, the way modules used to, for comparison. */
+struct SortedAction {
+	uint32 timestamp;
+
+	Aurora::NWScript::ScriptState state;
+
+	bool operator<(const SortedAction &action) const {
+		return timestamp < action.timestamp;
+	}
+};
+
+void Console::cmdActionBench(const CommandLine &cl) {
+	int count = 100000;
+	if (!cl.args.empty())
+		sscanf(cl.args.c_str(), "%d", &count);
+
+	if (count <= 0) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	static const uint32 kMaxDelay  = 60000;
+	static const uint32 kFrameTime = 16;
+
+	// A typical state of a delayed command: a few globals and locals
+	Aurora::NWScript::ScriptState state = Aurora::NWScript::NCSFile::getEmptyState();
+	state.globals.push_back(Aurora::NWScript::Variable((int32) 1));
+	state.globals.push_back(Aurora::NWScript::Variable(1.0f));
+	state.locals.push_back(Aurora::NWScript::Variable((int32) 2));
+	state.locals.push_back(Aurora::NWScript::Variable((int32) 3));
+
+	std::vector<uint32> delays;
+	delays.reserve(count);
+
+	std::srand(0);
+	for (int i = 0; i < count; i++)
+		delays.push_back(std::rand() % kMaxDelay);
+
+	// Timer wheel
+
+	ActionScheduler scheduler;
+
+	uint64 startTime = Common::getMicroseconds();
+
+	for (int i = 0; i < count; i++)
+		scheduler.schedule("", state, 0, 0, delays[i]);
+
+	const uint64 wheelSchedule = Common::getMicroseconds() - startTime;
+
+	uint64 wheelRun = 0, wheelWorst = 0;
+	for (uint32 now = 0; now <= kMaxDelay; now += kFrameTime) {
+		startTime = Common::getMicroseconds();
+
+		scheduler.advance(now);
+
+		DelayedAction *action;
+		while ((action = scheduler.pop()))
+			scheduler.release(action);
+
+		const uint64 frameTime = Common::getMicroseconds() - startTime;
+
+		wheelRun  += frameTime;
+		wheelWorst = MAX(wheelWorst, frameTime);
+	}
+
+	// Sorted set
+
+	std::multiset<SortedAction> actions;
+
+	startTime = Common::getMicroseconds();
+
+	for (int i = 0; i < count; i++) {
+		SortedAction action;
+
+		action.timestamp = delays[i];
+		action.state     = state;
+
+		actions.insert(action);
+	}
+
+	const uint64 setSchedule = Common::getMicroseconds() - startTime;
+
+	uint64 setRun = 0, setWorst = 0;
+	for (uint32 now = 0; now <= kMaxDelay; now += kFrameTime) {
+		startTime = Common::getMicroseconds();
+
+		while (!actions.empty() && (actions.begin()->timestamp <= now))
+			actions.erase(actions.begin());
+
+		const uint64 frameTime = Common::getMicroseconds() - startTime;
+
+		setRun  += frameTime;
+		setWorst = MAX(setWorst, frameTime);
+	}
+
+	printf("Timer wheel: scheduling %d actions took %.3fms, running them %.3fms (worst frame %.3fms)",
+	       count, wheelSchedule / 1000.0, wheelRun / 1000.0, wheelWorst / 1000.0);
+	printf("Sorted set : scheduling %d actions took %.3fms, running them %.3fms (worst frame %.3fms)",
+	       count, setSchedule / 1000.0, setRun / 1000.0, setWorst / 1000.0);
+}
+
+/** A heap-allocated 4x4 matrix, the way transformations used to be done, for comparison. */
+struct HeapMatrix {
+	float *m;
+
+	HeapMatrix() : m(new float[16]) {
+		for (int i = 0; i < 16; i++)
+			m[i] = ((i % 5) == 0) ? 1.0f : 0.0f;
+	}
+
+	HeapMatrix(const HeapMatrix &right) : m(new float[16]) {
+		std::memcpy(m, right.m, 16 * sizeof(float));
+	}
+
+	~HeapMatrix() {
+		delete[] m;
+	}
+
+	HeapMatrix &operator=(const HeapMatrix &right) {
+		std::memcpy(m, right.m, 16 * sizeof(float));
+		return *this;
+	}
+
+	HeapMatrix operator*(const HeapMatrix &right) const {
+		HeapMatrix result;
+
+		for (int c = 0; c < 4; c++)
+			for (int r = 0; r < 4; r++) {
+				float v = 0.0f;
+				for (int k = 0; k < 4; k++)
+					v += m[k * 4 + r] * right.m[c * 4 + k];
+
+				result.m[c * 4 + r] = v;
+			}
+
+		return result;
+	}
+
+	HeapMatrix translated(float x, float y, float z) const {
+		HeapMatrix t;
+
+		t.m[12] = x;
+		t.m[13] = y;
+		t.m[14] = z;
+
+		return *this * t;
+	}
+};
+
+void Console::cmdMathBench(const CommandLine &cl) {
+	int count = 1000000;
+	if (!cl.args.empty())
+		sscanf(cl.args.c_str(), "%d", &count);
+
+	if (count <= 0) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	printf("Using %s kernels", Common::Mat4::getKernelName());
+
+	// Keep the results alive, so that the compiler can't throw the loops away
+	float sink = 0.0f;
+
+	Common::Mat4 rotation;
+	rotation.rotate(30.0f, 0.0f, 0.0f, 1.0f);
+
+	// Multiply
+
+	Common::Mat4 mat;
+
+	uint64 startTime = Common::getMicroseconds();
+	for (int i = 0; i < count; i++) {
+		mat *= rotation;
+		mat.translate(0.001f, 0.0f, 0.0f);
+	}
+	const uint64 mat4Multiply = Common::getMicroseconds() - startTime;
+
+	sink += mat(0, 3);
+
+	HeapMatrix heapRotation, heapMat;
+	std::memcpy(heapRotation.m, rotation.get(), 16 * sizeof(float));
+
+	startTime = Common::getMicroseconds();
+	for (int i = 0; i < count; i++) {
+		heapMat = heapMat * heapRotation;
+		heapMat = heapMat.translated(0.001f, 0.0f, 0.0f);
+	}
+	const uint64 heapMultiply = Common::getMicroseconds() - startTime;
+
+	sink += heapMat.m[12];
+
+	// Transform points and bounding boxes
+
+	startTime = Common::getMicroseconds();
+	for (int i = 0; i < count; i++) {
+		float x = i, y = 1.0f, z = 2.0f;
+
+		rotation.transformPoint(x, y, z);
+		sink += x;
+	}
+	const uint64 transformPoint = Common::getMicroseconds() - startTime;
+
+	const float boxMin[3] = { -1.0f, -2.0f, -3.0f }, boxMax[3] = { 1.0f, 2.0f, 3.0f };
+
+	startTime = Common::getMicroseconds();
+	for (int i = 0; i < count; i++) {
+		float outMin[3], outMax[3];
+
+		rotation.transformAABB(boxMin, boxMax, outMin, outMax);
+		sink += outMax[0];
+	}
+	const uint64 transformAABB = Common::getMicroseconds() - startTime;
+
+	// Inverse and slerp
+
+	startTime = Common::getMicroseconds();
+	for (int i = 0; i < count; i++)
+		sink += rotation.getInverse()(0, 1);
+	const uint64 inverse = Common::getMicroseconds() - startTime;
+
+	const Common::Quat q1 = Common::Quat::fromAxisAngle( 10.0f, 0.0f, 0.0f, 1.0f);
+	const Common::Quat q2 = Common::Quat::fromAxisAngle(170.0f, 0.0f, 1.0f, 0.0f);
+
+	startTime = Common::getMicroseconds();
+	for (int i = 0; i < count; i++)
+		sink += Common::Quat::slerp(q1, q2, (i & 1023) / 1024.0f)[3];
+	const uint64 slerp = Common::getMicroseconds() - startTime;
+
+	printf("Multiply + translate: %.3fms (%.3fms with heap matrices)",
+	       mat4Multiply / 1000.0, heapMultiply / 1000.0);
+	printf("Transform point     : %.3fms", transformPoint / 1000.0);
+	printf("Transform AABB      : %.3fms", transformAABB  / 1000.0);
+	printf("Inverse             : %.3fms", inverse        / 1000.0);
+	printf("Slerp               : %.3fms", slerp          / 1000.0);
+	printf("(%d iterations each, checksum %f)", count, sink);
+
+	// Position updates of all models in the area
+
+	std::list<Graphics::Aurora::Model *> models;
+
+	Graphics::QueueMan.lockQueue(Graphics::kQueueWorldObject);
+	const std::list<Graphics::Queueable *> &objects = Graphics::QueueMan.getQueue(Graphics::kQueueWorldObject);
+	for (std::list<Graphics::Queueable *>::const_iterator o = objects.begin(); o != objects.end(); ++o) {
+		Graphics::Aurora::Model *model = dynamic_cast<Graphics::Aurora::Model *>(*o);
+		if (model)
+			models.push_back(model);
+	}
+	Graphics::QueueMan.unlockQueue(Graphics::kQueueWorldObject);
+
+	if (models.empty()) {
+		printf("No models loaded, skipping the position updates");
+		return;
+	}
+
+	static const int kUpdates = 500;
+
+	startTime = Common::getMicroseconds();
+	for (int i = 0; i < kUpdates; i++) {
+		for (std::list<Graphics::Aurora::Model *>::iterator m = models.begin(); m != models.end(); ++m) {
+			float x, y, z;
+
+			(*m)->getPosition(x, y, z);
+			(*m)->setPosition(x, y, z);
+		}
+	}
+	const uint64 updates = Common::getMicroseconds() - startTime;
+
+	printf("Updating the positions of %u models %d times took %.3fms (%.3fus per model update)",
+	       (uint) models.size(), kUpdates, updates / 1000.0,
+	       ((double) updates) / (kUpdates * models.size()));
+}
+
+void Console::cmdCullStats(const CommandLine &cl) {
+	uint32 submitted, culled, cullTime;
+	GfxMan.getCullStatistics(submitted, culled, cullTime);
+
+	printf("%u world objects rendered, %u culled, culling took %.3fms",
+	       submitted, culled, cullTime / 1000.0);
+}
+
+/** An axis-aligned box, standing in for a model in the culling and picking benchmarks. */
+struct BenchBox {
+	float min[3];
+	float max[3];
+
+	int32 proxy;
+
+	bool clickable;
+
+	void set(const Common::Mat4 &position, const float *size) {
+		const float localMin[3] = { -size[0] / 2.0f, -size[1] / 2.0f, 0.0f    };
+		const float localMax[3] = {  size[0] / 2.0f,  size[1] / 2.0f, size[2] };
+
+		position.transformAABB(localMin, localMax, min, max);
+	}
+};
+
+static float getRandom(float min, float max) {
+	return min + (max - min) * (std::rand() / (float) RAND_MAX);
+}
+
+/** Place a box standing on the ground, the way a world object model is placed. */
+static void placeBenchBox(BenchBox &box, float x, float y, const float *size) {
+	Common::Mat4 position;
+
+	box.clickable = false;
+
+	position.rotate(90.0f, -1.0f, 0.0f, 0.0f);
+	position.translate(x, y, 0.0f);
+
+	box.set(position, size);
+}
+
+static const int   kBenchAreaSize  = 32;    ///< Tiles along each side of the benchmark area.
+static const float kBenchTileSize  = 10.0f; ///< Width of a benchmark tile.
+static const float kBenchAreaWidth = kBenchAreaSize * kBenchTileSize;
+static const int   kBenchTileCount = kBenchAreaSize * kBenchAreaSize;
+
+/** Build a NWN outdoor area for benchmarking: a grid of tiles, and objects scattered around it.
+ *
+ *  The tiles come first in the boxes, followed by the objects. Returns the
+ *  time it took to insert them all into the tree, in microseconds.
+ */
+static uint64 buildBenchArea(std::vector<BenchBox> &boxes, int objectCount, bool clickable,
+                             Graphics::AABBTree &tree) {
+
+	std::srand(0);
+
+	boxes.resize(kBenchTileCount + objectCount);
+
+	const float tileSize[3] = { kBenchTileSize, kBenchTileSize, 5.0f };
+	for (int y = 0; y < kBenchAreaSize; y++)
+		for (int x = 0; x < kBenchAreaSize; x++)
+			placeBenchBox(boxes[y * kBenchAreaSize + x],
+			              (x + 0.5f) * kBenchTileSize, (y + 0.5f) * kBenchTileSize, tileSize);
+
+	for (size_t i = kBenchTileCount; i < boxes.size(); i++) {
+		const float objectSize[3] = { getRandom(0.5f, 3.0f), getRandom(0.5f, 3.0f), getRandom(1.0f, 4.0f) };
+
+		placeBenchBox(boxes[i], getRandom(0.0f, kBenchAreaWidth), getRandom(0.0f, kBenchAreaWidth), objectSize);
+		boxes[i].clickable = clickable;
+	}
+
+	const uint64 startTime = Common::getMicroseconds();
+
+	for (std::vector<BenchBox>::iterator b = boxes.begin(); b != boxes.end(); ++b)
+		b->proxy = tree.insert(b->min, b->max, &*b);
+
+	return Common::getMicroseconds() - startTime;
+}
+
+void Console::cmdCullBench(const CommandLine &cl) {
+	int objectCount = 1000;
+	if (!cl.args.empty())
+		sscanf(cl.args.c_str(), "%d", &objectCount);
+
+	if (objectCount < 0) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	static const int kFrames = 1000;
+	static const int kMovers = 50;
+
+	std::vector<BenchBox> boxes;
+	Graphics::AABBTree tree(0.5f);
+
+	const uint64 buildTime = buildBenchArea(boxes, objectCount, false, tree);
+
+	uint64 startTime;
+
+	// The projection GraphicsManager sets up for a 4:3 screen
+	Common::Mat4 projection;
+
+	const float f = 1.0f / tanf(Common::deg2rad(60.0f) / 2.0f);
+
+	projection(0, 0) = f / (4.0f / 3.0f);
+	projection(1, 1) = f;
+	projection(2, 2) = (1000.0f + 1.0f) / (1.0f - 1000.0f);
+	projection(2, 3) = (2.0f * 1000.0f * 1.0f) / (1.0f - 1000.0f);
+	projection(3, 2) = -1.0f;
+	projection(3, 3) =  0.0f;
+
+	std::vector<void *> inFrustum;
+
+	uint64 queryTime = 0, bruteTime = 0, moveTime = 0;
+	uint64 submitted = 0, bruteSubmitted = 0, tests = 0;
+
+	for (int i = 0; i < kFrames; i++) {
+		// A camera somewhere above the area, looking into a random direction
+		const float cPos   [3] = { getRandom(0.0f, kBenchAreaWidth), getRandom(5.0f, 20.0f), getRandom(0.0f, kBenchAreaWidth) };
+		const float cOrient[3] = { getRandom(-45.0f, 45.0f), getRandom(0.0f, 360.0f), 0.0f };
+
+		Graphics::Frustum frustum;
+		frustum.set(projection, cPos, cOrient);
+
+		// Move a few objects around, like walking creatures
+
+		startTime = Common::getMicroseconds();
+
+		for (int j = 0; (j < kMovers) && (j < objectCount); j++) {
+			BenchBox &box = boxes[kBenchTileCount + j];
+
+			const float dX = getRandom(-0.1f, 0.1f), dZ = getRandom(-0.1f, 0.1f);
+
+			box.min[0] += dX;
+			box.max[0] += dX;
+			box.min[2] += dZ;
+			box.max[2] += dZ;
+
+			tree.update(box.proxy, box.min, box.max);
+		}
+
+		moveTime += Common::getMicroseconds() - startTime;
+
+		// Query the tree
+
+		startTime = Common::getMicroseconds();
+
+		inFrustum.clear();
+		tests += tree.query(frustum, inFrustum);
+
+		queryTime += Common::getMicroseconds() - startTime;
+		submitted += inFrustum.size();
+
+		// Test every box
+
+		startTime = Common::getMicroseconds();
+
+		uint32 bruteCount = 0;
+		for (std::vector<BenchBox>::const_iterator b = boxes.begin(); b != boxes.end(); ++b)
+			if (frustum.isIn(b->min, b->max))
+				bruteCount++;
+
+		bruteTime      += Common::getMicroseconds() - startTime;
+		bruteSubmitted += bruteCount;
+	}
+
+	const double total = boxes.size();
+
+	printf("%u objects, tree height %d, built in %.3fms",
+	       (uint) boxes.size(), tree.getHeight(), buildTime / 1000.0);
+	printf("Tree   : %.1f submitted, %.1f culled, %.1f box tests, %.3fus per frame",
+	       submitted / (double) kFrames, total - submitted / (double) kFrames,
+	       tests / (double) kFrames, queryTime / (double) kFrames);
+	printf("Linear : %.1f submitted, %.1f culled, %.1f box tests, %.3fus per frame",
+	       bruteSubmitted / (double) kFrames, total - bruteSubmitted / (double) kFrames,
+	       total, bruteTime / (double) kFrames);
+	printf("Moving %d objects: %.3fus per frame", MIN(kMovers, objectCount), moveTime / (double) kFrames);
+}
+
+/** Hit-testing a ray against the clickable boxes of the picking benchmark. */
+class BenchRayTest : public Graphics::AABBTree::RayTest {
+public:
+	uint32 tests;
+
+	BenchRayTest(const float *from, const float *to) : tests(0), _from(from), _to(to) {
+	}
+
+	float test(void *data) {
+		const BenchBox &box = *static_cast<const BenchBox *>(data);
+
+		tests++;
+
+		float t;
+		if (!box.clickable || !Graphics::AABBTree::intersectRay(_from, _to, box.min, box.max, t))
+			return -1.0f;
+
+		return t;
+	}
+
+private:
+	const float *_from;
+	const float *_to;
+};
+
+void Console::cmdPickBench(const CommandLine &cl) {
+	int objectCount = 500;
+	if (!cl.args.empty())
+		sscanf(cl.args.c_str(), "%d", &objectCount);
+
+	if (objectCount < 0) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	static const int kRays = 10000;
+
+	// Unclickable tiles, with clickable placeables and creatures on them
+
+	std::vector<BenchBox> boxes;
+	Graphics::AABBTree tree(0.5f);
+
+	buildBenchArea(boxes, objectCount, true, tree);
+
+	// Rays from a camera above the area, through a point near the ground, to the far plane
+
+	std::vector<float> rays;
+	rays.reserve(kRays * 6);
+
+	for (int i = 0; i < kRays; i++) {
+		const float from  [3] = { getRandom(0.0f, kBenchAreaWidth), getRandom(5.0f, 20.0f), -getRandom(0.0f, kBenchAreaWidth) };
+		const float target[3] = { getRandom(0.0f, kBenchAreaWidth), getRandom(0.0f,  2.0f), -getRandom(0.0f, kBenchAreaWidth) };
+
+		float direction[3] = { target[0] - from[0], target[1] - from[1], target[2] - from[2] };
+
+		const float length = sqrtf(direction[0] * direction[0] +
+		                           direction[1] * direction[1] +
+		                           direction[2] * direction[2]);
+
+		for (int j = 0; j < 3; j++)
+			rays.push_back(from[j]);
+		for (int j = 0; j < 3; j++)
+			rays.push_back(from[j] + direction[j] / length * 1000.0f);
+	}
+
+	std::vector<void *> treeHits(kRays), linearHits(kRays);
+
+	// Through the tree
+
+	uint64 treeTests = 0;
+
+	uint64 startTime = Common::getMicroseconds();
+
+	for (int i = 0; i < kRays; i++) {
+		const float *from = &rays[i * 6 + 0];
+		const float *to   = &rays[i * 6 + 3];
+
+		BenchRayTest rayTest(from, to);
+
+		treeHits[i] = tree.raycast(from, to, rayTest);
+		treeTests  += rayTest.tests;
+	}
+
+	const uint64 treeTime = Common::getMicroseconds() - startTime;
+
+	// Testing every box
+
+	startTime = Common::getMicroseconds();
+
+	for (int i = 0; i < kRays; i++) {
+		const float *from = &rays[i * 6 + 0];
+		const float *to   = &rays[i * 6 + 3];
+
+		void *hit  = 0;
+		float hitT = 2.0f;
+
+		for (std::vector<BenchBox>::iterator b = boxes.begin(); b != boxes.end(); ++b) {
+			float t;
+			if (b->clickable && Graphics::AABBTree::intersectRay(from, to, b->min, b->max, t) && (t < hitT)) {
+				hit  = &*b;
+				hitT = t;
+			}
+		}
+
+		linearHits[i] = hit;
+	}
+
+	const uint64 linearTime = Common::getMicroseconds() - startTime;
+
+	uint32 hits = 0, mismatches = 0;
+	for (int i = 0; i < kRays; i++) {
+		if (treeHits[i])
+			hits++;
+		if (treeHits[i] != linearHits[i])
+			mismatches++;
+	}
+
+	printf("%u objects (%d clickable), %d rays, %u hits, %u mismatches",
+	       (uint) boxes.size(), objectCount, kRays, hits, mismatches);
+	printf("Tree   : %.3fms (%.3fus per ray, %.1f objects tested)",
+	       treeTime / 1000.0, treeTime / (double) kRays, treeTests / (double) kRays);
+	printf("Linear : %.3fms (%.3fus per ray, %u objects tested)",
+	       linearTime / 1000.0, linearTime / (double) kRays, (uint) boxes.size());
+}
+
+void Console::cmdTLKBench(const CommandLine &cl) {
+	const Common::UString name = cl.args.empty() ? Common::UString("dialog") : cl.args;
+
+	Common::SeekableReadStream *stream = ResMan.getResource(name, Aurora::kFileTypeTLK);
+	if (!stream) {
+		printf("No such talk table \"%s\"", name.c_str());
+		return;
+	}
+
+	try {
+		const uint64 startTime = Common::getMicroseconds();
+
+		Aurora::TalkTable tlk(stream);
+
+		const uint64 loadedTime = Common::getMicroseconds();
+
+		// Look up every string
+		uint32 length = 0;
+		for (uint32 i = 0; i < tlk.getEntryCount(); i++)
+			length += tlk.getText(*tlk.getEntry(i)).size();
+
+		const uint64 readTime = Common::getMicroseconds() - loadedTime;
+		const uint32 count    = tlk.getEntryCount();
+
+		printf("%u strings (%u characters), taking up %.1fKB", count, length,
+		       tlk.getMemoryUsage() / 1024.0);
+		printf("Loading took %.3fms, looking up took %.3fms (%.1fns per string)",
+		       (loadedTime - startTime) / 1000.0, readTime / 1000.0,
+		       (readTime * 1000.0) / MAX<uint32>(count, 1));
+
+	} catch (Common::Exception &) {
+		printf("Failed loading talk table \"%s\"", name.c_str());
+	}
+}
+
+void Console::cmd2DACache(const CommandLine &cl) {
+	if (cl.args == "reset") {
+		TwoDAReg.resetStats();
+		print("Reset the 2DA registry statistics");
+		return;
+	}
+
+	if (!cl.args.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	const Aurora::TwoDARegistry::Stats stats = TwoDAReg.getStats();
+
+	printf("%u 2DAs loaded, %.1fMB of %.1fMB", stats.count,
+	       stats.size / (1024.0 * 1024.0), stats.maxSize / (1024.0 * 1024.0));
+	printf("%u hits, %u reused after a module change, %u loads, %u evictions",
+	       stats.hits, stats.reused, stats.loads, stats.evictions);
+	printf("Checking took %.3fms, loading took %.3fms",
+	       stats.checkTime / 1000.0, stats.loadTime / 1000.0);
+}
+
+void Console::cmd2DABench(const CommandLine &cl) {
+	std::list<Aurora::ResourceManager::ResourceID> resources;
+	ResMan.getAvailableResources(Aurora::kFileType2DA, resources);
+
+	uint32 files = 0, failed = 0, cells = 0, strings = 0, memory = 0;
+	uint64 loadTime = 0, readTime = 0;
+
+	for (std::list<Aurora::ResourceManager::ResourceID>::const_iterator r = resources.begin();
+	     r != resources.end(); ++r) {
+
+		Common::SeekableReadStream *stream = 0;
+		try {
+			if (!(stream = ResMan.getResource(r->name, Aurora::kFileType2DA)))
+				throw Common::Exception("No such 2DA");
+
+			const uint64 startTime = Common::getMicroseconds();
+
+			Aurora::TwoDAFile twoda;
+			twoda.load(*stream);
+
+			const uint64 loadedTime = Common::getMicroseconds();
+
+			// Read every cell as an int, a float and a string
+			const std::vector<Common::UString> &headers = twoda.getHeaders();
+
+			int32 sum = 0;
+			for (uint32 i = 0; i < twoda.getRowCount(); i++) {
+				const Aurora::TwoDARow &row = twoda.getRow(i);
+
+				for (uint32 j = 0; j < headers.size(); j++) {
+					sum += row.getInt(headers[j]);
+					sum += (int32) row.getFloat(j);
+					sum += row.getString(j).size();
+				}
+			}
+
+			// Keep the lookups from being optimized away
+			if (sum == 0x7FFFFFFF)
+				status("%s", r->name.c_str());
+
+			loadTime += loadedTime - startTime;
+			readTime += Common::getMicroseconds() - loadedTime;
+
+			cells   += twoda.getRowCount() * twoda.getColumnCount();
+			strings += twoda.getStringCount();
+			memory  += twoda.getMemoryUsage();
+
+			files++;
+		} catch (Common::Exception &) {
+			failed++;
+		}
+
+		delete stream;
+	}
+
+	printf("%u 2DAs (%u failed), %u cells, %u distinct strings", files, failed, cells, strings);
+	printf("Loading took %.3fms, cell data takes up %.1fKB", loadTime / 1000.0, memory / 1024.0);
+	printf("Reading took %.3fms (%.0f cells/s)", readTime / 1000.0,
+	       (cells * 1000000.0) / MAX<uint64>(readTime, 1));
+}
+
 void Console::printCommandHelp(const Common::UString &cmd) {
 	CommandMap::const_iterator c = _commands.find(cmd);
 	if (c == _commands.end()) {
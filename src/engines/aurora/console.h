@@ -278,6 +278,22 @@ private:
 	void cmdListSounds (const CommandLine &cl);
 	void cmdPlaySound  (const CommandLine &cl);
 	void cmdSilence    (const CommandLine &cl);
+	void cmdResIndex   (const CommandLine &cl);
+	void cmdResCache   (const CommandLine &cl);
+	void cmdBIFBench   (const CommandLine &cl);
+	void cmdGFFBench   (const CommandLine &cl);
+	void cmdNCSCache   (const CommandLine &cl);
+	void cmdNWScriptBench(const CommandLine &cl);
+	void cmdNWScriptProf (const CommandLine &cl);
+	void cmdLookupBench  (const CommandLine &cl);
+	void cmdActionBench  (const CommandLine &cl);
+	void cmdMathBench    (const CommandLine &cl);
+	void cmdCullStats    (const CommandLine &cl);
+	void cmdCullBench    (const CommandLine &cl);
+	void cmdPickBench    (const CommandLine &cl);
+	void cmdTLKBench   (const CommandLine &cl);
+	void cmd2DACache   (const CommandLine &cl);
+	void cmd2DABench   (const CommandLine &cl);
 
 	void updateHelpArguments();
 
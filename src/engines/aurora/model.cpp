@@ -27,11 +27,19 @@
  *  Generic Aurora engines model functions.
  */
 
-#ifndef ENGINES_AURORA_MODEL_H
-#define ENGINES_AURORA_MODEL_H
+#include <list>
+#include <map>
+
+#include <boost/bind.hpp>
 
 #include "common/ustring.h"
 #include "common/error.h"
+#include "common/util.h"
+#include "common/mutex.h"
+#include "common/threadpool.h"
+#include "common/configman.h"
+
+#include "graphics/aurora/model.h"
 
 #include "engines/aurora/model.h"
 #include "engines/aurora/modelloader.h"
@@ -40,11 +48,19 @@ namespace Engines {
 
 static ModelLoader *kModelLoader = 0;
 
+typedef std::multimap<Common::UString, Graphics::Aurora::Model *, Common::UString::iless> PreloadedModels;
+
+/** Object models parsed ahead of time, waiting to be taken by loadModelObject(). */
+static PreloadedModels kPreloadedModels;
+static Common::Mutex   kPreloadedModelsMutex;
+
 void registerModelLoader(ModelLoader *loader) {
 	kModelLoader = loader;
 }
 
 void unregisterModelLoader() {
+	clearPreloadedModels();
+
 	delete kModelLoader;
 
 	kModelLoader = 0;
@@ -56,6 +72,18 @@ Graphics::Aurora::Model *loadModelObject(const Common::UString &resref,
 
 	Graphics::Aurora::Model *model = 0;
 
+	if (texture.empty()) {
+		Common::StackLock lock(kPreloadedModelsMutex);
+
+		PreloadedModels::iterator preloaded = kPreloadedModels.find(resref);
+		if (preloaded != kPreloadedModels.end()) {
+			model = preloaded->second;
+
+			kPreloadedModels.erase(preloaded);
+			return model;
+		}
+	}
+
 	try {
 
 		model = kModelLoader->load(resref, Graphics::Aurora::kModelTypeObject, texture);
@@ -89,12 +117,71 @@ Graphics::Aurora::Model *loadModelGUI(const Common::UString &resref) {
 	return model;
 }
 
+static void preloadModelObject(const Common::UString *resref) {
+	Graphics::Aurora::Model *model = 0;
+
+	try {
+		model = kModelLoader->load(*resref, Graphics::Aurora::kModelTypeObject, "");
+	} catch (...) {
+		// loadModelObject() will try again, and report the error
+		return;
+	}
+
+	Common::StackLock lock(kPreloadedModelsMutex);
+
+	kPreloadedModels.insert(std::make_pair(*resref, model));
+}
+
+bool preloadModelObjects(const std::list<Common::UString> &resrefs) {
+	assert(kModelLoader);
+
+	uint32 threadCount = MAX(ConfigMan.getInt("modelthreads", 0), 0);
+	if (threadCount == 0)
+		threadCount = Common::ThreadPool::getCoreCount();
+
+	threadCount = MIN<uint32>(threadCount, resrefs.size());
+	if (threadCount <= 1)
+		return false;
+
+	clearPreloadedModels();
+
+	// The model and texture parsing is CPU-only. Display lists and textures
+	// are only created on the main thread, when the models are first rendered.
+	Common::ThreadPool pool(threadCount);
+
+	for (std::list<Common::UString>::const_iterator r = resrefs.begin(); r != resrefs.end(); ++r)
+		pool.addJob(boost::bind(&preloadModelObject, &*r));
+
+	pool.wait();
+
+	return true;
+}
+
+void clearPreloadedModels() {
+	PreloadedModels models;
+
+	{
+		Common::StackLock lock(kPreloadedModelsMutex);
+
+		models.swap(kPreloadedModels);
+	}
+
+	for (PreloadedModels::iterator m = models.begin(); m != models.end(); ++m)
+		freeModel(m->second);
+}
+
 void freeModel(Graphics::Aurora::Model *&model) {
 	assert(kModelLoader);
 
 	kModelLoader->free(model);
 }
 
-} // End of namespace Engines
+void clearModelCache() {
+	assert(kModelLoader);
 
-#endif // ENGINES_AURORA_MODEL_H
+	clearPreloadedModels();
+
+	kModelLoader->clearCache();
+}
+
+} // End of namespace Engines
@@ -30,6 +30,8 @@
 #ifndef ENGINES_AURORA_MODEL_H
 #define ENGINES_AURORA_MODEL_H
 
+#include <list>
+
 #include "graphics/aurora/types.h"
 
 namespace Common {
@@ -47,8 +49,26 @@ Graphics::Aurora::Model *loadModelObject(const Common::UString &resref,
                                          const Common::UString &texture = "");
 Graphics::Aurora::Model *loadModelGUI   (const Common::UString &resref);
 
+/** Parse object models ahead of time, on a pool of worker threads.
+ *
+ *  One model is loaded for each entry in the list, so a name that's
+ *  listed several times is loaded several times. Subsequent calls to
+ *  loadModelObject() with the default texture take these models first.
+ *
+ *  The number of threads is set by the "modelthreads" config option,
+ *  with 0 meaning one thread per core.
+ *
+ *  @return false if preloading is disabled and nothing was loaded.
+ */
+bool preloadModelObjects(const std::list<Common::UString> &resrefs);
+/** Free all preloaded models that haven't been taken by loadModelObject(). */
+void clearPreloadedModels();
+
 void freeModel(Graphics::Aurora::Model *&model);
 
+/** Let the model loader forget the models it cached, like when unloading a module. */
+void clearModelCache();
+
 } // End of namespace Engines
 
 #endif // ENGINES_AURORA_MODEL_H
@@ -41,4 +41,7 @@ void ModelLoader::free(Graphics::Aurora::Model *&model) {
 	model = 0;
 }
 
+void ModelLoader::clearCache() {
+}
+
 } // End of namespace Engines
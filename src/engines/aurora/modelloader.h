@@ -45,6 +45,9 @@ public:
 	virtual Graphics::Aurora::Model *load(const Common::UString &resref,
 			Graphics::Aurora::ModelType type, const Common::UString &texture) = 0;
 	virtual void free(Graphics::Aurora::Model *&model);
+
+	/** Forget all models cached for faster loading. Loaded models stay valid. */
+	virtual void clearCache();
 };
 
 } // End of namespace Engines
@@ -27,8 +27,10 @@
  *  Generic Aurora engines resource utility functions.
  */
 
+#include "common/util.h"
 #include "common/error.h"
 #include "common/ustring.h"
+#include "common/configman.h"
 
 #include "events/events.h"
 
@@ -68,6 +70,29 @@ bool indexOptionalArchive(Aurora::ArchiveType archive, const Common::UString &fi
 	return true;
 }
 
+uint32 queueMandatoryArchive(Aurora::ResourceManager::ArchiveBatch &batch,
+		Aurora::ArchiveType archive, const Common::UString &file, uint32 priority) {
+
+	batch.push_back(Aurora::ResourceManager::BatchArchive(archive, file, priority, false));
+
+	return batch.size() - 1;
+}
+
+uint32 queueOptionalArchive(Aurora::ResourceManager::ArchiveBatch &batch,
+		Aurora::ArchiveType archive, const Common::UString &file, uint32 priority) {
+
+	batch.push_back(Aurora::ResourceManager::BatchArchive(archive, file, priority, true));
+
+	return batch.size() - 1;
+}
+
+void indexArchives(Aurora::ResourceManager::ArchiveBatch &batch) {
+	if (EventMan.quitRequested())
+		return;
+
+	ResMan.addArchives(batch, MAX(ConfigMan.getInt("indexthreads", 0), 0));
+}
+
 void indexMandatoryDirectory(const Common::UString &dir,
 		const char *glob, int depth, uint32 priority,
 		Aurora::ResourceManager::ChangeID *change) {
@@ -46,6 +46,23 @@ void indexMandatoryArchive(Aurora::ArchiveType archive, const Common::UString &f
 bool indexOptionalArchive(Aurora::ArchiveType archive, const Common::UString &file,
 		uint32 priority = 10, Aurora::ResourceManager::ChangeID *change = 0);
 
+/** Queue an archive file to be added as part of a batch, erroring out if it does not exist.
+ *
+ *  @return The archive's index within the batch.
+ */
+uint32 queueMandatoryArchive(Aurora::ResourceManager::ArchiveBatch &batch,
+		Aurora::ArchiveType archive, const Common::UString &file, uint32 priority = 10);
+
+/** Queue an archive file to be added as part of a batch, if it exists.
+ *
+ *  @return The archive's index within the batch, to check whether it was added.
+ */
+uint32 queueOptionalArchive(Aurora::ResourceManager::ArchiveBatch &batch,
+		Aurora::ArchiveType archive, const Common::UString &file, uint32 priority = 10);
+
+/** Add a batch of archive files to the resource manager, reading them in parallel. */
+void indexArchives(Aurora::ResourceManager::ArchiveBatch &batch);
+
 /** Add a directory to the resource manager, erroring out if it does not exist. */
 void indexMandatoryDirectory(const Common::UString &dir,
 		const char *glob = 0, int depth = -1, uint32 priority = 10,
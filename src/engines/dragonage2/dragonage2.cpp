@@ -31,6 +31,7 @@
 #include "common/filelist.h"
 #include "common/filepath.h"
 #include "common/configman.h"
+#include "common/timestamp.h"
 
 #include "aurora/resman.h"
 
@@ -102,7 +103,7 @@ void DragonAge2Engine::run(const Common::UString &target) {
 	if (EventMan.quitRequested())
 		return;
 
-	status("Successfully initialized the engine");
+	status("Successfully initialized the engine, %.3fms after startup", Common::getMicroseconds() / 1000.0);
 
 	CursorMan.hideCursor();
 	CursorMan.set();
@@ -34,6 +34,7 @@
 #include "common/filepath.h"
 #include "common/debugman.h"
 #include "common/configman.h"
+#include "common/timestamp.h"
 
 #include "aurora/error.h"
 #include "aurora/resman.h"
@@ -41,6 +42,8 @@
 #include "aurora/2dareg.h"
 #include "../aurora/util.h"
 
+#include "aurora/nwscript/ncsreg.h"
+
 #include "graphics/aurora/cursorman.h"
 #include "graphics/aurora/fontman.h"
 #include "graphics/aurora/textureman.h"
@@ -197,6 +200,8 @@ void EngineManager::run(GameInstance &game) const {
 	try {
 		createEngine(game);
 
+		status("Starting the engine, %.3fms after startup", Common::getMicroseconds() / 1000.0);
+
 		game._engine->run(game._target);
 		EventMan.requestQuit();
 
@@ -237,6 +242,7 @@ void EngineManager::cleanup(GameInstance &game) const {
 
 		TalkMan.clear();
 		TwoDAReg.clear();
+		NCSReg.clear();
 		ResMan.clear();
 
 		ConfigMan.setGame();
@@ -31,6 +31,7 @@
 #include "common/filelist.h"
 #include "common/filepath.h"
 #include "common/configman.h"
+#include "common/timestamp.h"
 
 #include "aurora/resman.h"
 #include "aurora/talkman.h"
@@ -105,7 +106,7 @@ void JadeEngine::run(const Common::UString &target) {
 	if (EventMan.quitRequested())
 		return;
 
-	status("Successfully initialized the engine");
+	status("Successfully initialized the engine, %.3fms after startup", Common::getMicroseconds() / 1000.0);
 
 	CursorMan.hideCursor();
 	CursorMan.set();
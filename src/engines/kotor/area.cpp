@@ -27,8 +27,12 @@
  *  An area.
  */
 
+#include <algorithm>
+
 #include "common/util.h"
 #include "common/error.h"
+#include "common/debug.h"
+#include "common/filepool.h"
 #include "common/stream.h"
 
 #include "aurora/resman.h"
@@ -38,6 +42,7 @@
 #include "aurora/2dareg.h"
 
 #include "graphics/graphics.h"
+#include "graphics/camera.h"
 
 #include "graphics/aurora/cursorman.h"
 
@@ -55,16 +60,35 @@ namespace Engines {
 
 namespace KotOR {
 
+/** How far the camera can move out of its current room before it switches rooms.
+ *
+ *  Room bounding boxes overlap at doorways, and without some leeway, walking
+ *  along a room boundary would show and hide rooms all the time.
+ */
+static const float kRoomHysteresis = 1.0f;
+
 Area::Room::Room(const Aurora::LYTFile::Room &lRoom) :
-	lytRoom(&lRoom), model(0), visible(false) {
+	lytRoom(&lRoom), model(0), visible(false), hasBound(false) {
+
+	min[0] = min[1] = min[2] = 0.0f;
+	max[0] = max[1] = max[2] = 0.0f;
 }
 
 Area::Room::~Room() {
 	delete model;
 }
 
+bool Area::Room::contains(float x, float z, float margin) const {
+	if (!hasBound)
+		return false;
 
-Area::Area() : _loaded(false), _visible(false), _activeObject(0), _highlightAll(false) {
+	return (x >= (min[0] - margin)) && (x <= (max[0] + margin)) &&
+	       (z >= (min[2] - margin)) && (z <= (max[2] + margin));
+}
+
+
+Area::Area() : _loaded(false), _visible(false), _currentRoom(0), _roomCulling(true),
+	_activeObject(0), _highlightAll(false) {
 }
 
 Area::~Area() {
@@ -133,9 +157,9 @@ void Area::show() {
 
 	GfxMan.lockFrame();
 
-	// Show rooms
-	for (std::vector<Room *>::iterator r = _rooms.begin(); r != _rooms.end(); ++r)
-		(*r)->model->show();
+	// Show the rooms visible from where the camera is
+	_currentRoom = findCameraRoom();
+	showVisibleRooms();
 
 	// Show objects
 	for (ObjectList::iterator o = _objects.begin(); o != _objects.end(); ++o)
@@ -163,8 +187,12 @@ void Area::hide() {
 		(*o)->hide();
 
 	// Hide rooms
-	for (std::vector<Room *>::iterator room = _rooms.begin(); room != _rooms.end(); ++room)
+	for (std::vector<Room *>::iterator room = _rooms.begin(); room != _rooms.end(); ++room) {
 		(*room)->model->hide();
+		(*room)->visible = false;
+	}
+
+	_currentRoom = 0;
 
 	GfxMan.unlockFrame();
 
@@ -172,9 +200,15 @@ void Area::hide() {
 }
 
 void Area::load(const Common::UString &resRef) {
+	const Common::FilePoolManager::Stats fileStats = FilePool.getStats();
+
 	_resRef = resRef;
 
 	loadLYT(); // Room layout
+
+	// Let the room models be read in the background, while we're busy parsing
+	prefetchModels();
+
 	loadVIS(); // Room visibilities
 
 	loadModels(); // Room models
@@ -187,6 +221,10 @@ void Area::load(const Common::UString &resRef) {
 	loadGIT(git.getTopLevel());
 
 	_loaded = true;
+
+	const Common::FilePoolManager::Stats newFileStats = FilePool.getStats();
+	debugC(1, Common::kDebugResources, "Area \"%s\": %u archive reads, %u file opens",
+	       _resRef.c_str(), newFileStats.reads - fileStats.reads, newFileStats.opens - fileStats.opens);
 }
 
 void Area::loadLYT() {
@@ -350,6 +388,15 @@ void Area::loadCreatures(const Aurora::GFFList &list) {
 
 void Area::loadModels() {
 	const Aurora::LYTFile::RoomArray &rooms = _lyt.getRooms();
+
+	// Parse the room models on all cores, to be picked up in order below
+	std::list<Common::UString> models;
+	for (size_t i = 0; i < rooms.size(); i++)
+		if (rooms[i].model != "****")
+			models.push_back(rooms[i].model);
+
+	preloadModelObjects(models);
+
 	_rooms.reserve(rooms.size());
 	for (size_t i = 0; i < rooms.size(); i++) {
 		const Aurora::LYTFile::Room &lytRoom = rooms[i];
@@ -363,15 +410,38 @@ void Area::loadModels() {
 		room->model = loadModelObject(lytRoom.model);
 		if (!room->model) {
 			delete room;
+			clearPreloadedModels();
 			throw Common::Exception("Can't load model \"%s\" for area \"%s\"",
 			                        lytRoom.model.c_str(), _resRef.c_str());
 		}
 
 		room->model->setPosition(lytRoom.x, lytRoom.y, lytRoom.z);
+		room->hasBound = room->model->getWorldBound(room->min, room->max);
 
 		_rooms.push_back(room);
 	}
 
+	clearPreloadedModels();
+}
+
+void Area::prefetchModels() {
+	const Aurora::LYTFile::RoomArray &rooms = _lyt.getRooms();
+
+	std::list<Aurora::ResourceManager::ResourceID> resources;
+	for (size_t i = 0; i < rooms.size(); i++) {
+		if (rooms[i].model == "****")
+			continue;
+
+		resources.push_back(Aurora::ResourceManager::ResourceID());
+		resources.back().name = rooms[i].model;
+		resources.back().type = Aurora::kFileTypeMDL;
+
+		resources.push_back(Aurora::ResourceManager::ResourceID());
+		resources.back().name = rooms[i].model;
+		resources.back().type = Aurora::kFileTypeMDX;
+	}
+
+	ResMan.prefetch(resources);
 }
 
 void Area::loadVisibles() {
@@ -386,12 +456,18 @@ void Area::loadVisibles() {
 			for (std::vector<Room *>::iterator iRoom = _rooms.begin(); iRoom != _rooms.end(); ++iRoom)
 				(*room)->visibles.push_back(*iRoom);
 
-			return;
+			continue;
 		}
 
+		// A room is always visible from itself
+		(*room)->visibles.push_back(*room);
+
 		// Otherwise, go through all rooms again, look for a match with the visibilities
 		for (std::vector<Room *>::iterator iRoom = _rooms.begin(); iRoom != _rooms.end(); ++iRoom) {
 
+			if (*iRoom == *room)
+				continue;
+
 			for (std::vector<Common::UString>::const_iterator vRoom = rooms.begin(); vRoom != rooms.end(); ++vRoom) {
 				if (vRoom->equalsIgnoreCase((*iRoom)->lytRoom->model)) {
 					// Mark that room as visible from the first room
@@ -406,6 +482,94 @@ void Area::loadVisibles() {
 
 }
 
+Area::Room *Area::findCameraRoom() const {
+	// The camera position, in the world space the rooms are rendered in
+	const float *cPos = CameraMan.getPosition();
+
+	const float x =  cPos[0];
+	const float z = -cPos[2];
+
+	// Stay in the current room until the camera has clearly left it
+	if (_currentRoom && _currentRoom->contains(x, z, kRoomHysteresis))
+		return _currentRoom;
+
+	// Otherwise, find the smallest room containing the camera
+	Room *room = 0;
+	float roomSize = 0.0f;
+
+	for (std::vector<Room *>::const_iterator r = _rooms.begin(); r != _rooms.end(); ++r) {
+		if (!(*r)->contains(x, z, 0.0f))
+			continue;
+
+		const float size = ((*r)->max[0] - (*r)->min[0]) * ((*r)->max[2] - (*r)->min[2]);
+		if (!room || (size < roomSize)) {
+			room     = *r;
+			roomSize = size;
+		}
+	}
+
+	// Outside of all rooms, keep what we have
+	if (!room)
+		return _currentRoom;
+
+	return room;
+}
+
+void Area::showVisibleRooms() {
+	// Without a current room, we can't know what's visible, so show everything
+	const bool showAll = !_roomCulling || !_currentRoom;
+
+	std::vector<bool> visible(_rooms.size(), showAll);
+	if (!showAll) {
+		for (size_t i = 0; i < _rooms.size(); i++)
+			visible[i] = std::find(_currentRoom->visibles.begin(), _currentRoom->visibles.end(),
+			                       _rooms[i]) != _currentRoom->visibles.end();
+	}
+
+	for (size_t i = 0; i < _rooms.size(); i++) {
+		Room &room = *_rooms[i];
+
+		if (room.visible == visible[i])
+			continue;
+
+		if (visible[i])
+			room.model->show();
+		else
+			room.model->hide();
+
+		room.visible = visible[i];
+	}
+}
+
+void Area::updateRoomVisibility() {
+	if (!_visible)
+		return;
+
+	Room *room = findCameraRoom();
+	if (room == _currentRoom)
+		return;
+
+	_currentRoom = room;
+
+	GfxMan.lockFrame();
+	showVisibleRooms();
+	GfxMan.unlockFrame();
+}
+
+void Area::setRoomCulling(bool enabled) {
+	if (_roomCulling == enabled)
+		return;
+
+	_roomCulling = enabled;
+
+	if (!_visible)
+		return;
+
+	GfxMan.lockFrame();
+	showVisibleRooms();
+	GfxMan.unlockFrame();
+}
+
 void Area::addEvent(const Events::Event &event) {
 	_eventQueue.push_back(event);
 }
@@ -488,6 +652,8 @@ void Area::removeFocus() {
 }
 
 void Area::notifyCameraMoved() {
+	updateRoomVisibility();
+
 	checkActive();
 }
 
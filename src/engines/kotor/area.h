@@ -74,6 +74,9 @@ public:
 
 	void removeFocus();
 
+	/** Enable/Disable only showing the rooms visible from the camera's room. */
+	void setRoomCulling(bool enabled);
+
 
 protected:
 	void notifyCameraMoved();
@@ -89,8 +92,15 @@ private:
 		bool visible;
 		std::vector<Room *> visibles;
 
+		bool hasBound;  ///< Does the room's model have a bounding box?
+		float min[3];   ///< The minimum of the room's bounding box, in world space.
+		float max[3];   ///< The maximum of the room's bounding box, in world space.
+
 		Room(const Aurora::LYTFile::Room &lRoom);
 		~Room();
+
+		/** Is that point on the floor plan of the room, enlarged by margin? */
+		bool contains(float x, float z, float margin) const;
 	};
 
 	typedef std::list<Object *> ObjectList;
@@ -125,6 +135,9 @@ private:
 
 	std::vector<Room *> _rooms;
 
+	Room *_currentRoom; ///< The room the camera is in.
+	bool  _roomCulling; ///< Only show the rooms visible from the current room?
+
 	ObjectList _objects;
 
 	ObjectMap _objectMap;
@@ -147,6 +160,16 @@ private:
 	void loadModels();
 	void loadVisibles();
 
+	/** Start reading all room models in the background. */
+	void prefetchModels();
+
+	/** Find the room the camera is in, preferring the current one. */
+	Room *findCameraRoom() const;
+	/** Show the rooms visible from the current room, and hide all others. */
+	void showVisibleRooms();
+	/** Update the current room and the rooms visible from it. */
+	void updateRoomVisibility();
+
 	void loadProperties(const Aurora::GFFStruct &props);
 
 	void loadPlaceables(const Aurora::GFFList &list);
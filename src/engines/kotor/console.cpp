@@ -32,10 +32,13 @@
 #include "common/ustring.h"
 #include "common/util.h"
 
+#include "graphics/graphics.h"
+
 #include "graphics/aurora/fontman.h"
 
 #include "engines/kotor/console.h"
 #include "engines/kotor/module.h"
+#include "engines/kotor/area.h"
 
 namespace Engines {
 
@@ -46,6 +49,9 @@ Console::Console() : ::Engines::Console(Graphics::Aurora::kSystemFontMono, 13),
 
 	registerCommand("loadmodule", boost::bind(&Console::cmdLoadModule, this, _1),
 			"Usage: loadmodule <module>\nLoad and enter the specified module");
+	registerCommand("roomvis"   , boost::bind(&Console::cmdRoomVis   , this, _1),
+			"Usage: roomvis [on|off]\nShow the camera's room and the rooms visible from it, "
+			"with the world objects rendered in the last frame, or toggle room culling");
 }
 
 Console::~Console() {
@@ -67,6 +73,37 @@ void Console::cmdLoadModule(const CommandLine &cl) {
 	_module->replaceModule(cl.args);
 }
 
+void Console::cmdRoomVis(const CommandLine &cl) {
+	if (!_module || !_module->_area)
+		return;
+
+	Area &area = *_module->_area;
+
+	if        (cl.args == "on") {
+		area.setRoomCulling(true);
+	} else if (cl.args == "off") {
+		area.setRoomCulling(false);
+	} else if (!cl.args.empty()) {
+		printCommandHelp(cl.cmd);
+		return;
+	}
+
+	uint32 visibleRooms = 0;
+	for (std::vector<Area::Room *>::const_iterator r = area._rooms.begin(); r != area._rooms.end(); ++r)
+		if ((*r)->visible)
+			visibleRooms++;
+
+	printf("Room culling %s, camera in room \"%s\", %u of %u rooms visible",
+	       area._roomCulling ? "on" : "off",
+	       area._currentRoom ? area._currentRoom->lytRoom->model.c_str() : "",
+	       visibleRooms, (uint) area._rooms.size());
+
+	uint32 submitted, culled, cullTime;
+	GfxMan.getCullStatistics(submitted, culled, cullTime);
+
+	printf("Last frame: %u world objects rendered, %u culled", submitted, culled);
+}
+
 } // End of namespace KOTOR
 
 } // End of namespace Engines
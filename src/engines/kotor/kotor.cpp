@@ -32,6 +32,7 @@
 #include "common/filepath.h"
 #include "common/stream.h"
 #include "common/configman.h"
+#include "common/timestamp.h"
 
 #include "aurora/resman.h"
 #include "aurora/talkman.h"
@@ -136,7 +137,7 @@ void KotOREngine::run(const Common::UString &target) {
 	if (EventMan.quitRequested())
 		return;
 
-	status("Successfully initialized the engine");
+	status("Successfully initialized the engine, %.3fms after startup", Common::getMicroseconds() / 1000.0);
 
 	CursorMan.hideCursor();
 	CursorMan.set();
@@ -198,35 +199,40 @@ void KotOREngine::initResources() {
 	ResMan.addArchiveDir(Aurora::kArchiveRIM, (_platform == Aurora::kPlatformXbox) ? "rimsxbox" : "rims");
 	ResMan.addArchiveDir(Aurora::kArchiveRIM, "modules");
 
-	status("Loading main KEY");
-	indexMandatoryArchive(Aurora::kArchiveKEY, "chitin.key", 1);
+	status("Loading main KEY and global auxiliary resources");
 
-	if (indexOptionalArchive(Aurora::kArchiveKEY, "live1.key", 2)) {
-		status("Loading Xbox DLC KEY");
-		_hasLiveKey = true;
-	}
+	Aurora::ResourceManager::ArchiveBatch archives;
+
+	queueMandatoryArchive(archives, Aurora::kArchiveKEY, "chitin.key", 1);
+	const uint32 liveKey = queueOptionalArchive(archives, Aurora::kArchiveKEY, "live1.key", 2);
 
-	status("Loading global auxiliary resources");
-	indexMandatoryArchive(Aurora::kArchiveRIM, "mainmenu.rim"    , 10);
-	indexMandatoryArchive(Aurora::kArchiveRIM, "mainmenudx.rim"  , 11);
-	indexMandatoryArchive(Aurora::kArchiveRIM, "legal.rim"       , 12);
-	indexMandatoryArchive(Aurora::kArchiveRIM, "legaldx.rim"     , 13);
-	indexMandatoryArchive(Aurora::kArchiveRIM, "global.rim"      , 14);
-	indexMandatoryArchive(Aurora::kArchiveRIM, "subglobaldx.rim" , 15);
-	indexMandatoryArchive(Aurora::kArchiveRIM, "miniglobaldx.rim", 16);
-	indexMandatoryArchive(Aurora::kArchiveRIM, "globaldx.rim"    , 17);
-	indexMandatoryArchive(Aurora::kArchiveRIM, "chargen.rim"     , 18);
-	indexMandatoryArchive(Aurora::kArchiveRIM, "chargendx.rim"   , 19);
+	queueMandatoryArchive(archives, Aurora::kArchiveRIM, "mainmenu.rim"    , 10);
+	queueMandatoryArchive(archives, Aurora::kArchiveRIM, "mainmenudx.rim"  , 11);
+	queueMandatoryArchive(archives, Aurora::kArchiveRIM, "legal.rim"       , 12);
+	queueMandatoryArchive(archives, Aurora::kArchiveRIM, "legaldx.rim"     , 13);
+	queueMandatoryArchive(archives, Aurora::kArchiveRIM, "global.rim"      , 14);
+	queueMandatoryArchive(archives, Aurora::kArchiveRIM, "subglobaldx.rim" , 15);
+	queueMandatoryArchive(archives, Aurora::kArchiveRIM, "miniglobaldx.rim", 16);
+	queueMandatoryArchive(archives, Aurora::kArchiveRIM, "globaldx.rim"    , 17);
+	queueMandatoryArchive(archives, Aurora::kArchiveRIM, "chargen.rim"     , 18);
+	queueMandatoryArchive(archives, Aurora::kArchiveRIM, "chargendx.rim"   , 19);
 
 	if (_platform == Aurora::kPlatformXbox) {
 		// The Xbox version has most of its textures in "textures.bif"
 		// Some, however, reside in "players.erf"
-		status("Loading Xbox textures");
-		indexMandatoryArchive(Aurora::kArchiveERF, "players.erf", 20);
+		queueMandatoryArchive(archives, Aurora::kArchiveERF, "players.erf", 20);
 	} else {
 		// The Windows/Mac versions have the GUI textures here
-		status("Loading GUI textures");
-		indexMandatoryArchive(Aurora::kArchiveERF, "swpc_tex_gui.erf", 20);
+		queueMandatoryArchive(archives, Aurora::kArchiveERF, "swpc_tex_gui.erf", 20);
+	}
+
+	indexArchives(archives);
+	if (EventMan.quitRequested())
+		return;
+
+	if (archives[liveKey].added) {
+		status("Found Xbox DLC KEY");
+		_hasLiveKey = true;
 	}
 
 	status("Indexing extra sound resources");
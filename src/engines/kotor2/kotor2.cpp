@@ -32,6 +32,7 @@
 #include "common/filepath.h"
 #include "common/stream.h"
 #include "common/configman.h"
+#include "common/timestamp.h"
 
 #include "aurora/resman.h"
 #include "aurora/talkman.h"
@@ -122,7 +123,7 @@ void KotOR2Engine::run(const Common::UString &target) {
 	if (EventMan.quitRequested())
 		return;
 
-	status("Successfully initialized the engine");
+	status("Successfully initialized the engine, %.3fms after startup", Common::getMicroseconds() / 1000.0);
 
 	CursorMan.hideCursor();
 	CursorMan.set();
@@ -27,9 +27,15 @@
  *  NWN area.
  */
 
+#include <set>
+
 #include "common/util.h"
 #include "common/error.h"
+#include "common/debug.h"
+#include "common/filepool.h"
+#include "common/timestamp.h"
 
+#include "aurora/resman.h"
 #include "aurora/locstring.h"
 #include "aurora/gfffile.h"
 #include "aurora/2dafile.h"
@@ -378,20 +384,92 @@ void Area::loadTile(const Aurora::GFFStruct &t, Tile &tile) {
 }
 
 void Area::loadModels() {
-	loadTileModels();
+	const Common::FilePoolManager::Stats fileStats = FilePool.getStats();
+	const uint64 startTime = Common::getMicroseconds();
+
+	loadTileset();
+
+	// Let the models be read in the background, while we're busy parsing them
+	prefetchModels();
 
-	for (ObjectList::iterator o = _objects.begin(); o != _objects.end(); ++o) {
-		Engines::NWN::Object &object = **o;
+	// Parse the tile and object models on all cores, to be picked up in order below
+	preloadModels();
 
-		object.loadModel();
+	try {
+		loadTiles();
+
+		for (ObjectList::iterator o = _objects.begin(); o != _objects.end(); ++o) {
+			Engines::NWN::Object &object = **o;
 
-		if (!object.isStatic()) {
-			const std::list<uint32> &ids = object.getIDs();
+			object.loadModel();
 
-			for (std::list<uint32>::const_iterator id = ids.begin(); id != ids.end(); ++id)
-				_objectMap.insert(std::make_pair(*id, &object));
+			if (!object.isStatic()) {
+				const std::list<uint32> &ids = object.getIDs();
+
+				for (std::list<uint32>::const_iterator id = ids.begin(); id != ids.end(); ++id)
+					_objectMap.insert(std::make_pair(*id, &object));
+			}
 		}
+	} catch (...) {
+		clearPreloadedModels();
+		throw;
+	}
+
+	clearPreloadedModels();
+
+	const Common::FilePoolManager::Stats newFileStats = FilePool.getStats();
+	debugC(1, Common::kDebugResources, "Area \"%s\": %u archive reads, %u file opens",
+	       _resRef.c_str(), newFileStats.reads - fileStats.reads, newFileStats.opens - fileStats.opens);
+
+	// Tiles sharing a model share its geometry, so count each buffer only once
+	std::set<const void *> buffers;
+	uint32 geometrySize = 0, geometryTotal = 0;
+
+	for (std::vector<Tile>::const_iterator t = _tiles.begin(); t != _tiles.end(); ++t)
+		if (t->model)
+			t->model->getGeometrySize(buffers, geometrySize, geometryTotal);
+
+	debugC(1, Common::kDebugResources, "Area \"%s\": %u tiles loaded in %.3fms, "
+	       "tile geometry %u KB (%u KB unshared)", _resRef.c_str(), (uint) _tiles.size(),
+	       (Common::getMicroseconds() - startTime) / 1000.0, geometrySize / 1024, geometryTotal / 1024);
+}
+
+void Area::prefetchModels() {
+	std::set<Common::UString> models;
+
+	for (std::vector<Tile>::const_iterator t = _tiles.begin(); t != _tiles.end(); ++t)
+		models.insert(_tileset->getTile(t->tileID).model);
+
+	std::list<Common::UString> objectModels;
+	for (ObjectList::const_iterator o = _objects.begin(); o != _objects.end(); ++o)
+		(*o)->getModelNames(objectModels);
+
+	models.insert(objectModels.begin(), objectModels.end());
+
+	std::list<Aurora::ResourceManager::ResourceID> resources;
+	for (std::set<Common::UString>::const_iterator m = models.begin(); m != models.end(); ++m) {
+		resources.push_back(Aurora::ResourceManager::ResourceID());
+
+		resources.back().name = *m;
+		resources.back().type = Aurora::kFileTypeMDL;
 	}
+
+	ResMan.prefetch(resources);
+}
+
+void Area::preloadModels() {
+	// Only the first instance of each tile model needs parsing, all further
+	// instances are cheap copies of the loader's shared template
+	std::set<Common::UString> tileModels;
+	for (std::vector<Tile>::const_iterator t = _tiles.begin(); t != _tiles.end(); ++t)
+		tileModels.insert(_tileset->getTile(t->tileID).model);
+
+	std::list<Common::UString> models(tileModels.begin(), tileModels.end());
+
+	for (ObjectList::const_iterator o = _objects.begin(); o != _objects.end(); ++o)
+		(*o)->getModelNames(models);
+
+	preloadModelObjects(models);
 }
 
 void Area::unloadModels() {
@@ -403,11 +481,6 @@ void Area::unloadModels() {
 	unloadTileModels();
 }
 
-void Area::loadTileModels() {
-	loadTileset();
-	loadTiles();
-}
-
 void Area::unloadTileModels() {
 	unloadTiles();
 	unloadTileset();
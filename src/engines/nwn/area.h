@@ -223,7 +223,11 @@ private:
 	void loadModels();
 	void unloadModels();
 
-	void loadTileModels();
+	/** Start reading all models the area is about to load in the background. */
+	void prefetchModels();
+	/** Parse all models the area is about to load in parallel. */
+	void preloadModels();
+
 	void unloadTileModels();
 
 	void loadTileset();
@@ -491,6 +491,19 @@ void Creature::loadModel() {
 	}
 }
 
+void Creature::getModelNames(std::list<Common::UString> &models) const {
+	if (_appearanceID == Aurora::kFieldIDInvalid)
+		return;
+
+	const Aurora::TwoDARow &appearance = TwoDAReg.get("appearance").getRow(_appearanceID);
+
+	// Part-based models depend on the armor, and are only known while loading
+	if (appearance.getString("MODELTYPE") == "P")
+		return;
+
+	models.push_back(appearance.getString("RACE"));
+}
+
 void Creature::unloadModel() {
 	hide();
 
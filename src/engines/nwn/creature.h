@@ -65,6 +65,9 @@ public:
 	void loadModel();   ///< Load the creature's model.
 	void unloadModel(); ///< Unload the creature's model.
 
+	/** Add the name of the creature's model to the list. */
+	void getModelNames(std::list<Common::UString> &models) const;
+
 	void show(); ///< Show the creature's model.
 	void hide(); ///< Hide the creature's model.
 
@@ -44,19 +44,42 @@ namespace NWN {
 Graphics::Aurora::Model *NWNModelLoader::load(const Common::UString &resref,
 		Graphics::Aurora::ModelType type, const Common::UString &texture) {
 
-	Graphics::Aurora::Model *model = 0;
-	try {
-		model = new Graphics::Aurora::Model_NWN(resref, type, texture, &modelCache);
-	} catch (...) {
-		delete model;
-		throw;
+	return new Graphics::Aurora::Model_NWN(getTemplate(resref, type, texture));
+}
+
+void NWNModelLoader::clearCache() {
+	TemplateMap templates;
+
+	{
+		Common::StackLock lock(_templateMutex);
+
+		templates.swap(_templates);
+	}
+
+	// Templates still in use are kept alive by their instances
+}
+
+NWNModelLoader::ModelTemplate NWNModelLoader::getTemplate(const Common::UString &resref,
+		Graphics::Aurora::ModelType type, const Common::UString &texture) {
+
+	const Common::UString key = Common::UString::sprintf("%s:%d:%s", resref.c_str(), (int) type, texture.c_str());
+
+	{
+		Common::StackLock lock(_templateMutex);
+
+		TemplateMap::const_iterator t = _templates.find(key);
+		if (t != _templates.end())
+			return t->second;
 	}
 
-	// if supermodel
-	// check model cache
-	// else load supermodel and insert into cache
+	// Parse the model without holding the lock, and drop it if another thread was faster
+	ModelTemplate model(new Graphics::Aurora::Model_NWN(resref, type, texture, &modelCache));
+
+	model->makeTemplate();
+
+	Common::StackLock lock(_templateMutex);
 
-	return model;
+	return _templates.insert(std::make_pair(key, model)).first->second;
 }
 
 } // End of namespace NWN
@@ -30,18 +30,54 @@
 #ifndef ENGINES_NWN_MODELLOADER_H
 #define ENGINES_NWN_MODELLOADER_H
 
+#include <map>
+
+#include <boost/shared_ptr.hpp>
+
+#include "common/ustring.h"
+#include "common/mutex.h"
+
 #include "engines/aurora/modelloader.h"
 
+namespace Graphics {
+	namespace Aurora {
+		class Model_NWN;
+	}
+}
+
 namespace Engines {
 
 namespace NWN {
 
+/** Loads NWN models.
+ *
+ *  Every model is only parsed once, as a template. All models handed out
+ *  are instances of that template, sharing its geometry and animations,
+ *  so that an area with hundreds of identical tiles keeps only one copy
+ *  of each tile's geometry.
+ *
+ *  Templates are kept until the cache is cleared, and after that for as
+ *  long as any of their instances exist.
+ */
 class NWNModelLoader : public ModelLoader {
 public:
 	Graphics::Aurora::Model *load(const Common::UString &resref,
 			Graphics::Aurora::ModelType type, const Common::UString &texture);
 
+	void clearCache();
+
 	std::map<Common::UString, Graphics::Aurora::Model*, Common::UString::iless> modelCache;
+
+private:
+	typedef boost::shared_ptr<Graphics::Aurora::Model_NWN> ModelTemplate;
+	typedef std::map<Common::UString, ModelTemplate, Common::UString::iless> TemplateMap;
+
+	TemplateMap   _templates;     ///< All models parsed since the cache was last cleared.
+	Common::Mutex _templateMutex; ///< Guards the templates, since models are loaded from several threads.
+
+	/** Return the template for this model, parsing it if necessary. */
+	ModelTemplate getTemplate(const Common::UString &resref,
+			Graphics::Aurora::ModelType type, const Common::UString &texture);
 };
 
 } // End of namespace NWN
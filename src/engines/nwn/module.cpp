@@ -30,6 +30,7 @@
 #include "common/util.h"
 #include "common/error.h"
 #include "common/configman.h"
+#include "common/timestamp.h"
 
 #include "events/events.h"
 
@@ -37,12 +38,15 @@
 #include "aurora/talkman.h"
 #include "aurora/erffile.h"
 
+#include "aurora/nwscript/ncsreg.h"
+
 #include "graphics/camera.h"
 
 #include "graphics/aurora/textureman.h"
 #include "graphics/aurora/model.h"
 
 #include "engines/aurora/util.h"
+#include "engines/aurora/model.h"
 #include "engines/aurora/tokenman.h"
 #include "engines/aurora/resources.h"
 
@@ -95,14 +99,12 @@ namespace Engines {
 
 namespace NWN {
 
-bool Module::Action::operator<(const Action &s) const {
-	return timestamp < s.timestamp;
-}
-
-
 Module::Module(Console &console) : _console(&console), _hasModule(false), _pc(0),
 	_currentTexturePack(-1), _exit(false), _currentArea(0) {
 
+	// Milliseconds per frame to spend on delayed scripts, the rest waits for the next frame
+	_actionBudget = MAX(ConfigMan.getInt("actionbudget", 4), 0) * 1000;
+
 	_ingameGUI = new IngameGUI(*this);
 }
 
@@ -492,20 +494,21 @@ bool Module::handleCamera(const Events::Event &e) {
 	return true;
 }
 
-void Module::handleActions() {
-	uint32 now = EventMan.getTimestamp();
+void Module::handleActions(bool budget) {
+	_delayedActions.advance(EventMan.getTimestamp());
 
-	while (!_delayedActions.empty()) {
-		std::multiset<Action>::iterator action = _delayedActions.begin();
+	const uint64 startTime = Common::getMicroseconds();
 
-		if (now < action->timestamp)
-			break;
+	DelayedAction *action;
+	while ((action = _delayedActions.pop())) {
+		ScriptContainer::runScript(action->script, action->state,
+		                           action->owner, action->triggerer);
 
-		if (action->type == kActionScript)
-			ScriptContainer::runScript(action->script, action->state,
-			                           action->owner, action->triggerer);
+		_delayedActions.release(action);
 
-		_delayedActions.erase(action);
+		// Spread bursts of due scripts over several frames
+		if (budget && (_actionBudget > 0) && ((Common::getMicroseconds() - startTime) >= _actionBudget))
+			break;
 	}
 }
 
@@ -515,15 +518,22 @@ void Module::unload() {
 	unloadHAKs();
 	unloadPC();
 	unloadModule();
+
+	// The next module might override the models, and its areas use other tilesets anyway
+	clearModelCache();
 }
 
 void Module::unloadModule() {
 	runScript(kScriptExit, this, _pc);
-	handleActions();
+	handleActions(false);
 
 	_delayedActions.clear();
 
-	TwoDAReg.clear();
+	// Keep the 2DAs around, they're only reloaded if the next module overrides them
+	TwoDAReg.invalidate();
+
+	// The next module might bring its own versions of the scripts
+	NCSReg.clear();
 
 	clearVariables();
 	clearScripts();
@@ -704,16 +714,7 @@ void Module::delayScript(const Common::UString &script,
                          const Aurora::NWScript::ScriptState &state,
                          Aurora::NWScript::Object *owner,
                          Aurora::NWScript::Object *triggerer, uint32 delay) {
-	Action action;
-
-	action.type      = kActionScript;
-	action.script    = script;
-	action.state     = state;
-	action.owner     = owner;
-	action.triggerer = triggerer;
-	action.timestamp = EventMan.getTimestamp() + delay;
-
-	_delayedActions.insert(action);
+	_delayedActions.schedule(script, state, owner, triggerer, EventMan.getTimestamp() + delay);
 }
 
 Common::UString Module::getDescription(const Common::UString &module) {
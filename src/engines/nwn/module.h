@@ -31,7 +31,6 @@
 #define ENGINES_NWN_MODULE_H
 
 #include <list>
-#include <set>
 #include <map>
 
 #include "common/ustring.h"
@@ -45,6 +44,8 @@
 
 #include "events/types.h"
 
+#include "engines/aurora/actionscheduler.h"
+
 #include "engines/nwn/ifofile.h"
 #include "engines/nwn/creature.h"
 
@@ -104,25 +105,6 @@ public:
 	static Common::UString getDescription(const Common::UString &module);
 
 private:
-	enum ActionType {
-		kActionNone   = 0,
-		kActionScript = 1
-	};
-
-	struct Action {
-		ActionType type;
-
-		Common::UString script;
-
-		Aurora::NWScript::ScriptState state;
-		Aurora::NWScript::Object *owner;
-		Aurora::NWScript::Object *triggerer;
-
-		uint32 timestamp;
-
-		bool operator<(const Action &s) const;
-	};
-
 	typedef std::map<Common::UString, Area *> AreaMap;
 
 	Console *_console;
@@ -153,7 +135,8 @@ private:
 
 	Common::UString _newModule; ///< The module we should change to.
 
-	std::multiset<Action> _delayedActions;
+	ActionScheduler _delayedActions; ///< Scripts waiting to be run.
+	uint32 _actionBudget;            ///< Time to spend on delayed scripts per frame, in microseconds.
 
 
 	void unload(); ///< Unload the whole shebang.
@@ -183,7 +166,8 @@ private:
 	void handleEvents();
 	bool handleCamera(const Events::Event &e);
 
-	void handleActions();
+	/** Run the delayed scripts that are due, within the budget if requested. */
+	void handleActions(bool budget = true);
 
 	friend class Console;
 };
@@ -34,6 +34,7 @@
 #include "common/filepath.h"
 #include "common/stream.h"
 #include "common/configman.h"
+#include "common/timestamp.h"
 
 #include "aurora/resman.h"
 #include "aurora/talkman.h"
@@ -128,7 +129,7 @@ void NWNEngine::run(const Common::UString &target) {
 	if (EventMan.quitRequested())
 		return;
 
-	status("Successfully initialized the engine");
+	status("Successfully initialized the engine, %.3fms after startup", Common::getMicroseconds() / 1000.0);
 
 	CursorMan.hideCursor();
 	CursorMan.set();
@@ -183,30 +184,38 @@ void NWNEngine::initResources() {
 	ResMan.addArchiveDir(Aurora::kArchiveERF, "hak");
 	ResMan.addArchiveDir(Aurora::kArchiveERF, "texturepacks");
 
-	status("Loading main KEY");
-	indexMandatoryArchive(Aurora::kArchiveKEY, "chitin.key", 1);
+	status("Loading main KEY, expansions and patch KEYs, and GUI textures");
 
-	status("Loading expansions and patch KEYs");
+	Aurora::ResourceManager::ArchiveBatch archives;
+
+	queueMandatoryArchive(archives, Aurora::kArchiveKEY, "chitin.key", 1);
 
 	// Base game patch
-	indexOptionalArchive(Aurora::kArchiveKEY, "patch.key", 2);
+	queueOptionalArchive(archives, Aurora::kArchiveKEY, "patch.key", 2);
 
 	// Expansion 1: Shadows of Undrentide (SoU)
-	_hasXP1 = indexOptionalArchive(Aurora::kArchiveKEY, "xp1.key", 3);
-	indexOptionalArchive(Aurora::kArchiveKEY, "xp1patch.key", 4);
+	const uint32 xp1 = queueOptionalArchive(archives, Aurora::kArchiveKEY, "xp1.key", 3);
+	queueOptionalArchive(archives, Aurora::kArchiveKEY, "xp1patch.key", 4);
 
 	// Expansion 2: Hordes of the Underdark (HotU)
-	_hasXP2 = indexOptionalArchive(Aurora::kArchiveKEY, "xp2.key", 5);
-	indexOptionalArchive(Aurora::kArchiveKEY, "xp2patch.key", 6);
+	const uint32 xp2 = queueOptionalArchive(archives, Aurora::kArchiveKEY, "xp2.key", 5);
+	queueOptionalArchive(archives, Aurora::kArchiveKEY, "xp2patch.key", 6);
 
 	// Expansion 3: Kingmaker (resources also included in the final 1.69 patch)
-	_hasXP3 = indexOptionalArchive(Aurora::kArchiveKEY, "xp3.key", 7);
-	indexOptionalArchive(Aurora::kArchiveKEY, "xp3patch.key", 8);
+	const uint32 xp3 = queueOptionalArchive(archives, Aurora::kArchiveKEY, "xp3.key", 7);
+	queueOptionalArchive(archives, Aurora::kArchiveKEY, "xp3patch.key", 8);
+
+	queueMandatoryArchive(archives, Aurora::kArchiveERF, "gui_32bit.erf"   , 10);
+	queueOptionalArchive (archives, Aurora::kArchiveERF, "xp1_gui.erf"     , 11);
+	queueOptionalArchive (archives, Aurora::kArchiveERF, "xp2_gui.erf"     , 12);
+
+	indexArchives(archives);
+	if (EventMan.quitRequested())
+		return;
 
-	status("Loading GUI textures");
-	indexMandatoryArchive(Aurora::kArchiveERF, "gui_32bit.erf"   , 10);
-	indexOptionalArchive (Aurora::kArchiveERF, "xp1_gui.erf"     , 11);
-	indexOptionalArchive (Aurora::kArchiveERF, "xp2_gui.erf"     , 12);
+	_hasXP1 = archives[xp1].added;
+	_hasXP2 = archives[xp2].added;
+	_hasXP3 = archives[xp3].added;
 
 	status("Indexing extra sound resources");
 	indexMandatoryDirectory("ambient"   , 0, 0, 20);
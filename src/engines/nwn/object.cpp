@@ -78,6 +78,9 @@ void Object::loadModel() {
 void Object::unloadModel() {
 }
 
+void Object::getModelNames(std::list<Common::UString> &models) const {
+}
+
 void Object::show() {
 }
 
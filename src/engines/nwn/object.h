@@ -70,6 +70,9 @@ public:
 	virtual void loadModel();   ///< Load the object's model(s).
 	virtual void unloadModel(); ///< Unload the object's model(s).
 
+	/** Add the names of the model(s) loadModel() will load to the list. */
+	virtual void getModelNames(std::list<Common::UString> &models) const;
+
 	virtual void show(); ///< Show the object's model(s).
 	virtual void hide(); ///< Hide the object's model(s).
 
@@ -88,6 +88,11 @@ void Situated::loadModel() {
 	_ids.push_back(_model->getID());
 }
 
+void Situated::getModelNames(std::list<Common::UString> &models) const {
+	if (!_modelName.empty())
+		models.push_back(_modelName);
+}
+
 void Situated::unloadModel() {
 	hide();
 
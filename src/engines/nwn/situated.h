@@ -48,6 +48,9 @@ public:
 	void loadModel();   ///< Load the situated object's model.
 	void unloadModel(); ///< Unload the situated object's model.
 
+	/** Add the name of the situated object's model to the list. */
+	void getModelNames(std::list<Common::UString> &models) const;
+
 	void show(); ///< Show the situated object's model.
 	void hide(); ///< Hide the situated object's model.
 
@@ -31,6 +31,7 @@
 #include "common/filelist.h"
 #include "common/stream.h"
 #include "common/configman.h"
+#include "common/timestamp.h"
 
 #include "aurora/resman.h"
 #include "aurora/error.h"
@@ -109,7 +110,7 @@ void NWN2Engine::run(const Common::UString &target) {
 	if (EventMan.quitRequested())
 		return;
 
-	status("Successfully initialized the engine");
+	status("Successfully initialized the engine, %.3fms after startup", Common::getMicroseconds() / 1000.0);
 
 	CursorMan.hideCursor();
 	CursorMan.set();
@@ -211,65 +212,67 @@ void NWN2Engine::init() {
 	ResMan.addArchiveDir(Aurora::kArchiveZIP, "data");
 	ResMan.addArchiveDir(Aurora::kArchiveERF, "modules");
 
-	status("Loading main resource files");
-
-	indexMandatoryArchive(Aurora::kArchiveZIP, "2da.zip"           ,  1);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "actors.zip"        ,  2);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "animtags.zip"      ,  3);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "convo.zip"         ,  4);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "ini.zip"           ,  5);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "lod-merged.zip"    ,  6);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "music.zip"         ,  7);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "nwn2_materials.zip",  8);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "nwn2_models.zip"   ,  9);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "nwn2_vfx.zip"      , 10);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "prefabs.zip"       , 11);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "scripts.zip"       , 12);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "sounds.zip"        , 13);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "soundsets.zip"     , 14);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "speedtree.zip"     , 15);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "templates.zip"     , 16);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "vo.zip"            , 17);
-	indexMandatoryArchive(Aurora::kArchiveZIP, "walkmesh.zip"      , 18);
-
-	status("Loading expansions resource files");
+	status("Loading main and expansions resource files");
+
+	Aurora::ResourceManager::ArchiveBatch archives;
+
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "2da.zip"           ,  1);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "actors.zip"        ,  2);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "animtags.zip"      ,  3);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "convo.zip"         ,  4);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "ini.zip"           ,  5);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "lod-merged.zip"    ,  6);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "music.zip"         ,  7);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "nwn2_materials.zip",  8);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "nwn2_models.zip"   ,  9);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "nwn2_vfx.zip"      , 10);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "prefabs.zip"       , 11);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "scripts.zip"       , 12);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "sounds.zip"        , 13);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "soundsets.zip"     , 14);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "speedtree.zip"     , 15);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "templates.zip"     , 16);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "vo.zip"            , 17);
+	queueMandatoryArchive(archives, Aurora::kArchiveZIP, "walkmesh.zip"      , 18);
 
 	// Expansion 1: Mask of the Betrayer (MotB)
-	indexOptionalArchive(Aurora::kArchiveZIP, "2da_x1.zip"           , 20);
-	indexOptionalArchive(Aurora::kArchiveZIP, "actors_x1.zip"        , 21);
-	indexOptionalArchive(Aurora::kArchiveZIP, "animtags_x1.zip"      , 22);
-	indexOptionalArchive(Aurora::kArchiveZIP, "convo_x1.zip"         , 23);
-	indexOptionalArchive(Aurora::kArchiveZIP, "ini_x1.zip"           , 24);
-	indexOptionalArchive(Aurora::kArchiveZIP, "lod-merged_x1.zip"    , 25);
-	indexOptionalArchive(Aurora::kArchiveZIP, "music_x1.zip"         , 26);
-	indexOptionalArchive(Aurora::kArchiveZIP, "nwn2_materials_x1.zip", 27);
-	indexOptionalArchive(Aurora::kArchiveZIP, "nwn2_models_x1.zip"   , 28);
-	indexOptionalArchive(Aurora::kArchiveZIP, "nwn2_vfx_x1.zip"      , 29);
-	indexOptionalArchive(Aurora::kArchiveZIP, "prefabs_x1.zip"       , 30);
-	indexOptionalArchive(Aurora::kArchiveZIP, "scripts_x1.zip"       , 31);
-	indexOptionalArchive(Aurora::kArchiveZIP, "soundsets_x1.zip"     , 32);
-	indexOptionalArchive(Aurora::kArchiveZIP, "sounds_x1.zip"        , 33);
-	indexOptionalArchive(Aurora::kArchiveZIP, "speedtree_x1.zip"     , 34);
-	indexOptionalArchive(Aurora::kArchiveZIP, "templates_x1.zip"     , 35);
-	indexOptionalArchive(Aurora::kArchiveZIP, "vo_x1.zip"            , 36);
-	indexOptionalArchive(Aurora::kArchiveZIP, "walkmesh_x1.zip"      , 37);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "2da_x1.zip"           , 20);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "actors_x1.zip"        , 21);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "animtags_x1.zip"      , 22);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "convo_x1.zip"         , 23);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "ini_x1.zip"           , 24);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "lod-merged_x1.zip"    , 25);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "music_x1.zip"         , 26);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "nwn2_materials_x1.zip", 27);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "nwn2_models_x1.zip"   , 28);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "nwn2_vfx_x1.zip"      , 29);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "prefabs_x1.zip"       , 30);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "scripts_x1.zip"       , 31);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "soundsets_x1.zip"     , 32);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "sounds_x1.zip"        , 33);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "speedtree_x1.zip"     , 34);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "templates_x1.zip"     , 35);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "vo_x1.zip"            , 36);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "walkmesh_x1.zip"      , 37);
 
 	// Expansion 2: Storm of Zehir (SoZ)
-	indexOptionalArchive(Aurora::kArchiveZIP, "2da_x2.zip"           , 40);
-	indexOptionalArchive(Aurora::kArchiveZIP, "actors_x2.zip"        , 41);
-	indexOptionalArchive(Aurora::kArchiveZIP, "animtags_x2.zip"      , 42);
-	indexOptionalArchive(Aurora::kArchiveZIP, "lod-merged_x2.zip"    , 43);
-	indexOptionalArchive(Aurora::kArchiveZIP, "music_x2.zip"         , 44);
-	indexOptionalArchive(Aurora::kArchiveZIP, "nwn2_materials_x2.zip", 45);
-	indexOptionalArchive(Aurora::kArchiveZIP, "nwn2_models_x2.zip"   , 46);
-	indexOptionalArchive(Aurora::kArchiveZIP, "nwn2_vfx_x2.zip"      , 47);
-	indexOptionalArchive(Aurora::kArchiveZIP, "prefabs_x2.zip"       , 48);
-	indexOptionalArchive(Aurora::kArchiveZIP, "scripts_x2.zip"       , 49);
-	indexOptionalArchive(Aurora::kArchiveZIP, "soundsets_x2.zip"     , 50);
-	indexOptionalArchive(Aurora::kArchiveZIP, "sounds_x2.zip"        , 51);
-	indexOptionalArchive(Aurora::kArchiveZIP, "speedtree_x2.zip"     , 52);
-	indexOptionalArchive(Aurora::kArchiveZIP, "templates_x2.zip"     , 53);
-	indexOptionalArchive(Aurora::kArchiveZIP, "vo_x2.zip"            , 54);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "2da_x2.zip"           , 40);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "actors_x2.zip"        , 41);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "animtags_x2.zip"      , 42);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "lod-merged_x2.zip"    , 43);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "music_x2.zip"         , 44);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "nwn2_materials_x2.zip", 45);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "nwn2_models_x2.zip"   , 46);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "nwn2_vfx_x2.zip"      , 47);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "prefabs_x2.zip"       , 48);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "scripts_x2.zip"       , 49);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "soundsets_x2.zip"     , 50);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "sounds_x2.zip"        , 51);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "speedtree_x2.zip"     , 52);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "templates_x2.zip"     , 53);
+	queueOptionalArchive (archives, Aurora::kArchiveZIP, "vo_x2.zip"            , 54);
+
+	indexArchives(archives);
 
 	warning("TODO: Mysteries of Westgate (MoW) resource files");
 	warning("TODO: Patch resource files");
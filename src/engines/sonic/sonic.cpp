@@ -37,6 +37,7 @@
 #include "common/stream.h"
 #include "common/strutil.h"
 #include "common/configman.h"
+#include "common/timestamp.h"
 
 #include "graphics/graphics.h"
 
@@ -100,7 +101,7 @@ void SonicEngine::run(const Common::UString &target) {
 
 	ResMan.declareResource("nintendosplash.tga");
 
-	status("Successfully initialized the engine");
+	status("Successfully initialized the engine, %.3fms after startup", Common::getMicroseconds() / 1000.0);
 
 	playIntroVideos();
 
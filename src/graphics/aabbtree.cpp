@@ -0,0 +1,496 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file graphics/aabbtree.cpp
+ *  A dynamic bounding volume hierarchy of axis-aligned boxes.
+ */
+
+#include <cassert>
+
+#include <utility>
+
+#include "common/util.h"
+
+#include "graphics/aabbtree.h"
+#include "graphics/frustum.h"
+
+namespace Graphics {
+
+static float getSurface(const float *min, const float *max) {
+	const float x = max[0] - min[0];
+	const float y = max[1] - min[1];
+	const float z = max[2] - min[2];
+
+	return 2.0f * (x * y + y * z + z * x);
+}
+
+static void combine(const float *min1, const float *max1, const float *min2, const float *max2,
+                    float *min, float *max) {
+
+	for (int i = 0; i < 3; i++) {
+		min[i] = MIN(min1[i], min2[i]);
+		max[i] = MAX(max1[i], max2[i]);
+	}
+}
+
+static bool contains(const float *min1, const float *max1, const float *min2, const float *max2) {
+	for (int i = 0; i < 3; i++)
+		if ((min2[i] < min1[i]) || (max2[i] > max1[i]))
+			return false;
+
+	return true;
+}
+
+
+AABBTree::RayTest::~RayTest() {
+}
+
+
+AABBTree::AABBTree(float margin) : _root(kNull), _freeList(kNull), _leafCount(0), _margin(margin) {
+}
+
+AABBTree::~AABBTree() {
+}
+
+void AABBTree::clear() {
+	_nodes.clear();
+
+	_root      = kNull;
+	_freeList  = kNull;
+	_leafCount = 0;
+}
+
+int32 AABBTree::allocateNode() {
+	int32 node;
+
+	if (_freeList != kNull) {
+		node      = _freeList;
+		_freeList = _nodes[node].parent;
+	} else {
+		node = _nodes.size();
+		_nodes.push_back(Node());
+	}
+
+	Node &n = _nodes[node];
+
+	n.data   = 0;
+	n.parent = kNull;
+	n.child1 = kNull;
+	n.child2 = kNull;
+	n.height = 0;
+
+	return node;
+}
+
+void AABBTree::freeNode(int32 node) {
+	_nodes[node].parent = _freeList;
+	_nodes[node].height = -1;
+
+	_freeList = node;
+}
+
+int32 AABBTree::insert(const float *min, const float *max, void *data) {
+	const int32 leaf = allocateNode();
+
+	Node &n = _nodes[leaf];
+	for (int i = 0; i < 3; i++) {
+		n.min[i] = min[i] - _margin;
+		n.max[i] = max[i] + _margin;
+	}
+
+	n.data = data;
+
+	insertLeaf(leaf);
+
+	_leafCount++;
+	return leaf;
+}
+
+void AABBTree::remove(int32 proxy) {
+	assert((proxy >= 0) && (proxy < (int32) _nodes.size()) && _nodes[proxy].isLeaf());
+
+	removeLeaf(proxy);
+	freeNode(proxy);
+
+	_leafCount--;
+}
+
+bool AABBTree::update(int32 proxy, const float *min, const float *max) {
+	assert((proxy >= 0) && (proxy < (int32) _nodes.size()) && _nodes[proxy].isLeaf());
+
+	Node &n = _nodes[proxy];
+
+	// Still within the fat box, nothing to do
+	if (contains(n.min, n.max, min, max))
+		return false;
+
+	removeLeaf(proxy);
+
+	for (int i = 0; i < 3; i++) {
+		n.min[i] = min[i] - _margin;
+		n.max[i] = max[i] + _margin;
+	}
+
+	insertLeaf(proxy);
+	return true;
+}
+
+void *AABBTree::getData(int32 proxy) const {
+	assert((proxy >= 0) && (proxy < (int32) _nodes.size()));
+
+	return _nodes[proxy].data;
+}
+
+uint32 AABBTree::size() const {
+	return _leafCount;
+}
+
+int32 AABBTree::getHeight() const {
+	if (_root == kNull)
+		return 0;
+
+	return _nodes[_root].height;
+}
+
+void AABBTree::insertLeaf(int32 leaf) {
+	if (_root == kNull) {
+		_root = leaf;
+		_nodes[leaf].parent = kNull;
+		return;
+	}
+
+	// Find the best sibling, by the surface area the new parent would add
+	// Copy the box, since allocating the new parent below might move the nodes
+	float leafMin[3], leafMax[3];
+	for (int i = 0; i < 3; i++) {
+		leafMin[i] = _nodes[leaf].min[i];
+		leafMax[i] = _nodes[leaf].max[i];
+	}
+
+	int32 sibling = _root;
+	while (!_nodes[sibling].isLeaf()) {
+		const Node &s = _nodes[sibling];
+
+		float combinedMin[3], combinedMax[3];
+		combine(s.min, s.max, leafMin, leafMax, combinedMin, combinedMax);
+
+		const float surface         = getSurface(s.min, s.max);
+		const float combinedSurface = getSurface(combinedMin, combinedMax);
+
+		// Cost of making a new parent for this node and the new leaf
+		const float cost = 2.0f * combinedSurface;
+
+		// Minimum cost of pushing the leaf further down the tree
+		const float inheritanceCost = 2.0f * (combinedSurface - surface);
+
+		float childCost[2];
+		const int32 children[2] = { s.child1, s.child2 };
+		for (int i = 0; i < 2; i++) {
+			const Node &c = _nodes[children[i]];
+
+			float min[3], max[3];
+			combine(c.min, c.max, leafMin, leafMax, min, max);
+
+			if (c.isLeaf())
+				childCost[i] = getSurface(min, max) + inheritanceCost;
+			else
+				childCost[i] = getSurface(min, max) - getSurface(c.min, c.max) + inheritanceCost;
+		}
+
+		if ((cost < childCost[0]) && (cost < childCost[1]))
+			break;
+
+		sibling = (childCost[0] < childCost[1]) ? s.child1 : s.child2;
+	}
+
+	// Create a new parent for the sibling and the leaf
+	const int32 oldParent = _nodes[sibling].parent;
+	const int32 newParent = allocateNode();
+
+	Node &p = _nodes[newParent];
+	combine(_nodes[sibling].min, _nodes[sibling].max, leafMin, leafMax, p.min, p.max);
+
+	p.parent = oldParent;
+	p.child1 = sibling;
+	p.child2 = leaf;
+	p.height = _nodes[sibling].height + 1;
+
+	_nodes[sibling].parent = newParent;
+	_nodes[leaf].parent    = newParent;
+
+	if (oldParent != kNull) {
+		if (_nodes[oldParent].child1 == sibling)
+			_nodes[oldParent].child1 = newParent;
+		else
+			_nodes[oldParent].child2 = newParent;
+	} else
+		_root = newParent;
+
+	refit(newParent);
+}
+
+void AABBTree::removeLeaf(int32 leaf) {
+	if (leaf == _root) {
+		_root = kNull;
+		return;
+	}
+
+	const int32 parent      = _nodes[leaf].parent;
+	const int32 grandParent = _nodes[parent].parent;
+	const int32 sibling     = (_nodes[parent].child1 == leaf) ? _nodes[parent].child2 : _nodes[parent].child1;
+
+	// Replace the parent with the sibling
+	if (grandParent != kNull) {
+		if (_nodes[grandParent].child1 == parent)
+			_nodes[grandParent].child1 = sibling;
+		else
+			_nodes[grandParent].child2 = sibling;
+
+		_nodes[sibling].parent = grandParent;
+		freeNode(parent);
+
+		refit(grandParent);
+	} else {
+		_root = sibling;
+		_nodes[sibling].parent = kNull;
+		freeNode(parent);
+	}
+}
+
+void AABBTree::refit(int32 node) {
+	// Walk back up the tree, rebalancing and fixing boxes and heights
+	while (node != kNull) {
+		node = balance(node);
+
+		Node &n = _nodes[node];
+
+		const Node &c1 = _nodes[n.child1];
+		const Node &c2 = _nodes[n.child2];
+
+		combine(c1.min, c1.max, c2.min, c2.max, n.min, n.max);
+		n.height = 1 + MAX(c1.height, c2.height);
+
+		node = n.parent;
+	}
+}
+
+int32 AABBTree::balance(int32 iA) {
+	// If A's children differ in height by more than one, rotate the higher
+	// child X up into A's place, and give A the lower of X's children
+
+	Node &a = _nodes[iA];
+	if (a.isLeaf() || (a.height < 2))
+		return iA;
+
+	const int32 iB = a.child1;
+	const int32 iC = a.child2;
+
+	const int32 diff = _nodes[iC].height - _nodes[iB].height;
+	if ((diff >= -1) && (diff <= 1))
+		return iA;
+
+	const int32 iX = (diff > 0) ? iC : iB;
+	const int32 iY = (diff > 0) ? iB : iC;
+
+	Node &x = _nodes[iX];
+	Node &y = _nodes[iY];
+
+	const int32 iF = x.child1;
+	const int32 iG = x.child2;
+
+	Node &f = _nodes[iF];
+	Node &g = _nodes[iG];
+
+	// X takes A's place
+	x.child1 = iA;
+	x.parent = a.parent;
+	a.parent = iX;
+
+	if (x.parent != kNull) {
+		if (_nodes[x.parent].child1 == iA)
+			_nodes[x.parent].child1 = iX;
+		else
+			_nodes[x.parent].child2 = iX;
+	} else
+		_root = iX;
+
+	// The higher of X's children stays with X, the other one goes to A
+	const bool keepF = f.height > g.height;
+
+	const int32 iKeep = keepF ? iF : iG;
+	const int32 iMove = keepF ? iG : iF;
+
+	x.child2 = iKeep;
+
+	a.child1 = iY;
+	a.child2 = iMove;
+	_nodes[iMove].parent = iA;
+
+	combine(y.min, y.max, _nodes[iMove].min, _nodes[iMove].max, a.min, a.max);
+	combine(a.min, a.max, _nodes[iKeep].min, _nodes[iKeep].max, x.min, x.max);
+
+	a.height = 1 + MAX(y.height, _nodes[iMove].height);
+	x.height = 1 + MAX(a.height, _nodes[iKeep].height);
+
+	return iX;
+}
+
+void AABBTree::collectLeaves(int32 node, std::vector<void *> &data) const {
+	const Node &n = _nodes[node];
+
+	if (n.isLeaf()) {
+		data.push_back(n.data);
+		return;
+	}
+
+	collectLeaves(n.child1, data);
+	collectLeaves(n.child2, data);
+}
+
+uint32 AABBTree::query(const Frustum &frustum, std::vector<void *> &data) const {
+	if (_root == kNull)
+		return 0;
+
+	uint32 tests = 0;
+
+	std::vector<int32> stack;
+	stack.reserve(64);
+	stack.push_back(_root);
+
+	while (!stack.empty()) {
+		const int32 node = stack.back();
+		stack.pop_back();
+
+		const Node &n = _nodes[node];
+
+		tests++;
+		const Frustum::Intersection intersection = frustum.test(n.min, n.max);
+
+		if (intersection == Frustum::kOutside)
+			continue;
+
+		// Completely inside, so all the leaves below are, too
+		if ((intersection == Frustum::kInside) || n.isLeaf()) {
+			collectLeaves(node, data);
+			continue;
+		}
+
+		stack.push_back(n.child1);
+		stack.push_back(n.child2);
+	}
+
+	return tests;
+}
+
+void *AABBTree::raycast(const float *from, const float *to, RayTest &rayTest) const {
+	float t;
+	if ((_root == kNull) || !intersectRay(from, to, _nodes[_root].min, _nodes[_root].max, t))
+		return 0;
+
+	void *hit  = 0;
+	float hitT = 2.0f;
+
+	// Nodes to visit, with where the ray enters them
+	std::vector< std::pair<int32, float> > stack;
+	stack.reserve(64);
+	stack.push_back(std::make_pair(_root, t));
+
+	while (!stack.empty()) {
+		const int32 node  = stack.back().first;
+		const float enter = stack.back().second;
+		stack.pop_back();
+
+		// Everything in here is further away than what we already hit
+		if (enter >= hitT)
+			continue;
+
+		const Node &n = _nodes[node];
+
+		if (n.isLeaf()) {
+			const float dataT = rayTest.test(n.data);
+			if ((dataT >= 0.0f) && (dataT < hitT)) {
+				hit  = n.data;
+				hitT = dataT;
+			}
+
+			continue;
+		}
+
+		float t1, t2;
+		const bool hit1 = intersectRay(from, to, _nodes[n.child1].min, _nodes[n.child1].max, t1);
+		const bool hit2 = intersectRay(from, to, _nodes[n.child2].min, _nodes[n.child2].max, t2);
+
+		// Push the further child first, so that the nearer one is visited first
+		if (hit1 && hit2) {
+			if (t1 <= t2) {
+				stack.push_back(std::make_pair(n.child2, t2));
+				stack.push_back(std::make_pair(n.child1, t1));
+			} else {
+				stack.push_back(std::make_pair(n.child1, t1));
+				stack.push_back(std::make_pair(n.child2, t2));
+			}
+		} else if (hit1)
+			stack.push_back(std::make_pair(n.child1, t1));
+		else if (hit2)
+			stack.push_back(std::make_pair(n.child2, t2));
+	}
+
+	return hit;
+}
+
+bool AABBTree::intersectRay(const float *from, const float *to,
+                            const float *min, const float *max, float &t) {
+
+	float tMin = 0.0f;
+	float tMax = 1.0f;
+
+	for (int i = 0; i < 3; i++) {
+		const float d = to[i] - from[i];
+
+		if (ABS(d) < 1e-8f) {
+			// Parallel to this slab, so we need to be within it
+			if ((from[i] < min[i]) || (from[i] > max[i]))
+				return false;
+
+			continue;
+		}
+
+		float t1 = (min[i] - from[i]) / d;
+		float t2 = (max[i] - from[i]) / d;
+		if (t1 > t2)
+			SWAP(t1, t2);
+
+		tMin = MAX(tMin, t1);
+		tMax = MIN(tMax, t2);
+
+		if (tMin > tMax)
+			return false;
+	}
+
+	t = tMin;
+	return true;
+}
+
+} // End of namespace Graphics
@@ -0,0 +1,152 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file graphics/aabbtree.h
+ *  A dynamic bounding volume hierarchy of axis-aligned boxes.
+ */
+
+#ifndef GRAPHICS_AABBTREE_H
+#define GRAPHICS_AABBTREE_H
+
+#include <vector>
+
+#include "common/types.h"
+
+namespace Graphics {
+
+class Frustum;
+
+/** A dynamic tree of axis-aligned bounding boxes.
+ *
+ *  Every inserted box becomes a leaf, addressed by a proxy ID. Leaves store
+ *  a slightly enlarged ("fat") box, so that small movements don't need to
+ *  touch the tree at all; larger ones remove and reinsert the leaf. Inner
+ *  nodes are kept balanced with tree rotations, so that queries stay
+ *  logarithmic however the boxes were added.
+ */
+class AABBTree {
+public:
+	/** A test of a ray against the user data of a box the ray hits. */
+	class RayTest {
+	public:
+		virtual ~RayTest();
+
+		/** Where does the ray hit the object?
+		 *
+		 *  @return The distance along the ray, as a fraction of its length,
+		 *          or a negative value if the ray misses the object.
+		 */
+		virtual float test(void *data) = 0;
+	};
+
+	/** Create a tree whose leaves are enlarged by margin on each side. */
+	AABBTree(float margin = 0.0f);
+	~AABBTree();
+
+	/** Remove all boxes. */
+	void clear();
+
+	/** Add a box with its user data, returning its proxy ID. */
+	int32 insert(const float *min, const float *max, void *data);
+	/** Remove the box with this proxy ID. */
+	void remove(int32 proxy);
+	/** Move the box with this proxy ID. Return true if the tree had to change. */
+	bool update(int32 proxy, const float *min, const float *max);
+
+	/** Return the user data of the box with this proxy ID. */
+	void *getData(int32 proxy) const;
+
+	/** Return the number of boxes in the tree. */
+	uint32 size() const;
+	/** Return the height of the tree. */
+	int32 getHeight() const;
+
+	/** Collect the user data of all boxes intersecting the frustum.
+	 *
+	 *  @return The number of boxes tested against the frustum.
+	 */
+	uint32 query(const Frustum &frustum, std::vector<void *> &data) const;
+
+	/** Find the nearest object hit by the ray from one point to another.
+	 *
+	 *  Boxes are visited nearest first, and boxes further away than the
+	 *  nearest hit found so far are skipped.
+	 *
+	 *  @return The user data of the nearest hit, or 0 if nothing was hit.
+	 */
+	void *raycast(const float *from, const float *to, RayTest &rayTest) const;
+
+	/** Where does the ray from one point to another enter the box?
+	 *
+	 *  @param  t The distance along the ray, as a fraction of its length.
+	 *  @return false if the ray misses the box.
+	 */
+	static bool intersectRay(const float *from, const float *to,
+	                         const float *min, const float *max, float &t);
+
+private:
+	static const int32 kNull = -1;
+
+	struct Node {
+		float min[3];
+		float max[3];
+
+		void *data;
+
+		int32 parent; ///< The parent, or the next free node.
+		int32 child1;
+		int32 child2;
+
+		int32 height; ///< 0 for leaves, -1 for free nodes.
+
+		bool isLeaf() const {
+			return child1 == kNull;
+		}
+	};
+
+	std::vector<Node> _nodes;
+
+	int32 _root;
+	int32 _freeList;
+
+	uint32 _leafCount;
+
+	float _margin;
+
+	int32 allocateNode();
+	void freeNode(int32 node);
+
+	void insertLeaf(int32 leaf);
+	void removeLeaf(int32 leaf);
+
+	int32 balance(int32 node);
+
+	void refit(int32 node);
+	void collectLeaves(int32 node, std::vector<void *> &data) const;
+};
+
+} // End of namespace Graphics
+
+#endif // GRAPHICS_AABBTREE_H
@@ -65,6 +65,66 @@ Model::Model(ModelType type) : Renderable((RenderableType) type),
 	_loopAnimation = 0;
 }
 
+Model::Model(const Model &original) : GLContainer(), Renderable((RenderableType) original._type),
+	_type(original._type), _fileName(original._fileName), _name(original._name),
+	_superModelName(original._superModelName), _supermodel(original._supermodel),
+	_currentState(0), _animationMap(original._animationMap),
+	_currentAnimation(0), _nextAnimation(0), _drawBound(false), _lists(0) {
+
+	for (int i = 0; i < kRenderPassAll; i++)
+		_needBuild[i] = true;
+
+	_position[0] = 0.0; _position[1] = 0.0; _position[2] = 0.0;
+	_rotation[0] = 0.0; _rotation[1] = 0.0; _rotation[2] = 0.0;
+
+	_modelScale[0] = original._modelScale[0];
+	_modelScale[1] = original._modelScale[1];
+	_modelScale[2] = original._modelScale[2];
+
+	_animationScale    = original._animationScale;
+	_defaultAnimations = original._defaultAnimations;
+
+	_elapsedTime   = 0.0;
+	_loopAnimation = 0;
+
+	// Copy the node hierarchy of all states
+	for (StateList::const_iterator s = original._stateList.begin(); s != original._stateList.end(); ++s) {
+		State *state = new State;
+
+		state->name = (*s)->name;
+
+		std::map<const ModelNode *, ModelNode *> nodes;
+		for (NodeList::const_iterator n = (*s)->rootNodes.begin(); n != (*s)->rootNodes.end(); ++n)
+			state->rootNodes.push_back(cloneNode(**n, 0, nodes));
+
+		for (NodeList::const_iterator n = (*s)->nodeList.begin(); n != (*s)->nodeList.end(); ++n) {
+			std::map<const ModelNode *, ModelNode *>::const_iterator node = nodes.find(*n);
+			if (node == nodes.end())
+				continue;
+
+			state->nodeList.push_back(node->second);
+			state->nodeMap.insert(std::make_pair(node->second->getName(), node->second));
+		}
+
+		_stateList.push_back(state);
+		_stateMap.insert(std::make_pair(state->name, state));
+	}
+}
+
+ModelNode *Model::cloneNode(const ModelNode &node, ModelNode *parent,
+                            std::map<const ModelNode *, ModelNode *> &nodes) {
+
+	ModelNode *clone = new ModelNode(*this, node);
+	clone->setParent(parent);
+
+	nodes.insert(std::make_pair(&node, clone));
+
+	for (std::list<ModelNode *>::const_iterator c = node._children.begin(); c != node._children.end(); ++c)
+		cloneNode(**c, clone, nodes);
+
+	return clone;
+}
+
 Model::~Model() {
 	hide();
 
@@ -123,6 +183,42 @@ bool Model::isIn(float x1, float y1, float z1, float x2, float y2, float z2) con
 	return _absoluteBoundBox.isIn(x1, y1, z1, x2, y2, z2);
 }
 
+void Model::makeTemplate() {
+	hide();
+
+	Renderable::removeFromQueue(_queueExists);
+	GLContainer::removeFromQueue(kQueueGLContainer);
+}
+
+void Model::getGeometrySize(std::set<const void *> &buffers, uint32 &size, uint32 &total) const {
+	for (StateList::const_iterator s = _stateList.begin(); s != _stateList.end(); ++s) {
+		for (NodeList::const_iterator n = (*s)->nodeList.begin(); n != (*s)->nodeList.end(); ++n) {
+			const VertexBuffer &vertices = (*n)->_vertexBuffer;
+			const IndexBuffer  &indices  = (*n)->_indexBuffer;
+
+			const uint32 vertexSize = vertices.getCount() * vertices.getSize();
+			const uint32 indexSize  = indices.getCount()  * indices.getSize();
+
+			total += vertexSize + indexSize;
+
+			if (vertices.getData() && buffers.insert(vertices.getData()).second)
+				size += vertexSize;
+			if (indices.getData() && buffers.insert(indices.getData()).second)
+				size += indexSize;
+		}
+	}
+}
+
+bool Model::getWorldBound(float *min, float *max) const {
+	if (_absoluteBoundBox.isEmpty())
+		return false;
+
+	_absoluteBoundBox.getMin(min[0], min[1], min[2]);
+	_absoluteBoundBox.getMax(max[0], max[1], max[2]);
+
+	return true;
+}
+
 float Model::getWidth() const {
 	return _boundBox.getWidth() * _modelScale[0];
 }
@@ -231,11 +327,11 @@ void Model::rotate(float x, float y, float z) {
 }
 
 void Model::getTooltipAnchor(float &x, float &y, float &z) const {
-	Common::TransformationMatrix pos = _absolutePosition;
-
-	pos.translate(0.0, 0.0, _absoluteBoundBox.getHeight() + 0.5);
+	x = 0.0;
+	y = 0.0;
+	z = _absoluteBoundBox.getHeight() + 0.5;
 
-	pos.getPosition(x, y, z);
+	_absolutePosition.transformPoint(x, y, z);
 }
 
 void Model::createAbsolutePosition() {
@@ -255,6 +351,8 @@ void Model::createAbsolutePosition() {
 	_absoluteBoundBox = _boundBox;
 	_absoluteBoundBox.transform(_absolutePosition);
 	_absoluteBoundBox.absolutize();
+
+	updateWorldBound();
 }
 
 const std::list<Common::UString> &Model::getStates() const {
@@ -384,18 +482,16 @@ void Model::calculateDistance() {
 	}
 
 
-	Common::TransformationMatrix center = _absolutePosition;
-
-	center.translate(_center[0], _center[1], _center[2]);
+	const Common::Vec3 center = _absolutePosition.transformPoint(Common::Vec3(_center));
 
 
 	const float cameraX =  CameraMan.getPosition()[0];
 	const float cameraY =  CameraMan.getPosition()[1];
 	const float cameraZ = -CameraMan.getPosition()[2];
 
-	const float x = ABS(center.getX() - cameraX);
-	const float y = ABS(center.getY() - cameraY);
-	const float z = ABS(center.getZ() - cameraZ);
+	const float x = ABS(center[0] - cameraX);
+	const float y = ABS(center[1] - cameraY);
+	const float z = ABS(center[2] - cameraZ);
 
 
 	_distance = x + y + z;
@@ -638,6 +734,8 @@ void Model::createBound() {
 	_absoluteBoundBox = _boundBox;
 	_absoluteBoundBox.transform(_absolutePosition);
 	_absoluteBoundBox.absolutize();
+
+	updateWorldBound();
 }
 
 void Model::readValue(Common::SeekableReadStream &stream, uint32 &value) {
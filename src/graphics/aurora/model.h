@@ -33,6 +33,9 @@
 #include <vector>
 #include <list>
 #include <map>
+#include <set>
+
+#include <boost/shared_ptr.hpp>
 
 #include "common/ustring.h"
 #include "common/transmatrix.h"
@@ -80,6 +83,9 @@ public:
 	/** Does the line from x1.y1.z1 to x2.y2.z2 intersect with model's bounding box? */
 	bool isIn(float x1, float y1, float z1, float x2, float y2, float z2) const;
 
+	/** Get the model's bounding box after translate/rotate. */
+	bool getWorldBound(float *min, float *max) const;
+
 
 	// Positioning
 
@@ -141,6 +147,22 @@ public:
 	void playDefaultAnimation();
 
 
+	/** Add up the memory taken by the model's vertex and index data.
+	 *
+	 *  @param buffers The data already counted, so that shared data is only counted once.
+	 *  @param size    Increased by the size of the data not counted before.
+	 *  @param total   Increased by the size of all data, as if nothing was shared.
+	 */
+	void getGeometrySize(std::set<const void *> &buffers, uint32 &size, uint32 &total) const;
+
+	/** Only use this model as the original of instances.
+	 *
+	 *  Takes the model out of all render queues, so that it's never drawn
+	 *  and never has its OpenGL structures built.
+	 */
+	void makeTemplate();
+
+
 	// Renderable
 	void calculateDistance();
 	void render(RenderPass pass);
@@ -184,6 +206,9 @@ protected:
 	Common::UString _superModelName; ///< Name of the supermodel.
 	Model *_supermodel; ///< The actual supermodel.
 
+	/** The model this is an instance of, kept alive since we share its data. */
+	boost::shared_ptr<const Model> _original;
+
 	StateList _stateList;   ///< All states within this model.
 	StateMap  _stateMap;    ///< All states within this model, index by name.
 	State   *_currentState; ///< The current state.
@@ -222,6 +247,16 @@ protected:
 	Animation *getAnimation(const Common::UString &anim);
 
 
+	/** Create a new instance of a model.
+	 *
+	 *  The instance gets its own copy of the node hierarchy, since nodes
+	 *  carry the animated positions and orientations. The nodes' geometry,
+	 *  the animations and the supermodel are shared with the original.
+	 *  The original must outlive the instance, which subclasses ensure by
+	 *  setting _original.
+	 */
+	Model(const Model &original);
+
 	/** Finalize the loading procedure. */
 	void finalize();
 	/** Signal that the nodes changed and the OpenGL list needs to be rebuild. */
@@ -248,6 +283,9 @@ private:
 
 	void createAbsolutePosition();
 
+	/** Copy a node and its children into the state of this model. */
+	ModelNode *cloneNode(const ModelNode &node, ModelNode *parent, std::map<const ModelNode *, ModelNode *> &nodes);
+
 	void doDrawBound();
 	void manageAnimations(float dt);
 
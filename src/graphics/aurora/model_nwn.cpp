@@ -38,7 +38,8 @@
 #include "common/debug.h"
 #include "common/stream.h"
 #include "common/streamtokenizer.h"
-#include "common/vector3.h"
+#include "common/vec3.h"
+#include "common/mutex.h"
 
 #include "aurora/types.h"
 #include "aurora/resman.h"
@@ -113,6 +114,11 @@ namespace Graphics {
 
 namespace Aurora {
 
+typedef std::map<Common::UString, Model *, Common::UString::iless> ModelCache;
+
+/** Guards the supermodel caches, since models can be loaded from several threads at once. */
+static Common::Mutex kModelCacheMutex;
+
 Model_NWN::ParserContext::ParserContext(const Common::UString &name,
                                         const Common::UString &t) :
 	mdl(0), state(0), texture(t) {
@@ -191,11 +197,32 @@ Model_NWN::Model_NWN(const Common::UString &name, ModelType type,
 		loadBinary(ctx);
 
 	if (!_superModelName.empty() && _superModelName != "NULL") {
-		if ((*modelCache).count(_superModelName)>0)
-			_supermodel = (*modelCache)[_superModelName];
-		else {
-			_supermodel = new Model_NWN(_superModelName, type, "", modelCache);
-			(*modelCache)[_superModelName] = _supermodel;
+		{
+			Common::StackLock lock(kModelCacheMutex);
+
+			ModelCache::const_iterator cached = modelCache->find(_superModelName);
+			if (cached != modelCache->end())
+				_supermodel = cached->second;
+		}
+
+		if (!_supermodel) {
+			// Parse the supermodel without holding the lock, and drop it if another thread was faster
+			Model *supermodel = new Model_NWN(_superModelName, type, "", modelCache);
+			Model *duplicate  = 0;
+
+			{
+				Common::StackLock lock(kModelCacheMutex);
+
+				std::pair<ModelCache::iterator, bool> result =
+					modelCache->insert(std::make_pair(_superModelName, supermodel));
+
+				if (!result.second)
+					duplicate = supermodel;
+
+				_supermodel = result.first->second;
+			}
+
+			delete duplicate;
 		}
 	}
 
@@ -205,6 +232,12 @@ Model_NWN::Model_NWN(const Common::UString &name, ModelType type,
 	finalize();
 }
 
+Model_NWN::Model_NWN(const boost::shared_ptr<Model_NWN> &original) : Model(*original) {
+	_original = original;
+
+	finalize();
+}
+
 Model_NWN::~Model_NWN() {
 }
 
@@ -1243,7 +1276,7 @@ void ModelNode_NWN_ASCII::readFaces(Model_NWN::ParserContext &ctx, Mesh &mesh) {
 	}
 }
 
-typedef Common::Vector3 Vec3;
+typedef Common::Vec3 Vec3;
 
 struct FaceVert {
 	uint32 p, t; // position, texture coord indices
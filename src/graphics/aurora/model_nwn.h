@@ -50,6 +50,8 @@ class Model_NWN : public Model {
 public:
 	Model_NWN(const Common::UString &name, ModelType type = kModelTypeObject,
 	          const Common::UString &texture = "", std::map<Common::UString, Model*, Common::UString::iless> *modelCache = 0);
+	/** Create a new instance of an already loaded model, sharing its geometry and animations. */
+	explicit Model_NWN(const boost::shared_ptr<Model_NWN> &original);
 	~Model_NWN();
 
 private:
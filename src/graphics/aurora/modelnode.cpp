@@ -29,6 +29,7 @@
 
 #include "common/util.h"
 #include "common/maths.h"
+#include "common/quat.h"
 
 #include "graphics/graphics.h"
 #include "graphics/camera.h"
@@ -123,6 +124,21 @@ ModelNode::ModelNode(Model &model) :
 	_orientation[3] = 0.0;
 }
 
+ModelNode::ModelNode(Model &model, const ModelNode &node) {
+	// The vertex and index buffers share their data when copied
+	*this = node;
+
+	_model  = &model;
+	_parent = 0;
+
+	_children.clear();
+
+	// PLTs are colored per instance, so they can't be shared
+	for (uint t = 0; t < _pltNames.size(); t++)
+		if (!_pltNames[t].empty())
+			_textures[t] = TextureMan.get(_pltNames[t]);
+}
+
 ModelNode::~ModelNode() {
 	// dtor
 }
@@ -260,6 +276,7 @@ void ModelNode::inheritOrientation(ModelNode &node) const {
 
 void ModelNode::inheritGeometry(ModelNode &node) const {
 	node._textures      = _textures;
+	node._pltNames      = _pltNames;
 	node._render        = _render;
 	node._isTransparent = _isTransparent;
 	node._vertexBuffer  = _vertexBuffer;
@@ -343,6 +360,7 @@ void ModelNode::loadTextures(const std::vector<Common::UString> &textures) {
 	bool hasTexture = false;
 
 	_textures.resize(textures.size());
+	_pltNames.clear();
 
 	bool hasAlpha = true;
 	bool isDecal  = true;
@@ -355,6 +373,11 @@ void ModelNode::loadTextures(const std::vector<Common::UString> &textures) {
 				_textures[t] = TextureMan.get(textures[t]);
 				hasTexture = true;
 
+				if (TextureMan.isPLT(textures[t])) {
+					_pltNames.resize(textures.size());
+					_pltNames[t] = textures[t];
+				}
+
 				if (!_textures[t].getTexture().hasAlpha())
 					hasAlpha = false;
 				if (_textures[t].getTexture().getTXI().getFeatures().alphaMean == 1.0)
@@ -561,17 +584,17 @@ void ModelNode::interpolateOrientation(float time, float &x, float &y, float &z,
 		y = last.y;
 		z = last.z;
 		a = Common::rad2deg(acos(last.q) * 2.0);
+		return;
 	}
 
 	const QuaternionKeyFrame &next = _orientationFrames[lastFrame + 1];
 
 	const float f = (time - last.time) / (next.time - last.time);
-	x = f * next.x + (1.0f - f) * last.x;
-	y = f * next.y + (1.0f - f) * last.y;
-	z = f * next.z + (1.0f - f) * last.z;
 
-	const float q = f * next.q + (1.0f - f) * last.q;
-	a = Common::rad2deg(acos(q) * 2.0);
+	const Common::Quat q = Common::Quat::slerp(Common::Quat(last.x, last.y, last.z, last.q),
+	                                           Common::Quat(next.x, next.y, next.z, next.q), f);
+
+	q.getAxisAngle(a, x, y, z);
 }
 
 } // End of namespace Aurora
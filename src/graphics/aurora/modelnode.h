@@ -68,6 +68,8 @@ struct QuaternionKeyFrame {
 class ModelNode {
 public:
 	ModelNode(Model &model);
+	/** Copy a node into another model, sharing its geometry. The copy has no parent or children. */
+	ModelNode(Model &model, const ModelNode &node);
 	~ModelNode();
 
 	/** Get the node's name. */
@@ -140,6 +142,7 @@ protected:
 	float _shininess;    ///< Shiny?
 
 	std::vector<TextureHandle> _textures; ///< Textures.
+	std::vector<Common::UString> _pltNames; ///< Names of the textures that are PLTs, by texture index.
 
 	bool _isTransparent;
 
@@ -202,10 +202,14 @@ TextureHandle TextureManager::add(Texture *texture, Common::UString name) {
 	return TextureHandle(text);
 }
 
+bool TextureManager::isPLT(const Common::UString &name) const {
+	return ResMan.hasResource(name, ::Aurora::kFileTypePLT);
+}
+
 TextureHandle TextureManager::get(const Common::UString &name) {
-	Common::StackLock lock(_mutex);
+	if (isPLT(name)) {
+		Common::StackLock lock(_mutex);
 
-	if (ResMan.hasResource(name, ::Aurora::kFileTypePLT)) {
 		_plts.push_back(new ManagedPLT(name));
 
 		_newPLTs.push_back(PLTHandle(--_plts.end()));
@@ -213,18 +217,31 @@ TextureHandle TextureManager::get(const Common::UString &name) {
 		return _newPLTs.back().getPLT().getTexture();
 	}
 
+	{
+		Common::StackLock lock(_mutex);
+
+		TextureMap::iterator texture = _textures.find(name);
+		if (texture != _textures.end())
+			return TextureHandle(texture);
+	}
+
+	// Decode the image without holding the lock, so that several threads can load textures at once
+	Texture *t = new Texture(name);
+
+	Common::StackLock lock(_mutex);
+
 	TextureMap::iterator texture = _textures.find(name);
 	if (texture == _textures.end()) {
 		std::pair<TextureMap::iterator, bool> result;
 
-		ManagedTexture *t = new ManagedTexture(name);
-
-		result = _textures.insert(std::make_pair(name, t));
+		result = _textures.insert(std::make_pair(name, new ManagedTexture(name, t)));
 
 		texture = result.first;
 
 		texture->second->reloadable = true;
-	}
+	} else
+		// Another thread loaded the same texture in the meantime
+		delete t;
 
 	return TextureHandle(texture);
 }
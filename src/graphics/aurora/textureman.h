@@ -130,6 +130,9 @@ public:
 	TextureHandle add(Texture *texture, Common::UString name = "");
 	TextureHandle get(const Common::UString &name);
 
+	/** Is this texture a PLT? Every get() of a PLT creates a new, separately colorable copy. */
+	bool isPLT(const Common::UString &name) const;
+
 
 	void reloadAll();
 
@@ -0,0 +1,110 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file graphics/frustum.cpp
+ *  A view frustum, for culling.
+ */
+
+#include <cmath>
+
+#include "graphics/frustum.h"
+
+namespace Graphics {
+
+Frustum::Frustum() {
+	// An empty frustum contains everything
+	for (int i = 0; i < 6; i++) {
+		_planes[i][0] = 0.0f;
+		_planes[i][1] = 0.0f;
+		_planes[i][2] = 0.0f;
+		_planes[i][3] = 1.0f;
+	}
+}
+
+void Frustum::set(const Common::Mat4 &clip) {
+	// Each plane is the sum or difference of the fourth and one other row of
+	// the clip matrix (Gribb/Hartmann): left, right, bottom, top, near, far
+
+	for (int i = 0; i < 3; i++) {
+		for (int j = 0; j < 4; j++) {
+			_planes[i * 2 + 0][j] = clip(3, j) + clip(i, j);
+			_planes[i * 2 + 1][j] = clip(3, j) - clip(i, j);
+		}
+	}
+
+	for (int i = 0; i < 6; i++) {
+		const float length = sqrtf(_planes[i][0] * _planes[i][0] +
+		                           _planes[i][1] * _planes[i][1] +
+		                           _planes[i][2] * _planes[i][2]);
+		if (length == 0.0f)
+			continue;
+
+		for (int j = 0; j < 4; j++)
+			_planes[i][j] /= length;
+	}
+}
+
+void Frustum::set(const Common::Mat4 &projection, const float *position, const float *orientation) {
+	// The same camera transformation GraphicsManager::renderWorld() applies
+	Common::Mat4 view;
+
+	view.rotate(-orientation[0], 1.0f, 0.0f, 0.0f);
+	view.rotate( orientation[1], 0.0f, 1.0f, 0.0f);
+	view.rotate(-orientation[2], 0.0f, 0.0f, 1.0f);
+
+	view.translate(-position[0], -position[1], position[2]);
+
+	set(projection * view);
+}
+
+Frustum::Intersection Frustum::test(const float *min, const float *max) const {
+	Intersection result = kInside;
+
+	for (int i = 0; i < 6; i++) {
+		const float *p = _planes[i];
+
+		// The corners furthest along and against the plane normal
+		const float farX  = (p[0] >= 0.0f) ? max[0] : min[0];
+		const float farY  = (p[1] >= 0.0f) ? max[1] : min[1];
+		const float farZ  = (p[2] >= 0.0f) ? max[2] : min[2];
+		const float nearX = (p[0] >= 0.0f) ? min[0] : max[0];
+		const float nearY = (p[1] >= 0.0f) ? min[1] : max[1];
+		const float nearZ = (p[2] >= 0.0f) ? min[2] : max[2];
+
+		if ((p[0] * farX + p[1] * farY + p[2] * farZ + p[3]) < 0.0f)
+			return kOutside;
+
+		if ((p[0] * nearX + p[1] * nearY + p[2] * nearZ + p[3]) < 0.0f)
+			result = kIntersect;
+	}
+
+	return result;
+}
+
+bool Frustum::isIn(const float *min, const float *max) const {
+	return test(min, max) != kOutside;
+}
+
+} // End of namespace Graphics
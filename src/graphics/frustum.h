@@ -0,0 +1,67 @@
+/* xoreos - A reimplementation of BioWare's Aurora engine
+ *
+ * xoreos is the legal property of its developers, whose names can be
+ * found in the AUTHORS file distributed with this source
+ * distribution.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 3
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ *
+ * The Infinity, Aurora, Odyssey, Eclipse and Lycium engines, Copyright (c) BioWare corp.
+ * The Electron engine, Copyright (c) Obsidian Entertainment and BioWare corp.
+ */
+
+/** @file graphics/frustum.h
+ *  A view frustum, for culling.
+ */
+
+#ifndef GRAPHICS_FRUSTUM_H
+#define GRAPHICS_FRUSTUM_H
+
+#include "common/mat4.h"
+
+namespace Graphics {
+
+/** A view frustum, the six planes bounding what the camera can see. */
+class Frustum {
+public:
+	/** How a box relates to the frustum. */
+	enum Intersection {
+		kOutside   = 0, ///< Completely outside.
+		kIntersect    , ///< Partly inside.
+		kInside         ///< Completely inside.
+	};
+
+	Frustum();
+
+	/** Extract the planes from a combined projection * modelview matrix. */
+	void set(const Common::Mat4 &clip);
+	/** Set the frustum of a camera, positioned and oriented like the world is rendered. */
+	void set(const Common::Mat4 &projection, const float *position, const float *orientation);
+
+	/** Test an axis-aligned box against the frustum. */
+	Intersection test(const float *min, const float *max) const;
+
+	/** Is any part of the axis-aligned box within the frustum? */
+	bool isIn(const float *min, const float *max) const;
+
+private:
+	/** The planes (a, b, c, d) with normals pointing inward. */
+	float _planes[6][4];
+};
+
+} // End of namespace Graphics
+
+#endif // GRAPHICS_FRUSTUM_H
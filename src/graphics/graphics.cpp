@@ -37,11 +37,14 @@
 #include "common/configman.h"
 #include "common/threads.h"
 #include "common/transmatrix.h"
+#include "common/timestamp.h"
 
 #include "events/requests.h"
 #include "events/events.h"
 #include "events/notifications.h"
 
+#include "aurora/nwscript/profiler.h"
+
 #include "graphics/graphics.h"
 #include "graphics/util.h"
 #include "graphics/cursor.h"
@@ -50,6 +53,7 @@
 #include "graphics/glcontainer.h"
 #include "graphics/renderable.h"
 #include "graphics/camera.h"
+#include "graphics/frustum.h"
 
 #include "graphics/images/decoder.h"
 #include "graphics/images/screenshot.h"
@@ -58,7 +62,14 @@ DECLARE_SINGLETON(Graphics::GraphicsManager)
 
 namespace Graphics {
 
-GraphicsManager::GraphicsManager() : _projection(4, 4), _projectionInv(4, 4) {
+/** How far world bounding boxes are enlarged in the culling tree.
+ *
+ *  This lets objects move a bit without touching the tree, and covers
+ *  animations reaching slightly out of their model's bounding box.
+ */
+static const float kWorldTreeMargin = 0.5f;
+
+GraphicsManager::GraphicsManager() : _worldTree(kWorldTreeMargin) {
 	_ready = false;
 
 	_needManualDeS3TC        = false;
@@ -87,6 +98,11 @@ GraphicsManager::GraphicsManager() : _projection(4, 4), _projectionInv(4, 4) {
 	_hasAbandoned = false;
 
 	_lastSampled = 0;
+
+	_cullFrame     = 0;
+	_cullSubmitted = 0;
+	_cullCulled    = 0;
+	_cullTime      = 0;
 }
 
 GraphicsManager::~GraphicsManager() {
@@ -418,7 +434,7 @@ void GraphicsManager::perspective(float fovy, float aspect, float zNear, float z
 
 bool GraphicsManager::project(float x, float y, float z, float &sX, float &sY, float &sZ) {
 	// This is our projection matrix
-	Common::Matrix proj = _projection;
+	const Common::Mat4 &proj = _projection;
 
 
 	// Generate the model matrix
@@ -442,28 +458,16 @@ bool GraphicsManager::project(float x, float y, float z, float &sX, float &sY, f
 	model.translate(-cPos[0], -cPos[1], cPos[2]);
 
 
-	// Generate a matrix for the coordinates
-
-	Common::Matrix coords(4, 1);
-
-	coords(0, 0) = x;
-	coords(1, 0) = y;
-	coords(2, 0) = z;
-	coords(3, 0) = 1.0;
-
-
-	// Multiply them
-	Common::Matrix v(proj * model * coords);
+	// Multiply them with the coordinates
+	const Common::Vec4 c = (proj * model) * Common::Vec4(x, y, z, 1.0);
 
 
 	// Projection divide
 
-	if (v(3, 0) == 0.0)
+	if (c[3] == 0.0)
 		return false;
 
-	v(0, 0) /= v(3, 0);
-	v(1, 0) /= v(3, 0);
-	v(2, 0) /= v(3, 0);
+	const Common::Vec3 v = c.getProjected();
 
 	// Viewport coordinates
 
@@ -475,9 +479,9 @@ bool GraphicsManager::project(float x, float y, float z, float &sX, float &sY, f
 	view[3] = _screen->h;
 
 
-	sX = view[0] + view[2] * (v(0, 0) + 1.0) / 2.0;
-	sY = view[1] + view[3] * (v(1, 0) + 1.0) / 2.0;
-	sZ =                     (v(2, 0) + 1.0) / 2.0;
+	sX = view[0] + view[2] * (v[0] + 1.0) / 2.0;
+	sY = view[1] + view[3] * (v[1] + 1.0) / 2.0;
+	sZ =                     (v[2] + 1.0) / 2.0;
 
 	sX -= view[2] / 2.0;
 	sY -= view[3] / 2.0;
@@ -527,47 +531,34 @@ bool GraphicsManager::unproject(float x, float y,
 		float zFar  = 1.0;
 
 
-		// Generate a matrix for the coordinates at the near plane
+		// The coordinates at the near and far plane
 
-		Common::Matrix coordsNear(4, 1);
+		const float cX = ((2 * (x - view[0])) / (view[2])) - 1.0;
+		const float cY = ((2 * (y - view[1])) / (view[3])) - 1.0;
 
-		coordsNear(0, 0) = ((2 * (x - view[0])) / (view[2])) - 1.0;
-		coordsNear(1, 0) = ((2 * (y - view[1])) / (view[3])) - 1.0;
-		coordsNear(2, 0) = (2 * zNear) - 1.0;
-		coordsNear(3, 0) = 1.0;
-
-
-
-		// Generate a matrix for the coordinates at the far plane
-
-		Common::Matrix coordsFar(4, 1);
-
-		coordsFar(0, 0) = ((2 * (x - view[0])) / (view[2])) - 1.0;
-		coordsFar(1, 0) = ((2 * (y - view[1])) / (view[3])) - 1.0;
-		coordsFar(2, 0) = (2 * zFar) - 1.0;
-		coordsFar(3, 0) = 1.0;
+		const Common::Vec4 coordsNear(cX, cY, (2 * zNear) - 1.0, 1.0);
+		const Common::Vec4 coordsFar (cX, cY, (2 * zFar ) - 1.0, 1.0);
 
 
 		// Unproject
-		Common::Matrix oNear(model * coordsNear);
-		Common::Matrix oFar (model * coordsFar );
-		if ((oNear(3, 0) == 0.0) || (oNear(3, 0) == 0.0))
+		const Common::Vec4 oNear(model * coordsNear);
+		const Common::Vec4 oFar (model * coordsFar );
+		if ((oNear[3] == 0.0) || (oFar[3] == 0.0))
 			return false;
 
 
 		// And return the values
 
-		oNear(3, 0) = 1.0 / oNear(3, 0);
+		const Common::Vec3 pNear = oNear.getProjected();
+		const Common::Vec3 pFar  = oFar .getProjected();
 
-		x1 = oNear(0, 0) * oNear(3, 0);
-		y1 = oNear(1, 0) * oNear(3, 0);
-		z1 = oNear(2, 0) * oNear(3, 0);
+		x1 = pNear[0];
+		y1 = pNear[1];
+		z1 = pNear[2];
 
-		oFar(3, 0) = 1.0 / oFar(3, 0);
-
-		x2 = oFar(0, 0) * oFar(3, 0);
-		y2 = oFar(1, 0) * oFar(3, 0);
-		z2 = oFar(2, 0) * oFar(3, 0);
+		x2 = pFar[0];
+		y2 = pFar[1];
+		z2 = pFar[2];
 
 	} catch (Common::Exception &e) {
 		Common::printException(e, "WARNING: ");
@@ -593,6 +584,58 @@ void GraphicsManager::unlockFrame() {
 	_frameLock--;
 }
 
+void GraphicsManager::updateWorldBound(Renderable &renderable) {
+	float min[3], max[3];
+	const bool hasBound = renderable._cullable && renderable.getWorldBound(min, max);
+
+	Common::StackLock lock(_worldTreeMutex);
+
+	if (!hasBound) {
+		if (renderable._cullProxy >= 0)
+			_worldTree.remove(renderable._cullProxy);
+
+		renderable._cullProxy = -1;
+		return;
+	}
+
+	if (renderable._cullProxy < 0)
+		renderable._cullProxy = _worldTree.insert(min, max, &renderable);
+	else
+		_worldTree.update(renderable._cullProxy, min, max);
+}
+
+void GraphicsManager::getCullStatistics(uint32 &submitted, uint32 &culled, uint32 &cullTime) const {
+	submitted = _cullSubmitted;
+	culled    = _cullCulled;
+	cullTime  = _cullTime;
+}
+
+void GraphicsManager::cullWorld(const float *cPos, const float *cOrient) {
+	const uint64 startTime = Common::getMicroseconds();
+
+	Frustum frustum;
+	frustum.set(_projection, cPos, cOrient);
+
+	_cullFrame++;
+
+	_inFrustum.clear();
+
+	_worldTreeMutex.lock();
+
+	_worldTree.query(frustum, _inFrustum);
+	for (std::vector<void *>::iterator o = _inFrustum.begin(); o != _inFrustum.end(); ++o)
+		static_cast<Renderable *>(*o)->_cullFrame = _cullFrame;
+
+	_worldTreeMutex.unlock();
+
+	_cullTime = Common::getMicroseconds() - startTime;
+}
+
+bool GraphicsManager::isCulled(const Renderable &renderable) const {
+	// Objects without a bounding box are never culled
+	return (renderable._cullProxy >= 0) && (renderable._cullFrame != _cullFrame);
+}
+
 void GraphicsManager::recalculateObjectDistances() {
 	// World objects
 	QueueMan.lockQueue(kQueueVisibleWorldObject);
@@ -694,6 +737,39 @@ Renderable *GraphicsManager::getGUIObjectAt(float x, float y) const {
 	return object;
 }
 
+/** Hit-testing a ray against clickable world objects. */
+class PickRayTest : public AABBTree::RayTest {
+public:
+	PickRayTest(const float *from, const float *to) {
+		for (int i = 0; i < 3; i++) {
+			_from[i] = from[i];
+			_to  [i] = to  [i];
+		}
+	}
+
+	float test(void *data) {
+		const Renderable &r = *static_cast<const Renderable *>(data);
+
+		if (!r.isClickable())
+			// Object isn't clickable, don't check
+			return -1.0f;
+
+		float min[3], max[3], t;
+		if (!r.getWorldBound(min, max) || !AABBTree::intersectRay(_from, _to, min, max, t))
+			return -1.0f;
+
+		// Let the object have the final say
+		if (!r.isIn(_from[0], _from[1], _from[2], _to[0], _to[1], _to[2]))
+			return -1.0f;
+
+		return t;
+	}
+
+private:
+	float _from[3];
+	float _to  [3];
+};
+
 Renderable *GraphicsManager::getWorldObjectAt(float x, float y) const {
 	if (QueueMan.isQueueEmpty(kQueueVisibleWorldObject))
 		return 0;
@@ -701,31 +777,16 @@ Renderable *GraphicsManager::getWorldObjectAt(float x, float y) const {
 		// Map the screen coordinates to OpenGL world screen coordinates
 	y = _screen->h - y;
 
-	float x1, y1, z1, x2, y2, z2;
-	if (!unproject(x, y, x1, y1, z1, x2, y2, z2))
+	float from[3], to[3];
+	if (!unproject(x, y, from[0], from[1], from[2], to[0], to[1], to[2]))
 		return 0;
 
-	Renderable *object = 0;
-
-	QueueMan.lockQueue(kQueueVisibleWorldObject);
-	const std::list<Queueable *> &objects = QueueMan.getQueue(kQueueVisibleWorldObject);
-
-	for (std::list<Queueable *>::const_iterator o = objects.begin(); o != objects.end(); ++o) {
-		Renderable &r = static_cast<Renderable &>(**o);
+	// Find the nearest clickable object along the line, through the world tree
+	PickRayTest pickTest(from, to);
 
-		if (!r.isClickable())
-			// Object isn't clickable, don't check
-			continue;
+	Common::StackLock lock(_worldTreeMutex);
 
-		// If the line intersects with the object, return it
-		if (r.isIn(x1, y1, z1, x2, y2, z2)) {
-			object = &r;
-			break;
-		}
-	}
-
-	QueueMan.unlockQueue(kQueueVisibleWorldObject);
-	return object;
+	return static_cast<Renderable *>(_worldTree.raycast(from, to, pickTest));
 }
 
 Renderable *GraphicsManager::getObjectAt(float x, float y) {
@@ -843,12 +904,26 @@ bool GraphicsManager::renderWorld() {
 		static_cast<Renderable *>(*o)->advanceTime(elapsedTime);
 	}
 
+	// Only draw objects within the view frustum
+	cullWorld(cPos, cOrient);
+
+	_cullSubmitted = 0;
+	_cullCulled    = 0;
+
 	// Draw opaque objects
 	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
 	     o != objects.rend(); ++o) {
 
+		Renderable *object = static_cast<Renderable *>(*o);
+		if (isCulled(*object)) {
+			_cullCulled++;
+			continue;
+		}
+
+		_cullSubmitted++;
+
 		glPushMatrix();
-		static_cast<Renderable *>(*o)->render(kRenderPassOpaque);
+		object->render(kRenderPassOpaque);
 		glPopMatrix();
 	}
 
@@ -856,8 +931,12 @@ bool GraphicsManager::renderWorld() {
 	for (std::list<Queueable *>::const_reverse_iterator o = objects.rbegin();
 	     o != objects.rend(); ++o) {
 
+		Renderable *object = static_cast<Renderable *>(*o);
+		if (isCulled(*object))
+			continue;
+
 		glPushMatrix();
-		static_cast<Renderable *>(*o)->render(kRenderPassTransparent);
+		object->render(kRenderPassTransparent);
 		glPopMatrix();
 	}
 
@@ -926,6 +1005,7 @@ void GraphicsManager::endScene() {
 	}
 
 	_fpsCounter->finishedFrame();
+	ScriptProf.nextFrame();
 
 	if (_fsaa > 0)
 		glDisable(GL_MULTISAMPLE_ARB);
@@ -34,11 +34,12 @@
 #include <list>
 
 #include "graphics/types.h"
+#include "graphics/aabbtree.h"
 
 #include "common/types.h"
 #include "common/singleton.h"
 #include "common/mutex.h"
-#include "common/matrix.h"
+#include "common/mat4.h"
 
 namespace Common {
 	class UString;
@@ -134,6 +135,17 @@ public:
 	/** Recalculate all object distances to the camera and resort the objebts. */
 	void recalculateObjectDistances();
 
+	/** Add, move or remove a world object in the culling tree, following its visibility. */
+	void updateWorldBound(Renderable &renderable);
+
+	/** Get the culling statistics of the last frame.
+	 *
+	 *  @param submitted The number of world objects rendered.
+	 *  @param culled    The number of world objects outside the view frustum.
+	 *  @param cullTime  The time spent culling, in microseconds.
+	 */
+	void getCullStatistics(uint32 &submitted, uint32 &culled, uint32 &cullTime) const;
+
 	/** Lock the frame mutex. */
 	void lockFrame();
 	/** Unlock the frame mutex. */
@@ -179,8 +191,8 @@ private:
 
 	FPSCounter *_fpsCounter; ///< Counts the current frames per seconds value.
 	uint32 _lastSampled; ///< Timestamp used to advance animations.
-	Common::Matrix _projection;    ///< Our projection matrix.
-	Common::Matrix _projectionInv; ///< The inverse of our projection matrix.
+	Common::Mat4 _projection;    ///< Our projection matrix.
+	Common::Mat4 _projectionInv; ///< The inverse of our projection matrix.
 
 	uint32 _frameLock;
 
@@ -202,6 +214,16 @@ private:
 
 	Common::Mutex _abandonMutex; ///< A mutex protecting abandoned structures.
 
+	AABBTree              _worldTree;      ///< The bounding boxes of all visible world objects.
+	mutable Common::Mutex _worldTreeMutex; ///< A mutex protecting the world tree.
+
+	std::vector<void *> _inFrustum; ///< The world objects found within the view frustum.
+
+	uint32 _cullFrame;     ///< The current culling frame.
+	uint32 _cullSubmitted; ///< The number of world objects rendered in the last frame.
+	uint32 _cullCulled;    ///< The number of world objects culled in the last frame.
+	uint32 _cullTime;      ///< The time spent culling in the last frame, in microseconds.
+
 	void initSize(int width, int height, bool fullscreen);
 	void setupScene();
 
@@ -228,6 +250,11 @@ private:
 
 	void buildNewTextures();
 
+	/** Mark all world objects within the view frustum of the camera. */
+	void cullWorld(const float *cPos, const float *cOrient);
+	/** Was this world object culled in the current frame? */
+	bool isCulled(const Renderable &renderable) const;
+
 	void beginScene();
 	bool playVideo();
 	bool renderWorld();
@@ -27,29 +27,28 @@
  *  A index buffer implementation.
  */
 
-#include <cstdlib>
-
 #include "graphics/indexbuffer.h"
 
 namespace Graphics {
 
-IndexBuffer::IndexBuffer() : _count(0), _size(0), _type(GL_UNSIGNED_INT), _data(0) {
+IndexBuffer::IndexBuffer() : _count(0), _size(0), _type(GL_UNSIGNED_INT) {
 	//ctor
 }
 
-IndexBuffer::IndexBuffer(const IndexBuffer &other) {
-	*this = other;
+IndexBuffer::IndexBuffer(const IndexBuffer &other) :
+	_count(other._count), _size(other._size), _type(other._type), _data(other._data) {
+
 }
 
 IndexBuffer::~IndexBuffer() {
-	if (_data)
-		std::free(_data);
 }
 
 IndexBuffer &IndexBuffer::operator=(const IndexBuffer &other) {
 	if (this != &other) {
-		setSize(other._count, other._size, other._type);
-		memcpy(_data, other._data, other._count * other._size);
+		_count = other._count;
+		_size  = other._size;
+		_type  = other._type;
+		_data  = other._data;
 	}
 	return *this;
 }
@@ -59,27 +58,28 @@ void IndexBuffer::setSize(uint32 indexCount, uint32 indexSize, GLenum indexType)
 	_size = indexSize;
 	_type = indexType;
 
-	if (_data)
-		std::free(_data);
-
 	if (_count * _size)
-		_data = std::malloc(_count * _size);
+		_data.reset(new byte[_count * _size]);
 	else
-		_data = NULL;
+		_data.reset();
 }
 
 GLvoid *IndexBuffer::getData() {
-	return _data;
+	return _data.get();
 }
 
 const GLvoid *IndexBuffer::getData() const {
-	return _data;
+	return _data.get();
 }
 
 uint32 IndexBuffer::getCount() const {
 	return _count;
 }
 
+uint32 IndexBuffer::getSize() const {
+	return _size;
+}
+
 GLenum IndexBuffer::getType() const {
 	return _type;
 }
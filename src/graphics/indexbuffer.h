@@ -30,11 +30,19 @@
 #ifndef GRAPHICS_INDEXBUFFER_H
 #define GRAPHICS_INDEXBUFFER_H
 
+#include <boost/shared_array.hpp>
+
+#include "common/types.h"
+
 #include "graphics/types.h"
 
 namespace Graphics {
 
-/** Buffer containing indices data */
+/** Buffer containing indices data.
+ *
+ *  Copies share the same data, so that model instances don't duplicate
+ *  their geometry. setSize() gives a buffer new data of its own.
+ */
 class IndexBuffer {
 public:
 	IndexBuffer();
@@ -57,6 +65,9 @@ public:
 	/** Get element count */
 	uint32 getCount() const;
 
+	/** Get element size in bytes */
+	uint32 getSize() const;
+
 	/** Get element type */
 	GLenum getType() const;
 
@@ -64,7 +75,8 @@ private:
 	uint32 _count; ///< Number of elements in buffer
 	uint32 _size;  ///< Size of a buffer element in bytes
 	GLenum _type;  ///< Element type (GL_UNSIGNED_SHORT, GL_UNSIGNED_INT, ...)
-	GLvoid *_data; ///< Buffer data
+
+	boost::shared_array<byte> _data; ///< Buffer data
 };
 
 }
@@ -35,7 +35,9 @@
 
 namespace Graphics {
 
-Renderable::Renderable(RenderableType type) : _clickable(false), _distance(0.0) {
+Renderable::Renderable(RenderableType type) : _clickable(false), _distance(0.0),
+	_cullable(false), _cullProxy(-1), _cullFrame(0) {
+
 	if        (type == kRenderableTypeVideo) {
 		_queueExists  = kQueueVideo;
 		_queueVisible = kQueueVisibleVideo;
@@ -102,10 +104,29 @@ void Renderable::show() {
 	sortQueue(_queueVisible);
 
 	unlockQueue(_queueVisible);
+
+	if (_queueVisible == kQueueVisibleWorldObject) {
+		_cullable = true;
+		GfxMan.updateWorldBound(*this);
+	}
 }
 
 void Renderable::hide() {
 	removeFromQueue(_queueVisible);
+
+	if (_cullable) {
+		_cullable = false;
+		GfxMan.updateWorldBound(*this);
+	}
+}
+
+void Renderable::updateWorldBound() {
+	if (_cullable)
+		GfxMan.updateWorldBound(*this);
+}
+
+bool Renderable::getWorldBound(float *min, float *max) const {
+	return false;
 }
 
 bool Renderable::isIn(float x, float y) const {
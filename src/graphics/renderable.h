@@ -75,6 +75,12 @@ public:
 	virtual void show(); ///< Show the object.
 	virtual void hide(); ///< Hide the object.
 
+	/** Get the object's bounding box in world space.
+	 *
+	 *  @return false if the object has no bounding box, and can't be culled.
+	 */
+	virtual bool getWorldBound(float *min, float *max) const;
+
 	/** Is that point within the object? */
 	virtual bool isIn(float x, float y) const;
 	/** Is that point within the object? */
@@ -94,6 +100,16 @@ protected:
 	double _distance; ///< The distance of the object from the viewer.
 
 	void resort();
+
+	/** Signal that the object's world bounding box changed. */
+	void updateWorldBound();
+
+private:
+	bool   _cullable;  ///< Is the object visible in the world, and can be culled?
+	int32  _cullProxy; ///< The object's ID in the world culling tree, or -1.
+	uint32 _cullFrame; ///< The last frame the object was within the view frustum.
+
+	friend class GraphicsManager;
 };
 
 } // End of namespace Graphics
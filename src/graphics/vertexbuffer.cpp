@@ -27,30 +27,29 @@
  *  Vertex buffer implementation.
  */
 
-#include <cstdlib>
-
 #include "graphics/vertexbuffer.h"
 
 namespace Graphics {
 
-VertexBuffer::VertexBuffer() : _count(0), _size(0), _data(0) {
+VertexBuffer::VertexBuffer() : _count(0), _size(0) {
 	//ctor
 }
 
-VertexBuffer::VertexBuffer(const VertexBuffer &other) {
-	*this = other;
+VertexBuffer::VertexBuffer(const VertexBuffer &other) :
+	_decl(other._decl), _count(other._count), _size(other._size), _data(other._data) {
+
 }
 
 VertexBuffer::~VertexBuffer() {
-	if (_data)
-		std::free(_data);
 }
 
 VertexBuffer &VertexBuffer::operator=(const VertexBuffer &other) {
+	// Share the data, which also keeps the declaration's pointers into it valid
 	if (this != &other) {
-		setVertexDecl(other._decl);
-		setSize(other._count, other._size);
-		memcpy(_data, other._data, other._count * other._size);
+		_decl  = other._decl;
+		_count = other._count;
+		_size  = other._size;
+		_data  = other._data;
 	}
 	return *this;
 }
@@ -59,13 +58,10 @@ void VertexBuffer::setSize(uint32 vertCount, uint32 vertSize) {
 	_count = vertCount;
 	_size = vertSize;
 
-	if (_data)
-		std::free(_data);
-
 	if (_count * _size)
-		_data = std::malloc(_count * _size);
+		_data.reset(new byte[_count * _size]);
 	else
-		_data = NULL;
+		_data.reset();
 }
 
 void VertexBuffer::setVertexDecl(const VertexDecl &decl) {
@@ -73,11 +69,11 @@ void VertexBuffer::setVertexDecl(const VertexDecl &decl) {
 }
 
 GLvoid *VertexBuffer::getData() {
-	return _data;
+	return _data.get();
 }
 
 const GLvoid *VertexBuffer::getData() const {
-	return _data;
+	return _data.get();
 }
 
 const VertexDecl &VertexBuffer::getVertexDecl() const {
@@ -32,6 +32,10 @@
 
 #include <vector>
 
+#include <boost/shared_array.hpp>
+
+#include "common/types.h"
+
 #include "graphics/types.h"
 
 namespace Graphics {
@@ -56,7 +60,11 @@ struct VertexAttrib {
 /** Vertex data layout */
 typedef std::vector<VertexAttrib> VertexDecl;
 
-/** Buffer containing vertex data */
+/** Buffer containing vertex data.
+ *
+ *  Copies share the same data, so that model instances don't duplicate
+ *  their geometry. setSize() gives a buffer new data of its own.
+ */
 class VertexBuffer {
 public:
 	VertexBuffer();
@@ -92,7 +100,8 @@ private:
 	VertexDecl _decl; ///< Vertex declaration
 	uint32 _count;    ///< Number of elements in buffer
 	uint32 _size;     ///< Size of a buffer element in bytes (vertex attributes size sum)
-	GLvoid *_data;    ///< Buffer data
+
+	boost::shared_array<byte> _data; ///< Buffer data
 };
 
 }
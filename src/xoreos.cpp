@@ -38,12 +38,17 @@
 #include "common/threads.h"
 #include "common/debugman.h"
 #include "common/configman.h"
+#include "common/filepool.h"
 
 #include "aurora/resman.h"
 #include "aurora/2dareg.h"
 #include "aurora/talkman.h"
 #include "aurora/util.h"
 
+#include "aurora/nwscript/ncsreg.h"
+#include "aurora/nwscript/profiler.h"
+#include "aurora/nwscript/interner.h"
+
 #include "graphics/queueman.h"
 #include "graphics/graphics.h"
 
@@ -68,6 +73,8 @@ void deinit();
 void initDebug();
 void listDebug();
 
+uint32 getCacheBudget(const Common::UString &key, int def);
+
 // *grumbles about Microsoft incompetence*
 #ifdef WIN32
 #define WIN32_LEAN_AND_MEAN
@@ -137,6 +144,26 @@ int main(int argc, char **argv) {
 	if (!Common::FilePath::isDirectory(baseDir) && !Common::FilePath::isRegularFile(baseDir))
 		error("No such file or directory \"%s\"", baseDir.c_str());
 
+	// Cache the resource indices of KEY files between runs
+	if (ConfigMan.getBool("indexcache", true))
+		ResMan.setIndexCache(Common::ConfigManager::getCacheDirectory());
+
+	// Budget for decompressed resources kept in memory, in MB
+	ResMan.setCacheSize(getCacheBudget("resourcecache", 32));
+
+	// Budget for parsed 2DAs kept across module changes, in MB
+	TwoDAReg.setMaxSize(getCacheBudget("2dacache", 16));
+
+	// Number of threads reading resources ahead of time. 0 disables prefetching
+	ResMan.setPrefetchThreads(MAX(ConfigMan.getInt("prefetchthreads", 2), 0));
+
+	// Fuse and remove redundant script instructions. Can be disabled for debugging
+	NCSReg.setOptimize(ConfigMan.getBool("nwscriptoptimize", true));
+
+	// Profile scripts and engine functions, flagging scripts exceeding their per-frame budget
+	ScriptProf.setEnabled(ConfigMan.getBool("nwscriptprofile", false));
+	ScriptProf.setInstructionBudget(MAX(ConfigMan.getInt("nwscriptbudget", 50000), 0));
+
 	Engines::GameThread *gameThread = new Engines::GameThread;
 	try {
 		// Initialize all necessary subsystems
@@ -205,6 +232,17 @@ void initConfig() {
 
 	ConfigMan.setBool(Common::kConfigRealmDefault, "skipvideos", false);
 
+	ConfigMan.setBool(Common::kConfigRealmDefault, "indexcache", true);
+	ConfigMan.setInt (Common::kConfigRealmDefault, "indexthreads", 0);
+	ConfigMan.setInt (Common::kConfigRealmDefault, "resourcecache", 32);
+	ConfigMan.setInt (Common::kConfigRealmDefault, "2dacache", 16);
+	ConfigMan.setInt (Common::kConfigRealmDefault, "prefetchthreads", 2);
+	ConfigMan.setBool(Common::kConfigRealmDefault, "nwscriptoptimize", true);
+	ConfigMan.setBool(Common::kConfigRealmDefault, "nwscriptprofile", false);
+	ConfigMan.setInt (Common::kConfigRealmDefault, "nwscriptbudget", 50000);
+	ConfigMan.setInt (Common::kConfigRealmDefault, "actionbudget", 4);
+	ConfigMan.setInt (Common::kConfigRealmDefault, "modelthreads", 0);
+
 	// Populate the new config with the defaults
 	if (newConfig) {
 		ConfigMan.setDefaults();
@@ -212,6 +250,16 @@ void initConfig() {
 	}
 }
 
+/** Read a cache budget from the config, given there in MB, and return it in bytes. */
+uint32 getCacheBudget(const Common::UString &key, int def) {
+	// Clamp to a sane size that still fits into 32 bits once converted to bytes
+	static const int kMaxCacheSizeMB = 2048;
+
+	const int size = CLIP(ConfigMan.getInt(key, def), 0, kMaxCacheSizeMB);
+
+	return ((uint32) size) * 1024 * 1024;
+}
+
 void initDebug() {
 	DebugMan.setDebugLevel(ConfigMan.getInt("debuglevel", 0));
 	DebugMan.setEnabled(DebugMan.parseChannelList(ConfigMan.getString("debugchannel")));
@@ -266,11 +314,18 @@ void deinit() {
 
 	Aurora::TalkManager::destroy();
 	Aurora::TwoDARegistry::destroy();
+	Aurora::NWScript::NCSRegistry::destroy();
+	Aurora::NWScript::ScriptProfiler::destroy();
 	Aurora::ResourceManager::destroy();
 	Aurora::FileTypeManager::destroy();
 
+	Common::FilePoolManager::destroy();
+
 	Engines::EngineManager::destroy();
 
+	// Objects and their variables refer to interned names until the engine is gone
+	Aurora::NWScript::StringInterner::destroy();
+
 	Events::EventsManager::destroy();
 	Events::RequestManager::destroy();
 	Events::TimerManager::destroy();